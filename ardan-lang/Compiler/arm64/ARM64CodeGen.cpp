@@ -737,7 +737,7 @@ R ARM64CodeGen::visitCall(CallExpression* expr) {
     int fnReg = regAlloc.alloc(); // register to hold function pointer
 
     // Determine function
-    auto ident = dynamic_cast<IdentifierExpression*>(expr->callee.get());
+    auto ident = node_cast<IdentifierExpression>(expr->callee.get());
     if (ident && ident->name == "print") {
         emitter.mov_abs(fnReg, reinterpret_cast<uint64_t>(&print_value));
     } else {
@@ -19,7 +19,7 @@
 using namespace std;
 
 EventLoop::EventLoop()
-: kq_fd(-1), wake_read_fd(-1), wake_write_fd(-1), running(false), task_counter(0)
+: draining_microtasks(false), kq_fd(-1), wake_read_fd(-1), wake_write_fd(-1), running(false), pending_work(0), task_counter(0)
 {
     kq_fd = kqueue();
     if (kq_fd == -1) {
@@ -83,6 +83,32 @@ void EventLoop::post(function<Value(vector<Value>)> fn, vector<Value> args) {
     (void)r;
 }
 
+void EventLoop::queueMicrotask(function<Value(vector<Value>)> fn, vector<Value> args) {
+    microtasks.push_back({ std::move(fn), std::move(args) });
+}
+
+void EventLoop::drainMicrotasks() {
+
+    // a job that re-enters here leaves its new jobs to the outer drain
+    if (draining_microtasks) return;
+    draining_microtasks = true;
+
+    while (!microtasks.empty()) {
+
+        Microtask job = std::move(microtasks.front());
+        microtasks.pop_front();
+
+        try {
+            job.fn(job.args);
+        } catch (const std::exception &e) {
+            cerr << "EventLoop microtask exception: " << e.what() << "\n";
+        }
+
+    }
+
+    draining_microtasks = false;
+}
+
 void EventLoop::addSocket(int fd,
                           function<void(int)> onReadable,
                           function<void(int)> onWritable)
@@ -144,12 +170,30 @@ void EventLoop::removeSocket(int fd) {
     write(wake_write_fd, &b, 1);
 }
 
+void EventLoop::ref() {
+    lock_guard<mutex> lock(mtx);
+    pending_work++;
+}
+
+void EventLoop::unref() {
+    {
+        lock_guard<mutex> lock(mtx);
+        if (pending_work > 0) pending_work--;
+    }
+
+    uint8_t b = 1;
+    write(wake_write_fd, &b, 1);
+}
+
 void EventLoop::run() {
     running = true;
 
     const int MAX_EVENTS = 64;
     struct kevent events[MAX_EVENTS];
 
+    // flush jobs queued by the synchronous part of the script
+    drainMicrotasks();
+
     while (true) {
 
         Task task;
@@ -186,12 +230,14 @@ void EventLoop::run() {
                 cerr << "EventLoop task exception: " << e.what() << "\n";
             }
 
+            drainMicrotasks();
+
             continue;
         }
 
         {
             lock_guard<mutex> lock(mtx);
-            if (!running && tasks.empty() && socketHandles.empty()) {
+            if (!running && tasks.empty() && socketHandles.empty() && pending_work == 0) {
                 break;
             }
         }
@@ -238,6 +284,7 @@ void EventLoop::run() {
                 } catch (const std::exception &e) {
                     cerr << "socket onReadable exception: " << e.what() << "\n";
                 }
+                drainMicrotasks();
             }
 
             if (ev.filter == EVFILT_WRITE && handle.onWritable) {
@@ -246,6 +293,7 @@ void EventLoop::run() {
                 } catch (const std::exception &e) {
                     cerr << "socket onWritable exception: " << e.what() << "\n";
                 }
+                drainMicrotasks();
             }
         } 
 
@@ -10,6 +10,7 @@
 
 //#include <stdio.h>
 //#include <queue>
+#include <deque>
 //#include <functional>
 //#include <mutex>
 //#include <condition_variable>
@@ -55,6 +56,13 @@ struct Task {
     std::function<Value(std::vector<Value>)> fn;
 };
 
+// A promise reaction job. Microtasks run to completion after the current
+// macrotask, before the loop goes back to kqueue for more I/O.
+struct Microtask {
+    std::function<Value(std::vector<Value>)> fn;
+    std::vector<Value> args;
+};
+
 struct SocketHandle {
     int fd;
     std::function<void(int)> onReadable;
@@ -69,6 +77,10 @@ public:
     // scheduling
     void post(std::function<Value(std::vector<Value>)> fn, std::vector<Value> args);
     
+    // microtasks (promise jobs)
+    void queueMicrotask(std::function<Value(std::vector<Value>)> fn, std::vector<Value> args);
+    void drainMicrotasks();
+    
     // socket management (register/unregister)
     void addSocket(int fd,
                    std::function<void(int)> onReadable,
@@ -76,21 +88,39 @@ public:
     
     // remove socket and close FD
     void removeSocket(int fd);
+
+    // keeps run() alive while off-loop work (fs requests on the thread
+    // pool) is outstanding. every ref() is paired with one unref().
+    void ref();
+    void unref();
     
     // loop control (run blocks on current thread)
     void run();
     void stop();
     
+    // the loop of the thread asking: a Worker thread's own loop, or the
+    // process-wide one
     static EventLoop& getInstance() {
+        if (current() != nullptr) return *current();
         static EventLoop* instance = new EventLoop(); // created once, thread-safe since C++11
         return *instance;
     }
 
+    // set by a thread that runs its own loop for as long as it runs it
+    static EventLoop*& current() {
+        static thread_local EventLoop* loop = nullptr;
+        return loop;
+    }
+
 private:
     // tasks
     std::queue<Task> tasks;
     std::unordered_map<std::string, std::vector<Value>> parameters;
 
+    // microtask queue, only touched from the loop thread
+    std::deque<Microtask> microtasks;
+    bool draining_microtasks;
+
     // socket handles registered with kqueue
     std::unordered_map<int, SocketHandle> socketHandles;
 
@@ -102,6 +132,7 @@ private:
     // concurrency
     std::mutex mtx;
     bool running;
+    size_t pending_work;
     
     // small helper to generate unique task ids
     size_t next_task_id();
@@ -0,0 +1,68 @@
+//
+//  ThreadPool.cpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#include "ThreadPool.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+ThreadPool::ThreadPool(size_t size) : stopping(false) {
+    for (size_t i = 0; i < size; i++) {
+        workers.emplace_back([this]() { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+// disk I/O gains little past a handful of threads
+size_t ThreadPool::default_size() {
+    size_t cores = thread::hardware_concurrency();
+    if (cores == 0) return 2;
+    return cores < 4 ? cores : 4;
+}
+
+void ThreadPool::submit(function<void()> job) {
+    {
+        lock_guard<mutex> lock(mtx);
+        jobs.push(std::move(job));
+    }
+    cv.notify_one();
+}
+
+void ThreadPool::work() {
+    while (true) {
+
+        function<void()> job;
+        {
+            unique_lock<mutex> lock(mtx);
+            cv.wait(lock, [this]() { return stopping || !jobs.empty(); });
+
+            if (stopping && jobs.empty()) return;
+
+            job = std::move(jobs.front());
+            jobs.pop();
+        }
+
+        try {
+            job();
+        } catch (const std::exception &e) {
+            cerr << "ThreadPool job exception: " << e.what() << "\n";
+        }
+    }
+}
@@ -0,0 +1,45 @@
+//
+//  ThreadPool.hpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#ifndef ThreadPool_hpp
+#define ThreadPool_hpp
+
+#include <queue>
+#include <vector>
+#include <thread>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
+// A fixed set of worker threads for blocking work (disk I/O) that must not
+// run on the event loop thread. Jobs never touch script values; they hand
+// their results back to the loop with EventLoop::post.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t workers);
+    ~ThreadPool();
+
+    void submit(std::function<void()> job);
+
+    static ThreadPool& getInstance() {
+        static ThreadPool* instance = new ThreadPool(default_size());
+        return *instance;
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stopping;
+
+    void work();
+    static size_t default_size();
+};
+
+#endif /* ThreadPool_hpp */
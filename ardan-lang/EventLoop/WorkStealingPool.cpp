@@ -0,0 +1,169 @@
+//
+//  WorkStealingPool.cpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 19/10/2026.
+//
+
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+// set while a thread is running a worker, so a nested run stays on it
+static thread_local bool inRun = false;
+
+WorkStealingPool::WorkStealingPool(size_t size) : failed(false), stopping(false) {
+    queues.push_back(make_unique<Queue>());
+    for (size_t i = 1; i <= size; i++) {
+        queues.push_back(make_unique<Queue>());
+        workers.emplace_back([this, i]() { work(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        lock_guard<mutex> lock(mtx);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+// one thread per core; the thread calling run() is the last one
+size_t WorkStealingPool::default_size() {
+    size_t cores = thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 0;
+}
+
+void WorkStealingPool::run(size_t count, size_t ranges, const function<void(const Next&)>& worker) {
+
+    ranges = max<size_t>(1, min(ranges, count));
+    size_t step = (count + ranges - 1) / max<size_t>(1, ranges);
+
+    if (inRun || workers.empty()) {
+        size_t begin = 0;
+        Next next = [&](Range& range) {
+            if (begin >= count) return false;
+            range = { begin, min(begin + step, count) };
+            begin = range.end;
+            return true;
+        };
+        worker(next);
+        return;
+    }
+
+    lock_guard<mutex> serial(running);
+
+    // dealt round robin, so every thread starts with its share
+    size_t slot = 0;
+    for (size_t begin = 0; begin < count; begin += step) {
+        Queue& queue = *queues[slot];
+        lock_guard<mutex> lock(queue.mtx);
+        queue.ranges.push_back({ begin, min(begin + step, count) });
+        slot = (slot + 1) % queues.size();
+    }
+
+    {
+        lock_guard<mutex> lock(mtx);
+        job = &worker;
+        active = queues.size();
+        error = nullptr;
+        failed = false;
+        generation++;
+    }
+    wake.notify_all();
+
+    participate(0, worker);
+
+    exception_ptr thrown;
+    {
+        unique_lock<mutex> lock(mtx);
+        done.wait(lock, [this]() { return active == 0; });
+        job = nullptr;
+        thrown = error;
+        error = nullptr;
+    }
+
+    // a failed run leaves ranges behind
+    for (auto& queue : queues) {
+        lock_guard<mutex> lock(queue->mtx);
+        queue->ranges.clear();
+    }
+
+    if (thrown) rethrow_exception(thrown);
+
+}
+
+void WorkStealingPool::work(size_t slot) {
+
+    uint64_t seen = 0;
+
+    while (true) {
+
+        const function<void(const Next&)>* worker;
+        {
+            unique_lock<mutex> lock(mtx);
+            wake.wait(lock, [&]() { return stopping || generation != seen; });
+
+            if (stopping) return;
+
+            seen = generation;
+            worker = job;
+        }
+
+        participate(slot, *worker);
+    }
+
+}
+
+void WorkStealingPool::participate(size_t slot, const function<void(const Next&)>& worker) {
+
+    Next next = [this, slot](Range& range) { return take(slot, range); };
+
+    inRun = true;
+    try {
+        worker(next);
+    } catch (...) {
+        lock_guard<mutex> lock(mtx);
+        if (!error) error = current_exception();
+        failed = true;
+    }
+    inRun = false;
+
+    lock_guard<mutex> lock(mtx);
+    if (--active == 0) done.notify_all();
+
+}
+
+bool WorkStealingPool::take(size_t slot, Range& range) {
+
+    if (failed) return false;
+
+    {
+        Queue& own = *queues[slot];
+        lock_guard<mutex> lock(own.mtx);
+        if (!own.ranges.empty()) {
+            range = own.ranges.back();
+            own.ranges.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < queues.size(); i++) {
+        Queue& victim = *queues[(slot + i) % queues.size()];
+        lock_guard<mutex> lock(victim.mtx);
+        if (!victim.ranges.empty()) {
+            range = victim.ranges.front();
+            victim.ranges.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+
+}
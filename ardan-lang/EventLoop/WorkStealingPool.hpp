@@ -0,0 +1,82 @@
+//
+//  WorkStealingPool.hpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 19/10/2026.
+//
+
+#ifndef WorkStealingPool_hpp
+#define WorkStealingPool_hpp
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <mutex>
+#include <condition_variable>
+
+// Worker threads for CPU-bound script work (Array.prototype.parallelMap and
+// friends). run() splits [0, count) into ranges and deals them out to one
+// queue per thread, the calling thread included. A thread takes ranges from
+// the back of its own queue and, once that is empty, steals from the front
+// of the others, so a slow range does not hold up the rest.
+class WorkStealingPool {
+public:
+    struct Range {
+        size_t begin;
+        size_t end;
+    };
+
+    // hands out the next range for the calling thread; false once none remain
+    using Next = std::function<bool(Range&)>;
+
+    explicit WorkStealingPool(size_t threads);
+    ~WorkStealingPool();
+
+    static WorkStealingPool& getInstance() {
+        static WorkStealingPool* instance = new WorkStealingPool(default_size());
+        return *instance;
+    }
+
+    // threads that take part in a run, the caller included
+    size_t size() const { return workers.size() + 1; }
+
+    // Calls worker(next) once on every thread and returns when all of them
+    // have. The first exception a worker throws stops the others taking
+    // ranges and is rethrown here. A run started from inside a worker runs
+    // on that thread alone.
+    void run(size_t count, size_t ranges, const std::function<void(const Next&)>& worker);
+
+private:
+    struct Queue {
+        std::mutex mtx;
+        std::deque<Range> ranges;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues;
+
+    // the run in progress
+    const std::function<void(const Next&)>* job = nullptr;
+    uint64_t generation = 0;
+    size_t active = 0;
+    std::exception_ptr error;
+    std::atomic<bool> failed;
+
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::condition_variable done;
+    // one run at a time
+    std::mutex running;
+    bool stopping;
+
+    void work(size_t slot);
+    void participate(size_t slot, const std::function<void(const Next&)>& worker);
+    bool take(size_t slot, Range& range);
+    static size_t default_size();
+};
+
+#endif /* WorkStealingPool_hpp */
@@ -0,0 +1,81 @@
+//
+//  AstContext.cpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 19/10/2026.
+//
+
+#include "AstContext.hpp"
+#include <algorithm>
+#include <mutex>
+#include <new>
+
+constexpr size_t MAX_BLOCK_SIZE = 64 * 1024;
+
+static thread_local AstContext* active = nullptr;
+
+// Never freed: nodes may still be reached from static objects destroyed at
+// exit, after this list would be.
+static AstContext* retain(AstContext* context) {
+
+    static auto* retained = new vector<AstContext*>();
+    static auto* retainedMutex = new mutex();
+
+    lock_guard<mutex> lock(*retainedMutex);
+    retained->push_back(context);
+    return context;
+
+}
+
+AstContext::~AstContext() {
+    for (char* block : blocks) {
+        ::operator delete(block);
+    }
+}
+
+void* AstContext::allocate(size_t size) {
+
+    constexpr size_t align = alignof(max_align_t);
+    size = (size + align - 1) & ~(align - 1);
+
+    if (size > size_t(end - next)) {
+        grow(size);
+    }
+
+    void* node = next;
+    next += size;
+    used += size;
+
+    return node;
+
+}
+
+void AstContext::grow(size_t size) {
+
+    size_t bytes = max(blockSize, size);
+    blockSize = min(blockSize * 2, MAX_BLOCK_SIZE);
+
+    char* block = static_cast<char*>(::operator new(bytes));
+    blocks.push_back(block);
+
+    next = block;
+    end = block + bytes;
+
+}
+
+AstContext& AstContext::current() {
+
+    if (active) return *active;
+
+    static thread_local AstContext* fallback = retain(new AstContext());
+    return *fallback;
+
+}
+
+AstContext::Scope::Scope() : owned(retain(new AstContext())), previous(active) {
+    active = owned;
+}
+
+AstContext::Scope::~Scope() {
+    active = previous;
+}
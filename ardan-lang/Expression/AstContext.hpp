@@ -0,0 +1,117 @@
+//
+//  AstContext.hpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 19/10/2026.
+//
+
+#ifndef AstContext_hpp
+#define AstContext_hpp
+
+#include <stdio.h>
+#include <cstddef>
+#include <vector>
+#include <type_traits>
+
+using namespace std;
+
+// Memory for the nodes of one parse. Nodes are bump-allocated out of a few
+// large blocks instead of one heap allocation each.
+class AstContext {
+public:
+    AstContext() = default;
+    ~AstContext();
+    AstContext(const AstContext&) = delete;
+    AstContext& operator=(const AstContext&) = delete;
+
+    void* allocate(size_t size);
+    // bytes handed out to nodes so far
+    size_t size() const { return used; }
+
+    // where nodes created on this thread go: the innermost Scope's context,
+    // or a per-thread default one outside any parse
+    static AstContext& current();
+
+    // A context made current for as long as the scope lives. Compiled code
+    // keeps pointing into its tree, so contexts are kept until exit.
+    class Scope {
+    public:
+        Scope();
+        ~Scope();
+        AstContext& context() { return *owned; }
+    private:
+        AstContext* owned;
+        AstContext* previous;
+    };
+
+private:
+    vector<char*> blocks;
+    char* next = nullptr;
+    char* end = nullptr;
+    size_t blockSize = 4096;
+    size_t used = 0;
+
+    void grow(size_t size);
+};
+
+// what node_cast compares instead of walking the class hierarchy
+enum class NodeKind : unsigned char {
+    Other,
+
+    Identifier,
+    Literal,
+    Binary,
+    Member,
+    Call,
+    New,
+    Sequence,
+    Spread,
+    RestParameter,
+    This,
+    Super,
+    Function,
+    Arrow,
+    Class,
+    Public,
+    Private,
+    Protected,
+    Static,
+    UIView,
+
+    Block,
+    ExpressionStatement,
+    Return,
+    Variable,
+    FunctionDeclaration,
+};
+
+// Base of Expression and Statement: nodes live in the current AstContext,
+// and deleting one runs its destructor without freeing its memory.
+class AstNode {
+public:
+    NodeKind nodeKind = NodeKind::Other;
+
+    static void* operator new(size_t size) { return AstContext::current().allocate(size); }
+    static void operator delete(void*) noexcept {}
+};
+
+// Gives a node class its kind: class X : public Tagged<Expression, NodeKind::X>
+template <typename Base, NodeKind Kind>
+class Tagged : public Base {
+public:
+    static constexpr NodeKind KIND = Kind;
+    Tagged() { this->nodeKind = Kind; }
+};
+
+// dynamic_cast for tagged node classes
+template <typename T, typename Node>
+T* node_cast(Node* node) {
+    // an Expression is never a Statement and the other way round
+    if constexpr (!is_base_of_v<Node, T>) {
+        return nullptr;
+    } else {
+        return node && node->nodeKind == T::KIND ? static_cast<T*>(node) : nullptr;
+    }
+}
+
+#endif /* AstContext_hpp */
@@ -24,18 +24,20 @@
 #include "Scanner/Token/TokenType.h"
 #include "ExpressionVisitor/ExpressionVisitor.hpp"
 #include "Interpreter/R.hpp"
+#include "Interpreter/ExecutionContext/Atom/Atom.h"
+#include "Expression/AstContext.hpp"
 
 using std::string;
 using std::unique_ptr;
 using std::vector;
 
-class Expression {
+class Expression : public AstNode {
 public:
     virtual ~Expression() = default;
     virtual R accept(ExpressionVisitor& visitor) = 0;
 };
 
-class LiteralExpression : public Expression {
+class LiteralExpression : public Tagged<Expression, NodeKind::Literal> {
 public:
     Token token;
     explicit LiteralExpression(Token token) : token(token) {}
@@ -43,13 +45,16 @@ public:
     R accept(ExpressionVisitor& visitor) { return visitor.visitLiteral(this); }
 };
 
-class IdentifierExpression : public Expression {
+class IdentifierExpression : public Tagged<Expression, NodeKind::Identifier> {
 public:
-    string name;
+    // name, interned once when the tree is built
+    Atom atom;
+    // the interned text, shared by every node with this name
+    const string& name;
     Token token;
     
-    explicit IdentifierExpression(const string& name) : name(name) {}
-    explicit IdentifierExpression(Token token) : token(token), name(token.lexeme) {}
+    explicit IdentifierExpression(const string& name) : atom(name), name(atom.str()) {}
+    explicit IdentifierExpression(Token token) : atom(token.lexeme), name(atom.str()), token(std::move(token)) {}
 
     R accept(ExpressionVisitor& visitor) { return visitor.visitIdentifier(this); }
 };
@@ -65,7 +70,7 @@ public:
     R accept(ExpressionVisitor& visitor) { return visitor.visitUnary(this); }
 };
 
-class BinaryExpression : public Expression {
+class BinaryExpression : public Tagged<Expression, NodeKind::Binary> {
 public:
     unique_ptr<Expression> left;
     Token op;
@@ -118,7 +123,7 @@ public:
     R accept(ExpressionVisitor& visitor) { return visitor.visitLogical(this); }
 };
 
-class CallExpression : public Expression {
+class CallExpression : public Tagged<Expression, NodeKind::Call> {
     
     enum class CallType {
         GLOBAL,
@@ -140,7 +145,7 @@ public:
     R accept(ExpressionVisitor& visitor) { return visitor.visitCall(this); }
 };
 
-class MemberExpression : public Expression {
+class MemberExpression : public Tagged<Expression, NodeKind::Member> {
 public:
     unique_ptr<Expression> object;
     unique_ptr<Expression> property;
@@ -159,20 +164,20 @@ public:
 };
 
 
-class ThisExpression : public Expression {
+class ThisExpression : public Tagged<Expression, NodeKind::This> {
 public:
     
     R accept(ExpressionVisitor& visitor) { return visitor.visitThis(this); }
 };
 
 
-class SuperExpression : public Expression {
+class SuperExpression : public Tagged<Expression, NodeKind::Super> {
 public:
     
     R accept(ExpressionVisitor& visitor) { return visitor.visitSuper(this); }
 };
 
-class NewExpression : public Expression {
+class NewExpression : public Tagged<Expression, NodeKind::New> {
 public:
     Token token;
     unique_ptr<Expression> callee;
@@ -228,7 +233,7 @@ public:
 
 };
 
-class SequenceExpression : public Expression {
+class SequenceExpression : public Tagged<Expression, NodeKind::Sequence> {
 public:
     vector<unique_ptr<Expression>> expressions;
     explicit SequenceExpression(vector<unique_ptr<Expression>> expressions)
@@ -522,7 +527,7 @@ public:
 
 };
 
-class PublicKeyword : public Expression {
+class PublicKeyword : public Tagged<Expression, NodeKind::Public> {
 public:
     PublicKeyword() {}
     
@@ -533,7 +538,7 @@ public:
 
 };
 
-class PrivateKeyword : public Expression {
+class PrivateKeyword : public Tagged<Expression, NodeKind::Private> {
 public:
     PrivateKeyword() {}
     
@@ -544,7 +549,7 @@ public:
 
 };
 
-class ProtectedKeyword : public Expression {
+class ProtectedKeyword : public Tagged<Expression, NodeKind::Protected> {
 public:
     ProtectedKeyword() {}
     
@@ -555,7 +560,7 @@ public:
 
 };
 
-class StaticKeyword : public Expression {
+class StaticKeyword : public Tagged<Expression, NodeKind::Static> {
 public:
     StaticKeyword() {}
         
@@ -565,7 +570,7 @@ public:
 
 };
 
-class RestParameter : public Expression {
+class RestParameter : public Tagged<Expression, NodeKind::RestParameter> {
 public:
     Token token;
     RestParameter(Token token) : token(token) {}
@@ -625,7 +630,7 @@ public:
     
 };
 
-class SpreadExpression : public Expression {
+class SpreadExpression : public Tagged<Expression, NodeKind::Spread> {
 
 public:
     Token token;
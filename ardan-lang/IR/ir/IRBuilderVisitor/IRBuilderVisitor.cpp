@@ -367,7 +367,7 @@ void IRBuilderVisitor::emitAssignment(BinaryExpression* expr) {
     
     if (expr->op.type == TokenType::ASSIGN) {
         
-        if (auto* ident = dynamic_cast<IdentifierExpression*>(left)) {
+        if (auto* ident = node_cast<IdentifierExpression>(left)) {
             store(ident->name, value_dst_reg);
         }
 
@@ -666,13 +666,13 @@ unordered_set<string> IRBuilderVisitor::collectDeclaredNames(Statement* body) {
     
     unordered_set<string> names;
     
-    if (BlockStatement* block = dynamic_cast<BlockStatement*>(body)) {
+    if (BlockStatement* block = node_cast<BlockStatement>(body)) {
         
         for (int i = 0; i < block->body.size(); i++) {
             
             auto stmt = block->body[i].get();
             
-            if (VariableStatement* var = dynamic_cast<VariableStatement*>(stmt)) {
+            if (VariableStatement* var = node_cast<VariableStatement>(stmt)) {
                 //
                 for (int j = 0; j < var->declarations.size(); j++) {
                     auto var_decl = var->declarations[j].id;
@@ -690,13 +690,13 @@ unordered_set<string> IRBuilderVisitor::collectDeclaredNames(Statement* body) {
 void IRBuilderVisitor::collectFreeVars(Expression* expr,
                                        unordered_set<string>& names) {
     
-    if (IdentifierExpression* var = dynamic_cast<IdentifierExpression*>(expr)) {
+    if (IdentifierExpression* var = node_cast<IdentifierExpression>(expr)) {
         
         names.insert(var->name);
         
     }
     
-    if (BinaryExpression* block = dynamic_cast<BinaryExpression*>(expr)) {
+    if (BinaryExpression* block = node_cast<BinaryExpression>(expr)) {
         collectFreeVars(block->left.get(), names);
         collectFreeVars(block->right.get(), names);
     }
@@ -706,7 +706,7 @@ void IRBuilderVisitor::collectFreeVars(Expression* expr,
 void IRBuilderVisitor::walkForFreeVars(Expression* expr,
                                        vector<unordered_set<string>>& boundStack,
                                        unordered_set<string>& freeVars) {
-    if (IdentifierExpression* ident = dynamic_cast<IdentifierExpression*>(expr)) {
+    if (IdentifierExpression* ident = node_cast<IdentifierExpression>(expr)) {
         for (auto& s : boundStack) {
             auto it = s.count(ident->name);
             if (!it) {
@@ -715,7 +715,7 @@ void IRBuilderVisitor::walkForFreeVars(Expression* expr,
         }
     }
     
-    if (auto* bin = dynamic_cast<BinaryExpression*>(expr)) {
+    if (auto* bin = node_cast<BinaryExpression>(expr)) {
         walkForFreeVars(bin->left.get(), boundStack, freeVars);
         walkForFreeVars(bin->right.get(), boundStack, freeVars);
         return;
@@ -726,7 +726,7 @@ void IRBuilderVisitor::walkForFreeVars(Expression* expr,
 
 void IRBuilderVisitor::walkForFreeVars(Statement* stmt, vector<unordered_set<string>>& boundStack, unordered_set<string>& freeVars) {
     
-    if (VariableStatement* var = dynamic_cast<VariableStatement*>(stmt)) {
+    if (VariableStatement* var = node_cast<VariableStatement>(stmt)) {
         
         for (int j = 0; j < var->declarations.size(); j++) {
             
@@ -742,7 +742,7 @@ void IRBuilderVisitor::walkForFreeVars(Statement* stmt, vector<unordered_set<str
         
     }
     
-    if (ReturnStatement* returnStmt = dynamic_cast<ReturnStatement*>(stmt)) {
+    if (ReturnStatement* returnStmt = node_cast<ReturnStatement>(stmt)) {
         
         walkForFreeVars(returnStmt->argument.get(), boundStack, freeVars);
         
@@ -770,9 +770,9 @@ unordered_set<string> IRBuilderVisitor::freeVariablesOf(const vector<unique_ptr<
 
 void IRBuilderVisitor::collectFreeVars(Statement* stmt, unordered_set<string>& result) {
     
-    if (FunctionDeclaration* fnStmt = dynamic_cast<FunctionDeclaration*>(stmt)) {
+    if (FunctionDeclaration* fnStmt = node_cast<FunctionDeclaration>(stmt)) {
         
-        if (BlockStatement* block = dynamic_cast<BlockStatement*>(fnStmt->body.get())) {
+        if (BlockStatement* block = node_cast<BlockStatement>(fnStmt->body.get())) {
             
             vector<string> names;
             auto v = freeVariablesOf(block->body, names);
@@ -791,7 +791,7 @@ unordered_set<string> IRBuilderVisitor::collectNestedVariables(Statement* body)
 
     unordered_set<string> names;
 
-    if (BlockStatement* block = dynamic_cast<BlockStatement*>(body)) {
+    if (BlockStatement* block = node_cast<BlockStatement>(body)) {
         
         for (int i = 0; i < block->body.size(); i++) {
             
@@ -871,7 +871,7 @@ R IRBuilderVisitor::visitFunction(FunctionDeclaration* stmt) {
         currentFunctionOwnsTopContextFrame = false;
     }
     
-    if (BlockStatement* body = dynamic_cast<BlockStatement*>(stmt->body.get())) {
+    if (BlockStatement* body = node_cast<BlockStatement>(stmt->body.get())) {
         
         for (auto& s : body->body) {
             
@@ -911,7 +911,7 @@ R IRBuilderVisitor::visitFunction(FunctionDeclaration* stmt) {
 
 R IRBuilderVisitor::visitCall(CallExpression* expr) {
     
-    if (auto ident = dynamic_cast<IdentifierExpression*>(expr->callee.get())) {
+    if (auto ident = node_cast<IdentifierExpression>(expr->callee.get())) {
         if (ident->name == "print") {
             
             vector<shared_ptr<IRValue>> operands;
@@ -11,7 +11,13 @@ Env::Env(Env* parent) : parent(parent) {}
 
 Env::~Env() {}
 
-R Env::getValue(const string& key) const {
+void Env::forEachBinding(const function<void(Atom, const R&)>& visit) const {
+    for (const auto& [key, value] : variables) visit(key, value);
+    for (const auto& [key, value] : let_variables) visit(key, value);
+    for (const auto& [key, value] : const_variables) visit(key, value);
+}
+
+R Env::getValue(Atom key) const {
     auto it = variables.find(key);
     if (it != variables.end()) {
         return it->second;
@@ -33,7 +39,7 @@ R Env::getValue(const string& key) const {
     throw runtime_error("Undefined variable: " + key);
 }
 
-R Env::getParentValue(const string& key) const {
+R Env::getParentValue(Atom key) const {
     if (parent) {
         return parent->getValue(key);
     }
@@ -44,7 +50,7 @@ void Env::setParentEnv(shared_ptr<Env> _parent) {
     parent = _parent.get();
 }
 
-R Env::getValueWithoutThrow(const string& key) const {
+R Env::getValueWithoutThrow(Atom key) const {
     auto it = variables.find(key);
     if (it != variables.end()) {
         return it->second;
@@ -68,7 +74,7 @@ R Env::getValueWithoutThrow(const string& key) const {
     
 }
 
-R Env::get_var_value(const string& key) {
+R Env::get_var_value(Atom key) {
 
     auto it = variables.find(key);
     if (it != variables.end()) {
@@ -79,7 +85,7 @@ R Env::get_var_value(const string& key) {
     throw runtime_error("Undefined variable: " + key);
 }
 
-R Env::get_let_value(const string& key) {
+R Env::get_let_value(Atom key) {
     
     auto it_let = let_variables.find(key);
     if (it_let != let_variables.end()) {
@@ -90,7 +96,7 @@ R Env::get_let_value(const string& key) {
     throw runtime_error("Undefined variable: " + key);
 }
 
-R Env::get_const_value(const string& key) {
+R Env::get_const_value(Atom key) {
     
     auto it_const = const_variables.find(key);
     if (it_const != const_variables.end()) {
@@ -101,23 +107,23 @@ R Env::get_const_value(const string& key) {
     throw runtime_error("Undefined variable: " + key);
 }
 
-R Env::get(const string& key) {
+R Env::get(Atom key) {
     return getValue(key);
 }
 
-void Env::set_var(const string& key, R value) {
+void Env::set_var(Atom key, R value) {
     variables[key] = std::forward<R>(value);
 }
 
-void Env::set_let(const string& key, R value) {
+void Env::set_let(Atom key, R value) {
      let_variables[key] = std::forward<R>(value);
 }
 
-void Env::set_const(const string& key, R value) {
+void Env::set_const(Atom key, R value) {
     const_variables[key] = std::forward<R>(value);
 }
 
-bool Env::is_const_key_set(const string& key) {
+bool Env::is_const_key_set(Atom key) {
     
     if (const_variables.find(key) != const_variables.end()) {
         // key exists
@@ -132,7 +138,7 @@ bool Env::is_const_key_set(const string& key) {
     return false;
 }
 
-bool Env::is_var_key_set(const string& key) {
+bool Env::is_var_key_set(Atom key) {
     
     if (variables.find(key) != variables.end()) {
         // key exists
@@ -147,7 +153,7 @@ bool Env::is_var_key_set(const string& key) {
     return false;
 }
 
-bool Env::is_let_key_set(const string& key) {
+bool Env::is_let_key_set(Atom key) {
     
     if (let_variables.find(key) != let_variables.end()) {
         // key exists
@@ -162,17 +168,17 @@ bool Env::is_let_key_set(const string& key) {
     return false;
 }
 
-void Env::assign(const string& key, R value) {
+void Env::assign(Atom key, R value) {
     
     auto it_var = variables.find(key);
     if (it_var != variables.end()) {
-        variables[key] = std::move(value);
+        it_var->second = std::move(value);
         return;
     }
 
     auto it_let = let_variables.find(key);
     if (it_let != let_variables.end()) {
-        let_variables[key] = std::move(value);
+        it_let->second = std::move(value);
         return;
     }
 
@@ -279,7 +285,7 @@ void Env::debugPrint() const {
         for (size_t i = 0; i < paramList.size(); i++) {
             Expression* expr = paramList[i].get();
             
-            if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr)) {
+            if (auto idExpr = node_cast<IdentifierExpression>(expr)) {
                 cout << idExpr->name;
             } else {
                 cout << "param";
@@ -297,7 +303,7 @@ void Env::debugPrint() const {
     cout << "========================\n";
 }
 
-Env* Env::resolveBinding(const string& name, Env* env) {
+Env* Env::resolveBinding(Atom name, Env* env) {
     if (env->variables.count(name) ||
         env->let_variables.count(name) ||
         env->const_variables.count(name)) {
@@ -19,6 +19,7 @@
 
 #include "Statements/Statements.hpp"
 #include "Expression/Expression.hpp"
+#include "ExecutionContext/Atom/Atom.h"
 
 using namespace std;
 
@@ -32,32 +33,32 @@ public:
     Env(Env* parent = nullptr);
     ~Env();
 
-    R getValue(const string& key) const;
-    R getValueWithoutThrow(const string& key) const;
-    R getParentValue(const string& key) const;
+    R getValue(Atom key) const;
+    R getValueWithoutThrow(Atom key) const;
+    R getParentValue(Atom key) const;
     void setParentEnv(shared_ptr<Env> parent);
 
-    R get(const string& key);
+    R get(Atom key);
 
-    void set_var(const string& key, R value);
+    void set_var(Atom key, R value);
     
-    void set_let(const string& key, R value);
+    void set_let(Atom key, R value);
 
-    void set_const(const string& key, R value) ;
+    void set_const(Atom key, R value) ;
     
-    R get_var_value(const string& key);
+    R get_var_value(Atom key);
 
-    R get_let_value(const string& key);
+    R get_let_value(Atom key);
 
-    R get_const_value(const string& key);
+    R get_const_value(Atom key);
 
-    bool is_const_key_set(const string& key);
+    bool is_const_key_set(Atom key);
     
-    bool is_var_key_set(const string& key);
+    bool is_var_key_set(Atom key);
     
-    bool is_let_key_set(const string& key);
+    bool is_let_key_set(Atom key);
 
-    void assign(const string& key, R value);
+    void assign(Atom key, R value);
 
     void setStackValue(const string& key, R value);
 
@@ -72,14 +73,18 @@ public:
     void clearStack();
         
     shared_ptr<JSObject> this_binding;
-    shared_ptr<JSObject> global_object = make_shared<JSObject>();
     void debugPrint() const;
-    Env* resolveBinding(const string& name, Env* env);
+    Env* resolveBinding(Atom name, Env* env);
+
+    // the var, let and const bindings of this scope alone, for the heap
+    // snapshot
+    void forEachBinding(const function<void(Atom, const R&)>& visit) const;
+    Env* getParent() const { return parent; }
     
 private:
-    unordered_map<string, R> variables = {};
-    unordered_map<string, R> let_variables = {};
-    unordered_map<string, R> const_variables = {};
+    unordered_map<Atom, R> variables = {};
+    unordered_map<Atom, R> let_variables = {};
+    unordered_map<Atom, R> const_variables = {};
 
     unordered_map<string, R> stack = {};
 
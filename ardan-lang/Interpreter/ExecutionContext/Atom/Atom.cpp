@@ -0,0 +1,55 @@
+//
+//  Atom.cpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 19/10/2026.
+//
+
+#include "Atom.h"
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+
+using Entry = pair<const string, size_t>;
+
+// unordered_map never moves its elements, so the entries handed out stay
+// valid. The table is never freed: atoms live in static objects that may be
+// destroyed after it would be.
+static unordered_map<string, size_t>& table() {
+    static auto* names = new unordered_map<string, size_t>();
+    return *names;
+}
+
+static shared_mutex& tableMutex() {
+    static auto* mutex = new shared_mutex();
+    return *mutex;
+}
+
+static const Entry* intern(const string& name) {
+
+    {
+        shared_lock<shared_mutex> lock(tableMutex());
+        auto it = table().find(name);
+        if (it != table().end()) return &*it;
+    }
+
+    unique_lock<shared_mutex> lock(tableMutex());
+    return &*table().try_emplace(name, table().size()).first;
+
+}
+
+static const Entry* emptyName() {
+    static const Entry* empty = intern("");
+    return empty;
+}
+
+Atom::Atom() : entry(emptyName()) {}
+
+Atom::Atom(const string& name) : entry(intern(name)) {}
+
+Atom::Atom(const char* name) : entry(intern(name)) {}
+
+size_t Atom::count() {
+    shared_lock<shared_mutex> lock(tableMutex());
+    return table().size();
+}
@@ -0,0 +1,88 @@
+//
+//  Atom.h
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 19/10/2026.
+//
+
+#ifndef Atom_h
+#define Atom_h
+
+#include <stdio.h>
+#include <string>
+#include <ostream>
+#include <functional>
+#include <utility>
+#include "../RopeString/RopeString.h"
+
+using namespace std;
+
+// An interned identifier or property name.
+//
+// Every distinct name is stored once in a process-wide table, so two atoms
+// are equal exactly when they point at the same entry and comparing them is a
+// pointer compare. The hash is the name's interning order rather than its
+// address, which keeps property iteration order the same from run to run.
+// The code generators intern names when a chunk's constants are built;
+// anything that still arrives as a string is interned on the way in.
+class Atom {
+
+public:
+    Atom();
+    Atom(const string& name);
+    Atom(const char* name);
+    Atom(const RopeString& name) : Atom(name.str()) {}
+
+    const string& str() const { return entry->first; }
+    operator const string&() const { return entry->first; }
+
+    const char* c_str() const { return str().c_str(); }
+    size_t size() const { return str().size(); }
+    bool empty() const { return str().empty(); }
+
+    bool operator==(const Atom& other) const { return entry == other.entry; }
+    bool operator!=(const Atom& other) const { return entry != other.entry; }
+
+    // comparing against a literal does not intern it
+    bool operator==(const string& other) const { return str() == other; }
+    bool operator==(const char* other) const { return str() == other; }
+
+    size_t hash() const { return entry->second; }
+
+    // number of distinct names interned so far
+    static size_t count();
+
+private:
+    // the name and its interning order
+    const pair<const string, size_t>* entry;
+
+};
+
+inline ostream& operator<<(ostream& os, const Atom& atom) {
+    return os << atom.str();
+}
+
+inline string operator+(const string& lhs, const Atom& rhs) {
+    return lhs + rhs.str();
+}
+
+inline string operator+(const char* lhs, const Atom& rhs) {
+    return lhs + rhs.str();
+}
+
+inline string operator+(const Atom& lhs, const string& rhs) {
+    return lhs.str() + rhs;
+}
+
+inline string operator+(const Atom& lhs, const char* rhs) {
+    return lhs.str() + rhs;
+}
+
+template <>
+struct std::hash<Atom> {
+    size_t operator()(const Atom& atom) const noexcept {
+        return atom.hash();
+    }
+};
+
+#endif /* Atom_h */
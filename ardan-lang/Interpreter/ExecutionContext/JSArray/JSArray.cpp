@@ -6,82 +6,99 @@
 //
 
 #include "JSArray.h"
-#include "engines/Cascade/VM/VM.hpp"
-#include "engines/Nova/TurboVM.hpp"
-
-void JSArray::set(const string& key, const Value& val) {
-    if (isNumeric(key)) {
-        size_t idx = std::stoull(key);
-        if (idx >= elements_size) {
-            elements_size = static_cast<int>(idx) + 1;
-            set("length", Value(elements_size));
-        }
-        var_properties[key] = { key, {}, val };
-    } else {
-        var_properties[key] = { key, {}, val };
+#include "engines/BaseVM/BaseVM.hpp"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+static const Atom length_key("length");
+
+bool JSArray::indexKey(const string& key, size_t& index) {
+
+    if (key.empty() || key.size() > 18 || key.find_first_not_of("0123456789") != string::npos) {
+        return false;
     }
+
+    index = stoull(key);
+    return true;
+
 }
 
+void JSArray::set(Atom key, const Value& val) {
+
+    size_t index;
+    if (indexKey(key, index)) {
+        setIndex(index, val);
+        return;
+    }
+
+    if (key == length_key) {
+        updateLength((size_t)val.numberValue);
+        return;
+    }
+
+    var_properties[key] = { key, {}, val };
+
+}
+
+// writing past the end grows the array, filling the gap with undefined
 void JSArray::setIndex(size_t i, const Value& val) {
-    elements_size++;
-    set(to_string(i), val);
-    set("length", Value(elements_size));
+    if (i >= elements.size()) elements.resize(i + 1);
+    elements[i] = val;
 }
 
-Value JSArray::getIndex(size_t i) {
-    return (i < elements_size) ? get(to_string(i)) : Value::undefined();
+Value JSArray::get(Atom key) const {
+
+    size_t index;
+    if (indexKey(key, index)) return getIndex(index);
+
+    if (key == length_key) return Value::number((double)elements.size());
+
+    Value own = JSObject::get(key);
+    if (!own.isUndefined()) return own;
+
+    // the shared prototype; the native keeps the array alive, since a
+    // temporary like `[1, 2].join()` is only held by the bound method
+    if (ArrayMethod method = findMethod(key)) {
+        shared_ptr<JSArray> self = const_pointer_cast<JSArray>(shared_from_this());
+        return Value::native([self, method](const vector<Value>& args) -> Value {
+            return method(*self, args);
+        });
+    }
+
+    return own;
+
 }
 
 void JSArray::updateLength(size_t len) {
-    set("length", Value((int)len));
+    elements.resize(len);
 }
 
 const unordered_map<string, Value> JSArray::get_indexed_properties() {
-    
+
     unordered_map<string, Value> indexed_properties = {};
 
-    for (auto prop : var_properties) {
-        
-        if (isNumeric(prop.first)) {
-            indexed_properties[prop.first] = prop.second.value;
-        }
-        
+    for (size_t i = 0; i < elements.size(); i++) {
+        indexed_properties[to_string(i)] = elements[i];
     }
-    
+
     return indexed_properties;
-    
+
 }
 
 string JSArray::toString() {
-    
+
     string concat = "[";
-    int index = 0;
-    
-    auto all_properties = get_indexed_properties();
-    
-    for (auto prop : all_properties) {
-                        
-        if (prop.second.type == ValueType::ARRAY) {
-            concat += prop.second.toString();
-        }
-        
-        if (prop.second.type == ValueType::OBJECT) {
-            concat += prop.second.toString();
-        }
-        
-        concat += prop.second.toString() + ( index >= (all_properties.size() - 1) ? "" : ", ");
-        
-        index++;
-        
+
+    for (size_t i = 0; i < elements.size(); i++) {
+        if (i > 0) concat += ", ";
+        concat += elements[i].toString();
     }
+
     concat += "]";
-    
+
     return concat;
-    
-}
 
-size_t JSArray::length() {
-    return elements_size;
 }
 
 bool JSArray::isNumeric(const std::string& s) {
@@ -90,105 +107,418 @@ bool JSArray::isNumeric(const std::string& s) {
 }
 
 void JSArray::push(const vector<Value> &args) {
-    setIndex((elements_size), args[0]);
+    elements.insert(elements.end(), args.begin(), args.end());
 }
 
 void JSArray::pop() {
-    if (elements_size == 0)
-        return;
-    // Get the last index as a string
-    size_t lastIndex = elements_size - 1;
-    var_properties.erase(to_string(lastIndex));
-    elements_size--;
-    set("length", Value(elements_size));
-}
-
-void JSArray::init_builtins() {
-
-    // pop removes the first item in the properties
-    set("pop", Value::native([this](const std::vector<Value>& args) {
-
-        pop();
-        
-        return Value::nullVal();
-
-    }));
-    
-    // pushes a vlaue to the properties
-    set("push", Value::native([this](const vector<Value>& args) {
-
-        push(args);
-        
-        return Value::nullVal();
-        
-    }));
-    
-    set("join", Value::native([this](const vector<Value>& args) {
-
-        string concat;
-        string delimiter = args[0].toString();
-        
-        int index = 0;
-        auto indexed_properties = get_indexed_properties();
-        
-        for(auto indexed_property : indexed_properties) {
-            concat += indexed_property.second.toString() + ((index == (indexed_properties.size() - 1)) ? "" : delimiter);
-            index++;
+    if (!elements.empty()) elements.pop_back();
+}
+
+// --- Array prototype ---
+//
+// One table of natives serves every array in every realm. A native reads
+// the array it was looked up on and calls script through Callback, which
+// runs closures on the VM of the calling thread.
+
+static Value arrayValue(JSArray& self) {
+    return Value::array(self.shared_from_this());
+}
+
+static bool strictEquals(const Value& a, const Value& b) {
+    if (a.type != b.type) return false;
+    switch (a.type) {
+        case ValueType::NUMBER: return a.numberValue == b.numberValue;
+        case ValueType::STRING: return a.stringValue == b.stringValue;
+        case ValueType::BOOLEAN: return a.boolValue == b.boolValue;
+        case ValueType::NULLTYPE:
+        case ValueType::UNDEFINED:
+            return true;
+        case ValueType::OBJECT: return a.objectValue == b.objectValue;
+        case ValueType::ARRAY: return a.arrayValue == b.arrayValue;
+        case ValueType::CLOSURE: return a.closureValue == b.closureValue;
+        case ValueType::CLASS: return a.classValue == b.classValue;
+        default: return false;
+    }
+}
+
+// relative index as in slice/splice: negative counts from the end
+static size_t relativeIndex(const vector<Value>& args, size_t i, size_t fallback, size_t length) {
+    if (i >= args.size() || args[i].type == ValueType::UNDEFINED) return fallback;
+    double index = std::trunc(args[i].numberValue);
+    if (std::isnan(index)) return 0;
+    if (index < 0) {
+        index += (double)length;
+        return index < 0 ? 0 : (size_t)index;
+    }
+    return index > (double)length ? length : (size_t)index;
+}
+
+static const Value& callbackArg(const vector<Value>& args, const string& name) {
+    if (args.empty()) {
+        throw runtime_error("TypeError: Array.prototype." + name + " expects a callback");
+    }
+    return args[0];
+}
+
+static Value arrayPush(JSArray& self, const vector<Value>& args) {
+    self.push(args);
+    return Value::number((double)self.length());
+}
+
+static Value arrayPop(JSArray& self, const vector<Value>& args) {
+    if (self.elements.empty()) return Value::undefined();
+    Value last = std::move(self.elements.back());
+    self.elements.pop_back();
+    return last;
+}
+
+static Value arrayJoin(JSArray& self, const vector<Value>& args) {
+
+    string delimiter = args.empty() || args[0].type == ValueType::UNDEFINED ? "," : args[0].toString();
+    string joined;
+
+    for (size_t i = 0; i < self.elements.size(); i++) {
+        if (i > 0) joined += delimiter;
+        const Value& element = self.elements[i];
+        if (element.type != ValueType::UNDEFINED && element.type != ValueType::NULLTYPE) {
+            joined += element.toString();
         }
+    }
+
+    return Value::str(joined);
+
+}
+
+// Callbacks get (element, index, array). Elements are read by index on
+// every step because the callback may grow or shrink the array.
+
+static Value arrayForEach(JSArray& self, const vector<Value>& args) {
+
+    Callback callback(callbackArg(args, "forEach"));
+    Value argv[3] = { Value(), Value::number(0), arrayValue(self) };
+    size_t length = self.length();
+
+    for (size_t i = 0; i < length && i < self.length(); i++) {
+        argv[0] = self.elements[i];
+        argv[1].numberValue = (double)i;
+        callback(argv, 3);
+    }
+
+    return Value::undefined();
 
-        return Value(concat);
-        
-    }));
-    
-    set("reduce", Value::native([this](const vector<Value>& args) {
-        
-        if (args.size() < 1) {
-            throw runtime_error("reduce expects at least (callback)");
+}
+
+static Value arrayMap(JSArray& self, const vector<Value>& args) {
+
+    Callback callback(callbackArg(args, "map"));
+    Value argv[3] = { Value(), Value::number(0), arrayValue(self) };
+    size_t length = self.length();
+
+    auto result = make_shared<JSArray>();
+    result->elements.reserve(length);
+
+    for (size_t i = 0; i < length; i++) {
+        if (i >= self.length()) {
+            result->elements.emplace_back();
+            continue;
         }
-        
-        Value callback = args[0];
-        if (callback.type != ValueType::FUNCTION && callback.type != ValueType::CLOSURE) {
-            throw std::runtime_error("First argument to reduce must be a function");
+        argv[0] = self.elements[i];
+        argv[1].numberValue = (double)i;
+        result->elements.push_back(callback(argv, 3));
+    }
+
+    return Value::array(result);
+
+}
+
+static Value arrayFilter(JSArray& self, const vector<Value>& args) {
+
+    Callback callback(callbackArg(args, "filter"));
+    Value argv[3] = { Value(), Value::number(0), arrayValue(self) };
+    size_t length = self.length();
+
+    auto result = make_shared<JSArray>();
+
+    for (size_t i = 0; i < length && i < self.length(); i++) {
+        argv[0] = self.elements[i];
+        argv[1].numberValue = (double)i;
+        if (callback(argv, 3).isTruthy()) {
+            result->elements.push_back(argv[0]);
         }
+    }
+
+    return Value::array(result);
+
+}
+
+static Value arrayFind(JSArray& self, const vector<Value>& args) {
+
+    Callback callback(callbackArg(args, "find"));
+    Value argv[3] = { Value(), Value::number(0), arrayValue(self) };
+    size_t length = self.length();
+
+    for (size_t i = 0; i < length; i++) {
+        argv[0] = self.getIndex(i);
+        argv[1].numberValue = (double)i;
+        if (callback(argv, 3).isTruthy()) return argv[0];
+    }
+
+    return Value::undefined();
 
-        size_t len = elements_size;
-        
-        // Setup accumulator
-        Value acc;
-        size_t start = 0;
-        if (args.size() >= 3) {
-            acc = args[2]; // initial value
+}
+
+static Value arrayReduce(JSArray& self, const vector<Value>& args) {
+
+    Callback callback(callbackArg(args, "reduce"));
+    size_t length = self.length();
+    size_t i = 0;
+
+    // (accumulator, element, index, array)
+    Value argv[4] = { Value(), Value(), Value::number(0), arrayValue(self) };
+
+    if (args.size() >= 2) {
+        argv[0] = args[1];
+    } else {
+        if (length == 0) {
+            throw runtime_error("TypeError: Reduce of empty array with no initial value");
+        }
+        argv[0] = self.elements[0];
+        i = 1;
+    }
+
+    for (; i < length && i < self.length(); i++) {
+        argv[1] = self.elements[i];
+        argv[2].numberValue = (double)i;
+        argv[0] = callback(argv, 4);
+    }
+
+    return argv[0];
+
+}
+
+static Value arrayIndexOf(JSArray& self, const vector<Value>& args) {
+
+    Value target = args.empty() ? Value::undefined() : args[0];
+    size_t from = relativeIndex(args, 1, 0, self.length());
+
+    for (size_t i = from; i < self.elements.size(); i++) {
+        if (strictEquals(self.elements[i], target)) return Value::number((double)i);
+    }
+
+    return Value::number(-1);
+
+}
+
+// sort(compare?): stable, in place. Without a compare function elements
+// are ordered by their string forms and undefined goes last.
+static Value arraySort(JSArray& self, const vector<Value>& args) {
+
+    // sorted apart from the array, which the comparator may touch
+    vector<Value> sorted = self.elements;
+
+    auto undefinedLast = std::stable_partition(sorted.begin(), sorted.end(), [](const Value& v) {
+        return v.type != ValueType::UNDEFINED;
+    });
+
+    if (args.empty() || args[0].type == ValueType::UNDEFINED) {
+        std::stable_sort(sorted.begin(), undefinedLast, [](const Value& a, const Value& b) {
+            return a.toString() < b.toString();
+        });
+    } else {
+        Callback compare(args[0]);
+        Value argv[2];
+        std::stable_sort(sorted.begin(), undefinedLast, [&](const Value& a, const Value& b) {
+            argv[0] = a;
+            argv[1] = b;
+            return compare(argv, 2).numberValue < 0;
+        });
+    }
+
+    self.elements = std::move(sorted);
+    return arrayValue(self);
+
+}
+
+static Value arraySlice(JSArray& self, const vector<Value>& args) {
+
+    size_t length = self.length();
+    size_t begin = relativeIndex(args, 0, 0, length);
+    size_t end = relativeIndex(args, 1, length, length);
+
+    auto result = make_shared<JSArray>();
+    if (begin < end) {
+        result->elements.assign(self.elements.begin() + begin, self.elements.begin() + end);
+    }
+
+    return Value::array(result);
+
+}
+
+// splice(start, deleteCount?, ...items): removes and inserts in place and
+// returns the removed elements
+static Value arraySplice(JSArray& self, const vector<Value>& args) {
+
+    size_t length = self.length();
+    size_t start = relativeIndex(args, 0, 0, length);
+    size_t count = length - start;
+
+    if (args.size() >= 2) {
+        double requested = std::trunc(args[1].numberValue);
+        count = requested > 0 ? std::min((size_t)requested, length - start) : 0;
+    }
+
+    auto removed = make_shared<JSArray>();
+    auto first = self.elements.begin() + start;
+    removed->elements.assign(first, first + count);
+    self.elements.erase(first, first + count);
+
+    if (args.size() > 2) {
+        self.elements.insert(self.elements.begin() + start, args.begin() + 2, args.end());
+    }
+
+    return Value::array(removed);
+
+}
+
+// concat(...values): arrays are spread one level, anything else is appended
+static Value arrayConcat(JSArray& self, const vector<Value>& args) {
+
+    auto result = make_shared<JSArray>();
+    result->elements = self.elements;
+
+    for (const Value& arg : args) {
+        if (arg.type == ValueType::ARRAY) {
+            const vector<Value>& items = arg.arrayValue->elements;
+            result->elements.insert(result->elements.end(), items.begin(), items.end());
         } else {
-            if (len == 0) {
-                throw runtime_error("reduce of empty array with no initial value");
-            }
-            acc = getIndex(0);
-            start = 1;
+            result->elements.push_back(arg);
+        }
+    }
+
+    return Value::array(result);
+
+}
+
+// parallelMap(fn, options?) and parallelReduce(fn, initial?, options?)
+//
+// The elements are split into ranges that worker threads run fn over, each
+// in a VM of its own that shares the script's compiled code and globals.
+// Map results land at their own indexes; reduce folds each range, then the
+// range results in order, so fn must be associative. fn may only read state
+// outside its own frame unless options.pure declares it safe. Engines that
+// cannot run script off their thread run these serially.
+
+static bool declaredPure(const vector<Value>& args, size_t i) {
+    if (i >= args.size() || args[i].type != ValueType::OBJECT) return false;
+    return args[i].objectValue->get("pure").isTruthy();
+}
+
+// strings are flattened on their first read, so the workers get them flat
+static void flattenStrings(const JSArray& self) {
+    for (const Value& element : self.elements) {
+        if (element.type == ValueType::STRING) element.stringValue.str();
+    }
+}
+
+static Value arrayParallelMap(JSArray& self, const vector<Value>& args) {
+
+    const Value& fn = callbackArg(args, "parallelMap");
+    BaseVM* vm = BaseVM::current();
+    size_t length = self.length();
+
+    auto result = make_shared<JSArray>();
+    result->elements.resize(length);
+    flattenStrings(self);
+
+    auto body = [&](size_t begin, size_t end) {
+        Callback callback(fn);
+        Value argv[3] = { Value(), Value::number(0), arrayValue(self) };
+        for (size_t i = begin; i < end; i++) {
+            argv[0] = self.elements[i];
+            argv[1].numberValue = (double)i;
+            result->elements[i] = callback(argv, 3);
         }
-        
-        for (size_t i = start; i < len; i++) {
-            
-            std::vector<Value> cbArgs = {
-                acc,
-                getIndex(i),
-                Value((double)i)
-            };
-            
-            if (callback.type == ValueType::FUNCTION) {
-                acc = callback.functionValue(cbArgs);
-            } else if (callback.type == ValueType::CLOSURE) {
-                if (vm) {
-                    acc = vm->callFunction(callback, cbArgs);
-                } else if (turboVM) {
-                    acc = turboVM->callFunction(callback, cbArgs);
-                }
-            }
+    };
+
+    if (vm == nullptr || !vm->parallelFor(fn, declaredPure(args, 1), length, body)) {
+        return arrayMap(self, { fn });
+    }
+
+    return Value::array(result);
+
+}
+
+static Value arrayParallelReduce(JSArray& self, const vector<Value>& args) {
+
+    const Value& fn = callbackArg(args, "parallelReduce");
+    BaseVM* vm = BaseVM::current();
+    size_t length = self.length();
+
+    // an undefined initial value counts as none, so options can follow it
+    bool hasInitial = args.size() >= 2 && args[1].type != ValueType::UNDEFINED;
+
+    if (length == 0) {
+        if (!hasInitial) throw runtime_error("TypeError: Reduce of empty array with no initial value");
+        return args[1];
+    }
+
+    // the fold of each range, keyed by where it starts
+    vector<pair<size_t, Value>> folds;
+    mutex foldsMutex;
+    flattenStrings(self);
+
+    auto body = [&](size_t begin, size_t end) {
+        Callback callback(fn);
+        Value argv[4] = { self.elements[begin], Value(), Value::number(0), arrayValue(self) };
+        for (size_t i = begin + 1; i < end; i++) {
+            argv[1] = self.elements[i];
+            argv[2].numberValue = (double)i;
+            argv[0] = callback(argv, 4);
         }
-        
-        return acc;
-        
-    }));
+        lock_guard<mutex> lock(foldsMutex);
+        folds.push_back({ begin, argv[0] });
+    };
+
+    if (vm == nullptr || !vm->parallelFor(fn, declaredPure(args, 2), length, body)) {
+        return hasInitial ? arrayReduce(self, { fn, args[1] }) : arrayReduce(self, { fn });
+    }
+
+    std::sort(folds.begin(), folds.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    Callback callback(fn);
+    Value argv[4] = { hasInitial ? args[1] : folds[0].second, Value(), Value::number(0), arrayValue(self) };
+
+    for (size_t i = hasInitial ? 0 : 1; i < folds.size(); i++) {
+        argv[1] = folds[i].second;
+        argv[2].numberValue = (double)folds[i].first;
+        argv[0] = callback(argv, 4);
+    }
+
+    return argv[0];
+
+}
+
+ArrayMethod JSArray::findMethod(Atom name) {
+
+    static const unordered_map<Atom, ArrayMethod> methods = {
+        { "push", arrayPush },
+        { "pop", arrayPop },
+        { "join", arrayJoin },
+        { "forEach", arrayForEach },
+        { "map", arrayMap },
+        { "filter", arrayFilter },
+        { "find", arrayFind },
+        { "reduce", arrayReduce },
+        { "indexOf", arrayIndexOf },
+        { "sort", arraySort },
+        { "slice", arraySlice },
+        { "splice", arraySplice },
+        { "concat", arrayConcat },
+        { "parallelMap", arrayParallelMap },
+        { "parallelReduce", arrayParallelReduce },
+    };
 
-    set("length", elements_size);
+    auto it = methods.find(name);
+    return it == methods.end() ? nullptr : it->second;
 
 }
@@ -12,6 +12,8 @@
 #include <iostream>
 #include <string>
 #include <any>
+#include <vector>
+#include <memory>
 #include "../JSObject/JSObject.h"
 #include "../Value/Value.h"
 
@@ -19,39 +21,50 @@ using namespace std;
 
 class VM;
 class TurboVM;
+class JSArray;
 
-class JSArray : public JSObject {
+// a native of the shared Array prototype, called with the array it was
+// looked up on
+using ArrayMethod = Value (*)(JSArray& self, const vector<Value>& args);
 
-    int elements_size;
+class JSArray : public JSObject, public enable_shared_from_this<JSArray> {
 
 public:
-    
-    JSArray() {
-        
-        init_builtins();
 
-    }
-    
-    void init_builtins();
-    
-    void set(const string& key, const Value& val);
-    
+    // the elements, packed in index order. Numeric keys and `length` read
+    // and write this; other keys are ordinary properties.
+    vector<Value> elements;
+
+    JSArray() = default;
+
+    void set(Atom key, const Value& val);
+
     void setIndex(size_t i, const Value& val);
 
-    Value getIndex(size_t i);
+    Value getIndex(size_t i) const {
+        return i < elements.size() ? elements[i] : Value::undefined();
+    }
+
+    Value get(Atom key) const override;
 
     const unordered_map<string, Value> get_indexed_properties();
 
     void updateLength(size_t len);
-    
+
     bool isNumeric(const std::string& s);
-    
+
     void push(const vector<Value>& args);
     void pop();
-    
+
     string toString();
-    size_t length();
-    
+    size_t length() const { return elements.size(); }
+
+    // the native behind `name` on every array, or nullptr
+    static ArrayMethod findMethod(Atom name);
+
+private:
+    static bool indexKey(const string& key, size_t& index);
+
 };
 
 #endif /* JSArray_h */
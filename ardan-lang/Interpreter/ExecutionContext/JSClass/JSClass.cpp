@@ -13,7 +13,7 @@ JSClass::~JSClass() = default;
 static Value native(NativeFn fn) { Value v; v.type = ValueType::NATIVE_FUNCTION; v.nativeFunction = fn; return v; }
 
 // this fetches data from static_fields
-Value JSClass::get(const string& key, bool perform_privacy_check) {
+Value JSClass::get(Atom key, bool perform_privacy_check) {
 
     if (perform_privacy_check) {
         // if key is private throw error
@@ -56,7 +56,8 @@ Value JSClass::get(const string& key, bool perform_privacy_check) {
         
 }
 
-vector<string> JSClass::get_static_modifiers(const string& key) {
+const vector<string>& JSClass::get_static_modifiers(Atom key) {
+    static const vector<string> none;
     auto value = var_static_fields.find(key);
     if (value != var_static_fields.end()) return value->second.modifiers;
     auto let_value = let_static_fields.find(key);
@@ -65,11 +66,11 @@ vector<string> JSClass::get_static_modifiers(const string& key) {
     if (const_value != const_static_fields.end()) return const_value->second.modifiers;
     // Inherited statics
     if (superClass) return superClass->get_static_modifiers(key);
-    return {};
+    return none;
 }
 
 // calling this, we don't need the modifiers because it has been set by visitClassDeclarartions
-void JSClass::set(const string& key, Value value, bool perform_privacy_check) {
+void JSClass::set(Atom key, Value value, bool perform_privacy_check) {
 
     // if there is a this_binding, then we know, we are being called from inside a class.
     // so we can access all both private/public fields
@@ -108,7 +109,7 @@ void JSClass::set(const string& key, Value value, bool perform_privacy_check) {
 
 }
 
-void JSClass::check_privacy(const std::string& key) {
+void JSClass::check_privacy(Atom key) {
     // check in var static fields
     auto value = var_static_fields.find(key);
     if (value != var_static_fields.end()) {
@@ -141,19 +142,19 @@ bool JSClass::hasModifier(const vector<string>& mods, const string& name) {
 }
 
 // only called in visitClassDeclarartions
-void JSClass::set_var(const string& key, Value value, const vector<string> modifiers) {
+void JSClass::set_var(Atom key, Value value, const vector<string> modifiers) {
     var_static_fields[key] = { key, modifiers, value };
 }
 
-void JSClass::set_let(const string& key, Value value, const vector<string> modifiers) {
+void JSClass::set_let(Atom key, Value value, const vector<string> modifiers) {
     let_static_fields[key] = { key, modifiers, value };
 }
 
-void JSClass::set_const(const string& key, Value value, const vector<string> modifiers) {
+void JSClass::set_const(Atom key, Value value, const vector<string> modifiers) {
     const_static_fields[key] = { key, modifiers, value };
 }
 
-Value JSClass::get_proto_vm(const string& key) {
+Value JSClass::get_proto_vm(Atom key) {
     
     auto var_proto_props_value = var_proto_props.find(key);
     if (var_proto_props_value != var_proto_props.end()) {
@@ -177,17 +178,38 @@ Value JSClass::get_proto_vm(const string& key) {
 
 }
 
-void JSClass::set_proto_vm_var(const string& key, Value value, const vector<string> modifiers) {
+const ValueField* JSClass::find_proto_method(Atom key) const {
+    
+    for (const JSClass* klass = this; klass != nullptr; klass = klass->superClass.get()) {
+        
+        // fields are kept here too, as the index of their initialiser
+        auto var_it = klass->var_proto_props.find(key);
+        if (var_it != klass->var_proto_props.end() && var_it->second.value.type == ValueType::CLOSURE) {
+            return &var_it->second;
+        }
+        
+        auto const_it = klass->const_proto_props.find(key);
+        if (const_it != klass->const_proto_props.end() && const_it->second.value.type == ValueType::CLOSURE) {
+            return &const_it->second;
+        }
+        
+    }
+    
+    return nullptr;
+    
+}
+
+void JSClass::set_proto_vm_var(Atom key, Value value, const vector<string> modifiers) {
     var_proto_props[key] = { key, modifiers, value };
 }
 
-void JSClass::set_proto_vm_const(const string& key, Value value, const vector<string> modifiers) {
+void JSClass::set_proto_vm_const(Atom key, Value value, const vector<string> modifiers) {
     const_proto_props[key] = { key, modifiers, value };
 }
 
 Value JSClass::get_constructor() {
     
-    string key = "constructor";
+    static const Atom key("constructor");
 
     auto var_proto_props_value = var_proto_props.find(key);
     if (var_proto_props_value != var_proto_props.end()) {
@@ -209,7 +231,7 @@ Value JSClass::get_constructor() {
 
 bool JSClass::is_constructor_available() {
     
-    string key = "constructor";
+    static const Atom key("constructor");
     
     auto var_proto_props_value = var_proto_props.find(key);
     if (var_proto_props_value != var_proto_props.end()) {
@@ -224,7 +246,7 @@ bool JSClass::is_constructor_available() {
     return false;
 }
 
-bool JSClass::has_static(const std::string& name) const {
+bool JSClass::has_static(Atom name) const {
     
     if (var_static_fields.contains(name) ||
         let_static_fields.contains(name) ||
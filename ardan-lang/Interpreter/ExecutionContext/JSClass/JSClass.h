@@ -26,9 +26,9 @@ public:
     unordered_map<string, unique_ptr<PropertyDeclaration>> fields;
     unordered_map<string, unique_ptr<MethodDefinition>> methods;
 
-    unordered_map<string, ValueField> var_static_fields;
-    unordered_map<string, ValueField> let_static_fields;
-    unordered_map<string, ValueField> const_static_fields;
+    unordered_map<Atom, ValueField> var_static_fields;
+    unordered_map<Atom, ValueField> let_static_fields;
+    unordered_map<Atom, ValueField> const_static_fields;
     bool is_native = false;
     virtual Value call(const std::vector<Value>& args) {
         return Value();
@@ -36,31 +36,34 @@ public:
 
     // need to add var, let, const fields
     
-    Value get(const string& key, bool perform_privacy_check);
-    vector<string> get_static_modifiers(const string& key);
+    Value get(Atom key, bool perform_privacy_check);
+    const vector<string>& get_static_modifiers(Atom key);
     // calling this, we don't need the modifiers because it has been set by visitClassDeclarartions
-    void set(const string& key, Value value, bool perform_privacy_check);
-    void check_privacy(const string& key);
+    void set(Atom key, Value value, bool perform_privacy_check);
+    void check_privacy(Atom key);
     bool hasModifier(const vector<string>& mods, const string& name);
 
     // only called in visitClassDeclarations
-    void set_var(const string& key, Value value, const vector<string> modifiers);
-    void set_let(const string& key, Value value, const vector<string> modifiers);
-    void set_const(const string& key, Value value, const vector<string> modifiers);
+    void set_var(Atom key, Value value, const vector<string> modifiers);
+    void set_let(Atom key, Value value, const vector<string> modifiers);
+    void set_const(Atom key, Value value, const vector<string> modifiers);
 
     // Compiler Use only
         
     // non-static properties
-    unordered_map<string, ValueField> var_proto_props;
-    unordered_map<string, ValueField> const_proto_props;
+    unordered_map<Atom, ValueField> var_proto_props;
+    unordered_map<Atom, ValueField> const_proto_props;
 
-    Value get_proto_vm(const string& key);
+    Value get_proto_vm(Atom key);
+    // the method `key` of this class or the nearest superclass defining it.
+    // Instances look their methods up here instead of holding copies.
+    const ValueField* find_proto_method(Atom key) const;
 
-    void set_proto_vm_var(const string& key, Value value, const vector<string> modifiers);
-    void set_proto_vm_const(const string& key, Value value, const vector<string> modifiers);
+    void set_proto_vm_var(Atom key, Value value, const vector<string> modifiers);
+    void set_proto_vm_const(Atom key, Value value, const vector<string> modifiers);
     bool is_constructor_available();
     Value get_constructor();
-    bool has_static(const std::string& name) const;
+    bool has_static(Atom name) const;
     
     virtual std::shared_ptr<JSObject> construct() {
         return nullptr;
@@ -0,0 +1,40 @@
+//
+//  JSIterator.cpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#include "JSIterator.h"
+
+JSIterator::JSIterator(Step step) : step(std::move(step)) {
+
+    set_builtin_value("next", Value::native([this](const vector<Value>& args) -> Value {
+
+        Value value = Value::undefined();
+        bool has_value = next(value);
+
+        auto result = make_shared<JSObject>();
+        result->set("value", value, "VAR", {});
+        result->set("done", Value::boolean(!has_value), "VAR", {});
+
+        return Value::object(result);
+
+    }));
+
+}
+
+bool JSIterator::next(Value& out) {
+
+    if (done) return false;
+
+    if (!step(out)) {
+        // drop the source (and whatever it holds open) once exhausted
+        done = true;
+        step = nullptr;
+        return false;
+    }
+
+    return true;
+
+}
@@ -0,0 +1,37 @@
+//
+//  JSIterator.h
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#ifndef JSIterator_h
+#define JSIterator_h
+
+#include <stdio.h>
+#include <functional>
+#include "../JSObject/JSObject.h"
+#include "../Value/Value.h"
+
+using namespace std;
+
+// A pull-based iterator for native sources (file streams, line readers).
+// for...of in the register VMs drains it through next(); scripts can also
+// call it.next() and get { value, done } back.
+class JSIterator : public JSObject {
+
+public:
+    // writes the next value to out, or returns false once exhausted.
+    using Step = function<bool(Value& out)>;
+
+    JSIterator(Step step);
+
+    bool next(Value& out);
+
+private:
+    Step step;
+    bool done = false;
+
+};
+
+#endif /* JSIterator_h */
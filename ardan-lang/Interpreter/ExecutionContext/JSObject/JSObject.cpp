@@ -19,25 +19,27 @@ bool JSObject::operator!=(const JSObject& other) const {
 }
 
 // TODO: fix to set let and const too.
-void JSObject::set(const string& key, const Value& val) {
+void JSObject::set(Atom key, const Value& val) {
     
     if (is_object_literal) {
         
         // do not check to see if the key exists before setting the value
         // always set the value
-        var_properties[key] = { key, {}, val };
+        if (var_properties.insert_or_assign(key, ValueField{ key, {}, val }).second) {
+            key_order.push_back(key);
+        }
         
     } else {
         
         // Look in own properties
         auto it = var_properties.find(key);
         if (it != var_properties.end()) {
-            var_properties[key].value = val;
+            it->second.value = val;
         }
         
         auto let_it = let_properties.find(key);
         if (let_it != let_properties.end()) {
-            let_properties[key].value = val;
+            let_it->second.value = val;
         }
         
         auto const_it = const_properties.find(key);
@@ -49,17 +51,14 @@ void JSObject::set(const string& key, const Value& val) {
 
 }
 
-void JSObject::set(const string& key, const Value& val, string type, vector<string> modifiers) {
-    if (type == "LET") {
-        let_properties[key] = { key, modifiers, val };
-    } else if(type == "CONST") {
-        const_properties[key] = { key, modifiers, val };
-    } else {
-        var_properties[key] = { key, modifiers, val };
+void JSObject::set(Atom key, const Value& val, string type, vector<string> modifiers) {
+    auto& properties = type == "LET" ? let_properties : type == "CONST" ? const_properties : var_properties;
+    if (properties.insert_or_assign(key, ValueField{ key, std::move(modifiers), val }).second) {
+        key_order.push_back(key);
     }
 }
 
-Value JSObject::get(const string& key) const {
+Value JSObject::get(Atom key) const {
     
     // Look in own properties
     auto it = var_properties.find(key);
@@ -88,13 +87,20 @@ Value JSObject::get(const string& key) const {
     }
 
     // Look in class (and superclass chain)
+    if (js_class) {
+        if (const ValueField* method = js_class->find_proto_method(key)) {
+            return method->value;
+        }
+    }
 
     return Value::undefined();
     
 }
 
-vector<string> JSObject::get_modifiers(const string& key) const {
+const vector<string>& JSObject::get_modifiers(Atom key) const {
     
+    static const vector<string> none;
+
     auto it = var_properties.find(key);
     if (it != var_properties.end()) return it->second.modifiers;
     auto let_it = let_properties.find(key);
@@ -103,10 +109,13 @@ vector<string> JSObject::get_modifiers(const string& key) const {
     if (const_it != const_properties.end()) return const_it->second.modifiers;
 
     if (parent_object) {
-        auto val = parent_object->get_modifiers(key);
+        const auto& val = parent_object->get_modifiers(key);
         if (!val.empty()) return val;
     }
-    return {};
+    if (js_class) {
+        if (const ValueField* method = js_class->find_proto_method(key)) return method->modifiers;
+    }
+    return none;
 }
 
 void JSObject::setClass(shared_ptr<JSClass> js_klass) {
@@ -164,20 +173,22 @@ void JSObject::set_as_object_literal() {
     is_object_literal = true;
 }
 
-void JSObject::set_builtin_value(const string& key, const Value& val) {
-    var_properties[key] = { key, {}, val };
+void JSObject::set_builtin_value(Atom key, const Value& val) {
+    if (var_properties.insert_or_assign(key, ValueField{ key, {}, val }).second) {
+        key_order.push_back(key);
+    }
 }
 
-bool JSObject::has(const std::string& name) const {
+bool JSObject::has(Atom name) const {
     if (var_properties.contains(name) ||
         let_properties.contains(name) ||
         const_properties.contains(name)) {
         return true;
     }
 
-    if (parent_object) {
-        return parent_object->has(name);
+    if (parent_object && parent_object->has(name)) {
+        return true;
     }
 
-    return false;
+    return js_class && js_class->find_proto_method(name) != nullptr;
 }
@@ -13,6 +13,7 @@
 #include <string>
 #include "../Value/Value.h"
 #include "../JSClass/JSClass.h"
+#include "../Atom/Atom.h"
 
 using namespace std;
 
@@ -24,41 +25,49 @@ class JSObject {
 protected:
     bool frozen = false;
     bool is_object_literal = false;
-    unordered_map<string, ValueField> var_properties;
-    unordered_map<string, ValueField> let_properties;
-    unordered_map<string, ValueField> const_properties;
+    unordered_map<Atom, ValueField> var_properties;
+    unordered_map<Atom, ValueField> let_properties;
+    unordered_map<Atom, ValueField> const_properties;
+    // own property names in the order they were first set
+    vector<Atom> key_order;
 
     shared_ptr<JSClass> js_class;
 
 public:
 
     int _id;
+    // set by JSTypedArray so the VMs can take the unboxed element path
+    // without a dynamic_cast
+    bool is_typed_array = false;
     VM* vm;
     TurboVM* turboVM;
 
     shared_ptr<JSClass> parent_class;
     shared_ptr<JSObject> parent_object;
     
+    virtual ~JSObject() = default;
+
     bool operator==(const JSObject& other) const;
     bool operator!=(const JSObject& other) const;
     
-    void set(const string& key, const Value& val);
-    void set(const string& key, const Value& val, string type, vector<string> modifiers);
-    void set_builtin_value(const string& key, const Value& val);
+    void set(Atom key, const Value& val);
+    void set(Atom key, const Value& val, string type, vector<string> modifiers);
+    void set_builtin_value(Atom key, const Value& val);
 
-    Value get(const string& key) const;
-    vector<string> get_modifiers(const string& key) const;
+    virtual Value get(Atom key) const;
+    const vector<string>& get_modifiers(Atom key) const;
 
     void setClass(shared_ptr<JSClass> js_klass);
     
     const unordered_map<string, Value> get_all_properties() const;
+    const vector<Atom>& own_keys() const { return key_order; }
     
     shared_ptr<JSClass> getKlass() const;
     
-    string toString() const;
+    virtual string toString() const;
     
     void set_as_object_literal();
-    bool has(const string& key) const;
+    bool has(Atom key) const;
     
 };
 
@@ -0,0 +1,379 @@
+//
+//  JSTypedArray.cpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#include "JSTypedArray.h"
+#include "../JSArray/JSArray.h"
+
+shared_ptr<ByteStorage> ByteStorage::allocate(size_t size) {
+
+    auto storage = make_shared<ByteStorage>();
+    shared_ptr<uint8_t[]> bytes(new uint8_t[size > 0 ? size : 1]());
+
+    storage->data = bytes.get();
+    storage->size = size;
+    storage->owner = bytes;
+
+    return storage;
+
+}
+
+shared_ptr<ByteStorage> ByteStorage::adopt(string bytes) {
+
+    auto storage = make_shared<ByteStorage>();
+    auto holder = make_shared<string>(std::move(bytes));
+
+    storage->data = (uint8_t*)holder->data();
+    storage->size = holder->size();
+    storage->owner = holder;
+
+    return storage;
+
+}
+
+JSTypedArray::JSTypedArray(TypedArrayKind kind, size_t length, bool is_buffer)
+: kind(kind), is_buffer(is_buffer), storage(ByteStorage::allocate(length * elementSize(kind))), byte_offset(0), length(length) {
+
+    init_builtins();
+
+}
+
+JSTypedArray::JSTypedArray(TypedArrayKind kind,
+                           shared_ptr<ByteStorage> storage,
+                           size_t byte_offset,
+                           size_t length,
+                           bool is_buffer)
+: kind(kind), is_buffer(is_buffer), storage(storage), byte_offset(byte_offset), length(length) {
+
+    if (byte_offset + length * elementSize(kind) > storage->size) {
+        throw runtime_error("RangeError: typed array view is out of bounds");
+    }
+
+    init_builtins();
+
+}
+
+size_t JSTypedArray::elementSize(TypedArrayKind kind) {
+    switch (kind) {
+        case TypedArrayKind::Uint8: return sizeof(uint8_t);
+        case TypedArrayKind::Int32: return sizeof(int32_t);
+        case TypedArrayKind::Float64: return sizeof(double);
+    }
+    return 1;
+}
+
+string JSTypedArray::kindName(TypedArrayKind kind) {
+    switch (kind) {
+        case TypedArrayKind::Uint8: return "Uint8Array";
+        case TypedArrayKind::Int32: return "Int32Array";
+        case TypedArrayKind::Float64: return "Float64Array";
+    }
+    return "TypedArray";
+}
+
+shared_ptr<JSTypedArray> JSTypedArray::fromBytes(string bytes) {
+
+    shared_ptr<ByteStorage> storage = ByteStorage::adopt(std::move(bytes));
+    return make_shared<JSTypedArray>(TypedArrayKind::Uint8, storage, 0, storage->size, true);
+
+}
+
+string JSTypedArray::toBytes(const Value& value) {
+
+    if (value.type == ValueType::OBJECT && value.objectValue->is_typed_array) {
+        auto* typed = static_cast<JSTypedArray*>(value.objectValue.get());
+        return string((const char*)typed->bytes(), typed->byteLength());
+    }
+
+    return value.toString();
+
+}
+
+// relative begin/end as in Array.prototype.slice: negative counts from the end
+static size_t clampIndex(long index, size_t length) {
+    if (index < 0) {
+        index += (long)length;
+        return index < 0 ? 0 : (size_t)index;
+    }
+    return (size_t)index > length ? length : (size_t)index;
+}
+
+void JSTypedArray::init_builtins() {
+
+    is_typed_array = true;
+
+    // view onto the same storage, nothing is copied
+    set_builtin_value("subarray", Value::native([this](const vector<Value>& args) -> Value {
+        long begin = args.size() > 0 ? (long)args[0].numberValue : 0;
+        long end = args.size() > 1 ? (long)args[1].numberValue : (long)length;
+        return Value::object(subarray(begin, end));
+    }));
+
+    // Buffer.slice shares memory like subarray; typed arrays copy
+    set_builtin_value("slice", Value::native([this](const vector<Value>& args) -> Value {
+
+        long begin = args.size() > 0 ? (long)args[0].numberValue : 0;
+        long end = args.size() > 1 ? (long)args[1].numberValue : (long)length;
+
+        shared_ptr<JSTypedArray> view = subarray(begin, end);
+        if (is_buffer) return Value::object(view);
+
+        auto copy = make_shared<JSTypedArray>(kind, view->length);
+        memcpy(copy->bytes(), view->bytes(), view->byteLength());
+        return Value::object(copy);
+
+    }));
+
+    // fill(value[, begin[, end]])
+    set_builtin_value("fill", Value::native([this](const vector<Value>& args) -> Value {
+
+        double value = args.size() > 0 ? args[0].numberValue : 0;
+        size_t begin = clampIndex(args.size() > 1 ? (long)args[1].numberValue : 0, length);
+        size_t end = clampIndex(args.size() > 2 ? (long)args[2].numberValue : (long)length, length);
+
+        if (kind == TypedArrayKind::Uint8 && begin < end) {
+            memset(bytes() + begin, toUint32(value) & 0xff, end - begin);
+        } else {
+            for (size_t i = begin; i < end; i++) store(i, value);
+        }
+
+        return Value::undefined();
+
+    }));
+
+    // set(source[, offset]) copies an array or typed array in
+    set_builtin_value("set", Value::native([this](const vector<Value>& args) -> Value {
+
+        if (args.empty()) return Value::undefined();
+
+        size_t offset = args.size() > 1 ? (size_t)args[1].numberValue : 0;
+        const Value& source = args[0];
+
+        if (source.type == ValueType::OBJECT && source.objectValue->is_typed_array) {
+
+            auto* from = static_cast<JSTypedArray*>(source.objectValue.get());
+            if (offset + from->length > length) {
+                throw runtime_error("RangeError: source is too large");
+            }
+
+            if (from->kind == kind) {
+                memmove(bytes() + offset * elementSize(kind), from->bytes(), from->byteLength());
+            } else {
+                for (size_t i = 0; i < from->length; i++) store(offset + i, from->load(i));
+            }
+
+        } else if (source.type == ValueType::ARRAY) {
+
+            size_t count = source.arrayValue->length();
+            if (offset + count > length) {
+                throw runtime_error("RangeError: source is too large");
+            }
+
+            for (size_t i = 0; i < count; i++) {
+                store(offset + i, source.arrayValue->getIndex(i).numberValue);
+            }
+
+        }
+
+        return Value::undefined();
+
+    }));
+
+    set_builtin_value("toString", Value::native([this](const vector<Value>& args) -> Value {
+        if (is_buffer) return Value::str(string((const char*)bytes(), byteLength()));
+        return Value::str(toString());
+    }));
+
+}
+
+bool JSTypedArray::indexKey(const string& key, size_t& index) {
+
+    if (key.empty() || key.size() > 18 || key.find_first_not_of("0123456789") != string::npos) {
+        return false;
+    }
+
+    index = stoull(key);
+    return true;
+
+}
+
+Value JSTypedArray::get(Atom key) const {
+
+    size_t index;
+    if (indexKey(key, index)) return getIndex(index);
+
+    if (key == "length") return Value::number((double)length);
+    if (key == "byteLength") return Value::number((double)byteLength());
+    if (key == "byteOffset") return Value::number((double)byte_offset);
+
+    return JSObject::get(key);
+
+}
+
+void JSTypedArray::setKey(const string& key, const Value& val) {
+
+    size_t index;
+    if (indexKey(key, index)) {
+        setIndex(index, val.numberValue);
+        return;
+    }
+
+    set(key, val, "VAR", {});
+
+}
+
+string JSTypedArray::toString() const {
+
+    string out = is_buffer ? "<Buffer" : kindName(kind) + "(" + to_string(length) + ") [";
+
+    for (size_t i = 0; i < length; i++) {
+        if (is_buffer) {
+            char hex[4];
+            snprintf(hex, sizeof(hex), " %02x", bytes()[i]);
+            out += hex;
+        } else {
+            out += (i > 0 ? ", " : "") + Value::number(load(i)).toString();
+        }
+    }
+
+    return out + (is_buffer ? ">" : "]");
+
+}
+
+void JSTypedArray::assign(const vector<Value>& args) {
+
+    const Value source = args.empty() ? Value::number(0) : args[0];
+
+    if (source.type == ValueType::NUMBER) {
+        storage = ByteStorage::allocate((size_t)source.numberValue * elementSize(kind));
+        byte_offset = 0;
+        length = (size_t)source.numberValue;
+        return;
+    }
+
+    if (source.type == ValueType::STRING) {
+        if (kind != TypedArrayKind::Uint8) {
+            throw runtime_error("TypeError: only Uint8 arrays can be made from a string");
+        }
+        storage = ByteStorage::adopt(source.stringValue);
+        byte_offset = 0;
+        length = storage->size;
+        return;
+    }
+
+    if (source.type == ValueType::ARRAY) {
+        size_t count = source.arrayValue->length();
+        storage = ByteStorage::allocate(count * elementSize(kind));
+        byte_offset = 0;
+        length = count;
+        for (size_t i = 0; i < count; i++) {
+            store(i, source.arrayValue->getIndex(i).numberValue);
+        }
+        return;
+    }
+
+    if (source.type == ValueType::OBJECT) {
+        if (auto buffer = dynamic_pointer_cast<JSSharedArrayBuffer>(source.objectValue)) {
+            view(buffer->storage, args);
+            return;
+        }
+    }
+
+    if (source.type == ValueType::OBJECT && source.objectValue->is_typed_array) {
+        auto* from = static_cast<JSTypedArray*>(source.objectValue.get());
+        storage = ByteStorage::allocate(from->length * elementSize(kind));
+        byte_offset = 0;
+        length = from->length;
+        if (from->kind == kind) {
+            memcpy(bytes(), from->bytes(), from->byteLength());
+        } else {
+            for (size_t i = 0; i < length; i++) store(i, from->load(i));
+        }
+        return;
+    }
+
+    throw runtime_error("TypeError: cannot construct " + kindName(kind) + " from " + source.toString());
+
+}
+
+void JSTypedArray::view(shared_ptr<ByteStorage> shared, const vector<Value>& args) {
+
+    size_t size = elementSize(kind);
+    size_t offset = args.size() > 1 ? (size_t)args[1].numberValue : 0;
+
+    if (offset % size != 0) {
+        throw runtime_error("RangeError: start offset of " + kindName(kind) + " should be a multiple of " + to_string(size));
+    }
+    if (offset > shared->size) {
+        throw runtime_error("RangeError: start offset " + to_string(offset) + " is outside the bounds of the buffer");
+    }
+
+    size_t count;
+    if (args.size() > 2 && args[2].type != ValueType::UNDEFINED) {
+        count = (size_t)args[2].numberValue;
+        if (offset + count * size > shared->size) {
+            throw runtime_error("RangeError: invalid typed array length: " + to_string(count));
+        }
+    } else {
+        if ((shared->size - offset) % size != 0) {
+            throw runtime_error("RangeError: byte length of " + kindName(kind) + " should be a multiple of " + to_string(size));
+        }
+        count = (shared->size - offset) / size;
+    }
+
+    storage = std::move(shared);
+    byte_offset = offset;
+    length = count;
+
+}
+
+JSSharedArrayBuffer::JSSharedArrayBuffer(size_t size) : JSSharedArrayBuffer(ByteStorage::allocate(size)) {}
+
+JSSharedArrayBuffer::JSSharedArrayBuffer(shared_ptr<ByteStorage> storage) : storage(std::move(storage)) {
+
+    this->storage->shared = true;
+
+    // a copy of [begin, end), in a new SharedArrayBuffer
+    set_builtin_value("slice", Value::native([this](const vector<Value>& args) -> Value {
+
+        size_t size = this->storage->size;
+        size_t begin = clampIndex(args.size() > 0 ? (long)args[0].numberValue : 0, size);
+        size_t end = clampIndex(args.size() > 1 ? (long)args[1].numberValue : (long)size, size);
+        if (end < begin) end = begin;
+
+        auto copy = make_shared<JSSharedArrayBuffer>(end - begin);
+        memcpy(copy->storage->data, this->storage->data + begin, end - begin);
+        return Value::object(copy);
+
+    }));
+
+}
+
+Value JSSharedArrayBuffer::get(Atom key) const {
+
+    if (key == "byteLength") return Value::number((double)storage->size);
+
+    return JSObject::get(key);
+
+}
+
+string JSSharedArrayBuffer::toString() const {
+    return "SharedArrayBuffer { byteLength: " + to_string(storage->size) + " }";
+}
+
+shared_ptr<JSTypedArray> JSTypedArray::subarray(long begin, long end) const {
+
+    size_t from = clampIndex(begin, length);
+    size_t to = clampIndex(end, length);
+    if (to < from) to = from;
+
+    return make_shared<JSTypedArray>(kind,
+                                     storage,
+                                     byte_offset + from * elementSize(kind),
+                                     to - from,
+                                     is_buffer);
+
+}
@@ -0,0 +1,166 @@
+//
+//  JSTypedArray.h
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#ifndef JSTypedArray_h
+#define JSTypedArray_h
+
+#include <stdio.h>
+#include <string>
+#include <memory>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include "../JSObject/JSObject.h"
+#include "../Value/Value.h"
+
+using namespace std;
+
+// Contiguous bytes behind one or more typed array views. Views made with
+// subarray()/slice() share the storage instead of copying it.
+struct ByteStorage {
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    // set for storage that may be visible to more than one thread
+    bool shared = false;
+
+    // zero-filled
+    static shared_ptr<ByteStorage> allocate(size_t size);
+    // takes over a string's buffer without copying it
+    static shared_ptr<ByteStorage> adopt(string bytes);
+
+private:
+    shared_ptr<void> owner;
+};
+
+enum class TypedArrayKind {
+    Uint8,
+    Int32,
+    Float64
+};
+
+// Uint8Array, Int32Array, Float64Array and Buffer (a Uint8 view that
+// converts to and from strings). Elements are stored unboxed; the register
+// VMs read and write them directly in GetIndex/SetIndex.
+class JSTypedArray : public JSObject {
+
+public:
+    JSTypedArray(TypedArrayKind kind, size_t length, bool is_buffer = false);
+    JSTypedArray(TypedArrayKind kind,
+                 shared_ptr<ByteStorage> storage,
+                 size_t byte_offset,
+                 size_t length,
+                 bool is_buffer = false);
+
+    TypedArrayKind kind;
+    bool is_buffer;
+    shared_ptr<ByteStorage> storage;
+    size_t byte_offset;
+    size_t length;
+
+    static size_t elementSize(TypedArrayKind kind);
+    static string kindName(TypedArrayKind kind);
+
+    // a Buffer over the given bytes, without copying them
+    static shared_ptr<JSTypedArray> fromBytes(string bytes);
+    // raw bytes of a typed array, or the string form of any other value
+    static string toBytes(const Value& value);
+
+    uint8_t* bytes() const { return storage->data + byte_offset; }
+    size_t byteLength() const { return length * elementSize(kind); }
+
+    // unchecked element access; callers check i < length
+    inline double load(size_t i) const;
+    inline void store(size_t i, double v);
+
+    Value getIndex(size_t i) const {
+        return i < length ? Value::number(load(i)) : Value::undefined();
+    }
+
+    void setIndex(size_t i, double v) {
+        if (i < length) store(i, v);
+    }
+
+    // numeric keys address elements, everything else is a normal property
+    Value get(Atom key) const override;
+    void setKey(const string& key, const Value& val);
+
+    string toString() const override;
+
+    // replaces the contents from constructor arguments: a length, an array,
+    // another typed array, (for Buffer) a string, or a SharedArrayBuffer
+    // with an optional byte offset and length to view
+    void assign(const vector<Value>& args);
+
+    shared_ptr<JSTypedArray> subarray(long begin, long end) const;
+
+private:
+    void init_builtins();
+    // assign() over shared storage: (buffer[, byteOffset[, length]])
+    void view(shared_ptr<ByteStorage> shared, const vector<Value>& args);
+    static bool indexKey(const string& key, size_t& index);
+
+};
+
+// SharedArrayBuffer: bytes that every thread holding it sees, with no
+// elements of its own. Typed arrays made over it view the same storage,
+// and a Worker message carries it by reference instead of copying it.
+class JSSharedArrayBuffer : public JSObject {
+
+public:
+    explicit JSSharedArrayBuffer(size_t size);
+    explicit JSSharedArrayBuffer(shared_ptr<ByteStorage> storage);
+
+    shared_ptr<ByteStorage> storage;
+
+    Value get(Atom key) const override;
+    string toString() const override;
+
+};
+
+// ES ToUint32 wrapping, shared by the integer element kinds
+inline uint32_t toUint32(double v) {
+    if (!std::isfinite(v)) return 0;
+    double m = std::fmod(std::trunc(v), 4294967296.0);
+    if (m < 0) m += 4294967296.0;
+    return (uint32_t)m;
+}
+
+inline double JSTypedArray::load(size_t i) const {
+    switch (kind) {
+        case TypedArrayKind::Uint8:
+            return bytes()[i];
+        case TypedArrayKind::Int32: {
+            int32_t v;
+            memcpy(&v, bytes() + i * sizeof(int32_t), sizeof(int32_t));
+            return v;
+        }
+        case TypedArrayKind::Float64: {
+            double v;
+            memcpy(&v, bytes() + i * sizeof(double), sizeof(double));
+            return v;
+        }
+    }
+    return 0;
+}
+
+inline void JSTypedArray::store(size_t i, double v) {
+    switch (kind) {
+        case TypedArrayKind::Uint8:
+            bytes()[i] = (uint8_t)toUint32(v);
+            break;
+        case TypedArrayKind::Int32: {
+            int32_t x = (int32_t)toUint32(v);
+            memcpy(bytes() + i * sizeof(int32_t), &x, sizeof(int32_t));
+            break;
+        }
+        case TypedArrayKind::Float64:
+            memcpy(bytes() + i * sizeof(double), &v, sizeof(double));
+            break;
+    }
+}
+
+#endif /* JSTypedArray_h */
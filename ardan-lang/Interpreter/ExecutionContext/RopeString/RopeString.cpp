@@ -0,0 +1,176 @@
+//
+//  RopeString.cpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 19/10/2026.
+//
+
+#include "RopeString.h"
+
+static const string empty_string;
+
+shared_ptr<RopeString::Node> RopeString::leaf(string s) {
+    auto n = make_shared<Node>();
+    n->length = s.size();
+    n->flat = std::move(s);
+    return n;
+}
+
+RopeString::RopeString(const string& s) : node(s.empty() ? nullptr : leaf(s)) {}
+
+RopeString::RopeString(string&& s) : node(s.empty() ? nullptr : leaf(std::move(s))) {}
+
+RopeString::RopeString(const char* s) : RopeString(string(s)) {}
+
+RopeString& RopeString::operator=(const string& s) {
+    node = s.empty() ? nullptr : leaf(s);
+    return *this;
+}
+
+RopeString& RopeString::operator=(string&& s) {
+    node = s.empty() ? nullptr : leaf(std::move(s));
+    return *this;
+}
+
+RopeString& RopeString::operator=(const char* s) {
+    return *this = string(s);
+}
+
+RopeString& RopeString::operator=(char c) {
+    return *this = string(1, c);
+}
+
+// a rope built by a loop is a long left-leaning chain; release it without
+// recursing once per link
+RopeString::Node::~Node() {
+
+    vector<shared_ptr<Node>> pending;
+    if (left) pending.push_back(std::move(left));
+    if (right) pending.push_back(std::move(right));
+
+    while (!pending.empty()) {
+        shared_ptr<Node> n = std::move(pending.back());
+        pending.pop_back();
+
+        if (n.use_count() == 1) {
+            if (n->left) pending.push_back(std::move(n->left));
+            if (n->right) pending.push_back(std::move(n->right));
+        }
+    }
+
+}
+
+RopeString RopeString::concat(const RopeString& left, const RopeString& right) {
+
+    if (left.empty()) return right;
+    if (right.empty()) return left;
+
+    size_t length = left.size() + right.size();
+
+    RopeString result;
+
+    if (length < ROPE_MIN) {
+        string flat;
+        flat.reserve(length);
+        flat += left.str();
+        flat += right.str();
+        result.node = leaf(std::move(flat));
+        return result;
+    }
+
+    result.node = make_shared<Node>();
+    result.node->length = length;
+    result.node->left = left.node;
+    result.node->right = right.node;
+
+    return result;
+
+}
+
+RopeString RopeString::concat(const vector<RopeString>& parts) {
+
+    RopeString result;
+    string pending;
+
+    for (const auto& part : parts) {
+        if (part.size() < ROPE_MIN) {
+            pending += part.str();
+            continue;
+        }
+
+        if (!pending.empty()) {
+            result = concat(result, RopeString(std::move(pending)));
+            pending.clear();
+        }
+        result = concat(result, part);
+    }
+
+    if (!pending.empty()) {
+        result = concat(result, RopeString(std::move(pending)));
+    }
+
+    return result;
+
+}
+
+const string& RopeString::str() const {
+
+    if (!node) return empty_string;
+    if (!node->left) return node->flat;
+
+    string flat;
+    flat.reserve(node->length);
+
+    // in-order walk over the leaves
+    vector<const Node*> stack = { node.get() };
+
+    while (!stack.empty()) {
+        const Node* n = stack.back();
+        stack.pop_back();
+
+        if (!n->left) {
+            flat += n->flat;
+            continue;
+        }
+
+        stack.push_back(n->right.get());
+        stack.push_back(n->left.get());
+    }
+
+    // every Value holding this rope now sees the flat string
+    node->flat = std::move(flat);
+    shared_ptr<Node> left = std::move(node->left);
+    shared_ptr<Node> right = std::move(node->right);
+
+    return node->flat;
+
+}
+
+bool operator==(const RopeString& a, const RopeString& b) {
+    return a.size() == b.size() && a.str() == b.str();
+}
+
+bool operator==(const RopeString& a, const string& b) {
+    return a.size() == b.size() && a.str() == b;
+}
+
+bool operator==(const RopeString& a, const char* b) {
+    return a.str() == b;
+}
+
+bool operator!=(const RopeString& a, const RopeString& b) { return !(a == b); }
+bool operator!=(const RopeString& a, const string& b) { return !(a == b); }
+bool operator!=(const RopeString& a, const char* b) { return !(a == b); }
+
+bool operator<(const RopeString& a, const RopeString& b) {
+    return a.str() < b.str();
+}
+
+string operator+(const RopeString& a, const string& b) { return a.str() + b; }
+string operator+(const string& a, const RopeString& b) { return a + b.str(); }
+string operator+(const RopeString& a, const char* b) { return a.str() + b; }
+string operator+(const char* a, const RopeString& b) { return a + b.str(); }
+
+ostream& operator<<(ostream& out, const RopeString& s) {
+    return out << s.str();
+}
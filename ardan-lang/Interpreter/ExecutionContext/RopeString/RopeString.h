@@ -0,0 +1,88 @@
+//
+//  RopeString.h
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 19/10/2026.
+//
+
+#ifndef RopeString_h
+#define RopeString_h
+
+#include <stdio.h>
+#include <string>
+#include <memory>
+#include <vector>
+#include <ostream>
+
+using namespace std;
+
+// The string payload of a Value.
+//
+// Copies share one immutable buffer. concat() links its operands into a rope
+// instead of copying them, so building a string with repeated `+` is linear.
+// The rope is flattened the first time its characters are read (str(),
+// comparisons, printing), and the flat result replaces the rope for every
+// Value sharing it.
+class RopeString {
+
+public:
+    RopeString() = default;
+    RopeString(const string& s);
+    RopeString(string&& s);
+    RopeString(const char* s);
+
+    static RopeString concat(const RopeString& left, const RopeString& right);
+    // adjacent short parts are copied into one piece, long ones are linked
+    static RopeString concat(const vector<RopeString>& parts);
+
+    const string& str() const;
+    operator const string&() const { return str(); }
+
+    size_t size() const { return node ? node->length : 0; }
+    size_t length() const { return size(); }
+    bool empty() const { return size() == 0; }
+    const char* c_str() const { return str().c_str(); }
+    char operator[](size_t i) const { return str()[i]; }
+
+    bool isRope() const { return node && node->left; }
+
+    RopeString& operator=(const string& s);
+    RopeString& operator=(string&& s);
+    RopeString& operator=(const char* s);
+    RopeString& operator=(char c);
+
+private:
+    struct Node {
+        size_t length = 0;
+        string flat;                // the characters, once there are no children
+        shared_ptr<Node> left;
+        shared_ptr<Node> right;
+
+        ~Node();
+    };
+
+    // results shorter than this are copied rather than linked
+    static const size_t ROPE_MIN = 64;
+
+    mutable shared_ptr<Node> node;
+
+    static shared_ptr<Node> leaf(string s);
+
+};
+
+bool operator==(const RopeString& a, const RopeString& b);
+bool operator==(const RopeString& a, const string& b);
+bool operator==(const RopeString& a, const char* b);
+bool operator!=(const RopeString& a, const RopeString& b);
+bool operator!=(const RopeString& a, const string& b);
+bool operator!=(const RopeString& a, const char* b);
+bool operator<(const RopeString& a, const RopeString& b);
+
+string operator+(const RopeString& a, const string& b);
+string operator+(const string& a, const RopeString& b);
+string operator+(const RopeString& a, const char* b);
+string operator+(const char* a, const RopeString& b);
+
+ostream& operator<<(ostream& out, const RopeString& s);
+
+#endif /* RopeString_h */
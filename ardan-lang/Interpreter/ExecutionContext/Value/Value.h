@@ -14,6 +14,9 @@
 #include <any>
 #include <vector>
 
+#include "../RopeString/RopeString.h"
+#include "../Atom/Atom.h"
+
 using namespace std;
 
 struct Chunk;
@@ -27,7 +30,7 @@ struct FunctionObject {
     uint32_t arity;
     string name;
     uint32_t upvalues_size;
-    bool isAsync;
+    bool isAsync = false;
 };
 
 enum class ValueType {
@@ -64,7 +67,7 @@ public:
     ValueType type;
     
     double numberValue;
-    string stringValue;
+    RopeString stringValue;
     bool boolValue;
     shared_ptr<JSObject> objectValue;
     shared_ptr<JSArray> arrayValue;
@@ -96,6 +99,7 @@ public:
     
     static Value number(double n) { Value v; v.type = ValueType::NUMBER; v.numberValue = n; return v; }
     static Value str(const string& s) { Value v; v.type = ValueType::STRING; v.stringValue = s; return v; }
+    static Value rope(RopeString s) { Value v; v.type = ValueType::STRING; v.stringValue = std::move(s); return v; }
     static Value boolean(bool b) { Value v; v.type = ValueType::BOOLEAN; v.boolValue = b; return v; }
     static Value object(shared_ptr<JSObject> obj) { Value v; v.type = ValueType::OBJECT; v.objectValue = obj; return v; }
     static Value array(shared_ptr<JSArray> array) {
@@ -204,7 +208,7 @@ public:
 };
 
 struct ValueField {
-    string key;
+    Atom key;
     vector<string> modifiers;
     Value value;
 };
@@ -216,11 +220,22 @@ struct Upvalue {
     bool isClosed() const { return location == &closed; }
 };
 
+// one slot of Nova's flat closure record. a variable that is never
+// assigned once captured is copied into value; one that is lives in box,
+// shared with the function that declared it.
+struct Capture {
+    Value value;
+    shared_ptr<Value> box;
+};
+
 struct Closure {
     shared_ptr<FunctionObject> fn;
     vector<shared_ptr<Upvalue>> upvalues;
+    vector<Capture> captures;
     shared_ptr<JSObject> js_object;
     shared_ptr<ExecutionContext> ctx;
+    // the class a method belongs to; `super` is looked up from its superclass
+    shared_ptr<JSClass> home_class;
 };
 
 #endif /* Value_h */
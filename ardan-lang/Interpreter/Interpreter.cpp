@@ -9,7 +9,8 @@
 
 Interpreter::Interpreter() {
     env = new Env();
-    event_loop = new EventLoop();
+    // promises queue their jobs on the shared loop, so run that one
+    event_loop = &EventLoop::getInstance();
     
     // init all builtins
     init_builtins();
@@ -19,7 +20,7 @@ Interpreter::Interpreter() {
 Interpreter::Interpreter(Env* local_env) {
     
     env = local_env;
-    event_loop = new EventLoop();
+    event_loop = &EventLoop::getInstance();
 
     // init all builtins
     init_builtins();
@@ -34,7 +35,6 @@ Interpreter::~Interpreter() {
     
     if (event_loop != nullptr) {
         event_loop->stop();
-        delete event_loop;
     }
     
 }
@@ -42,6 +42,7 @@ Interpreter::~Interpreter() {
 void Interpreter::init_builtins() {
     
     env->set_var("Math", make_shared<Math>());
+    env->set_var("JSON", make_shared<JSON>());
     env->set_var("console", make_shared<Print>());
     env->set_var("fs", make_shared<File>());
     env->set_var("Server", make_shared<Server>(event_loop));
@@ -61,8 +62,13 @@ void Interpreter::execute(vector<unique_ptr<Statement>> ast) {
         // stmt->accept(printer);
     }
     
-    // run the event loop
-    // add function to the ev
+    // run the event loop until it has no more work. stop() is posted so it
+    // runs inside the loop and cannot be overridden by run() starting.
+    event_loop->post([this](vector<Value> args) -> Value {
+        event_loop->stop();
+        return Value::undefined();
+    }, {});
+    
     event_loop->run();
     
 }
@@ -86,6 +92,7 @@ R Interpreter::visitBlock(BlockStatement* stmt) {
     try {
         for (auto& s : stmt->body) {
             s->accept(*this);
+            if (completion != Completion::Normal) break;
         }
     } catch (...) {
         //delete env;
@@ -93,8 +100,11 @@ R Interpreter::visitBlock(BlockStatement* stmt) {
         throw;
     }
 
-    previous->clearStack();
-    previous->this_binding = nullptr;
+    // a return, break or continue leaves the outer scope as a throw did
+    if (completion == Completion::Normal) {
+        previous->clearStack();
+        previous->this_binding = nullptr;
+    }
     //delete env;
     env = previous;
     return true;
@@ -116,13 +126,13 @@ R Interpreter::visitVariable(VariableStatement* stmt) {
                 
                 R value = declarator.init->accept(*this);
 
-                if (NewExpression* new_expr = dynamic_cast<NewExpression*>(declarator.init.get())) {
+                if (NewExpression* new_expr = node_cast<NewExpression>(declarator.init.get())) {
 
                     std::shared_ptr<JSObject> object = std::get<std::shared_ptr<JSObject>>(value);
 
                     // value is a JSObject.
                     // run the constructor
-                    R klass = env->get((dynamic_cast<IdentifierExpression*>(new_expr->callee.get())->name));
+                    R klass = env->get((node_cast<IdentifierExpression>(new_expr->callee.get())->name));
                     std::shared_ptr<JSClass> new_klass = std::get<std::shared_ptr<JSClass>>(klass);
                     
                     // get the constructor
@@ -136,9 +146,9 @@ R Interpreter::visitVariable(VariableStatement* stmt) {
                             string key;
                             R arg_value;
                             
-                            if (VariableStatement* variable = dynamic_cast<VariableStatement*>(constructor_arg.get())) {
+                            if (VariableStatement* variable = node_cast<VariableStatement>(constructor_arg.get())) {
                                 key = variable->kind;
-                            } else if (IdentifierExpression* ident = dynamic_cast<IdentifierExpression*>(constructor_arg.get())) {
+                            } else if (IdentifierExpression* ident = node_cast<IdentifierExpression>(constructor_arg.get())) {
                                 key = ident->token.lexeme;
                             }
                             
@@ -154,6 +164,7 @@ R Interpreter::visitVariable(VariableStatement* stmt) {
                         env->this_binding = object;
                         
                         constructor->methodBody->accept(*this);
+                        takeReturn();
                         
                     }
 
@@ -187,7 +198,7 @@ R Interpreter::visitVariable(VariableStatement* stmt) {
 R Interpreter::visitCall(CallExpression* expr) {
         
     // TODO: check if callee is a MemberExpression e.g user.getAge();
-    if (MemberExpression* member = dynamic_cast<MemberExpression*>(expr->callee.get())) {
+    if (MemberExpression* member = node_cast<MemberExpression>(expr->callee.get())) {
         
         // it is a dot access
         // get the object name and the JSObject.
@@ -293,7 +304,7 @@ R Interpreter::visitCall(CallExpression* expr) {
                 
                 string key;
                 
-                if (IdentifierExpression* ident = dynamic_cast<IdentifierExpression*>(method->params[index].get())) {
+                if (IdentifierExpression* ident = node_cast<IdentifierExpression>(method->params[index].get())) {
                     key = ident->name;
                 }
                 
@@ -301,15 +312,8 @@ R Interpreter::visitCall(CallExpression* expr) {
                 index++;
             }
 
-            try {
-                
-                method->accept(*this);
-                
-            } catch (ReturnException& r) {
-                
-                return r.value;
-                
-            }
+            method->accept(*this);
+            return takeReturn();
             
         }
         
@@ -320,7 +324,7 @@ R Interpreter::visitCall(CallExpression* expr) {
     // ------- end of member access --------
     
     // ------- super ------- super();
-    if (SuperExpression* super = dynamic_cast<SuperExpression*>(expr->callee.get())) {
+    if (SuperExpression* super = node_cast<SuperExpression>(expr->callee.get())) {
         // copy all props and methods
         return expr->callee->accept(*this);
     }
@@ -365,11 +369,11 @@ R Interpreter::visitCall(CallExpression* expr) {
         
         string key;
         
-        if (IdentifierExpression* ident = dynamic_cast<IdentifierExpression*>(arg)) {
+        if (IdentifierExpression* ident = node_cast<IdentifierExpression>(arg)) {
             key = ident->name;
         }
         
-        if (RestParameter* rest_parameter = dynamic_cast<RestParameter*>(arg)) {
+        if (RestParameter* rest_parameter = node_cast<RestParameter>(arg)) {
             
             auto array = make_shared<JSArray>();
             int arr_index = 0;
@@ -392,17 +396,8 @@ R Interpreter::visitCall(CallExpression* expr) {
 
     if (body != nullptr) {
         
-        try {
-            
-            body->accept(*this);
-            
-        } catch (ReturnException& r) {
-            
-            return r.value;
-            
-        }
-        
-        return monostate();
+        body->accept(*this);
+        return takeReturn();
     }
     
     throw runtime_error("Unknown function call");
@@ -428,7 +423,7 @@ R Interpreter::visitStringLiteral(StringLiteral* expr) {
 R Interpreter::visitIdentifier(IdentifierExpression* expr) {
     // check if name is function or class
     // construct and return function
-    return env->getValue(expr->name);
+    return env->getValue(expr->atom);
 }
 
 R Interpreter::visitFunction(FunctionDeclaration* stmt) {
@@ -465,14 +460,14 @@ R Interpreter::create_func_expr(FunctionDeclaration* stmt) {
                 Value paramValue = (i < args.size()) ? args[i] : Value::undefined();
                 Expression* param_expr = stmt->params[i].get();
                 std::string paramName;
-                if (IdentifierExpression* ident = dynamic_cast<IdentifierExpression*>(param_expr)) {
+                if (IdentifierExpression* ident = node_cast<IdentifierExpression>(param_expr)) {
                     paramName = ident->token.lexeme;
-                } else if (VariableStatement* variable = dynamic_cast<VariableStatement*>(param_expr)) {
+                } else if (VariableStatement* variable = node_cast<VariableStatement>(param_expr)) {
                     paramName = variable->declarations[0].id;
                     if (i >= args.size()) {
                         paramValue = toValue(variable->declarations[0].init->accept(*intr));
                     }
-                } else if (RestParameter* rest_expr = dynamic_cast<RestParameter*>(param_expr)) {
+                } else if (RestParameter* rest_expr = node_cast<RestParameter>(param_expr)) {
                     paramName = toValue(param_expr->accept(*intr)).stringValue;
                     auto array = make_shared<JSArray>();
                     int arr_index = 0;
@@ -483,8 +478,8 @@ R Interpreter::create_func_expr(FunctionDeclaration* stmt) {
                     localEnv->set_var(paramName, array);
                     break;
                 } else {
-                    if (BinaryExpression* bin_expr = dynamic_cast<BinaryExpression*>(param_expr)) {
-                        auto left = dynamic_cast<IdentifierExpression*>(bin_expr->left.get());
+                    if (BinaryExpression* bin_expr = node_cast<BinaryExpression>(param_expr)) {
+                        auto left = node_cast<IdentifierExpression>(bin_expr->left.get());
                         if (left) {
                             paramName = left->token.lexeme;
                             if (paramValue.type == ValueType::UNDEFINED || paramValue.type == ValueType::NULLTYPE) {
@@ -501,16 +496,11 @@ R Interpreter::create_func_expr(FunctionDeclaration* stmt) {
                 if (stmt->body) {
                     stmt->body->accept(*intr);
                 }
-                promise->resolve(Value::undefined());
+                Value result = toValue(intr->takeReturn());
+                promise->resolve(result);
 
                 intr->env = prevEnv;
-                return Value::undefined();
-                
-            } catch (const ReturnException& r) {
-                
-                promise->resolve(toValue(r.value));
-                intr->env = prevEnv;
-                return toValue(r.value);
+                return result;
                 
             } catch (std::exception& e) {
                 
@@ -565,19 +555,8 @@ R Interpreter::visitWhile(WhileStatement* stmt) {
     
     while (truthy(stmt->test->accept(*this))) {
         
-        try {
-            
-            stmt->body->accept(*this);
-            
-        } catch(BreakException&) {
-            
-            break;
-            
-        } catch(ContinueException&) {
-            
-            continue;
-            
-        }
+        stmt->body->accept(*this);
+        if (loopShouldStop()) break;
         
     }
     
@@ -606,19 +585,8 @@ R Interpreter::visitFor(ForStatement* stmt) {
     
     while (truthy(stmt->test->accept(*this))) {
         
-        try {
-            
-            stmt->body->accept(*this);
-            
-        } catch(BreakException&) {
-            
-            break;
-            
-        } catch(ContinueException&) {
-            
-            continue;
-            
-        }
+        stmt->body->accept(*this);
+        if (loopShouldStop()) break;
         
         stmt->update->accept(*this);
         
@@ -639,13 +607,13 @@ R Interpreter::visitForIn(ForInStatement* stmt) {
     // init can be VariableStatement or Identifier
     string variable;
     
-    if (VariableStatement* variable_stmt = dynamic_cast<VariableStatement*>(stmt->init.get())) {
+    if (VariableStatement* variable_stmt = node_cast<VariableStatement>(stmt->init.get())) {
         
         if (variable_stmt->declarations.size() == 1) {
             variable = variable_stmt->declarations[0].id;
         }
         
-    } else if (IdentifierExpression* ident = dynamic_cast<IdentifierExpression*>(stmt->init.get())) {
+    } else if (IdentifierExpression* ident = node_cast<IdentifierExpression>(stmt->init.get())) {
         variable = ident->name;
     }
     
@@ -656,20 +624,9 @@ R Interpreter::visitForIn(ForInStatement* stmt) {
     // loop through the object fields
     for (auto field : js_object->get_all_properties()) {
         
-        try {
-            
-            env->setStackValue(variable, field.first);
-            stmt->body->accept(*this);
-            
-        } catch(BreakException&) {
-            
-            break;
-            
-        } catch(ContinueException&) {
-            
-            continue;
-            
-        }
+        env->setStackValue(variable, field.first);
+        stmt->body->accept(*this);
+        if (loopShouldStop()) break;
         
     }
 
@@ -689,13 +646,13 @@ R Interpreter::visitForOf(ForOfStatement* stmt) {
     
     string variable;
     
-    if (VariableStatement* variable_stmt = dynamic_cast<VariableStatement*>(stmt->left.get())) {
+    if (VariableStatement* variable_stmt = node_cast<VariableStatement>(stmt->left.get())) {
         
         if (variable_stmt->declarations.size() == 1) {
             variable = variable_stmt->declarations[0].id;
         }
         
-    } else if (IdentifierExpression* ident = dynamic_cast<IdentifierExpression*>(stmt->left.get())) {
+    } else if (IdentifierExpression* ident = node_cast<IdentifierExpression>(stmt->left.get())) {
         
         variable = ident->name;
         
@@ -705,25 +662,17 @@ R Interpreter::visitForOf(ForOfStatement* stmt) {
     
     shared_ptr<JSArray> js_array = get<shared_ptr<JSArray>>(stmt->right->accept(*this));
     
-    for (auto& element : js_array->get_indexed_properties()) {
+    // the elements as they were when the loop started, in index order
+    vector<Value> elements = js_array->elements;
+    
+    for (auto& element : elements) {
                 
-        try {
-            
-            auto shared_element = std::make_shared<Value>();
-            *shared_element = element.second;
+        auto shared_element = std::make_shared<Value>();
+        *shared_element = element;
 
-            env->setStackValue(variable, shared_element);
-            stmt->body->accept(*this);
-            
-        } catch(BreakException&) {
-            
-            break;
-            
-        } catch(ContinueException&) {
-            
-            continue;
-            
-        }
+        env->setStackValue(variable, shared_element);
+        stmt->body->accept(*this);
+        if (loopShouldStop()) break;
         
     }
 
@@ -733,16 +682,48 @@ R Interpreter::visitForOf(ForOfStatement* stmt) {
 
 R Interpreter::visitReturn(ReturnStatement* stmt) {
     
-    R value = stmt->argument ? stmt->argument->accept(*this) : monostate{};
-    throw ReturnException{ value };
+    returnValue = stmt->argument ? stmt->argument->accept(*this) : monostate{};
+    completion = Completion::Return;
+    return true;
 }
 
 R Interpreter::visitBreak(BreakStatement* stmt) {
-    throw BreakException();
+    completion = Completion::Break;
+    return true;
 }
 
 R Interpreter::visitContinue(ContinueStatement* stmt) {
-    throw ContinueException();
+    completion = Completion::Continue;
+    return true;
+}
+
+// the result of a function body: its return value, or undefined if it ran
+// off the end. clears the completion for the caller.
+R Interpreter::takeReturn() {
+    Completion finished = completion;
+    completion = Completion::Normal;
+    if (finished != Completion::Return) return monostate();
+    R value = std::move(returnValue);
+    returnValue = monostate();
+    return value;
+}
+
+// called after each loop iteration: consumes break and continue, and keeps
+// a return pending for the enclosing function
+bool Interpreter::loopShouldStop() {
+    switch (completion) {
+        case Completion::Normal:
+            return false;
+        case Completion::Continue:
+            completion = Completion::Normal;
+            return false;
+        case Completion::Break:
+            completion = Completion::Normal;
+            return true;
+        case Completion::Return:
+            return true;
+    }
+    return true;
 }
 
 R Interpreter::visitEmpty(EmptyStatement* stmt) {
@@ -774,7 +755,7 @@ R Interpreter::create_js_class(vector<unique_ptr<PropertyDeclaration>> fields, v
         vector<string> field_modifiers;
         
         // check tha field is a variable statement
-        if (VariableStatement* variable = dynamic_cast<VariableStatement*>(field->property.get())) {
+        if (VariableStatement* variable = node_cast<VariableStatement>(field->property.get())) {
             
             if (variable->declarations.size() > 1) {
                 throw runtime_error("You cannot have multiple variable declarations here.");
@@ -795,7 +776,7 @@ R Interpreter::create_js_class(vector<unique_ptr<PropertyDeclaration>> fields, v
             
             if (is_static) {
 
-                if (VariableStatement* variable_stmt = dynamic_cast<VariableStatement*>(field->property.get())) {
+                if (VariableStatement* variable_stmt = node_cast<VariableStatement>(field->property.get())) {
                     
                     if (variable_stmt->declarations.size() == 0) {
                         throw runtime_error("static field must be initialized.");
@@ -863,7 +844,7 @@ R Interpreter::create_js_class(vector<unique_ptr<PropertyDeclaration>> fields, v
         
     }
         
-    if (IdentifierExpression* ident = dynamic_cast<IdentifierExpression*>(superClass)) {
+    if (IdentifierExpression* ident = node_cast<IdentifierExpression>(superClass)) {
         js_class->superClass = get<shared_ptr<JSClass>>(env->get(ident->name));
     }
     
@@ -889,6 +870,7 @@ R Interpreter::visitDoWhile(DoWhileStatement* stmt) {
     do {
         
         stmt->body->accept(*this);
+        if (loopShouldStop()) break;
         
     } while(truthy(stmt->condition->accept(*this)));
         
@@ -900,19 +882,8 @@ R Interpreter::visitSwitchCase(SwitchCase* stmt) {
     
     for (auto& current_stmt : stmt->consequent) {
         
-        try {
-            
-            current_stmt->accept(*this);
-            
-        } catch(BreakException&) {
-            
-            break;
-            
-        } catch(ContinueException&) {
-            
-            continue;
-            
-        }
+        current_stmt->accept(*this);
+        if (completion != Completion::Normal) break;
         
     }
     
@@ -929,6 +900,7 @@ R Interpreter::visitSwitch(SwitchStatement* stmt) {
         if (current_case->test == nullptr) {
             // we have hit default case
             current_case->accept(*this);
+            if (completion != Completion::Normal) break;
             continue;
         }
         
@@ -943,6 +915,10 @@ R Interpreter::visitSwitch(SwitchStatement* stmt) {
         
     }
     
+    // break ends the switch; continue and return belong to the enclosing
+    // loop or function
+    if (completion == Completion::Break) completion = Completion::Normal;
+    
     return true;
 }
 
@@ -955,59 +931,78 @@ R Interpreter::visitCatch(CatchClause* stmt) {
 
 R Interpreter::visitTry(TryStatement* stmt) {
     try {
-        if (stmt->block)
-            stmt->block->accept(*this);
-    } catch (const Value& v) {
-        if (stmt->handler) {
+        try {
+            if (stmt->block)
+                stmt->block->accept(*this);
+        } catch (const Value& v) {
+            if (stmt->handler) {
+                    Env* previous = env;
+                    env = new Env(previous);
+                    env->set_var(stmt->handler->param, v);
+                    stmt->handler->accept(*this);
+                    env = previous;
+                } else {
+                    throw; // propagate
+                }
+        } catch (const std::exception& err) {
+            if (stmt->handler) {
+                // Enter a new environment scope for catch
                 Env* previous = env;
                 env = new Env(previous);
-                env->set_var(stmt->handler->param, v);
-                stmt->handler->accept(*this);
+                // Bind the exception to the catch variable
+                env->set_var(stmt->handler->param, toValue(err.what()));
+                try {
+                    stmt->handler->accept(*this); // invokes visitCatch
+                } catch(...) {
+                    //delete env;
+                    env = previous;
+                    throw;
+                }
+                //delete env;
                 env = previous;
             } else {
-                throw; // propagate
+                // No catch handler: propagate
+                throw;
             }
-    } catch (const std::exception& err) {
-        if (stmt->handler) {
-            // Enter a new environment scope for catch
-            Env* previous = env;
-            env = new Env(previous);
-            // Bind the exception to the catch variable
-            env->set_var(stmt->handler->param, toValue(err.what()));
-            try {
-                stmt->handler->accept(*this); // invokes visitCatch
-            } catch(...) {
+        } catch (...) {
+            // Non-std::exception: only handle if catch handler present
+            if (stmt->handler) {
+                Env* previous = env;
+                env = new Env(previous);
+                env->set_var(stmt->handler->param, "unknown error");
+                try {
+                    stmt->handler->accept(*this);
+                } catch(...) {
+                    //delete env;
+                    env = previous;
+                    throw;
+                }
                 //delete env;
                 env = previous;
+            } else {
                 throw;
             }
-            //delete env;
-            env = previous;
-        } else {
-            // No catch handler: propagate
-            throw;
         }
     } catch (...) {
-        // Non-std::exception: only handle if catch handler present
-        if (stmt->handler) {
-            Env* previous = env;
-            env = new Env(previous);
-            env->set_var(stmt->handler->param, "unknown error");
-            try {
-                stmt->handler->accept(*this);
-            } catch(...) {
-                //delete env;
-                env = previous;
-                throw;
-            }
-            //delete env;
-            env = previous;
-        } else {
-            throw;
+        // a throw out of the try or catch block still runs the finally,
+        // unless the finally returns or breaks out of it instead
+        if (stmt->finalizer) {
+            stmt->finalizer->accept(*this);
+            if (completion != Completion::Normal) return true;
         }
+        throw;
     }
     if (stmt->finalizer) {
+        // the finally block runs with a clean completion; a return or break
+        // of its own replaces the pending one
+        Completion pending = completion;
+        R pendingValue = returnValue;
+        completion = Completion::Normal;
         stmt->finalizer->accept(*this);
+        if (completion == Completion::Normal) {
+            completion = pending;
+            returnValue = pendingValue;
+        }
     }
     return true;
 }
@@ -1121,9 +1116,9 @@ R Interpreter::visitBinary(BinaryExpression* expr) {
         case TokenType::LOGICAL_OR_ASSIGN:
         case TokenType::NULLISH_COALESCING_ASSIGN: {
             // Left must be identifier
-            auto* ident = dynamic_cast<IdentifierExpression*>(expr->left.get());
+            auto* ident = node_cast<IdentifierExpression>(expr->left.get());
             
-            auto* member_expr = dynamic_cast<MemberExpression*>(expr->left.get());
+            auto* member_expr = node_cast<MemberExpression>(expr->left.get());
 
             if (!ident && !member_expr) throw runtime_error("Invalid left-hand side in assignment");
             
@@ -1135,7 +1130,7 @@ R Interpreter::visitBinary(BinaryExpression* expr) {
             // add support for member expression
             if (member_expr) {
                 // get the member object name.
-                auto* member_ident  = dynamic_cast<IdentifierExpression*>(member_expr->object.get());
+                auto* member_ident  = node_cast<IdentifierExpression>(member_expr->object.get());
                 if (member_ident) {
                     name = member_ident->token.lexeme;
                     current = env->get(name);
@@ -1177,8 +1172,8 @@ R Interpreter::visitBinary(BinaryExpression* expr) {
             
                 string property_name;
 
-                auto* this_epxr = dynamic_cast<ThisExpression*>(member_expr->object.get());
-                auto* super_epxr = dynamic_cast<ThisExpression*>(member_expr->object.get());
+                auto* this_epxr = node_cast<ThisExpression>(member_expr->object.get());
+                auto* super_epxr = node_cast<ThisExpression>(member_expr->object.get());
 
                 if (super_epxr) {
                     current = env->this_binding->parent_object;
@@ -1189,13 +1184,13 @@ R Interpreter::visitBinary(BinaryExpression* expr) {
                     current = env->this_binding;
                 }
                 
-                if (auto obj = dynamic_cast<MemberExpression*>(member_expr->object.get())) {
+                if (auto obj = node_cast<MemberExpression>(member_expr->object.get())) {
                     current = member_expr->object->accept(*this);
                 }
 
                 if (member_expr->computed) {
                     // TODO: evaluate this.
-                    auto* property_name_ident = dynamic_cast<IdentifierExpression*>(member_expr->property.get());
+                    auto* property_name_ident = node_cast<IdentifierExpression>(member_expr->property.get());
                     
                     if (property_name_ident) {
                         property_name = property_name_ident->token.lexeme;
@@ -1326,7 +1321,7 @@ R Interpreter::visitUnary(UnaryExpression* expr) {
             // ++age
         case TokenType::INCREMENT: {
             
-            if (IdentifierExpression* ident = dynamic_cast<IdentifierExpression*>(expr->right.get())) {
+            if (IdentifierExpression* ident = node_cast<IdentifierExpression>(expr->right.get())) {
                 
                 R value = env->get(ident->name);
                 
@@ -1336,7 +1331,7 @@ R Interpreter::visitUnary(UnaryExpression* expr) {
                 
             } else {
                 // this is member expression.
-                if (MemberExpression* member = dynamic_cast<MemberExpression*>(expr->right.get())) {
+                if (MemberExpression* member = node_cast<MemberExpression>(expr->right.get())) {
                                         
                     // Compute property key
                     std::string key;
@@ -1386,7 +1381,7 @@ R Interpreter::visitUnary(UnaryExpression* expr) {
             // --age
         case TokenType::DECREMENT: {
 
-            if (IdentifierExpression* ident = dynamic_cast<IdentifierExpression*>(expr->right.get())) {
+            if (IdentifierExpression* ident = node_cast<IdentifierExpression>(expr->right.get())) {
                 
                 R value = env->get(ident->name);
                 
@@ -1396,7 +1391,7 @@ R Interpreter::visitUnary(UnaryExpression* expr) {
                 
             } else {
                 // this is member expression.
-                if (MemberExpression* member = dynamic_cast<MemberExpression*>(expr->right.get())) {
+                if (MemberExpression* member = node_cast<MemberExpression>(expr->right.get())) {
                     
                     // check of its static access
                     
@@ -1520,14 +1515,14 @@ R Interpreter::visitUpdate(UpdateExpression* expr) {
             
         case TokenType::INCREMENT: {
             
-            if (IdentifierExpression* ident = dynamic_cast<IdentifierExpression*>(expr->argument.get())) {
+            if (IdentifierExpression* ident = node_cast<IdentifierExpression>(expr->argument.get())) {
                 R sum = toValue(value).numberValue + 1;
                 env->assign(ident->name, sum);
                 return sum;
             }
             
             // this is member expression.
-            if (MemberExpression* member = dynamic_cast<MemberExpression*>(expr->argument.get())) {
+            if (MemberExpression* member = node_cast<MemberExpression>(expr->argument.get())) {
 
                 R objectValue = member->object->accept(*this);
                 
@@ -1616,14 +1611,14 @@ R Interpreter::visitUpdate(UpdateExpression* expr) {
             
         case TokenType::DECREMENT: {
             
-            if (IdentifierExpression* ident = dynamic_cast<IdentifierExpression*>(expr->argument.get())) {
+            if (IdentifierExpression* ident = node_cast<IdentifierExpression>(expr->argument.get())) {
                 R sum = toValue(value).numberValue - 1;
                 env->assign(ident->name, sum);
                 return sum;
             }
 
             // this is member expression.
-            if (MemberExpression* member = dynamic_cast<MemberExpression*>(expr->argument.get())) {
+            if (MemberExpression* member = node_cast<MemberExpression>(expr->argument.get())) {
 
                 R objectValue = member->object->accept(*this);
                 
@@ -1995,7 +1990,7 @@ R Interpreter::visitNew(NewExpression* expr) {
     // here, the object is created from user-defined class
     auto object = make_shared<JSObject>();
     
-    if (IdentifierExpression* ident = dynamic_cast<IdentifierExpression*>(expr->callee.get())) {
+    if (IdentifierExpression* ident = node_cast<IdentifierExpression>(expr->callee.get())) {
 
         const string class_name = ident->name;
         
@@ -2030,7 +2025,7 @@ R Interpreter::visitNew(NewExpression* expr) {
             }
 
             // property is a Statement: VariableStatement
-            if (VariableStatement* variable = dynamic_cast<VariableStatement*>(field.second->property.get())) {
+            if (VariableStatement* variable = node_cast<VariableStatement>(field.second->property.get())) {
 
                 string kind = variable->kind;
 
@@ -2198,7 +2193,7 @@ R Interpreter::visitArrowFunction(ArrowFunction* expr) {
             // Bind parameters to arguments
             if (expr->parameters != nullptr) {
                 
-                if (SequenceExpression* seq = dynamic_cast<SequenceExpression*>(expr->parameters.get())) {
+                if (SequenceExpression* seq = node_cast<SequenceExpression>(expr->parameters.get())) {
                     
                     for (size_t i = 0; i < seq->expressions.size(); ++i) {
                         
@@ -2207,9 +2202,9 @@ R Interpreter::visitArrowFunction(ArrowFunction* expr) {
                         Expression* param_expr = seq->expressions[i].get();
                         string paramName;
                         
-                        if (IdentifierExpression* ident = dynamic_cast<IdentifierExpression*>(param_expr)) {
+                        if (IdentifierExpression* ident = node_cast<IdentifierExpression>(param_expr)) {
                             paramName = ident->token.lexeme;
-                        } else if (VariableStatement* variable = dynamic_cast<VariableStatement*>(param_expr)) {
+                        } else if (VariableStatement* variable = node_cast<VariableStatement>(param_expr)) {
                             // TODO: fix var decl
                             paramName = variable->declarations[0].id;
                             
@@ -2218,7 +2213,7 @@ R Interpreter::visitArrowFunction(ArrowFunction* expr) {
                                 paramValue = toValue(variable->declarations[0].init->accept(*intr));
                             }
                             
-                        } else if (RestParameter* rest_expr = dynamic_cast<RestParameter*>(param_expr)) {
+                        } else if (RestParameter* rest_expr = node_cast<RestParameter>(param_expr)) {
                             paramName = toValue(param_expr->accept(*intr)).stringValue;
                             
                             auto array = make_shared<JSArray>();
@@ -2234,8 +2229,8 @@ R Interpreter::visitArrowFunction(ArrowFunction* expr) {
                             
                         } else {
                             
-                            if (BinaryExpression* bin_expr = dynamic_cast<BinaryExpression*>(param_expr)) {
-                                auto left = dynamic_cast<IdentifierExpression*>(bin_expr->left.get());
+                            if (BinaryExpression* bin_expr = node_cast<BinaryExpression>(param_expr)) {
+                                auto left = node_cast<IdentifierExpression>(bin_expr->left.get());
                                 
                                 if (left) {
                                     paramName = left->token.lexeme;
@@ -2253,7 +2248,7 @@ R Interpreter::visitArrowFunction(ArrowFunction* expr) {
                     
                 }
                 
-                if (IdentifierExpression* ident = dynamic_cast<IdentifierExpression*>(expr->parameters.get())) {
+                if (IdentifierExpression* ident = node_cast<IdentifierExpression>(expr->parameters.get())) {
                     localEnv->set_var(ident->token.lexeme, args.size() > 0 ? args[0] : Value::undefined());
                 }
                 
@@ -2274,17 +2269,11 @@ R Interpreter::visitArrowFunction(ArrowFunction* expr) {
                     
                 }
 
-                promise->resolve(Value::undefined());
+                Value result = toValue(intr->takeReturn());
+                promise->resolve(result);
 
                 intr->env = prevEnv;  // restore before returning
-                return Value::undefined();
-                
-            } catch (const ReturnException& r) {
-                
-                promise->resolve(toValue(r.value));
-
-                intr->env = prevEnv;  // restore before throwing
-                return toValue(r.value);
+                return result;
                 
             } catch (std::exception& e) {
                 
@@ -2321,7 +2310,7 @@ shared_ptr<JSObject> Interpreter::createJSObject(shared_ptr<JSClass> klass) {
     for (auto& field : klass->fields) {
 
         // property is a Statement: VariableStatement
-        if (VariableStatement* variable = dynamic_cast<VariableStatement*>(field.second->property.get())) {
+        if (VariableStatement* variable = node_cast<VariableStatement>(field.second->property.get())) {
 
             string kind = variable->kind;
 
@@ -2416,11 +2405,11 @@ shared_ptr<JSObject> Interpreter::getMemberExprJSObject(MemberExpression* member
     shared_ptr<JSObject> targetObj;
     
     // Handle "this"
-    if (auto* thisExpr = dynamic_cast<ThisExpression*>(member->object.get())) {
+    if (auto* thisExpr = node_cast<ThisExpression>(member->object.get())) {
         targetObj = env->this_binding;
     }
     // Handle "super"
-    else if (auto* superExpr = dynamic_cast<SuperExpression*>(member->object.get())) {
+    else if (auto* superExpr = node_cast<SuperExpression>(member->object.get())) {
         targetObj = env->this_binding->parent_object;
     }
     // Generic object
@@ -2495,8 +2484,8 @@ bool Interpreter::check_obj_prop_access(MemberExpression* member,
     // if member expression is a this, then we don't check for access.
     if (member != nullptr) {
         
-        ThisExpression* is_object_this = dynamic_cast<ThisExpression*>(member->object.get());
-        SuperExpression* is_object_super = dynamic_cast<SuperExpression*>(member->object.get());
+        ThisExpression* is_object_this = node_cast<ThisExpression>(member->object.get());
+        SuperExpression* is_object_super = node_cast<SuperExpression>(member->object.get());
         
         if (is_object_this || is_object_super) {
             return true;
@@ -2570,10 +2559,9 @@ R Interpreter::visitImportDeclaration(ImportDeclaration* stmt) {
     std::string source = read_file(resolved.string());
 
     Scanner scanner(source);
-    auto tokens = scanner.getTokens();
 
     // ✅ pass the resolved file path into the parser
-    Parser parser(tokens);
+    Parser parser(scanner);
     parser.sourceFile = resolved.string();
     auto ast = parser.parse();
 
@@ -2610,9 +2598,9 @@ R Interpreter::visitFunctionExpression(FunctionExpression* expr) {
                 Expression* param_expr = expr->params[i].get();
                 string paramName;
                 
-                if (IdentifierExpression* ident = dynamic_cast<IdentifierExpression*>(param_expr)) {
+                if (IdentifierExpression* ident = node_cast<IdentifierExpression>(param_expr)) {
                     paramName = ident->token.lexeme;
-                } else if (VariableStatement* variable = dynamic_cast<VariableStatement*>(param_expr)) {
+                } else if (VariableStatement* variable = node_cast<VariableStatement>(param_expr)) {
                     // TODO: fix var decl
                     paramName = variable->declarations[0].id;
                     
@@ -2621,7 +2609,7 @@ R Interpreter::visitFunctionExpression(FunctionExpression* expr) {
                         paramValue = toValue(variable->declarations[0].init->accept(*intr));
                     }
                     
-                } else if (RestParameter* rest_expr = dynamic_cast<RestParameter*>(param_expr)) {
+                } else if (RestParameter* rest_expr = node_cast<RestParameter>(param_expr)) {
                     paramName = toValue(param_expr->accept(*intr)).stringValue;
                     
                     auto array = make_shared<JSArray>();
@@ -2636,8 +2624,8 @@ R Interpreter::visitFunctionExpression(FunctionExpression* expr) {
                     break; // we break because rest should be the last param.
                     
                 } else {
-                    if (BinaryExpression* bin_expr = dynamic_cast<BinaryExpression*>(param_expr)) {
-                        auto left = dynamic_cast<IdentifierExpression*>(bin_expr->left.get());
+                    if (BinaryExpression* bin_expr = node_cast<BinaryExpression>(param_expr)) {
+                        auto left = node_cast<IdentifierExpression>(bin_expr->left.get());
                         
                         if (left) {
                             paramName = left->token.lexeme;
@@ -2662,15 +2650,10 @@ R Interpreter::visitFunctionExpression(FunctionExpression* expr) {
                     
                 }
                 
+                Value result = toValue(intr->takeReturn());
                 intr->env = prevEnv;  // restore before returning
-                promise->resolve(Value::undefined());
-                return Value::undefined();
-                
-            } catch (const ReturnException& r) {
-                
-                intr->env = prevEnv;  // restore before throwing
-                promise->resolve(toValue(r.value));
-                return toValue(r.value);
+                promise->resolve(result);
+                return result;
                 
             } catch (std::exception& e) {
 
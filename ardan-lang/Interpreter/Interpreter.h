@@ -39,11 +39,13 @@ class Interpreter : public ExpressionVisitor, public StatementVisitor {
 private:
     Env* env;
     EventLoop* event_loop;
-    struct BreakException {};
-    struct ContinueException {};
-    struct ReturnException {
-        R value;
-    };
+    // how the last statement finished. return, break and continue are
+    // recorded here and unwound by the enclosing statements, not thrown.
+    enum class Completion { Normal, Return, Break, Continue };
+    Completion completion = Completion::Normal;
+    R returnValue;
+    R takeReturn();
+    bool loopShouldStop();
     
     string CONST = "CONST";
     string LET = "LET";
@@ -12,85 +12,240 @@
 Promise::Promise(BaseVM* vm) : vm(vm) {
     loop = &EventLoop::getInstance();
 
+    // promise.then(onFulfilled, onRejected)
     set_builtin_value("then", Value::native([this](vector<Value> args) -> Value {
-        if (args.empty()) return Value::undefined();
-
-        if (args[0].type == ValueType::CLOSURE) {
-            return Value::promise(std::static_pointer_cast<JSObject>(then(args[0])));
-        }
-
-        return Value::promise(std::static_pointer_cast<JSObject>(then(args[0].functionValue)));
+        Value onFulfilled = args.size() > 0 ? args[0] : Value::undefined();
+        Value onRejected = args.size() > 1 ? args[1] : Value::undefined();
+        return Value::promise(std::static_pointer_cast<JSObject>(then(onFulfilled, onRejected)));
     }));
 
     set_builtin_value("catch", Value::native([this](vector<Value> args) -> Value {
-        if (args.empty()) return Value::undefined();
-        return Value::promise(static_pointer_cast<JSObject>(catchError(args[0].functionValue)));
+        Value onRejected = args.size() > 0 ? args[0] : Value::undefined();
+        return Value::promise(std::static_pointer_cast<JSObject>(then(Value::undefined(), onRejected)));
     }));
 }
 
-shared_ptr<Promise> Promise::then(Value cb) {
-    
-    auto callback = [this, cb](vector<Value> args) -> Value {
+shared_ptr<Promise> Promise::from(const Value& v) {
+
+    if (v.type == ValueType::PROMISE) {
+        return v.promiseValue;
+    }
+
+    if (v.type == ValueType::OBJECT && v.objectValue) {
+        return dynamic_pointer_cast<Promise>(v.objectValue);
+    }
+
+    return nullptr;
+
+}
+
+Value Promise::invoke(BaseVM* vm, const Value& fn, vector<Value> args) {
+
+    switch (fn.type) {
+        case ValueType::FUNCTION:
+            return fn.functionValue(args);
+        case ValueType::NATIVE_FUNCTION:
+            return fn.nativeFunction(args);
+        case ValueType::CLOSURE:
+            if (vm == nullptr) {
+                throw runtime_error("Promise callback needs a VM to run a closure");
+            }
+            return vm->callFunction(fn, args);
+        default:
+            throw runtime_error("Promise callback is not a function");
+    }
+
+}
+
+// turns a script value into a reaction handler. non-callables become
+// nullptr so the reaction passes the value/error through.
+Promise::Callback Promise::toCallback(const Value& cb) {
+
+    if (cb.type != ValueType::FUNCTION &&
+        cb.type != ValueType::NATIVE_FUNCTION &&
+        cb.type != ValueType::CLOSURE) {
+        return nullptr;
+    }
 
-        return vm->callFunction(cb, args);
-        
+    // capture the vm, not this: the job may outlive the source promise
+    BaseVM* owner = vm;
+    return [owner, cb](vector<Value> args) -> Value {
+        return invoke(owner, cb, args);
     };
-    
-    return then(callback);
 
 }
 
+shared_ptr<Promise> Promise::then(Value cb) {
+    return then(toCallback(cb), nullptr);
+}
+
+shared_ptr<Promise> Promise::then(Value onFulfilled, Value onRejected) {
+    return then(toCallback(onFulfilled), toCallback(onRejected));
+}
+
 shared_ptr<Promise> Promise::then(Callback cb) {
-    auto next = std::make_shared<Promise>(vm);
-    auto wrapper = [cb, next, this](vector<Value> v) -> Value {
-        
-        try {
-            Value result = cb(v);
-            next->resolve(result);
-        } catch (...) {
-            next->reject(Value::str("Error in then callback"));
-        }
-        
-        return Value::nullVal();
-        
-    };
+    return then(cb, nullptr);
+}
+
+shared_ptr<Promise> Promise::then(Callback onFulfilled, Errback onRejected) {
+    return addReaction({ onFulfilled, onRejected, std::make_shared<Promise>(vm) });
+}
+
+shared_ptr<Promise> Promise::catchError(Errback cb) {
+    return then(nullptr, cb);
+}
+
+shared_ptr<Promise> Promise::addReaction(Reaction reaction) {
 
-    if (resolved) loop->post(wrapper, {value});
-    else { then_callbacks.push_back(wrapper); loop->post(wrapper, {value}); }
+    shared_ptr<Promise> next = reaction.next;
+
+    if (state == State::Pending) {
+        reactions.push_back(std::move(reaction));
+    } else {
+        scheduleReaction(reaction);
+    }
 
     return next;
+
 }
 
-shared_ptr<Promise> Promise::catchError(Errback cb) {
-    auto next = std::make_shared<Promise>(vm);
-    auto wrapper = [cb, next, this](vector<Value> err) -> Value {
+// queues the job for a settled promise. each reaction is scheduled once,
+// either here from then() or from settle().
+void Promise::scheduleReaction(const Reaction& reaction) {
+
+    bool fulfilled = state == State::Fulfilled;
+    Value result = fulfilled ? value : error;
+
+    loop->queueMicrotask([reaction, fulfilled](vector<Value> args) -> Value {
+
+        const Callback& handler = fulfilled ? reaction.onFulfilled : reaction.onRejected;
+
+        if (!handler) {
+            // no handler: pass the outcome on to the chained promise
+            if (reaction.next) {
+                if (fulfilled) reaction.next->resolve(args[0]);
+                else reaction.next->reject(args[0]);
+            }
+            return Value::undefined();
+        }
+
         try {
-            Value result = cb(err);
-            next->resolve(result);
+            Value handled = handler(args);
+            if (reaction.next) reaction.next->resolve(handled);
+        } catch (const std::exception& e) {
+            if (reaction.next) reaction.next->reject(Value::str(e.what()));
         } catch (...) {
-            next->reject(Value::str("Error in catch callback"));
+            if (reaction.next) reaction.next->reject(Value::str("Error in promise callback"));
         }
-        return Value::nullVal();
-    };
 
-    if (rejected) loop->post(wrapper, {error});
-    else { catch_callbacks.push_back(wrapper); loop->post(wrapper, {error}); }
+        return Value::undefined();
+
+    }, { result });
+
+}
+
+void Promise::settle(State new_state, Value result) {
+
+    if (state != State::Pending) return;
+
+    state = new_state;
+    if (state == State::Fulfilled) value = result;
+    else error = result;
+
+    vector<Reaction> pending = std::move(reactions);
+    reactions.clear();
+
+    for (auto& reaction : pending) {
+        scheduleReaction(reaction);
+    }
 
-    return next;
 }
 
 void Promise::resolve(Value v) {
-    if (resolved || rejected) return;
-    resolved = true;
-    value = v;
-    for (auto& cb : then_callbacks) cb({v});
-    then_callbacks.clear();
+
+    if (already_resolved) return;
+    already_resolved = true;
+
+    shared_ptr<Promise> inner = from(v);
+
+    if (inner.get() == this) {
+        settle(State::Rejected, Value::str("TypeError: Chaining cycle detected for promise"));
+        return;
+    }
+
+    auto self = shared_from_this();
+
+    // adopt another promise: follow its outcome without an extra wrapper
+    if (inner) {
+        inner->addReaction({
+            [self](vector<Value> args) -> Value {
+                self->settle(State::Fulfilled, args[0]);
+                return Value::undefined();
+            },
+            [self](vector<Value> args) -> Value {
+                self->settle(State::Rejected, args[0]);
+                return Value::undefined();
+            },
+            nullptr
+        });
+        return;
+    }
+
+    // thenable object: call its then(resolve, reject) in a job
+    if (v.type == ValueType::OBJECT && v.objectValue) {
+
+        Value then_fn = v.objectValue->get("then");
+
+        if (then_fn.type == ValueType::FUNCTION ||
+            then_fn.type == ValueType::NATIVE_FUNCTION ||
+            then_fn.type == ValueType::CLOSURE) {
+
+            loop->queueMicrotask([self, then_fn](vector<Value> args) -> Value {
+
+                // a thenable may call both; only the first one counts
+                auto called = make_shared<bool>(false);
+
+                Value resolve_fn = Value::native([self, called](const vector<Value>& args) -> Value {
+                    if (*called) return Value::undefined();
+                    *called = true;
+                    self->already_resolved = false;
+                    self->resolve(args.empty() ? Value::undefined() : args[0]);
+                    return Value::undefined();
+                });
+
+                Value reject_fn = Value::native([self, called](const vector<Value>& args) -> Value {
+                    if (*called) return Value::undefined();
+                    *called = true;
+                    self->settle(State::Rejected, args.empty() ? Value::undefined() : args[0]);
+                    return Value::undefined();
+                });
+
+                try {
+                    invoke(self->vm, then_fn, { resolve_fn, reject_fn });
+                } catch (const std::exception& e) {
+                    if (!*called) {
+                        *called = true;
+                        self->settle(State::Rejected, Value::str(e.what()));
+                    }
+                }
+
+                return Value::undefined();
+
+            }, {});
+
+            return;
+        }
+    }
+
+    settle(State::Fulfilled, v);
+
 }
 
 void Promise::reject(Value err) {
-    if (resolved || rejected) return;
-    rejected = true;
-    error = err;
-    for (auto& cb : catch_callbacks) cb({err});
-    catch_callbacks.clear();
+
+    if (already_resolved) return;
+    already_resolved = true;
+
+    settle(State::Rejected, err);
+
 }
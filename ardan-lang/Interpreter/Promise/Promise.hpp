@@ -10,6 +10,7 @@
 
 #include <stdio.h>
 #include <vector>
+#include <memory>
 #include "Interpreter/ExecutionContext/Value/Value.h"
 #include "Interpreter/ExecutionContext/JSObject/JSObject.h"
 #include "EventLoop/EventLoop.hpp"
@@ -17,30 +18,59 @@
 class BaseVM;
 using namespace std;
 
-class Promise : public JSObject {
+class Promise : public JSObject, public enable_shared_from_this<Promise> {
 public:
     using Callback = std::function<Value(vector<Value>)>;
     using Errback  = std::function<Value(vector<Value>)>;
-    
+
+    enum class State { Pending, Fulfilled, Rejected };
+
     EventLoop* loop;
     BaseVM* vm;
     explicit Promise(BaseVM* vm);
 
     shared_ptr<Promise> then(Value cb);
+    shared_ptr<Promise> then(Value onFulfilled, Value onRejected);
     shared_ptr<Promise> then(Callback cb);
+    shared_ptr<Promise> then(Callback onFulfilled, Errback onRejected);
     shared_ptr<Promise> catchError(Errback cb);
 
+    // resolve adopts the state of a promise or thenable passed to it.
     void resolve(Value v);
     void reject(Value err);
 
+    State getState() const { return state; }
+    // the fulfilment value or rejection reason, undefined while pending
+    const Value& result() const { return state == State::Rejected ? error : value; }
+
+    // unwraps a PROMISE value, or an OBJECT value holding a Promise.
+    static shared_ptr<Promise> from(const Value& v);
+
 private:
-    bool resolved = false;
-    bool rejected = false;
+    // one pending then/catch registration. next is null for internal
+    // subscriptions (thenable adoption, await).
+    struct Reaction {
+        Callback onFulfilled;
+        Errback onRejected;
+        shared_ptr<Promise> next;
+    };
+
+    State state = State::Pending;
+
+    // set once resolve/reject has been called, even while still adopting
+    // another promise, so later calls are ignored.
+    bool already_resolved = false;
     Value value;
     Value error;
 
-    std::vector<Callback> then_callbacks;
-    std::vector<Errback>  catch_callbacks;
+    std::vector<Reaction> reactions;
+
+    Callback toCallback(const Value& cb);
+    static Value invoke(BaseVM* vm, const Value& fn, vector<Value> args);
+    shared_ptr<Promise> addReaction(Reaction reaction);
+    void scheduleReaction(const Reaction& reaction);
+    void settle(State new_state, Value result);
+
 };
 
 #endif /* Promise_hpp */
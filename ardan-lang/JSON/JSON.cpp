@@ -6,6 +6,559 @@
 //
 
 #include "JSON.hpp"
+#include "JSONScanner.hpp"
+#include "Interpreter/ExecutionContext/JSTypedArray/JSTypedArray.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+
+namespace {
+
+class JSONParser {
+
+public:
+    JSONParser(string_view text) : begin(text.data()), p(text.data()), end(text.data() + text.size()) {}
+
+    Value parse() {
+        skipWhitespace();
+        Value value = parseValue(0);
+        skipWhitespace();
+        if (p != end) fail("Unexpected token");
+        return value;
+    }
+
+private:
+    const char* begin;
+    const char* p;
+    const char* end;
+
+    // string contents are decoded here, so a string costs one allocation
+    string scratch;
+
+    static const int MAX_DEPTH = 512;
+
+    [[noreturn]] void fail(const string& what) {
+        string near = p < end ? string(" '") + *p + "'" : string(" end of input");
+        throw runtime_error("JSON.parse: " + what + near + " at position " + to_string(p - begin));
+    }
+
+    void skipWhitespace() {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+    }
+
+    void expect(char c) {
+        if (p >= end || *p != c) fail(string("Expected '") + c + "' but found");
+        p++;
+    }
+
+    Value parseValue(int depth) {
+
+        if (p >= end) fail("Unexpected");
+
+        switch (*p) {
+            case '{': return parseObject(depth + 1);
+            case '[': return parseArray(depth + 1);
+            case '"': return Value::str(parseString());
+            case 't': literal("true"); return Value::boolean(true);
+            case 'f': literal("false"); return Value::boolean(false);
+            case 'n': literal("null"); return Value::nullVal();
+            default:
+                if (*p == '-' || (*p >= '0' && *p <= '9')) return parseNumber();
+                fail("Unexpected token");
+        }
+
+    }
+
+    void literal(const char* word) {
+        size_t length = strlen(word);
+        if ((size_t)(end - p) < length || memcmp(p, word, length) != 0) fail("Unexpected token");
+        p += length;
+    }
+
+    Value parseObject(int depth) {
+
+        if (depth > MAX_DEPTH) fail("Nesting too deep");
+
+        auto object = make_shared<JSObject>();
+        object->set_as_object_literal();
+        p++;
+
+        skipWhitespace();
+        if (p < end && *p == '}') {
+            p++;
+            return Value::object(object);
+        }
+
+        while (true) {
+            skipWhitespace();
+            if (p >= end || *p != '"') fail("Expected property name but found");
+            Atom key(parseString());
+
+            skipWhitespace();
+            expect(':');
+            skipWhitespace();
+
+            object->set(key, parseValue(depth));
+
+            skipWhitespace();
+            if (p < end && *p == ',') {
+                p++;
+                continue;
+            }
+            expect('}');
+            return Value::object(object);
+        }
+
+    }
+
+    Value parseArray(int depth) {
+
+        if (depth > MAX_DEPTH) fail("Nesting too deep");
+
+        auto array = make_shared<JSArray>();
+        p++;
+
+        skipWhitespace();
+        if (p < end && *p == ']') {
+            p++;
+            return Value::array(array);
+        }
+
+        while (true) {
+            skipWhitespace();
+            array->push({ parseValue(depth) });
+
+            skipWhitespace();
+            if (p < end && *p == ',') {
+                p++;
+                continue;
+            }
+            expect(']');
+            return Value::array(array);
+        }
+
+    }
+
+    // decodes the string at p into scratch
+    const string& parseString() {
+
+        p++;
+        scratch.clear();
+
+        while (true) {
+
+            size_t run = plainStringRun(p, end);
+            scratch.append(p, run);
+            p += run;
+
+            if (p >= end) fail("Unterminated string, found");
+
+            char c = *p;
+            if (c == '"') {
+                p++;
+                return scratch;
+            }
+            if (c != '\\') fail("Bad control character in string");
+
+            p++;
+            if (p >= end) fail("Unterminated string, found");
+
+            switch (*p++) {
+                case '"': scratch += '"'; break;
+                case '\\': scratch += '\\'; break;
+                case '/': scratch += '/'; break;
+                case 'b': scratch += '\b'; break;
+                case 'f': scratch += '\f'; break;
+                case 'n': scratch += '\n'; break;
+                case 'r': scratch += '\r'; break;
+                case 't': scratch += '\t'; break;
+                case 'u': unicodeEscape(); break;
+                default:
+                    p--;
+                    fail("Bad escaped character");
+            }
+
+        }
+
+    }
+
+    unsigned hex4() {
+        if (end - p < 4) fail("Bad Unicode escape");
+        unsigned code = 0;
+        for (int i = 0; i < 4; i++, p++) {
+            char c = *p;
+            code <<= 4;
+            if (c >= '0' && c <= '9') code |= c - '0';
+            else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+            else fail("Bad Unicode escape");
+        }
+        return code;
+    }
+
+    // after "\u"; a surrogate pair becomes one code point, a lone surrogate
+    // is kept as its three byte form
+    void unicodeEscape() {
+
+        unsigned code = hex4();
+
+        if (code >= 0xD800 && code <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+            const char* save = p;
+            p += 2;
+            unsigned low = hex4();
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            } else {
+                p = save;
+            }
+        }
+
+        if (code < 0x80) {
+            scratch += (char)code;
+        } else if (code < 0x800) {
+            scratch += (char)(0xC0 | (code >> 6));
+            scratch += (char)(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            scratch += (char)(0xE0 | (code >> 12));
+            scratch += (char)(0x80 | ((code >> 6) & 0x3F));
+            scratch += (char)(0x80 | (code & 0x3F));
+        } else {
+            scratch += (char)(0xF0 | (code >> 18));
+            scratch += (char)(0x80 | ((code >> 12) & 0x3F));
+            scratch += (char)(0x80 | ((code >> 6) & 0x3F));
+            scratch += (char)(0x80 | (code & 0x3F));
+        }
+
+    }
+
+    Value parseNumber() {
+
+        const char* start = p;
+        bool negative = *p == '-';
+        if (negative) p++;
+
+        if (p >= end || *p < '0' || *p > '9') fail("No number after minus sign, found");
+
+        // short integers, the common case, are accumulated directly
+        long long integer = 0;
+        int digits = 0;
+
+        if (*p == '0') {
+            p++;
+        } else {
+            while (p < end && *p >= '0' && *p <= '9') {
+                if (digits < 18) integer = integer * 10 + (*p - '0');
+                digits++;
+                p++;
+            }
+        }
+
+        bool isInteger = true;
+
+        if (p < end && *p == '.') {
+            isInteger = false;
+            p++;
+            if (p >= end || *p < '0' || *p > '9') fail("Unterminated fractional number, found");
+            while (p < end && *p >= '0' && *p <= '9') p++;
+        }
+
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            isInteger = false;
+            p++;
+            if (p < end && (*p == '+' || *p == '-')) p++;
+            if (p >= end || *p < '0' || *p > '9') fail("Exponent part is missing a number, found");
+            while (p < end && *p >= '0' && *p <= '9') p++;
+        }
+
+        if (isInteger && digits <= 15) {
+            // -0 stays negative zero
+            return Value::number(negative ? -(double)integer : (double)integer);
+        }
+
+        // the text is not NUL terminated, so strtod gets a copy
+        string number(start, p - start);
+        return Value::number(strtod(number.c_str(), nullptr));
+
+    }
+
+};
+
+class JSONWriter {
+
+public:
+    JSONWriter(const string& indent) : indent(indent) {
+        out.reserve(256);
+    }
+
+    string out;
+
+    // false when value has no JSON form; nothing is written then
+    bool write(const Value& value) {
+
+        switch (value.type) {
+            case ValueType::NUMBER:
+                writeNumber(value.numberValue);
+                return true;
+            case ValueType::STRING:
+                writeString(value.stringValue.str());
+                return true;
+            case ValueType::BOOLEAN:
+                out += value.boolValue ? "true" : "false";
+                return true;
+            case ValueType::NULLTYPE:
+                out += "null";
+                return true;
+            case ValueType::ARRAY:
+                writeArray(value.arrayValue.get());
+                return true;
+            case ValueType::OBJECT:
+                writeObject(value.objectValue.get());
+                return true;
+            case ValueType::PROMISE:
+                out += "{}";
+                return true;
+            default:
+                return false;
+        }
+
+    }
+
+private:
+    string indent;
+    // objects and arrays being written, to reject cycles
+    vector<const void*> open;
+
+    static bool serializable(const Value& value) {
+        switch (value.type) {
+            case ValueType::NUMBER:
+            case ValueType::STRING:
+            case ValueType::BOOLEAN:
+            case ValueType::NULLTYPE:
+            case ValueType::ARRAY:
+            case ValueType::OBJECT:
+            case ValueType::PROMISE:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    void enter(const void* container) {
+        if (find(open.begin(), open.end(), container) != open.end()) {
+            throw runtime_error("JSON.stringify: cannot convert a circular structure");
+        }
+        open.push_back(container);
+    }
+
+    void newline() {
+        if (indent.empty()) return;
+        out += '\n';
+        for (size_t i = 0; i < open.size(); i++) out += indent;
+    }
+
+    void writeNumber(double n) {
+
+        if (!std::isfinite(n)) {
+            out += "null";
+            return;
+        }
+
+        char buffer[32];
+
+        if (n == std::trunc(n) && std::fabs(n) < 9007199254740992.0) {
+            auto result = to_chars(buffer, buffer + sizeof(buffer), (long long)n);
+            out.append(buffer, result.ptr);
+            return;
+        }
+
+        // shortest round-trip digits, laid out the way Number#toString does
+        auto result = to_chars(buffer, buffer + sizeof(buffer), n, chars_format::scientific);
+        string_view text(buffer, result.ptr - buffer);
+
+        size_t e = text.find('e');
+        bool negative = text[0] == '-';
+        string digits;
+        for (char c : text.substr(negative ? 1 : 0, e - (negative ? 1 : 0))) {
+            if (c != '.') digits += c;
+        }
+        int exponent = atoi(string(text.substr(e + 1)).c_str());
+        int k = (int)digits.size();
+        int point = exponent + 1;
+
+        if (negative) out += '-';
+
+        if (k <= point && point <= 21) {
+            out += digits;
+            out.append(point - k, '0');
+        } else if (0 < point && point <= 21) {
+            out.append(digits, 0, point);
+            out += '.';
+            out.append(digits, point, string::npos);
+        } else if (-6 < point && point <= 0) {
+            out += "0.";
+            out.append(-point, '0');
+            out += digits;
+        } else {
+            out += digits[0];
+            if (k > 1) {
+                out += '.';
+                out.append(digits, 1, string::npos);
+            }
+            out += 'e';
+            out += point - 1 >= 0 ? '+' : '-';
+            out += to_string(abs(point - 1));
+        }
+
+    }
+
+    void writeString(const string& text) {
+
+        static const char* hex = "0123456789abcdef";
+
+        out += '"';
+
+        const char* p = text.data();
+        const char* end = p + text.size();
+
+        while (p < end) {
+
+            size_t run = plainStringRun(p, end);
+            out.append(p, run);
+            p += run;
+            if (p >= end) break;
+
+            unsigned char c = static_cast<unsigned char>(*p++);
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\b': out += "\\b"; break;
+                case '\f': out += "\\f"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0xF];
+            }
+
+        }
+
+        out += '"';
+
+    }
+
+    void writeArray(JSArray* array) {
+
+        enter(array);
+        out += '[';
+
+        size_t length = array->length();
+        for (size_t i = 0; i < length; i++) {
+            if (i > 0) out += ',';
+            newline();
+            if (!write(array->getIndex(i))) out += "null";
+        }
+
+        open.pop_back();
+        if (length > 0) newline();
+        out += ']';
+
+    }
+
+    void writeKey(const string& key) {
+        writeString(key);
+        out += indent.empty() ? ":" : ": ";
+    }
+
+    void writeObject(JSObject* object) {
+
+        enter(object);
+        out += '{';
+
+        bool first = true;
+
+        if (object->is_typed_array) {
+            // typed arrays serialize as an object of their elements
+            auto* typed = static_cast<JSTypedArray*>(object);
+            for (size_t i = 0; i < typed->length; i++) {
+                if (!first) out += ',';
+                first = false;
+                newline();
+                writeKey(to_string(i));
+                writeNumber(typed->load(i));
+            }
+        } else {
+            for (const Atom& key : object->own_keys()) {
+
+                const vector<string>& modifiers = object->get_modifiers(key);
+                if (find(modifiers.begin(), modifiers.end(), "private") != modifiers.end() ||
+                    find(modifiers.begin(), modifiers.end(), "protected") != modifiers.end()) {
+                    continue;
+                }
+
+                Value value = object->get(key);
+                if (!serializable(value)) continue;
+
+                if (!first) out += ',';
+                first = false;
+                newline();
+                writeKey(key);
+                write(value);
+
+            }
+        }
+
+        open.pop_back();
+        if (!first) newline();
+        out += '}';
+
+    }
+
+};
+
+}
+
+Value JSON::parse(string_view text) {
+    return JSONParser(text).parse();
+}
+
+Value JSON::stringify(const Value& value, const string& indent) {
+    JSONWriter writer(indent);
+    if (!writer.write(value)) return Value::undefined();
+    return Value::rope(RopeString(std::move(writer.out)));
+}
+
+JSON::JSON() {
+
+    set_builtin_value("parse", Value::native([](const std::vector<Value>& args) {
+
+        if (args.empty()) return JSON::parse("undefined");
+        if (args[0].type == ValueType::STRING) return JSON::parse(args[0].stringValue.str());
+        return JSON::parse(args[0].toString());
+
+    }));
+
+    // JSON.stringify(value, replacer, space); replacer is not supported
+    set_builtin_value("stringify", Value::native([](const std::vector<Value>& args) {
+
+        string indent;
+
+        if (args.size() > 2) {
+            const Value& space = args[2];
+            if (space.type == ValueType::NUMBER) {
+                indent.assign((size_t)std::clamp(space.numberValue, 0.0, 10.0), ' ');
+            } else if (space.type == ValueType::STRING) {
+                indent = space.stringValue.str().substr(0, 10);
+            }
+        }
+
+        return JSON::stringify(args.empty() ? Value::undefined() : args[0], indent);
+
+    }));
+
+}
 
 // Simple function to trim whitespace and quotes
 std::string JSON::trim(const std::string& s) {
@@ -14,7 +567,8 @@ std::string JSON::trim(const std::string& s) {
     return (start == std::string::npos) ? "" : s.substr(start, end - start + 1);
 }
 
-// Very basic JSON object reader (flat key-value pairs only)
+// Top-level members of a JSON object file. Strings map to their contents,
+// other values to their JSON text.
 std::map<std::string, std::string> JSON::readJson(const std::string& filename) {
     std::ifstream file(filename);
     std::map<std::string, std::string> result;
@@ -24,23 +578,25 @@ std::map<std::string, std::string> JSON::readJson(const std::string& filename) {
         return result;
     }
 
-    std::string line, json;
-    while (std::getline(file, line)) {
-        json += line;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    Value data;
+    try {
+        data = parse(buffer.str());
+    } catch (const runtime_error& error) {
+        std::cerr << filename << ": " << error.what() << "\n";
+        return result;
     }
 
-    // Remove braces { }
-    json.erase(std::remove(json.begin(), json.end(), '{'), json.end());
-    json.erase(std::remove(json.begin(), json.end(), '}'), json.end());
+    if (data.type != ValueType::OBJECT) return result;
 
-    std::stringstream ss(json);
-    std::string pair;
-    while (std::getline(ss, pair, ',')) {
-        size_t colon = pair.find(':');
-        if (colon != std::string::npos) {
-            std::string key = trim(pair.substr(0, colon));
-            std::string value = trim(pair.substr(colon + 1));
-            result[key] = value;
+    for (const Atom& key : data.objectValue->own_keys()) {
+        Value value = data.objectValue->get(key);
+        if (value.type == ValueType::STRING) {
+            result[key.str()] = value.stringValue.str();
+        } else {
+            result[key.str()] = stringify(value).toString();
         }
     }
 
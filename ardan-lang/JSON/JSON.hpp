@@ -13,11 +13,25 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <map>
 #include <algorithm>
 
-class JSON {
+#include "Interpreter/R.hpp"
+
+using namespace std;
+
+// The `JSON` global: parse() builds JSObject/JSArray values in one pass over
+// the text, stringify() writes into a single growing buffer.
+class JSON : public JSObject {
 public:
+    JSON();
+
+    // throws runtime_error on malformed text
+    static Value parse(string_view text);
+    // undefined when value has no JSON form (undefined, functions)
+    static Value stringify(const Value& value, const string& indent = "");
+
     std::string trim(const std::string& s);
     std::map<std::string, std::string> readJson(const std::string& filename);
 
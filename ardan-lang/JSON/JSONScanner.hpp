@@ -0,0 +1,70 @@
+//
+//  JSONScanner.hpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 19/10/2026.
+//
+
+#ifndef JSONScanner_hpp
+#define JSONScanner_hpp
+
+#include <stdio.h>
+#include <cstddef>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Length of the run starting at p that a JSON string can hold as is: it ends
+// at the first '"', '\\' or control character, or at end. The parser uses it
+// to copy string contents and the stringifier to copy unescaped text, 16
+// bytes per step where SSE2 (every x86-64) or NEON (arm64) is available.
+inline size_t plainStringRun(const char* p, const char* end) {
+
+    const char* start = p;
+
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i lastControl = _mm_set1_epi8(0x1f);
+
+    while (end - p >= 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        // unsigned byte <= 0x1f  <=>  min(byte, 0x1f) == byte
+        __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(bytes, lastControl), bytes);
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, quote),
+                                                     _mm_cmpeq_epi8(bytes, backslash)),
+                                       control);
+        int mask = _mm_movemask_epi8(special);
+        if (mask) return (p - start) + __builtin_ctz(mask);
+        p += 16;
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t firstPrintable = vdupq_n_u8(0x20);
+
+    while (end - p >= 16) {
+        uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+        uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(bytes, quote),
+                                               vceqq_u8(bytes, backslash)),
+                                      vcltq_u8(bytes, firstPrintable));
+        // the scalar loop below finds the byte within this block
+        if (vmaxvq_u8(special)) break;
+        p += 16;
+    }
+#endif
+
+    while (p < end) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\' || c < 0x20) break;
+        p++;
+    }
+
+    return p - start;
+
+}
+
+#endif /* JSONScanner_hpp */
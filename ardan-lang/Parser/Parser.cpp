@@ -10,11 +10,17 @@
 #include "Statements/Statements.hpp"
 #include "Visitor/AstPrinter/AstPrinter.h"
 #include <stdexcept>
+#include <algorithm>
 
 using namespace std;
 
+bool defer_function_bodies = true;
+
 vector<unique_ptr<Statement>> Parser::parse() {
     
+    // every node of this tree goes into one arena
+    AstContext::Scope scope;
+    
     while (isAtEnd() == false) {
         statements.push_back(parseStatement());
     }
@@ -24,6 +30,15 @@ vector<unique_ptr<Statement>> Parser::parse() {
 }
 
 unique_ptr<Statement> Parser::parseStatement() {
+    int line = peek().line;
+    statementDepth++;
+    auto stmt = parseStatementKind();
+    statementDepth--;
+    stmt->line = line;
+    return stmt;
+}
+
+unique_ptr<Statement> Parser::parseStatementKind() {
     Token token = peek();
 
     switch (token.type) {
@@ -241,6 +256,16 @@ unique_ptr<Statement> Parser::parseFunctionDeclaration() {
     consumeKeyword("FUNCTION");
     auto id = consume(TokenType::IDENTIFIER, "Expected function name");
     
+    // only top-level declarations are deferred; anything nested is parsed
+    // along with the function around it
+    return parseFunctionRest(id.lexeme, deferredSource && statementDepth == 1);
+}
+
+unique_ptr<FunctionDeclaration> Parser::parseFunctionRest(const string& id, bool defer) {
+    
+    int begin = peek().offset;
+    int line = peek().line;
+    
     bool seenRest = false;
     
     consume(TokenType::LEFT_PARENTHESIS, "Expected '('");
@@ -259,8 +284,68 @@ unique_ptr<Statement> Parser::parseFunctionDeclaration() {
         } while (match(TokenType::COMMA));
     }
     consume(TokenType::RIGHT_PARENTHESIS, "Expected ')'");
+    
+    if (defer) {
+        skipFunctionBody();
+        auto function = make_unique<FunctionDeclaration>(id, std::move(params), nullptr);
+        function->deferred = make_shared<DeferredFunction>(DeferredFunction{ deferredSource, begin, previous().offset + 1, line });
+        return function;
+    }
+    
     unique_ptr<Statement> body = parseBlockStatement();
-    return make_unique<FunctionDeclaration>(id.lexeme, std::move(params), std::move(body));
+    return make_unique<FunctionDeclaration>(id, std::move(params), std::move(body));
+}
+
+// Pre-parse of a function body: scans up to its closing '}' checking only
+// that brackets pair up. Everything else is checked when it is parsed for real.
+void Parser::skipFunctionBody() {
+    
+    consume(TokenType::LEFT_BRACKET, "Expected '{'");
+    vector<TokenType> closers = { TokenType::RIGHT_BRACKET };
+    
+    while (!closers.empty()) {
+        
+        if (isAtEnd()) {
+            throw runtime_error("Parse error: expected '}' at end of function " + to_string(peek().line));
+        }
+        
+        const Token& token = advance();
+        
+        switch (token.type) {
+            case TokenType::LEFT_BRACKET:
+                closers.push_back(TokenType::RIGHT_BRACKET);
+                break;
+            case TokenType::LEFT_PARENTHESIS:
+                closers.push_back(TokenType::RIGHT_PARENTHESIS);
+                break;
+            case TokenType::LEFT_SQUARE_BRACKET:
+                closers.push_back(TokenType::RIGHT_SQUARE_BRACKET);
+                break;
+            case TokenType::RIGHT_BRACKET:
+            case TokenType::RIGHT_PARENTHESIS:
+            case TokenType::RIGHT_SQUARE_BRACKET:
+                if (token.type != closers.back()) {
+                    throw runtime_error("Parse error: unbalanced brackets " + to_string(token.line));
+                }
+                closers.pop_back();
+                break;
+            default:
+                break;
+        }
+        
+    }
+    
+}
+
+unique_ptr<FunctionDeclaration> Parser::parseDeferred(const string& id, const DeferredFunction& deferred) {
+    
+    Scanner scanner(*deferred.source, deferred.begin, deferred.line);
+    Parser parser(scanner);
+    
+    AstContext::Scope scope;
+    
+    return parser.parseFunctionRest(id, false);
+    
 }
 
 unique_ptr<Statement> Parser::parseClassDeclaration() {
@@ -471,7 +556,7 @@ unique_ptr<Statement> Parser::parseAsyncStatement() {
     
     if (peek().type == TokenType::KEYWORD && peek().lexeme == "FUNCTION") {
         stmt = parseFunctionDeclaration();
-        auto func_decl = dynamic_cast<FunctionDeclaration*>(stmt.get());
+        auto func_decl = node_cast<FunctionDeclaration>(stmt.get());
         
         if (func_decl) {
             func_decl->is_async = true;
@@ -786,34 +871,40 @@ Token Parser::consume(TokenType type, const std::string& message) {
     throw std::runtime_error("Parse error: expected " + message + " " + to_string(peek().line));
 }
 
-bool Parser::check(TokenType type) {
-    if (isAtEnd()) return false;
-    return peek().type == type;
+void Parser::pull() {
+    
+    Token& slot = window[pulled & (TOKEN_WINDOW - 1)];
+    
+    if (scanner) {
+        slot = scanner->nextToken();
+    } else if (nextToken < tokens.size()) {
+        slot = std::move(tokens[nextToken++]);
+    } else {
+        slot = Token{ TokenType::END_OF_FILE, "", 0 };
+    }
+    
+    pulled++;
+    
 }
 
-Token Parser::advance() {
+const Token& Parser::advance() {
     if (!isAtEnd()) current++;
     return previous();
 }
 
-Token Parser::peek() {
-    return tokens[current];
-}
-
-Token Parser::previous() {
-    return tokens[current - 1];
-}
-
-bool Parser::isAtEnd() {
-    return peek().type == TokenType::END_OF_FILE;
+Token Parser::keywordAsName() {
+    Token name = advance();
+    name.type = TokenType::IDENTIFIER;
+    transform(name.lexeme.begin(), name.lexeme.end(), name.lexeme.begin(), ::tolower);
+    return name;
 }
 
-bool Parser::checkKeyword(const string& keyword) {
+bool Parser::checkKeyword(string_view keyword) {
     if (isAtEnd()) return false;
     return peek().lexeme == keyword;
 }
 
-bool Parser::matchKeyword(const string& keyword) {
+bool Parser::matchKeyword(string_view keyword) {
     if (checkKeyword(keyword)) {
         advance();
         return true;
@@ -821,12 +912,12 @@ bool Parser::matchKeyword(const string& keyword) {
     return false;
 }
 
-Token Parser::consumeKeyword(const string& keyword) {
+Token Parser::consumeKeyword(string_view keyword) {
     if (checkKeyword(keyword)) return advance();
-    throw std::runtime_error("Parse error: expected keyword '" + keyword + "'" + " " + to_string(peek().line));
+    throw std::runtime_error("Parse error: expected keyword '" + string(keyword) + "'" + " " + to_string(peek().line));
 }
 
-Token Parser::consumeKeyword(const string& keyword, const string& message) {
+Token Parser::consumeKeyword(string_view keyword, const string& message) {
     if (checkKeyword(keyword)) return advance();
     throw std::runtime_error(message + " " + to_string(peek().line));
 }
@@ -11,25 +11,58 @@
 #include <stdio.h>
 #include <iostream>
 #include <cctype>
+#include <array>
+#include <string_view>
+#include "Scanner/Scanner.hpp"
 #include "Scanner/Token/Token.hpp"
 #include "Scanner/Token/TokenType.h"
 #include "Statements/Statements.hpp"
 #include "overloads/operators.h"
 #include "Scanner/keywords/keywords.h"
 
+// tokens kept by the parser; consumed ones stay reachable through
+// previous()/stepBack() until the window wraps around
+constexpr int TOKEN_WINDOW = 32;
+
+// cleared by `--eager`: engines that compile function bodies on first call
+// then parse and compile everything up front
+extern bool defer_function_bodies;
+
 class Parser {
+    // null when parsing a ready-made token vector
+    Scanner* scanner = nullptr;
     vector<Token> tokens;
+    size_t nextToken = 0;
+    // the most recent tokens of the stream; current and pulled count tokens
+    // from its start
+    array<Token, TOKEN_WINDOW> window;
     int current = 0;
+    int pulled = 0;
+    
+    void pull();
+    
+    shared_ptr<string> deferredSource;
+    // nesting of the statement being parsed; 1 at the top level
+    int statementDepth = 0;
 
 public:
-    Parser(vector<Token> tokens) : tokens(tokens) {};
+    Parser(vector<Token> tokens) : tokens(std::move(tokens)) {};
+    // pulls tokens from scanner while parsing instead of scanning the whole
+    // source up front
+    Parser(Scanner& scanner) : scanner(&scanner) {};
     vector<unique_ptr<Statement>> parse();
+    // pre-parse mode: bodies of top-level function declarations are skipped
+    // and recorded as ranges of source, the string the scanner is reading
+    void deferFunctionBodies(shared_ptr<string> source) { deferredSource = std::move(source); }
+    // full parse of a function skipped in pre-parse mode
+    static unique_ptr<FunctionDeclaration> parseDeferred(const string& id, const DeferredFunction& deferred);
     vector<unique_ptr<Statement>> statements;
     string sourceFile;
 
 private:
     
     unique_ptr<Statement> parseStatement();
+    unique_ptr<Statement> parseStatementKind();
     unique_ptr<Statement> parseEmptyStatement();
     unique_ptr<Statement> parseBlockStatement(bool standalone = false);
     unique_ptr<Statement> parseIfStatement();
@@ -51,6 +84,8 @@ private:
     unique_ptr<Statement> parseContinueStatement();
     unique_ptr<Statement> parseVariableStatement();
     unique_ptr<Statement> parseFunctionDeclaration();
+    unique_ptr<FunctionDeclaration> parseFunctionRest(const string& id, bool defer);
+    void skipFunctionBody();
     unique_ptr<Statement> parseClassDeclaration();
     unique_ptr<Statement> parseImportDeclaration();
     unique_ptr<Statement> parseEnumStatement();
@@ -75,33 +110,50 @@ private:
     Token consume(TokenType type, const string& message);
     void stepBack(int steps);
     
-    Token consumeKeyword(const string& keyword);
-    Token consumeKeyword(const string& keyword, const string& message);
-    bool checkKeyword(const string& keyword);
-    bool matchKeyword(const string& keyword);
+    Token consumeKeyword(string_view keyword);
+    Token consumeKeyword(string_view keyword, const string& message);
+    bool checkKeyword(string_view keyword);
+    bool matchKeyword(string_view keyword);
 
-    bool check(TokenType type);
-    Token advance();
-    Token peek();
-    Token previous();
-    bool isAtEnd();
+    bool check(TokenType type) {
+        return !isAtEnd() && peek().type == type;
+    }
+    
+    const Token& advance();
+    // keywords are valid property names after '.', e.g. Buffer.from
+    Token keywordAsName();
+    
+    const Token& peek() {
+        if (current == pulled) pull();
+        return window[current & (TOKEN_WINDOW - 1)];
+    }
+    
+    const Token& previous() {
+        return window[(current - 1) & (TOKEN_WINDOW - 1)];
+    }
+    
+    bool isAtEnd() {
+        return peek().type == TokenType::END_OF_FILE;
+    }
 
     unique_ptr<Expression> parseExpression() {
         return parseComma();
     }
 
     unique_ptr<Expression> parseComma() {
+        auto first = parseAssignment();
+
+        if (!check(TokenType::COMMA)) {
+            return first;
+        }
+
         vector<unique_ptr<Expression>> exprs;
-        exprs.push_back(parseAssignment());
+        exprs.push_back(std::move(first));
 
         while (match(TokenType::COMMA)) {
             exprs.push_back(parseAssignment());
         }
 
-        if (exprs.size() == 1) {
-            return std::move(exprs[0]);
-        }
-
         return make_unique<SequenceExpression>(std::move(exprs));
     }
 
@@ -374,7 +426,7 @@ private:
                 consume(TokenType::RIGHT_PARENTHESIS, "Expected ')' after arguments");
                 expr = make_unique<CallExpression>(std::move(expr), std::move(args));
             } else if (match(TokenType::DOT)) {
-                Token name = consume(TokenType::IDENTIFIER, "Expected property name after '.'");
+                Token name = check(TokenType::KEYWORD) ? keywordAsName() : consume(TokenType::IDENTIFIER, "Expected property name after '.'");
                 expr = make_unique<MemberExpression>(std::move(expr), name, false);
             } else if (match(TokenType::LEFT_SQUARE_BRACKET)) {
                 auto property = parseExpression();
@@ -575,9 +627,9 @@ private:
         
         auto expr = parseExpression();
         
-        if (ArrowFunction* arrow_expr = dynamic_cast<ArrowFunction*>(expr.get())) {
+        if (ArrowFunction* arrow_expr = node_cast<ArrowFunction>(expr.get())) {
             arrow_expr->is_async = true;
-        } else if (auto function_expr = dynamic_cast<FunctionExpression*>(expr.get())) {
+        } else if (auto function_expr = node_cast<FunctionExpression>(expr.get())) {
             function_expr->is_async = true;
         } else {
             throw runtime_error("Async can only be applied on a function.");
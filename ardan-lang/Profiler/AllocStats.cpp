@@ -0,0 +1,84 @@
+//
+//  AllocStats.cpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#include "AllocStats.hpp"
+#include "Profiler.hpp"
+
+#include <cstdlib>
+#include <climits>
+#include <new>
+
+static thread_local uint64_t alloc_count = 0;
+static thread_local uint64_t alloc_bytes = 0;
+
+// bytes left before the next sample; never reached while sampling is off
+static thread_local int64_t sample_left = LLONG_MAX;
+static thread_local uint64_t sample_interval = 0;
+static thread_local uint64_t sampled_bytes = 0;
+
+uint64_t AllocStats::count() {
+    return alloc_count;
+}
+
+uint64_t AllocStats::bytes() {
+    return alloc_bytes;
+}
+
+void AllocStats::sampleEvery(uint64_t interval) {
+    sample_interval = interval;
+    sample_left = interval > 0 ? (int64_t)interval : LLONG_MAX;
+    sampled_bytes = 0;
+}
+
+uint64_t AllocStats::takeSampledBytes() {
+    uint64_t bytes = sampled_bytes;
+    sampled_bytes = 0;
+    return bytes;
+}
+
+// every interval crossed is one sample of interval bytes, so a large
+// allocation is charged for all of its size
+static void takeAllocationSample() {
+
+    if (sample_interval == 0) {
+        sample_left = LLONG_MAX;
+        return;
+    }
+
+    while (sample_left <= 0) {
+        sampled_bytes += sample_interval;
+        sample_left += (int64_t)sample_interval;
+    }
+
+    Profiler::sample_pending = 1;
+
+}
+
+// replaces the global allocation functions; the nothrow and array forms
+// forward to these by default
+void* operator new(size_t size) {
+
+    alloc_count++;
+    alloc_bytes += size;
+
+    sample_left -= (int64_t)size;
+    if (sample_left <= 0) takeAllocationSample();
+
+    void* ptr = malloc(size > 0 ? size : 1);
+    if (ptr == nullptr) throw std::bad_alloc();
+
+    return ptr;
+
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
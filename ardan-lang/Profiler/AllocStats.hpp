@@ -0,0 +1,29 @@
+//
+//  AllocStats.hpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#ifndef AllocStats_hpp
+#define AllocStats_hpp
+
+#include <stdio.h>
+#include <cstdint>
+
+// Counts operator new calls made by the calling thread. The counters are
+// thread-local so counting costs one increment per allocation; the VMs run
+// scripts on the main thread, which is what --stats reports.
+struct AllocStats {
+    static uint64_t count();
+    static uint64_t bytes();
+
+    // samples one allocation in every `interval` bytes this thread
+    // allocates (0 stops). Each sample raises Profiler::sample_pending so
+    // the VM charges its current stack.
+    static void sampleEvery(uint64_t interval);
+    // bytes the samples taken since the last call stand for
+    static uint64_t takeSampledBytes();
+};
+
+#endif /* AllocStats_hpp */
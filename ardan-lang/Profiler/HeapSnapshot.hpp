@@ -0,0 +1,103 @@
+//
+//  HeapSnapshot.hpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 19/10/2026.
+//
+
+#ifndef HeapSnapshot_hpp
+#define HeapSnapshot_hpp
+
+#include <stdio.h>
+#include <csignal>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <iostream>
+
+#include "Interpreter/ExecutionContext/Value/Value.h"
+
+using namespace std;
+
+class Env;
+class BaseVM;
+
+// The graph of script objects reachable from a VM's roots: objects,
+// arrays, typed arrays and their bytes, closures and the boxes and scopes
+// they capture, promises and classes. Strings are charged to whatever
+// holds them; native functions are opaque.
+//
+// Sizes are estimates from the C++ layout of each object. A node's
+// retained size is what would be freed with it: its own size plus that of
+// everything only reachable through it (its dominator subtree).
+//
+// write() saves the graph in the .heapsnapshot format Chrome DevTools and
+// memlab load, and prints a summary on stderr: counts and sizes per type,
+// and the nodes retaining the most with the shortest path from a root.
+class HeapSnapshot {
+
+public:
+    // raised by SIGUSR2 (see listen); the VM takes a snapshot before its
+    // next instruction
+    static volatile sig_atomic_t requested;
+    // path prefix of the snapshot files
+    static string output;
+
+    // take a snapshot whenever the process gets SIGUSR2
+    static void listen();
+
+    // snapshots vm and writes it; the first file is <output>.heapsnapshot,
+    // later ones <output>-2.heapsnapshot and on
+    static void take(BaseVM& vm);
+
+    void addRoot(const string& name, const Value& value);
+    void addRoot(const string& name, Env* env);
+
+    void write(const string& path) const;
+
+private:
+    enum class Kind { Root, Object, Array, TypedArray, Bytes, Closure, Box, Scope, Promise, Class };
+
+    enum class EdgeKind { Context, Element, Property, Internal };
+
+    struct Edge {
+        EdgeKind kind;
+        string name;
+        size_t to;
+    };
+
+    struct Node {
+        Kind kind;
+        string name;
+        size_t self_size;
+        const void* address;
+        vector<Edge> edges;
+    };
+
+    vector<Node> nodes = { { Kind::Root, "(root)", 0, nullptr, {} } };
+    unordered_map<const void*, size_t> indexOf;
+    // nodes added but not yet expanded
+    vector<size_t> pending;
+
+    size_t node(Kind kind, const void* address, const string& name, size_t self_size);
+    void edge(size_t from, EdgeKind kind, const string& name, const Value& value);
+    void edge(size_t from, EdgeKind kind, const string& name, size_t to);
+    size_t scope(Env* env);
+    size_t box(const shared_ptr<Value>& box);
+    void expand(size_t index);
+    void walk();
+
+    static const char* kindName(Kind kind);
+
+    // immediate dominator of every node, root first
+    vector<size_t> dominators() const;
+    vector<size_t> retainedSizes(const vector<size_t>& idom) const;
+    string retainerPath(size_t target, const vector<size_t>& parent, const vector<const Edge*>& via) const;
+
+    void writeJSON(const string& path) const;
+    void printSummary(const string& path) const;
+
+};
+
+#endif /* HeapSnapshot_hpp */
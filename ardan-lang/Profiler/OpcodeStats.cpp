@@ -0,0 +1,154 @@
+//
+//  OpcodeStats.cpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#include "OpcodeStats.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+#include "engines/Nova/TurboBytecode.hpp"
+#include "Turbine/Turbine.hpp"
+
+static const size_t TOP_PAIRS = 20;
+
+static const char* turboName(uint8_t op) {
+    return turboOpCodeName(static_cast<TurboOpCode>(op));
+}
+
+static const char* turbineName(uint8_t op) {
+    return bytecodeName(static_cast<Bytecode>(op));
+}
+
+OpcodeStats& OpcodeStats::nova() {
+    static OpcodeStats stats("nova", turboName);
+    return stats;
+}
+
+OpcodeStats& OpcodeStats::peregrine() {
+    static OpcodeStats stats("peregrine", turboName);
+    return stats;
+}
+
+OpcodeStats& OpcodeStats::deathStar() {
+    static OpcodeStats stats("deathstar", turbineName);
+    return stats;
+}
+
+OpcodeStats::OpcodeStats(string engine, NameFn name)
+: engine(engine), name(name), pairs(256 * 256, 0) {}
+
+OpcodeStats::~OpcodeStats() {
+
+    if (total() == 0) return;
+
+    writeTable(cerr);
+    writeJson(engine + ".opstats.json");
+
+}
+
+uint64_t OpcodeStats::total() const {
+    uint64_t sum = 0;
+    for (uint64_t count : counts) sum += count;
+    return sum;
+}
+
+struct PairCount {
+    uint8_t first;
+    uint8_t second;
+    uint64_t count;
+};
+
+static vector<PairCount> sortedPairs(const vector<uint64_t>& pairs) {
+
+    vector<PairCount> result;
+
+    for (size_t i = 0; i < pairs.size(); i++) {
+        if (pairs[i] == 0) continue;
+        result.push_back({ (uint8_t)(i / 256), (uint8_t)(i % 256), pairs[i] });
+    }
+
+    sort(result.begin(), result.end(), [](const PairCount& a, const PairCount& b) {
+        return a.count > b.count;
+    });
+
+    return result;
+
+}
+
+void OpcodeStats::writeTable(ostream& out) const {
+
+    vector<uint8_t> ops;
+    for (int op = 0; op < 256; op++) {
+        if (counts[op] > 0) ops.push_back((uint8_t)op);
+    }
+
+    sort(ops.begin(), ops.end(), [this](uint8_t a, uint8_t b) {
+        return counts[a] > counts[b];
+    });
+
+    uint64_t executed = total();
+
+    out << "== opcode stats (" << engine << "): " << executed << " instructions ==\n";
+    out << left << setw(24) << "opcode" << right
+        << setw(14) << "count" << setw(8) << "%"
+        << setw(16) << "ticks" << setw(12) << "ticks/op" << "\n";
+
+    for (uint8_t op : ops) {
+        out << left << setw(24) << name(op) << right
+            << setw(14) << counts[op]
+            << setw(8) << fixed << setprecision(2) << (100.0 * counts[op] / executed)
+            << setw(16) << elapsed[op]
+            << setw(12) << setprecision(1) << ((double)elapsed[op] / counts[op]) << "\n";
+    }
+
+    out << "== top opcode pairs ==\n";
+
+    vector<PairCount> top = sortedPairs(pairs);
+    if (top.size() > TOP_PAIRS) top.resize(TOP_PAIRS);
+
+    for (const auto& pair : top) {
+        string label = string(name(pair.first)) + " -> " + name(pair.second);
+        out << left << setw(46) << label << right << setw(14) << pair.count << "\n";
+    }
+
+    out.unsetf(ios::floatfield);
+
+}
+
+void OpcodeStats::writeJson(const string& path) const {
+
+    ofstream out(path);
+    if (!out) return;
+
+    out << "{\n  \"engine\": \"" << engine << "\",\n";
+    out << "  \"instructions\": " << total() << ",\n";
+    out << "  \"opcodes\": [";
+
+    bool first = true;
+    for (int op = 0; op < 256; op++) {
+        if (counts[op] == 0) continue;
+        out << (first ? "\n" : ",\n")
+            << "    { \"name\": \"" << name((uint8_t)op) << "\", \"count\": " << counts[op]
+            << ", \"ticks\": " << elapsed[op] << " }";
+        first = false;
+    }
+
+    out << "\n  ],\n  \"pairs\": [";
+
+    first = true;
+    for (const auto& pair : sortedPairs(pairs)) {
+        out << (first ? "\n" : ",\n")
+            << "    { \"first\": \"" << name(pair.first) << "\", \"second\": \"" << name(pair.second)
+            << "\", \"count\": " << pair.count << " }";
+        first = false;
+    }
+
+    out << "\n  ]\n}\n";
+
+}
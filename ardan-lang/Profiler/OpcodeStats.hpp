@@ -0,0 +1,86 @@
+//
+//  OpcodeStats.hpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#ifndef OpcodeStats_hpp
+#define OpcodeStats_hpp
+
+#include <stdio.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <chrono>
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+using namespace std;
+
+// Per-opcode execution counts, time per opcode and opcode-pair (bigram)
+// counts for one instruction set. The VMs only call dispatch() when built
+// with ARDAN_OPCODE_STATS, so a normal build carries no cost. Each instance
+// prints a table to stderr and writes <engine>.opstats.json at exit.
+class OpcodeStats {
+
+public:
+    using NameFn = const char* (*)(uint8_t);
+
+    static OpcodeStats& nova();
+    static OpcodeStats& peregrine();
+    static OpcodeStats& deathStar();
+
+    ~OpcodeStats();
+
+    // called once per instruction, before it runs. time since the previous
+    // dispatch is charged to the previous opcode.
+    inline void dispatch(uint8_t op) {
+        uint64_t now = ticks();
+        if (last >= 0) {
+            elapsed[last] += now - last_start;
+            pairs[(size_t)last * 256 + op]++;
+        }
+        counts[op]++;
+        last = op;
+        last_start = now;
+    }
+
+    void writeTable(ostream& out) const;
+    void writeJson(const string& path) const;
+
+private:
+    OpcodeStats(string engine, NameFn name);
+
+    string engine;
+    NameFn name;
+
+    uint64_t counts[256] = {};
+    uint64_t elapsed[256] = {};
+    vector<uint64_t> pairs;
+
+    int last = -1;
+    uint64_t last_start = 0;
+
+    uint64_t total() const;
+
+    // cycle counter on x86, the virtual timer on arm64
+    static inline uint64_t ticks() {
+#if defined(__x86_64__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t value;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+        return value;
+#else
+        return chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+};
+
+#endif /* OpcodeStats_hpp */
@@ -0,0 +1,263 @@
+//
+//  Profiler.cpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#include "Profiler.hpp"
+#include "AllocStats.hpp"
+
+#include <sys/time.h>
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+volatile sig_atomic_t Profiler::sample_pending = 0;
+volatile sig_atomic_t Profiler::tick_pending = 0;
+
+static void onProfileTick(int) {
+    Profiler::tick_pending = 1;
+    Profiler::sample_pending = 1;
+}
+
+static int64_t nowNanos() {
+    return chrono::duration_cast<chrono::nanoseconds>(
+        chrono::system_clock::now().time_since_epoch()).count();
+}
+
+Profiler& Profiler::getInstance() {
+    static Profiler instance;
+    return instance;
+}
+
+// setitimer rather than timer_create: the latter is not available on macOS.
+// ITIMER_PROF counts CPU time, so a script blocked in the event loop is not
+// sampled.
+void Profiler::start(int interval) {
+
+    if (running) return;
+
+    interval_us = interval > 0 ? interval : 1000;
+
+    struct sigaction action = {};
+    action.sa_handler = onProfileTick;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+
+    if (sigaction(SIGPROF, &action, nullptr) == -1) {
+        throw runtime_error("Profiler: could not install SIGPROF handler");
+    }
+
+    struct itimerval timer = {};
+    timer.it_interval.tv_sec = interval_us / 1000000;
+    timer.it_interval.tv_usec = interval_us % 1000000;
+    timer.it_value = timer.it_interval;
+
+    if (setitimer(ITIMER_PROF, &timer, nullptr) == -1) {
+        throw runtime_error("Profiler: could not start the profiling timer");
+    }
+
+    start_nanos = nowNanos();
+    running = true;
+
+}
+
+void Profiler::stop() {
+
+    if (!running) return;
+
+    struct itimerval timer = {};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    signal(SIGPROF, SIG_IGN);
+
+    tick_pending = 0;
+    duration_nanos = nowNanos() - start_nanos;
+    running = false;
+
+}
+
+void Profiler::record(const vector<Frame>& stack) {
+
+    bool tick = tick_pending && running;
+    tick_pending = 0;
+    sample_pending = 0;
+
+    uint64_t allocated = AllocStats::takeSampledBytes();
+
+    if ((!tick && allocated == 0) || stack.empty()) return;
+
+    // parallel array workers sample their own stacks
+    lock_guard<mutex> lock(record_mutex);
+
+    if (tick) {
+        stacks[stack]++;
+        total_samples++;
+    }
+
+    if (allocated > 0) {
+        allocations[stack] += allocated;
+        total_allocated += allocated;
+    }
+
+}
+
+string Profiler::label(const Frame& frame) {
+
+    string name = frame.function.empty() ? "(anonymous)" : frame.function;
+    if (frame.line == 0) return name;
+
+    return name + ":" + to_string(frame.line);
+
+}
+
+void Profiler::writeCollapsed(const string& path) const {
+    writeStacks(path, stacks);
+}
+
+void Profiler::writeAllocations(const string& path) const {
+    writeStacks(path, allocations);
+}
+
+void Profiler::writeStacks(const string& path, const map<vector<Frame>, uint64_t>& stacks) {
+
+    ofstream out(path);
+    if (!out) {
+        throw runtime_error("Profiler: could not write " + path);
+    }
+
+    for (const auto& [stack, count] : stacks) {
+        for (size_t i = 0; i < stack.size(); i++) {
+            if (i > 0) out << ';';
+            out << label(stack[i]);
+        }
+        out << ' ' << count << '\n';
+    }
+
+}
+
+// minimal protobuf encoding, enough for profile.proto
+
+static void putVarint(string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += (char)((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += (char)value;
+}
+
+static void putUint(string& out, int field, uint64_t value) {
+    putVarint(out, (uint64_t)field << 3);
+    putVarint(out, value);
+}
+
+static void putBytes(string& out, int field, const string& bytes) {
+    putVarint(out, ((uint64_t)field << 3) | 2);
+    putVarint(out, bytes.size());
+    out += bytes;
+}
+
+static void putPacked(string& out, int field, const vector<uint64_t>& values) {
+    string packed;
+    for (uint64_t v : values) putVarint(packed, v);
+    putBytes(out, field, packed);
+}
+
+void Profiler::writePprof(const string& path) const {
+
+    vector<string> strings = { "" };
+    unordered_map<string, uint64_t> string_ids;
+
+    auto intern = [&](const string& s) -> uint64_t {
+        auto it = string_ids.find(s);
+        if (it != string_ids.end()) return it->second;
+        strings.push_back(s);
+        return string_ids[s] = strings.size() - 1;
+    };
+
+    auto valueType = [&](const string& type, const string& unit) {
+        string message;
+        putUint(message, 1, intern(type));
+        putUint(message, 2, intern(unit));
+        return message;
+    };
+
+    string profile;
+    int64_t period = (int64_t)interval_us * 1000;
+
+    // Profile.sample_type
+    putBytes(profile, 1, valueType("samples", "count"));
+    putBytes(profile, 1, valueType("cpu", "nanoseconds"));
+
+    map<string, uint64_t> function_ids;
+    map<Frame, uint64_t> location_ids;
+    string functions;
+    string locations;
+
+    for (const auto& [stack, count] : stacks) {
+
+        vector<uint64_t> location_list;
+
+        // pprof wants the leaf first
+        for (auto frame = stack.rbegin(); frame != stack.rend(); ++frame) {
+
+            string name = frame->function.empty() ? "(anonymous)" : frame->function;
+
+            if (!function_ids.count(name)) {
+                uint64_t id = function_ids.size() + 1;
+                function_ids[name] = id;
+
+                string function;
+                putUint(function, 1, id);
+                putUint(function, 2, intern(name));
+                putUint(function, 3, intern(name));
+                putUint(function, 4, intern(script));
+                putBytes(functions, 5, function);
+            }
+
+            if (!location_ids.count(*frame)) {
+                uint64_t id = location_ids.size() + 1;
+                location_ids[*frame] = id;
+
+                string line;
+                putUint(line, 1, function_ids[name]);
+                putUint(line, 2, frame->line);
+
+                string location;
+                putUint(location, 1, id);
+                putBytes(location, 4, line);
+                putBytes(locations, 4, location);
+            }
+
+            location_list.push_back(location_ids[*frame]);
+        }
+
+        string sample;
+        putPacked(sample, 1, location_list);
+        putPacked(sample, 2, { count, count * (uint64_t)period });
+        putBytes(profile, 2, sample);
+
+    }
+
+    profile += locations;
+    profile += functions;
+
+    string period_type = valueType("cpu", "nanoseconds");
+
+    for (const auto& s : strings) {
+        putBytes(profile, 6, s);
+    }
+
+    putUint(profile, 9, (uint64_t)start_nanos);
+    putUint(profile, 10, (uint64_t)duration_nanos);
+    putBytes(profile, 11, period_type);
+    putUint(profile, 12, (uint64_t)period);
+
+    ofstream out(path, ios::binary);
+    if (!out) {
+        throw runtime_error("Profiler: could not write " + path);
+    }
+    out.write(profile.data(), profile.size());
+
+}
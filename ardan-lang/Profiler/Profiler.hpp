@@ -0,0 +1,89 @@
+//
+//  Profiler.hpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#ifndef Profiler_hpp
+#define Profiler_hpp
+
+#include <stdio.h>
+#include <csignal>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+
+using namespace std;
+
+// Sampling CPU and allocation profiler for the register VMs.
+//
+// A SIGPROF timer only raises sample_pending; the VM notices it before its
+// next instruction and calls record() with its call stack, so the stack is
+// never read while it is being modified. With allocation sampling on (see
+// AllocStats::sampleEvery), operator new raises it the same way and the
+// stack is charged with the bytes the sample stands for.
+class Profiler {
+
+public:
+    struct Frame {
+        string function;
+        uint32_t line;
+
+        bool operator<(const Frame& other) const {
+            if (function != other.function) return function < other.function;
+            return line < other.line;
+        }
+    };
+
+    // the VM should call record()
+    static volatile sig_atomic_t sample_pending;
+    // the CPU timer fired since the last record()
+    static volatile sig_atomic_t tick_pending;
+
+    static Profiler& getInstance();
+
+    string script = "";
+
+    void start(int interval_us = 1000);
+    void stop();
+    bool isRunning() const { return running; }
+
+    // stack is ordered outermost frame first
+    void record(const vector<Frame>& stack);
+
+    size_t sampleCount() const { return total_samples; }
+    uint64_t allocatedBytes() const { return total_allocated; }
+
+    // one "outer;inner count" line per stack, for flamegraph.pl / speedscope
+    void writeCollapsed(const string& path) const;
+
+    // the same with sampled bytes allocated in place of counts
+    void writeAllocations(const string& path) const;
+
+    // uncompressed profile.proto, readable by `go tool pprof`
+    void writePprof(const string& path) const;
+
+private:
+    Profiler() = default;
+
+    bool running = false;
+    int interval_us = 1000;
+    int64_t start_nanos = 0;
+    int64_t duration_nanos = 0;
+
+    mutex record_mutex;
+    map<vector<Frame>, uint64_t> stacks;
+    uint64_t total_samples = 0;
+
+    map<vector<Frame>, uint64_t> allocations;
+    uint64_t total_allocated = 0;
+
+    static string label(const Frame& frame);
+    static void writeStacks(const string& path, const map<vector<Frame>, uint64_t>& stacks);
+
+};
+
+#endif /* Profiler_hpp */
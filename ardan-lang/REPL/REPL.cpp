@@ -67,10 +67,8 @@ void REPL::start_repl() {
 bool REPL::evalLine(string& line, string& result) {
     
     Scanner scanner(line);
-    
-    auto tokens = scanner.getTokens();
 
-    Parser parser(tokens);
+    Parser parser(scanner);
     auto ast = parser.parse();
 
     interpreter->execute(std::move(ast));
@@ -81,445 +81,468 @@ namespace chars {
 
 vector<Token>& Scanner::getTokens() {
     
-    while(current < source.length()) {
+    while (current < source.length()) {
+        scanToken();
+    }
+    
+    addToken(TokenType::END_OF_FILE);
+    
+    return tokens;
+    
+}
 
-        char& character = currentCharacter();
+Token Scanner::nextToken() {
+    
+    // tokens only buffers what the last scanToken() produced
+    while (next == tokens.size()) {
+        
+        tokens.clear();
+        next = 0;
         
-        switch (character) {
+        if (current < source.length()) {
+            scanToken();
+        } else {
+            addToken(TokenType::END_OF_FILE);
+        }
+        
+    }
+    
+    return std::move(tokens[next++]);
+    
+}
 
-            case chars::COMMA:
-                addToken(TokenType::COMMA, ",");
-                break;
-                
-            case chars::DOT:
+void Scanner::scanToken() {
+
+    tokenStart = current;
+    char& character = currentCharacter();
+    
+    switch (character) {
+
+        case chars::COMMA:
+            addToken(TokenType::COMMA, ",");
+            break;
+            
+        case chars::DOT:
+            
+            if (match('.')) {
                 
                 if (match('.')) {
                     
-                    if (match('.')) {
-                        
-                        addToken(TokenType::SPREAD);
-                        break;
-                        
-                    }
+                    addToken(TokenType::SPREAD);
+                    break;
                     
                 }
                 
-                addToken(TokenType::DOT);
-                break;
-                
-            case ':':
-                
-                addToken(TokenType::COLON);
-                break;
+            }
+            
+            addToken(TokenType::DOT);
+            break;
+            
+        case ':':
+            
+            addToken(TokenType::COLON);
+            break;
 
-            case '(':
-                addToken(TokenType::LEFT_PARENTHESIS);
-                break;
+        case '(':
+            addToken(TokenType::LEFT_PARENTHESIS);
+            break;
 
-            case ')':
-                addToken(TokenType::RIGHT_PARENTHESIS);
-                break;
+        case ')':
+            addToken(TokenType::RIGHT_PARENTHESIS);
+            break;
 
-            case '{':
-                addToken(TokenType::LEFT_BRACKET);
-                break;
+        case '{':
+            addToken(TokenType::LEFT_BRACKET);
+            break;
 
-            case '}':
-                addToken(TokenType::RIGHT_BRACKET);
-                break;
-                
-            case '[':
-                
-                addToken(TokenType::LEFT_SQUARE_BRACKET);
-                break;
-                
-            case ']':
-                
-                addToken(TokenType::RIGHT_SQUARE_BRACKET);
-                break;
+        case '}':
+            addToken(TokenType::RIGHT_BRACKET);
+            break;
+            
+        case '[':
+            
+            addToken(TokenType::LEFT_SQUARE_BRACKET);
+            break;
+            
+        case ']':
+            
+            addToken(TokenType::RIGHT_SQUARE_BRACKET);
+            break;
 
-            case '=':
+        case '=':
+            
+            if (match('=')) {
                 
                 if (match('=')) {
                     
-                    if (match('=')) {
-                        
-                        addToken(TokenType::REFERENCE_EQUAL, "===");
-                        break;
-                        
-                    }
-                    
-                    addToken(TokenType::VALUE_EQUAL, "==");
+                    addToken(TokenType::REFERENCE_EQUAL, "===");
                     break;
                     
                 }
                 
-                if (match('>')) {
-                    addToken(TokenType::ARROW, "=>");
-                    break;
-                }
+                addToken(TokenType::VALUE_EQUAL, "==");
+                break;
                 
-                addToken(TokenType::ASSIGN, "=");
+            }
+            
+            if (match('>')) {
+                addToken(TokenType::ARROW, "=>");
                 break;
+            }
+            
+            addToken(TokenType::ASSIGN, "=");
+            break;
 
-            case '-':
-                
-                if (match('-')) {
-                    
-                    addToken(TokenType::DECREMENT, "--");
-                    break;
-                    
-                }
+        case '-':
+            
+            if (match('-')) {
                 
-                if (match('=')) {
-                    
-                    addToken(TokenType::ASSIGN_MINUS, "-=");
-                    break;
-                    
-                }
+                addToken(TokenType::DECREMENT, "--");
+                break;
                 
-                addToken(TokenType::MINUS);
+            }
+            
+            if (match('=')) {
                 
+                addToken(TokenType::ASSIGN_MINUS, "-=");
                 break;
                 
-            case ';':
-                addToken(TokenType::SEMI_COLON);
-                break;
+            }
+            
+            addToken(TokenType::MINUS);
+            
+            break;
+            
+        case ';':
+            addToken(TokenType::SEMI_COLON);
+            break;
 
-            case '*':
-                
-                if (match('*')) {
-                    
-                    if (match('=')) {
-                        addToken(TokenType::POWER_ASSIGN);
-                        break;
-                    }
-                    
-                    addToken(TokenType::POWER);
-                    break;
-                }
+        case '*':
+            
+            if (match('*')) {
                 
                 if (match('=')) {
-                    addToken(TokenType::ASSIGN_MUL);
+                    addToken(TokenType::POWER_ASSIGN);
                     break;
                 }
                 
-                addToken(TokenType::MUL);
+                addToken(TokenType::POWER);
                 break;
+            }
+            
+            if (match('=')) {
+                addToken(TokenType::ASSIGN_MUL);
+                break;
+            }
+            
+            addToken(TokenType::MUL);
+            break;
 
-            case '/':
-                
+        case '/':
+            
+            if (match('*')) {
                 if (match('*')) {
-                    if (match('*')) {
-                        // we are in a multi-line comment
-                        
-                        consumeMultilineComment();
-                        break;
-                        
-                    }
+                    // we are in a multi-line comment
                     
                     consumeMultilineComment();
                     break;
                     
                 }
-
-                if (match('/')) {
-    
-                    // we have a comment.
-                    // loop till we hit /n
-                    consumeComment();
-                    break;
-                    
-                }
-                
-                if (match('=')) {
-                    addToken(TokenType::ASSIGN_DIV, "/=");
-                    break;
-                }
                 
-                addToken(TokenType::DIV, "/");
+                consumeMultilineComment();
                 break;
-
-            case '+':
-                
-                if (match('+')) {
-                    addToken(TokenType::INCREMENT, "++");
-                    break;
-                }
-                
-                if (match('=')) {
-                    addToken(TokenType::ASSIGN_ADD, "+=");
-                    break;
-                }
                 
-                addToken(TokenType::ADD, "+");
+            }
+
+            if (match('/')) {
+
+                // we have a comment.
+                // loop till we hit /n
+                consumeComment();
                 break;
                 
-            case '%':
+            }
+            
+            if (match('=')) {
+                addToken(TokenType::ASSIGN_DIV, "/=");
+                break;
+            }
+            
+            addToken(TokenType::DIV, "/");
+            break;
 
-                if(match('=')) {
-                    
-                    addToken(TokenType::MODULI_ASSIGN, "%=");
-                    break;
-                    
-                }
-                
-                addToken(TokenType::MODULI, "%");
+        case '+':
+            
+            if (match('+')) {
+                addToken(TokenType::INCREMENT, "++");
+                break;
+            }
+            
+            if (match('=')) {
+                addToken(TokenType::ASSIGN_ADD, "+=");
                 break;
+            }
+            
+            addToken(TokenType::ADD, "+");
+            break;
+            
+        case '%':
+
+            if(match('=')) {
                 
-            case '<':
+                addToken(TokenType::MODULI_ASSIGN, "%=");
+                break;
                 
-                if(match('<')) {
-                    
-                    if(match('=')) {
-                        
-                        addToken(TokenType::BITWISE_LEFT_SHIFT_ASSIGN);
-                        break;
-                        
-                    }
-                    
-                    addToken(TokenType::BITWISE_LEFT_SHIFT);
-                    break;
-                    
-                }
+            }
+            
+            addToken(TokenType::MODULI, "%");
+            break;
+            
+        case '<':
+            
+            if(match('<')) {
                 
                 if(match('=')) {
                     
-                    addToken(TokenType::LESS_THAN_EQUAL);
+                    addToken(TokenType::BITWISE_LEFT_SHIFT_ASSIGN);
                     break;
                     
                 }
                 
-                addToken(TokenType::LESS_THAN);
+                addToken(TokenType::BITWISE_LEFT_SHIFT);
                 break;
-
-            case '>':
                 
-                if(match('>')) {
+            }
+            
+            if(match('=')) {
+                
+                addToken(TokenType::LESS_THAN_EQUAL);
+                break;
+                
+            }
+            
+            addToken(TokenType::LESS_THAN);
+            break;
 
-                    if(match('>')) {
+        case '>':
+            
+            if(match('>')) {
 
-                        if(match('=')) {
-                            
-                            addToken(TokenType::UNSIGNED_RIGHT_SHIFT_ASSIGN);
-                            break;
-                            
-                        }
+                if(match('>')) {
 
-                        addToken(TokenType::UNSIGNED_RIGHT_SHIFT);
-                        break;
-                        
-                    }
-                    
                     if(match('=')) {
                         
-                        addToken(TokenType::BITWISE_RIGHT_SHIFT_ASSIGN);
+                        addToken(TokenType::UNSIGNED_RIGHT_SHIFT_ASSIGN);
                         break;
                         
                     }
-                    
-                    addToken(TokenType::BITWISE_RIGHT_SHIFT);
+
+                    addToken(TokenType::UNSIGNED_RIGHT_SHIFT);
                     break;
                     
                 }
                 
                 if(match('=')) {
                     
-                    addToken(TokenType::GREATER_THAN_EQUAL, ">=");
+                    addToken(TokenType::BITWISE_RIGHT_SHIFT_ASSIGN);
                     break;
                     
                 }
                 
-                addToken(TokenType::GREATER_THAN, ">");
+                addToken(TokenType::BITWISE_RIGHT_SHIFT);
+                break;
+                
+            }
+            
+            if(match('=')) {
+                
+                addToken(TokenType::GREATER_THAN_EQUAL, ">=");
                 break;
+                
+            }
+            
+            addToken(TokenType::GREATER_THAN, ">");
+            break;
 
-            case '&':
+        case '&':
 
-                if(match('&')) {
-                    
-                    if(match('=')) {
-                        
-                        addToken(TokenType::LOGICAL_AND_ASSIGN, "&&=");
-                        break;
-                        
-                    }
-                    
-                    addToken(TokenType::LOGICAL_AND, "&&");
-                    break;
-                    
-                }
+            if(match('&')) {
                 
                 if(match('=')) {
                     
-                    addToken(TokenType::BITWISE_AND_ASSIGN, "&=");
+                    addToken(TokenType::LOGICAL_AND_ASSIGN, "&&=");
                     break;
                     
                 }
-
-                addToken(TokenType::BITWISE_AND, "&");
-                break;
-                
-            case '|':
                 
-                if (match('|')) {
-                    
-                    if (match('=')) {
-                        
-                        addToken(TokenType::LOGICAL_OR_ASSIGN, "||=");
-                        break;
-                        
-                    }
-                    
-                    addToken(TokenType::LOGICAL_OR, "||");
-                    break;
-                    
-                }
+                addToken(TokenType::LOGICAL_AND, "&&");
+                break;
                 
-                if (match('=')) {
-                    
-                    addToken(TokenType::BITWISE_OR_ASSIGN, "|=");
-                    break;
-                    
-                }
+            }
+            
+            if(match('=')) {
                 
-                addToken(TokenType::BITWISE_OR, "|");
+                addToken(TokenType::BITWISE_AND_ASSIGN, "&=");
                 break;
                 
-            case '!':
+            }
+
+            addToken(TokenType::BITWISE_AND, "&");
+            break;
+            
+        case '|':
+            
+            if (match('|')) {
                 
                 if (match('=')) {
                     
-                    if (match('=')) {
-                        
-                        addToken(TokenType::STRICT_INEQUALITY, "!==");
-                        break;
-                        
-                    }
-
-                    addToken(TokenType::INEQUALITY, "!=");
+                    addToken(TokenType::LOGICAL_OR_ASSIGN, "||=");
                     break;
                     
                 }
                 
-                addToken(TokenType::LOGICAL_NOT, "!");
+                addToken(TokenType::LOGICAL_OR, "||");
                 break;
                 
-            case '?':
+            }
+            
+            if (match('=')) {
                 
-                if (match('?')) {
-                    
-                    if (match('=')) {
-                        
-                        addToken(TokenType::NULLISH_COALESCING_ASSIGN, "??=");
-                        break;
-                        
-                    }
-                    
-                    addToken(TokenType::NULLISH_COALESCING, "??");
-                    break;
-                    
-                }
+                addToken(TokenType::BITWISE_OR_ASSIGN, "|=");
+                break;
                 
-                if (match('.')) {
+            }
+            
+            addToken(TokenType::BITWISE_OR, "|");
+            break;
+            
+        case '!':
+            
+            if (match('=')) {
+                
+                if (match('=')) {
                     
-                    addToken(TokenType::OPTIONAL_CHAINING, "?.");
+                    addToken(TokenType::STRICT_INEQUALITY, "!==");
                     break;
                     
                 }
-                
-                addToken(TokenType::TERNARY, "?");
-                break;
-                
-            case '~':
-                addToken(TokenType::BITWISE_NOT, "~");
+
+                addToken(TokenType::INEQUALITY, "!=");
                 break;
                 
-            case '^':
+            }
+            
+            addToken(TokenType::LOGICAL_NOT, "!");
+            break;
+            
+        case '?':
+            
+            if (match('?')) {
                 
                 if (match('=')) {
                     
-                    addToken(TokenType::BITWISE_XOR_ASSIGN, "^=");
+                    addToken(TokenType::NULLISH_COALESCING_ASSIGN, "??=");
                     break;
                     
                 }
                 
-                addToken(TokenType::BITWISE_XOR, "^");
+                addToken(TokenType::NULLISH_COALESCING, "??");
                 break;
                 
-            case '\t':
-            case ' ':
-            case '\r':
-                break;
+            }
+            
+            if (match('.')) {
                 
-            case '\n':
-                line++;
+                addToken(TokenType::OPTIONAL_CHAINING, "?.");
                 break;
-
-            case '\'':
                 
-                collectSingleQuoteString();
+            }
+            
+            addToken(TokenType::TERNARY, "?");
+            break;
+            
+        case '~':
+            addToken(TokenType::BITWISE_NOT, "~");
+            break;
+            
+        case '^':
+            
+            if (match('=')) {
                 
+                addToken(TokenType::BITWISE_XOR_ASSIGN, "^=");
                 break;
                 
-            case '"':
-                
-                collectString();
-                
-                break;
+            }
+            
+            addToken(TokenType::BITWISE_XOR, "^");
+            break;
+            
+        case '\t':
+        case ' ':
+        case '\r':
+            break;
+            
+        case '\n':
+            line++;
+            break;
 
-            case '`':
-                collectLiteralString();
-                current--;
-                break;
-                
-                // if token is @
-            case '@':
-                addToken(TokenType::AT, "@");
-                break;
+        case '\'':
+            
+            collectSingleQuoteString();
+            
+            break;
+            
+        case '"':
+            
+            collectString();
+            
+            break;
 
-            default:
-                
-                if (isDigit()) {
-                    
-                    // collect number
-                    collectNumber();
-                    break;
-                }
+        case '`':
+            collectLiteralString();
+            current--;
+            break;
+            
+            // if token is @
+        case '@':
+            addToken(TokenType::AT, "@");
+            break;
+
+        default:
+            
+            if (isDigit()) {
                 
-                if (isAlpha()) {
-                    
-                    // collect identifier
-                    collectIdentifier();
-                    break;
-                    
-                }
+                // collect number
+                collectNumber();
+                break;
+            }
+            
+            if (isAlpha()) {
                 
+                // collect identifier
+                collectIdentifier();
                 break;
-        }
-        
-        advance();
-
+                
+            }
+            
+            break;
     }
     
-    addToken(TokenType::END_OF_FILE);
-    
-    return tokens;
-    
+    advance();
+
 }
 
 void Scanner::collectSingleQuoteString() {
     
     advance();
     
-    string concat = "";
+    size_t start = current;
         
     while (currentCharacter() != '\'' && !eof()) {
-        concat += currentCharacter();
         advance();
     }
     
-    addToken(TokenType::STRING, concat);
-    concat = "";
+    addToken(TokenType::STRING, slice(start));
 
 }
 
@@ -527,15 +550,13 @@ void Scanner::collectString() {
     
     advance();
     
-    string concat = "";
+    size_t start = current;
     
     while (currentCharacter() != '"' && !eof()) {
-        concat += currentCharacter();
         advance();
     }
     
-    addToken(TokenType::STRING, concat);
-    concat = "";
+    addToken(TokenType::STRING, slice(start));
 
 }
 
@@ -701,6 +722,7 @@ void Scanner::collectLiteralString() {
             continue;
         }
         
+        if (c == '\n') line++;
         chunk += c;
         advance();
     }
@@ -755,31 +777,28 @@ void Scanner::collectNumber() {
     }
 
     // we parse decimals and float
+    size_t start = current;
     bool hasDot = false;
     while ((isDigit() || currentCharacter() == '.')  && !eof()) {
         if (currentCharacter() == '.') {
             if (hasDot) break;
             hasDot = true;
         }
-        num += currentCharacter();
         advance();
     }
     
     // we parse scientific notation
     if (currentCharacter() == 'e' || currentCharacter() == 'E') {
-        num += currentCharacter();
         advance();
         if (currentCharacter() == '+' || currentCharacter() == '-') {
-            num += currentCharacter();
             advance();
         }
         while (isDigit() && !eof()) {
-            num += currentCharacter();
             advance();
         }
     }
 
-    addToken(TokenType::NUMBER, num);
+    addToken(TokenType::NUMBER, slice(start));
     
     reverse();
     
@@ -787,46 +806,18 @@ void Scanner::collectNumber() {
 
 void Scanner::collectIdentifier() {
     
-    string identifier;
+    size_t start = current;
 
     while (isAlpha() || isDigit()) {
-
-        identifier += currentCharacter();
-        
         advance();
-        
     }
     
-    if (isKeyword(identifier)) {
-        
-        std::string kw = keywords[identifier];
-
-        if (kw == "TRUE" || kw == "FALSE") {
-            addToken(TokenType::BOOLEAN, kw);
-        } else if (kw == "CLASS") {
-            addToken(TokenType::CLASS, kw);
-        } else if (kw == "TYPEOF") {
-            addToken(TokenType::TYPEOF, kw);
-        } else if (kw == "DELETE") {
-            addToken(TokenType::DELETE, kw);
-        } else if (kw == "INSTANCEOF") {
-            addToken(TokenType::INSTANCEOF, kw);
-        } else if (kw == "VOID") {
-            addToken(TokenType::VOID, kw);
-        } else if (kw == "AWAIT") {
-            addToken(TokenType::AWAIT, kw);
-        } else if (kw == "IN") {
-            addToken(TokenType::IN, kw);
-        }else if (kw == "YIELD") {
-            addToken(TokenType::YIELD, kw);
-        } else {
-            addToken(TokenType::KEYWORD, kw);
-        }
-
+    string_view identifier = slice(start);
+    
+    if (const Keyword* keyword = findKeyword(identifier)) {
+        addToken(keyword->type, keyword->name);
     } else {
-        
         addToken(TokenType::IDENTIFIER, identifier);
-        
     }
     
     reverse();
@@ -850,6 +841,7 @@ void Scanner::consumeMultilineComment() {
             }
         }
 
+        if (peek() == '\n') line++;
         advance();
         
     }
@@ -884,28 +876,19 @@ void Scanner::reverse() {
 }
 
 void Scanner::addToken(TokenType type) {
-    
-    Token token;
-    token.type = type;
-    token.line = line;
-    
-    tokens.push_back(token);
-
+    tokens.push_back(Token{ type, "", line, tokenStart });
 }
 
-void Scanner::addToken(TokenType type, string lexeme) {
-    
-    Token token;
-    token.type = type;
-    token.lexeme = lexeme;
-    token.line = line;
-    
-    tokens.push_back(token);
+void Scanner::addToken(TokenType type, string_view lexeme) {
+    tokens.push_back(Token{ type, string(lexeme), line, tokenStart });
+}
 
+string_view Scanner::slice(size_t start) {
+    return string_view(source).substr(start, current - start);
 }
 
-bool Scanner::isKeyword(const string& identifier) {
-    return keywords.contains(identifier);
+bool Scanner::isKeyword(string_view identifier) {
+    return findKeyword(identifier) != nullptr;
 }
 
 char& Scanner::currentCharacter() {
@@ -11,6 +11,8 @@
 #include <stdio.h>
 #include <iostream>
 #include <cstring>
+#include <string_view>
+#include <vector>
 #include "./keywords/keywords.h"
 #include "Token/Token.hpp"
 
@@ -20,11 +22,19 @@ class Scanner {
   
 public:
     Scanner(string& source): source(source) {};
+    // resumes scanning source at offset, which is on the given line
+    Scanner(string& source, int offset, int line): current(offset), line(line), source(source) {};
     vector<Token>& getTokens();
+    // next token of the source, scanning only as far as needed; keeps
+    // returning END_OF_FILE once the source is exhausted
+    Token nextToken();
+    void scanToken();
     void advance();
     void reverse();
     void addToken(TokenType type);
-    void addToken(TokenType type, string lexeme);
+    void addToken(TokenType type, string_view lexeme);
+    // source text from start up to the current character
+    string_view slice(size_t start);
     char& currentCharacter();
     bool eof();
     bool isDigit();
@@ -35,7 +45,7 @@ public:
     void collectString();
     void collectNumber();
     void collectIdentifier();
-    bool isKeyword(const string& identifier);
+    bool isKeyword(string_view identifier);
     bool match(char str);
     char& peek();
     void collectLiteralString();
@@ -50,7 +60,11 @@ public:
 private:
     int current = 0;
     int line = 1;
+    // offset of the token scanToken() is reading
+    int tokenStart = 0;
     vector<Token> tokens;
+    // tokens handed out by nextToken()
+    size_t next = 0;
     string& source;
     
 };
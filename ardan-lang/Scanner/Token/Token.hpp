@@ -20,6 +20,8 @@ public:
     TokenType type;
     string lexeme;
     int line;
+    // where the scanner started reading this token in the source
+    int offset = 0;
     
 };
 
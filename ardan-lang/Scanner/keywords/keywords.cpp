@@ -6,6 +6,7 @@
 //
 
 #include "./keywords.h"
+#include <array>
 
 std::unordered_map<std::string, std::string> keywords = {
     
@@ -41,3 +42,68 @@ std::unordered_map<std::string, std::string> keywords = {
     // Module-specific
     {"as", "AS"}, {"from", "FROM"}, {"of", "OF"}
 };
+
+static constexpr Keyword keywordList[] = {
+    
+    {"if", "IF", TokenType::KEYWORD}, {"else", "ELSE", TokenType::KEYWORD},
+    {"switch", "SWITCH", TokenType::KEYWORD}, {"case", "CASE", TokenType::KEYWORD},
+    {"default", "DEFAULT", TokenType::KEYWORD}, {"for", "FOR", TokenType::KEYWORD},
+    {"while", "WHILE", TokenType::KEYWORD}, {"do", "DO", TokenType::KEYWORD},
+    {"break", "BREAK", TokenType::KEYWORD}, {"continue", "CONTINUE", TokenType::KEYWORD},
+    {"return", "RETURN", TokenType::KEYWORD}, {"throw", "THROW", TokenType::KEYWORD},
+    {"try", "TRY", TokenType::KEYWORD}, {"catch", "CATCH", TokenType::KEYWORD},
+    {"finally", "FINALLY", TokenType::KEYWORD},
+
+    {"var", "VAR", TokenType::KEYWORD}, {"let", "LET", TokenType::KEYWORD},
+    {"const", "CONST", TokenType::KEYWORD}, {"function", "FUNCTION", TokenType::KEYWORD},
+    {"class", "CLASS", TokenType::CLASS}, {"extends", "EXTENDS", TokenType::KEYWORD},
+    {"import", "IMPORT", TokenType::KEYWORD}, {"export", "EXPORT", TokenType::KEYWORD},
+
+    {"new", "NEW", TokenType::KEYWORD}, {"delete", "DELETE", TokenType::DELETE},
+    {"typeof", "TYPEOF", TokenType::TYPEOF}, {"instanceof", "INSTANCEOF", TokenType::INSTANCEOF},
+    {"in", "IN", TokenType::IN}, {"void", "VOID", TokenType::VOID},
+    {"yield", "YIELD", TokenType::YIELD}, {"await", "AWAIT", TokenType::AWAIT},
+    {"async", "ASYNC", TokenType::KEYWORD},
+    
+    {"readonly", "READONLY", TokenType::KEYWORD},
+
+    {"true", "TRUE", TokenType::BOOLEAN}, {"false", "FALSE", TokenType::BOOLEAN},
+    {"null", "NULL", TokenType::KEYWORD}, {"this", "THIS", TokenType::KEYWORD},
+    {"super", "SUPER", TokenType::KEYWORD},
+
+    {"enum", "ENUM", TokenType::KEYWORD}, {"implements", "IMPLEMENTS", TokenType::KEYWORD},
+    {"interface", "INTERFACE", TokenType::KEYWORD}, {"package", "PACKAGE", TokenType::KEYWORD},
+    {"private", "PRIVATE", TokenType::KEYWORD}, {"protected", "PROTECTED", TokenType::KEYWORD},
+    {"public", "PUBLIC", TokenType::KEYWORD}, {"static", "STATIC", TokenType::KEYWORD},
+
+    {"as", "AS", TokenType::KEYWORD}, {"from", "FROM", TokenType::KEYWORD},
+    {"of", "OF", TokenType::KEYWORD}
+};
+
+constexpr size_t KEYWORD_SLOTS = 128;
+
+// Every keyword is at least two characters long. The multipliers were
+// searched for so that no two keywords share a slot; adding a keyword that
+// collides fails the build below.
+static constexpr size_t keywordSlot(std::string_view s) {
+    return ((unsigned char)s[0] * 9 + (unsigned char)s[1] * 14 +
+            (unsigned char)s.back() * 25 + s.size()) & (KEYWORD_SLOTS - 1);
+}
+
+static constexpr auto keywordTable = [] {
+    std::array<const Keyword*, KEYWORD_SLOTS> table{};
+    for (const Keyword& keyword : keywordList) {
+        if (table[keywordSlot(keyword.text)]) throw "keyword slots collide";
+        table[keywordSlot(keyword.text)] = &keyword;
+    }
+    return table;
+}();
+
+const Keyword* findKeyword(std::string_view identifier) {
+    
+    if (identifier.size() < 2) return nullptr;
+    
+    const Keyword* keyword = keywordTable[keywordSlot(identifier)];
+    return keyword && keyword->text == identifier ? keyword : nullptr;
+    
+}
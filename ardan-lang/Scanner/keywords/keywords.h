@@ -10,7 +10,19 @@
 
 #include <unordered_map>
 #include <string>
+#include <string_view>
+#include "../Token/TokenType.h"
 
 extern std::unordered_map<std::string, std::string> keywords;
 
+struct Keyword {
+    std::string_view text;
+    // lexeme the parser sees, e.g. "VAR"
+    const char* name;
+    TokenType type;
+};
+
+// nullptr unless identifier is a keyword; a single probe of a perfect hash
+const Keyword* findKeyword(std::string_view identifier);
+
 #endif /* keywords_h */
@@ -19,10 +19,12 @@
 
 using namespace std;
 
-class Statement {
+class Statement : public AstNode {
 public:
     virtual R accept(StatementVisitor& visitor) = 0;
     virtual ~Statement() = default;
+    // source line of the statement's first token; 0 when unknown
+    int line = 0;
 };
 
 class EmptyStatement : public Statement {
@@ -35,7 +37,7 @@ public:
     
 };
 
-class BlockStatement : public Statement {
+class BlockStatement : public Tagged<Statement, NodeKind::Block> {
 public:
     vector<unique_ptr<Statement>> body;
     bool standalone = false;
@@ -51,7 +53,7 @@ public:
     }
 };
 
-class ExpressionStatement : public Statement {
+class ExpressionStatement : public Tagged<Statement, NodeKind::ExpressionStatement> {
 public:
     unique_ptr<Expression> expression;
 
@@ -157,7 +159,7 @@ struct VariableDeclarator {
     unique_ptr<Expression> init; // may be null
 };
 
-class VariableStatement : public Statement {
+class VariableStatement : public Tagged<Statement, NodeKind::Variable> {
 public:
     string kind; // "var", "let", or "const"
     vector<VariableDeclarator> declarations;
@@ -170,12 +172,23 @@ public:
     }
 };
 
-class FunctionDeclaration : public Statement {
+// Source of a function whose body was skipped by the parser's pre-parse
+// mode: from the '(' of its parameter list to one past its closing '}'.
+struct DeferredFunction {
+    shared_ptr<string> source;
+    int begin;
+    int end;
+    int line;
+};
+
+class FunctionDeclaration : public Tagged<Statement, NodeKind::FunctionDeclaration> {
 public:
     string id;
     vector<unique_ptr<Expression>> params;
+    // null while the body is deferred
     unique_ptr<Statement> body;
-    bool is_async;
+    shared_ptr<DeferredFunction> deferred;
+    bool is_async = false;
 
     FunctionDeclaration(string id,
                         vector<unique_ptr<Expression>> params,
@@ -189,7 +202,7 @@ public:
     }
 };
 
-class ReturnStatement : public Statement {
+class ReturnStatement : public Tagged<Statement, NodeKind::Return> {
 public:
     unique_ptr<Expression> argument;
 
@@ -366,7 +379,7 @@ public:
 
 };
 
-class ArrowFunction : public Expression {
+class ArrowFunction : public Tagged<Expression, NodeKind::Arrow> {
 public:
     string name = "<arrow>";
     unique_ptr<Expression> parameters;
@@ -374,7 +387,7 @@ public:
     
     unique_ptr<Expression> exprBody;   // expression body (x => x + 1)
     unique_ptr<Statement> stmtBody; // block body (x => { return x + 1; })
-    bool is_async;
+    bool is_async = false;
     
     // x => x + 1
     ArrowFunction(Token token,
@@ -444,14 +457,14 @@ public:
     }
 };
 
-class FunctionExpression : public Expression {
+class FunctionExpression : public Tagged<Expression, NodeKind::Function> {
 
 public:
     Token token;
     string name = "<anon>";
     vector<unique_ptr<Expression>> params;
     unique_ptr<Statement> body;
-    bool is_async;
+    bool is_async = false;
 
     FunctionExpression(Token token, vector<unique_ptr<Expression>> params,
                         unique_ptr<Statement> body)
@@ -520,7 +533,7 @@ public:
 //
 //};
 
-class ClassExpression : public Expression {
+class ClassExpression : public Tagged<Expression, NodeKind::Class> {
 public:
     Token token;
     string name;
@@ -542,7 +555,7 @@ public:
 
 };
 
-class UIViewExpression : public Expression {
+class UIViewExpression : public Tagged<Expression, NodeKind::UIView> {
 public:
     string name;
     string viewType;
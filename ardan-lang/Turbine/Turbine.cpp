@@ -416,3 +416,162 @@ void Turbine::flushPendingPhis(BasicBlock* block) {
     }
     
 }
+
+const char* ardan::internal::interpreter::bytecodeName(Bytecode op) {
+    switch (op) {
+        case Bytecode::kWide: return "Wide";
+        case Bytecode::kExtraWide: return "ExtraWide";
+        case Bytecode::kLdaZero: return "LdaZero";
+        case Bytecode::kLdaSmi: return "LdaSmi";
+        case Bytecode::kLdaUndefined: return "LdaUndefined";
+        case Bytecode::kLdaNull: return "LdaNull";
+        case Bytecode::kLdaTrue: return "LdaTrue";
+        case Bytecode::kLdaFalse: return "LdaFalse";
+        case Bytecode::kLdaConstant: return "LdaConstant";
+        case Bytecode::kLdar: return "Ldar";
+        case Bytecode::kStar: return "Star";
+        case Bytecode::kMov: return "Mov";
+        case Bytecode::kLdaGlobal: return "LdaGlobal";
+        case Bytecode::kLdaGlobalInsideTypeof: return "LdaGlobalInsideTypeof";
+        case Bytecode::kLdaNamedProperty: return "LdaNamedProperty";
+        case Bytecode::kLdaNamedPropertyFromSuper: return "LdaNamedPropertyFromSuper";
+        case Bytecode::kLdaKeyedProperty: return "LdaKeyedProperty";
+        case Bytecode::kStaGlobalSloppy: return "StaGlobalSloppy";
+        case Bytecode::kStaGlobalStrict: return "StaGlobalStrict";
+        case Bytecode::kStaNamedProperty: return "StaNamedProperty";
+        case Bytecode::kStaNamedPropertySloppy: return "StaNamedPropertySloppy";
+        case Bytecode::kStaNamedPropertyStrict: return "StaNamedPropertyStrict";
+        case Bytecode::kStaNamedOwnProperty: return "StaNamedOwnProperty";
+        case Bytecode::kStaKeyedProperty: return "StaKeyedProperty";
+        case Bytecode::kStaKeyedPropertySloppy: return "StaKeyedPropertySloppy";
+        case Bytecode::kStaKeyedPropertyStrict: return "StaKeyedPropertyStrict";
+        case Bytecode::kStaInArrayLiteral: return "StaInArrayLiteral";
+        case Bytecode::kStaDataPropertyInLiteral: return "StaDataPropertyInLiteral";
+        case Bytecode::kCollectTypeProfile: return "CollectTypeProfile";
+        case Bytecode::kLdaContextSlot: return "LdaContextSlot";
+        case Bytecode::kLdaImmutableContextSlot: return "LdaImmutableContextSlot";
+        case Bytecode::kLdaCurrentContextSlot: return "LdaCurrentContextSlot";
+        case Bytecode::kLdaImmutableCurrentContextSlot: return "LdaImmutableCurrentContextSlot";
+        case Bytecode::kStaContextSlot: return "StaContextSlot";
+        case Bytecode::kStaCurrentContextSlot: return "StaCurrentContextSlot";
+        case Bytecode::kLdaModuleVariable: return "LdaModuleVariable";
+        case Bytecode::kStaModuleVariable: return "StaModuleVariable";
+        case Bytecode::kAdd: return "Add";
+        case Bytecode::kSub: return "Sub";
+        case Bytecode::kMul: return "Mul";
+        case Bytecode::kDiv: return "Div";
+        case Bytecode::kMod: return "Mod";
+        case Bytecode::kExp: return "Exp";
+        case Bytecode::kBitwiseOr: return "BitwiseOr";
+        case Bytecode::kBitwiseXor: return "BitwiseXor";
+        case Bytecode::kBitwiseAnd: return "BitwiseAnd";
+        case Bytecode::kShiftLeft: return "ShiftLeft";
+        case Bytecode::kShiftRight: return "ShiftRight";
+        case Bytecode::kShiftRightLogical: return "ShiftRightLogical";
+        case Bytecode::kAddSmi: return "AddSmi";
+        case Bytecode::kSubSmi: return "SubSmi";
+        case Bytecode::kMulSmi: return "MulSmi";
+        case Bytecode::kDivSmi: return "DivSmi";
+        case Bytecode::kModSmi: return "ModSmi";
+        case Bytecode::kExpSmi: return "ExpSmi";
+        case Bytecode::kBitwiseOrSmi: return "BitwiseOrSmi";
+        case Bytecode::kBitwiseXorSmi: return "BitwiseXorSmi";
+        case Bytecode::kBitwiseAndSmi: return "BitwiseAndSmi";
+        case Bytecode::kShiftLeftSmi: return "ShiftLeftSmi";
+        case Bytecode::kShiftRightSmi: return "ShiftRightSmi";
+        case Bytecode::kShiftRightLogicalSmi: return "ShiftRightLogicalSmi";
+        case Bytecode::kInc: return "Inc";
+        case Bytecode::kDec: return "Dec";
+        case Bytecode::kNegate: return "Negate";
+        case Bytecode::kToBooleanLogicalNot: return "ToBooleanLogicalNot";
+        case Bytecode::kLogicalNot: return "LogicalNot";
+        case Bytecode::kTypeOf: return "TypeOf";
+        case Bytecode::kDeletePropertyStrict: return "DeletePropertyStrict";
+        case Bytecode::kDeletePropertySloppy: return "DeletePropertySloppy";
+        case Bytecode::kGetSuperConstructor: return "GetSuperConstructor";
+        case Bytecode::kTestEqual: return "TestEqual";
+        case Bytecode::kTestSameValue: return "TestSameValue";
+        case Bytecode::kTestLessThan: return "TestLessThan";
+        case Bytecode::kTestGreaterThan: return "TestGreaterThan";
+        case Bytecode::kTestLessThanOrEqual: return "TestLessThanOrEqual";
+        case Bytecode::kTestGreaterThanOrEqual: return "TestGreaterThanOrEqual";
+        case Bytecode::kTestEqualStrict: return "TestEqualStrict";
+        case Bytecode::kTestIn: return "TestIn";
+        case Bytecode::kTestInstanceOf: return "TestInstanceOf";
+        case Bytecode::kTestUndetectable: return "TestUndetectable";
+        case Bytecode::kTestNull: return "TestNull";
+        case Bytecode::kTestUndefined: return "TestUndefined";
+        case Bytecode::kTestTypeOf: return "TestTypeOf";
+        case Bytecode::kToName: return "ToName";
+        case Bytecode::kNumberToString: return "NumberToString";
+        case Bytecode::kToNumber: return "ToNumber";
+        case Bytecode::kToNumeric: return "ToNumeric";
+        case Bytecode::kToObject: return "ToObject";
+        case Bytecode::kJump: return "Jump";
+        case Bytecode::kJumpConstant: return "JumpConstant";
+        case Bytecode::kJumpIfTrue: return "JumpIfTrue";
+        case Bytecode::kJumpIfTrueConstant: return "JumpIfTrueConstant";
+        case Bytecode::kJumpIfFalse: return "JumpIfFalse";
+        case Bytecode::kJumpIfFalseConstant: return "JumpIfFalseConstant";
+        case Bytecode::kJumpIfToBooleanTrue: return "JumpIfToBooleanTrue";
+        case Bytecode::kJumpIfToBooleanTrueConstant: return "JumpIfToBooleanTrueConstant";
+        case Bytecode::kJumpIfToBooleanFalse: return "JumpIfToBooleanFalse";
+        case Bytecode::kJumpIfToBooleanFalseConstant: return "JumpIfToBooleanFalseConstant";
+        case Bytecode::kJumpIfNull: return "JumpIfNull";
+        case Bytecode::kJumpIfNullConstant: return "JumpIfNullConstant";
+        case Bytecode::kJumpIfNotNull: return "JumpIfNotNull";
+        case Bytecode::kJumpIfNotNullConstant: return "JumpIfNotNullConstant";
+        case Bytecode::kJumpIfUndefined: return "JumpIfUndefined";
+        case Bytecode::kJumpIfUndefinedConstant: return "JumpIfUndefinedConstant";
+        case Bytecode::kJumpIfNotUndefined: return "JumpIfNotUndefined";
+        case Bytecode::kJumpIfNotUndefinedConstant: return "JumpIfNotUndefinedConstant";
+        case Bytecode::kJumpIfUndefinedOrNull: return "JumpIfUndefinedOrNull";
+        case Bytecode::kJumpIfUndefinedOrNullConstant: return "JumpIfUndefinedOrNullConstant";
+        case Bytecode::kJumpIfJSReceiver: return "JumpIfJSReceiver";
+        case Bytecode::kJumpIfJSReceiverConstant: return "JumpIfJSReceiverConstant";
+        case Bytecode::kSwitchOnSmiNoFeedback: return "SwitchOnSmiNoFeedback";
+        case Bytecode::kCallAnyReceiver: return "CallAnyReceiver";
+        case Bytecode::kCallProperty: return "CallProperty";
+        case Bytecode::kCallProperty0: return "CallProperty0";
+        case Bytecode::kCallProperty1: return "CallProperty1";
+        case Bytecode::kCallProperty2: return "CallProperty2";
+        case Bytecode::kCallUndefinedReceiver: return "CallUndefinedReceiver";
+        case Bytecode::kCallUndefinedReceiver0: return "CallUndefinedReceiver0";
+        case Bytecode::kCallUndefinedReceiver1: return "CallUndefinedReceiver1";
+        case Bytecode::kCallUndefinedReceiver2: return "CallUndefinedReceiver2";
+        case Bytecode::kCallWithSpread: return "CallWithSpread";
+        case Bytecode::kCallRuntime: return "CallRuntime";
+        case Bytecode::kCallRuntimeForPair: return "CallRuntimeForPair";
+        case Bytecode::kCallJSRuntime: return "CallJSRuntime";
+        case Bytecode::kConstruct: return "Construct";
+        case Bytecode::kConstructWithSpread: return "ConstructWithSpread";
+        case Bytecode::kCreateRegExpLiteral: return "CreateRegExpLiteral";
+        case Bytecode::kCreateArrayLiteral: return "CreateArrayLiteral";
+        case Bytecode::kCreateEmptyArrayLiteral: return "CreateEmptyArrayLiteral";
+        case Bytecode::kCreateArrayFromIterable: return "CreateArrayFromIterable";
+        case Bytecode::kCreateObjectLiteral: return "CreateObjectLiteral";
+        case Bytecode::kCreateEmptyObjectLiteral: return "CreateEmptyObjectLiteral";
+        case Bytecode::kCloneObject: return "CloneObject";
+        case Bytecode::kCreateClosure: return "CreateClosure";
+        case Bytecode::kCreateBlockContext: return "CreateBlockContext";
+        case Bytecode::kCreateFunctionContext: return "CreateFunctionContext";
+        case Bytecode::kCreateEvalContext: return "CreateEvalContext";
+        case Bytecode::kCreateWithContext: return "CreateWithContext";
+        case Bytecode::kCreateArguments: return "CreateArguments";
+        case Bytecode::kCreateRestParameter: return "CreateRestParameter";
+        case Bytecode::kGetTemplateObject: return "GetTemplateObject";
+        case Bytecode::kGetIterator: return "GetIterator";
+        case Bytecode::kThrow: return "Throw";
+        case Bytecode::kReThrow: return "ReThrow";
+        case Bytecode::kReturn: return "Return";
+        case Bytecode::kThrowReferenceErrorIfHole: return "ThrowReferenceErrorIfHole";
+        case Bytecode::kThrowSuperNotCalledIfHole: return "ThrowSuperNotCalledIfHole";
+        case Bytecode::kThrowSuperAlreadyCalledIfNotHole: return "ThrowSuperAlreadyCalledIfNotHole";
+        case Bytecode::kThrowIfNotSuperConstructor: return "ThrowIfNotSuperConstructor";
+        case Bytecode::kDebugger: return "Debugger";
+        case Bytecode::kIncBlockCounter: return "IncBlockCounter";
+        case Bytecode::kAbort: return "Abort";
+        case Bytecode::kPrint: return "Print";
+    }
+    return "Unknown";
+}
@@ -197,6 +197,8 @@ enum class Bytecode : uint8_t {
     kPrint,
 };
 
+const char* bytecodeName(Bytecode op);
+
 }
 }
 }
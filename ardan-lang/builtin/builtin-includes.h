@@ -14,8 +14,12 @@
 #include "runtime/JSBoolean/JSBoolean.hpp"
 #include "runtime/Array/Array.hpp"
 #include "runtime/JSPromise/JSPromise.hpp"
+#include "runtime/TypedArray/TypedArray.hpp"
+#include "runtime/Atomics/Atomics.hpp"
+#include "JSON/JSON.hpp"
 
 #include "platform/File/File.hpp"
 #include "platform/Print/Print.hpp"
+#include "platform/Worker/Worker.hpp"
 
 #endif /* builtin_includes_h */
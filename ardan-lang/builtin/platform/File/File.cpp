@@ -6,3 +6,520 @@
 //
 
 #include "File.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <filesystem>
+#include <stdexcept>
+
+#include "engines/BaseVM/BaseVM.hpp"
+#include "EventLoop/EventLoop.hpp"
+#include "EventLoop/ThreadPool.hpp"
+#include "Interpreter/Promise/Promise.hpp"
+#include "Interpreter/ExecutionContext/JSIterator/JSIterator.h"
+#include "Interpreter/ExecutionContext/JSTypedArray/JSTypedArray.h"
+#include "MappedFile.hpp"
+
+// descriptor shared by a stream iterator; closed once the iterator is
+// exhausted or dropped
+struct StreamSource {
+    int fd = -1;
+    string pending;     // lines: bytes read but not yet returned
+    size_t start = 0;   // lines: offset of the next line in pending
+    bool eof = false;
+
+    ~StreamSource() {
+        if (fd != -1) ::close(fd);
+    }
+};
+
+static const size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+File::File(BaseVM* vm) : vm(vm) {
+
+    loop = &EventLoop::getInstance();
+
+    // fs.readFile(path[, options], callback); { encoding: null } gives a Buffer
+    set_builtin_value("readFile", Value::native([this](const std::vector<Value>& args) -> Value {
+
+        if (args.size() < 1) {
+            throw std::runtime_error("readFile expects a path");
+        }
+
+        string path = resolvePath(args[0]);
+        bool raw = wantsBuffer(args);
+
+        return submit(lastCallback(args, 1), [path, raw]() -> function<Value()> {
+            auto data = make_shared<string>(readAll(path));
+            return [data, raw]() -> Value {
+                if (raw) return Value::object(JSTypedArray::fromBytes(std::move(*data)));
+                return Value::str(*data);
+            };
+        });
+
+    }));
+
+    // fs.writeFile(path, data[, callback])
+    set_builtin_value("writeFile", Value::native([this](const std::vector<Value>& args) -> Value {
+
+        if (args.size() < 2) {
+            throw std::runtime_error("writeFile expects 2 arguments (path, data)");
+        }
+
+        string path = resolvePath(args[0]);
+        string data = JSTypedArray::toBytes(args[1]);
+
+        return submit(lastCallback(args, 2), [path, data]() -> function<Value()> {
+            writeAll(path, data, false);
+            return []() -> Value { return Value::undefined(); };
+        });
+
+    }));
+
+    // fs.appendFile(path, data[, callback])
+    set_builtin_value("appendFile", Value::native([this](const std::vector<Value>& args) -> Value {
+
+        if (args.size() < 2) {
+            throw std::runtime_error("appendFile expects 2 arguments (path, data)");
+        }
+
+        string path = resolvePath(args[0]);
+        string data = JSTypedArray::toBytes(args[1]);
+
+        return submit(lastCallback(args, 2), [path, data]() -> function<Value()> {
+            writeAll(path, data, true);
+            return []() -> Value { return Value::undefined(); };
+        });
+
+    }));
+
+    // fs.stat(path, callback) -> { size, mode, mtimeMs, isFile(), isDirectory() }
+    set_builtin_value("stat", Value::native([this](const std::vector<Value>& args) -> Value {
+
+        if (args.size() < 1) {
+            throw std::runtime_error("stat expects a path");
+        }
+
+        string path = resolvePath(args[0]);
+
+        return submit(lastCallback(args, 1), [path]() -> function<Value()> {
+
+            struct stat st;
+            if (::stat(path.c_str(), &st) == -1) {
+                throw std::runtime_error("Could not stat " + path + ": " + strerror(errno));
+            }
+
+            return [st]() -> Value {
+
+                auto stats = make_shared<JSObject>();
+                bool is_file = S_ISREG(st.st_mode);
+                bool is_dir = S_ISDIR(st.st_mode);
+
+                stats->set("size", Value::number((double)st.st_size), "VAR", {});
+                stats->set("mode", Value::number((double)st.st_mode), "VAR", {});
+                stats->set("mtimeMs", Value::number((double)st.st_mtime * 1000), "VAR", {});
+
+                stats->set_builtin_value("isFile", Value::native([is_file](const vector<Value>&) -> Value {
+                    return Value::boolean(is_file);
+                }));
+                stats->set_builtin_value("isDirectory", Value::native([is_dir](const vector<Value>&) -> Value {
+                    return Value::boolean(is_dir);
+                }));
+
+                return Value::object(stats);
+            };
+
+        });
+
+    }));
+
+    // fs.readdir(path, callback) -> array of entry names
+    set_builtin_value("readdir", Value::native([this](const std::vector<Value>& args) -> Value {
+
+        if (args.size() < 1) {
+            throw std::runtime_error("readdir expects a path");
+        }
+
+        string path = resolvePath(args[0]);
+
+        return submit(lastCallback(args, 1), [path]() -> function<Value()> {
+
+            vector<string> names;
+            std::error_code ec;
+
+            for (auto it = std::filesystem::directory_iterator(path, ec);
+                 !ec && it != std::filesystem::directory_iterator();
+                 it.increment(ec)) {
+                names.push_back(it->path().filename().string());
+            }
+
+            if (ec) {
+                throw std::runtime_error("Could not read directory " + path + ": " + ec.message());
+            }
+
+            return [names = std::move(names)]() -> Value {
+                auto entries = make_shared<JSArray>();
+                for (size_t i = 0; i < names.size(); i++) {
+                    entries->setIndex(i, Value::str(names[i]));
+                }
+                return Value::array(entries);
+            };
+
+        });
+
+    }));
+
+    // fs.mmap(path) -> read-only buffer backed by the file's pages
+    set_builtin_value("mmap", Value::native([](const std::vector<Value>& args) -> Value {
+
+        if (args.size() < 1) {
+            throw std::runtime_error("mmap expects a path");
+        }
+
+        return Value::object(make_shared<MappedBuffer>(resolvePath(args[0])));
+
+    }));
+
+    // fs.createReadStream(path[, { chunkSize }]) -> iterator of string chunks
+    set_builtin_value("createReadStream", Value::native([](const std::vector<Value>& args) -> Value {
+
+        if (args.size() < 1) {
+            throw std::runtime_error("createReadStream expects a path");
+        }
+
+        auto source = openStream(resolvePath(args[0]));
+        size_t chunk_size = chunkSize(args);
+
+        return Value::object(make_shared<JSIterator>([source, chunk_size](Value& out) -> bool {
+
+            string chunk(chunk_size, '\0');
+            size_t n = readChunk(source->fd, &chunk[0], chunk_size);
+            if (n == 0) return false;
+
+            chunk.resize(n);
+            out = Value::str(chunk);
+            return true;
+
+        }));
+
+    }));
+
+    // fs.readLines(path[, { chunkSize }]) -> iterator of lines. only the
+    // current chunk and the line being assembled are held in memory.
+    set_builtin_value("readLines", Value::native([](const std::vector<Value>& args) -> Value {
+
+        if (args.size() < 1) {
+            throw std::runtime_error("readLines expects a path");
+        }
+
+        auto source = openStream(resolvePath(args[0]));
+        size_t chunk_size = chunkSize(args);
+
+        return Value::object(make_shared<JSIterator>([source, chunk_size](Value& out) -> bool {
+
+            while (true) {
+
+                size_t newline = source->pending.find('\n', source->start);
+
+                if (newline != string::npos || source->eof) {
+
+                    if (newline == string::npos) {
+                        // last line without a trailing newline
+                        if (source->start >= source->pending.size()) return false;
+                        newline = source->pending.size();
+                    }
+
+                    size_t length = newline - source->start;
+                    if (length > 0 && source->pending[newline - 1] == '\r') length--;
+
+                    out = Value::str(source->pending.substr(source->start, length));
+                    source->start = newline + 1;
+                    return true;
+                }
+
+                // drop consumed lines before reading the next chunk
+                source->pending.erase(0, source->start);
+                source->start = 0;
+
+                size_t old_size = source->pending.size();
+                source->pending.resize(old_size + chunk_size);
+
+                size_t n = readChunk(source->fd, &source->pending[old_size], chunk_size);
+                source->pending.resize(old_size + n);
+
+                if (n == 0) source->eof = true;
+            }
+
+        }));
+
+    }));
+
+    // blocking variants; the callback is optional and the data is returned
+    set_builtin_value("readFileSync", Value::native([this](const std::vector<Value>& args) -> Value {
+
+        if (args.size() < 1) {
+            throw std::runtime_error("readFile expects 1 argument (path)");
+        }
+
+        string path = resolvePath(args[0]);
+        Value callback = lastCallback(args, 1);
+
+        try {
+            string bytes = readAll(path);
+            Value data = wantsBuffer(args)
+                ? Value::object(JSTypedArray::fromBytes(std::move(bytes)))
+                : Value::str(bytes);
+            if (isCallable(callback)) invoke(callback, { Value::nullVal(), data });
+            return data;
+        } catch (const std::runtime_error& e) {
+            if (!isCallable(callback)) throw;
+            invoke(callback, { Value::str(e.what()) });
+            return Value::nullVal();
+        }
+
+    }));
+
+    set_builtin_value("writeFileSync", Value::native([this](const std::vector<Value>& args) -> Value {
+
+        if (args.size() < 2) {
+            throw std::runtime_error("writeFile expects 2 arguments (path, data)");
+        }
+
+        string path = resolvePath(args[0]);
+        Value callback = lastCallback(args, 2);
+
+        try {
+            writeAll(path, JSTypedArray::toBytes(args[1]), false);
+            if (isCallable(callback)) invoke(callback, { Value::nullVal() });
+        } catch (const std::runtime_error& e) {
+            if (!isCallable(callback)) throw;
+            invoke(callback, { Value::str(e.what()) });
+        }
+
+        return Value::nullVal();
+
+    }));
+
+}
+
+bool File::isCallable(const Value& v) {
+    return v.type == ValueType::FUNCTION ||
+           v.type == ValueType::NATIVE_FUNCTION ||
+           v.type == ValueType::CLOSURE;
+}
+
+// readFile(path, { encoding: null }) asks for the raw bytes
+bool File::wantsBuffer(const vector<Value>& args) {
+
+    if (args.size() < 2 || args[1].type != ValueType::OBJECT) return false;
+
+    Value encoding = args[1].objectValue->get("encoding");
+    return encoding.type == ValueType::NULLTYPE;
+
+}
+
+Value File::lastCallback(const vector<Value>& args, size_t from) {
+    if (args.size() > from && isCallable(args.back())) {
+        return args.back();
+    }
+    return Value::undefined();
+}
+
+string File::resolvePath(const Value& path) {
+    return std::filesystem::absolute(path.toString()).string();
+}
+
+Value File::invoke(const Value& fn, const vector<Value>& args) {
+
+    switch (fn.type) {
+        case ValueType::FUNCTION:
+            return fn.functionValue(args);
+        case ValueType::NATIVE_FUNCTION:
+            return fn.nativeFunction(args);
+        case ValueType::CLOSURE:
+            if (vm == nullptr) {
+                throw runtime_error("fs callback needs a VM to run a closure");
+            }
+            return vm->callFunction(fn, args);
+        default:
+            throw runtime_error("fs callback is not a function");
+    }
+
+}
+
+// hands work to the pool and completes it on the loop thread: through the
+// callback if there is one, else through the returned promise.
+Value File::submit(const Value& callback, Work work) {
+
+    shared_ptr<Promise> promise;
+    if (!isCallable(callback)) {
+        promise = make_shared<Promise>(vm);
+    }
+
+    EventLoop* target = loop;
+    target->ref();
+
+    ThreadPool::getInstance().submit([this, target, callback, promise, work]() {
+
+        function<Value()> finish;
+
+        try {
+            finish = work();
+        } catch (const std::exception& e) {
+            string message = e.what();
+            finish = [message]() -> Value { throw runtime_error(message); };
+        }
+
+        target->post([this, target, callback, promise, finish](vector<Value>) -> Value {
+
+            target->unref();
+
+            Value result;
+            string error;
+            bool failed = false;
+
+            try {
+                result = finish();
+            } catch (const std::exception& e) {
+                error = e.what();
+                failed = true;
+            }
+
+            if (promise) {
+                if (failed) promise->reject(Value::str(error));
+                else promise->resolve(result);
+            } else if (failed) {
+                invoke(callback, { Value::str(error) });
+            } else {
+                invoke(callback, { Value::nullVal(), result });
+            }
+
+            return Value::undefined();
+
+        }, {});
+
+    });
+
+    return promise ? Value::promise(promise) : Value::undefined();
+
+}
+
+// one allocation sized from fstat; the probe read catches files that
+// report no size (pipes, procfs) or grew after the fstat.
+string File::readAll(const string& path) {
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw runtime_error("Could not open file: " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        ::close(fd);
+        throw runtime_error("Could not stat file: " + path);
+    }
+
+    string data;
+    data.resize(st.st_size > 0 ? (size_t)st.st_size : 0);
+
+    size_t filled = 0;
+
+    while (true) {
+
+        if (filled == data.size()) {
+            char probe[4096];
+            ssize_t n = ::read(fd, probe, sizeof(probe));
+            if (n == -1 && errno == EINTR) continue;
+            if (n == -1) {
+                ::close(fd);
+                throw runtime_error("Could not read file: " + path);
+            }
+            if (n == 0) break;
+            data.append(probe, n);
+            filled += n;
+            continue;
+        }
+
+        ssize_t n = ::read(fd, &data[filled], data.size() - filled);
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1) {
+            ::close(fd);
+            throw runtime_error("Could not read file: " + path);
+        }
+        if (n == 0) break;
+        filled += n;
+    }
+
+    ::close(fd);
+    data.resize(filled);
+
+    return data;
+
+}
+
+void File::writeAll(const string& path, const string& data, bool append) {
+
+    int flags = O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC);
+    int fd = ::open(path.c_str(), flags, 0644);
+    if (fd == -1) {
+        throw runtime_error("Could not write file: " + path);
+    }
+
+    size_t written = 0;
+
+    while (written < data.size()) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1) {
+            ::close(fd);
+            throw runtime_error("Could not write file: " + path);
+        }
+        written += n;
+    }
+
+    ::close(fd);
+
+}
+
+shared_ptr<StreamSource> File::openStream(const string& path) {
+
+    auto source = make_shared<StreamSource>();
+    source->fd = ::open(path.c_str(), O_RDONLY);
+
+    if (source->fd == -1) {
+        throw runtime_error("Could not open file: " + path);
+    }
+
+    return source;
+
+}
+
+// reads up to size bytes, 0 at end of file
+size_t File::readChunk(int fd, char* buffer, size_t size) {
+
+    while (true) {
+        ssize_t n = ::read(fd, buffer, size);
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1) {
+            throw runtime_error(string("Could not read stream: ") + strerror(errno));
+        }
+        return (size_t)n;
+    }
+
+}
+
+size_t File::chunkSize(const vector<Value>& args) {
+
+    if (args.size() > 1 && args[1].type == ValueType::OBJECT) {
+        Value size = args[1].objectValue->get("chunkSize");
+        if (size.type == ValueType::NUMBER && size.numberValue >= 1) {
+            return (size_t)size.numberValue;
+        }
+    }
+
+    return DEFAULT_CHUNK_SIZE;
+
+}
@@ -9,105 +9,57 @@
 #define File_hpp
 
 #include <stdio.h>
-#include <fstream>
-#include <sstream>
+#include <string>
+#include <functional>
 
 #include "Interpreter/R.hpp"
 
-class File : public JSObject {
-//    const fs = require('fs');
+class BaseVM;
+class EventLoop;
+struct StreamSource;
 
-    // Reading a file asynchronously
+// fs builtin. The async calls run their blocking I/O on the shared
+// ThreadPool and complete on the event loop, either through a Node-style
+// callback (err, result) or, when no callback is given, a returned Promise.
+//
 //    fs.readFile('example.txt', 'utf8', (err, data) => {
 //        if (err) throw err;
 //        console.log('File contents:', data);
 //    });
-
-    // Writing to a file asynchronously
-//    fs.writeFile('output.txt', 'Hello, Node.js!', (err) => {
-//        if (err) throw err;
-//        console.log('File written successfully.');
-//    });
+//
+//    let data = await fs.readFile('example.txt');
+//
+// Large inputs can be read without loading them whole: fs.mmap(path) maps
+// the file, and fs.createReadStream / fs.readLines return iterators that
+// for...of pulls one chunk or line at a time.
+class File : public JSObject {
     
 public:
-    File() {
-        
-        set_builtin_value("readFileSync", Value::native([](const std::vector<Value>& args) {
-
-            if (args.size() < 1) {
-                throw std::runtime_error("readFile expects 1 argument (path)");
-            }
-            
-            // std::string path = args[0].toString();
-            
-            std::string path = std::filesystem::absolute(args[0].toString()).string();
-            Value callback = args[1];
-
-            std::ifstream file(path, std::ios::in | std::ios::binary);
-            if (!file) {
-                
-                vector<Value> cbArgs = {
-                    Value("Could not open file: " + path)
-                };
-                
-                callback.functionValue(cbArgs);
-                
-                return Value::nullVal();
-                
-                // throw std::runtime_error("Could not open file: " + path);
-            }
-            
-            std::ostringstream ss;
-            ss << file.rdbuf();
-                        
-            vector<Value> cbArgs = {
-                Value(),
-                Value(ss.str())
-            };
-            
-            callback.functionValue(cbArgs);
-            return Value::nullVal();
-            
-        }));
-        
-        set_builtin_value("writeFileSync", Value::native([](const std::vector<Value>& args) {
-            
-            if (args.size() < 2) {
-                throw std::runtime_error("writeFile expects 2 arguments (path, data)");
-            }
-            // std::string path = args[0].toString();
-            std::string path = std::filesystem::absolute(args[0].toString()).string();
+    File(BaseVM* vm = nullptr);
 
-            std::string data = args[1].toString();
-            Value callback = args[1];
+private:
+    BaseVM* vm;
+    EventLoop* loop;
 
-            std::ofstream file(path, std::ios::out | std::ios::binary);
-            if (!file) {
-                
-                vector<Value> cbArgs = {
-                    Value("Could not write file: " + path),
-                };
+    // runs on a worker thread. it must not touch script values: it does
+    // the I/O and returns the step that builds the result on the loop
+    // thread, throwing runtime_error there if the request failed.
+    using Work = std::function<std::function<Value()>()>;
 
-                callback.functionValue(cbArgs);
-                
-                return Value::nullVal();
-                
-                // throw std::runtime_error("Could not write file: " + path);
-                
-            }
-            
-            file << data;
-            file.close();
-            
-            vector<Value> cbArgs = {};
+    Value submit(const Value& callback, Work work);
+    Value invoke(const Value& fn, const vector<Value>& args);
 
-            callback.functionValue(cbArgs);
+    static bool isCallable(const Value& v);
+    static Value lastCallback(const vector<Value>& args, size_t from);
+    static bool wantsBuffer(const vector<Value>& args);
+    static string resolvePath(const Value& path);
 
-            return Value::nullVal();
-            
-        }));
+    static string readAll(const string& path);
+    static void writeAll(const string& path, const string& data, bool append);
 
-    }
+    static shared_ptr<StreamSource> openStream(const string& path);
+    static size_t readChunk(int fd, char* buffer, size_t size);
+    static size_t chunkSize(const vector<Value>& args);
 };
 
 #endif /* File_hpp */
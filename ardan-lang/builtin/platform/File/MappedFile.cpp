@@ -0,0 +1,116 @@
+//
+//  MappedFile.cpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#include "MappedFile.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdexcept>
+
+#include "Interpreter/ExecutionContext/JSIterator/JSIterator.h"
+
+MappedBuffer::Mapping::~Mapping() {
+    if (addr != nullptr) {
+        munmap((void*)addr, size);
+    }
+}
+
+MappedBuffer::MappedBuffer(const string& path) : mapping(make_shared<Mapping>()) {
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw runtime_error("Could not open file: " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        ::close(fd);
+        throw runtime_error("Could not stat file: " + path);
+    }
+
+    // mmap rejects zero-length mappings; an empty file is an empty view
+    if (st.st_size > 0) {
+        void* addr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            throw runtime_error("Could not map file " + path + ": " + strerror(errno));
+        }
+        mapping->addr = (const char*)addr;
+        mapping->size = (size_t)st.st_size;
+    }
+
+    // the mapping keeps the pages reachable after the descriptor is closed
+    ::close(fd);
+
+    set("length", Value::number((double)mapping->size), "CONST", {});
+
+    // buf.slice(start, end) -> string copy of [start, end)
+    set_builtin_value("slice", Value::native([this](const vector<Value>& args) -> Value {
+        size_t start = args.size() > 0 ? (size_t)args[0].numberValue : 0;
+        size_t end = args.size() > 1 ? (size_t)args[1].numberValue : size();
+        return Value::str(slice(start, end));
+    }));
+
+    set_builtin_value("toString", Value::native([this](const vector<Value>& args) -> Value {
+        return Value::str(slice(0, size()));
+    }));
+
+    // buf.lines() -> iterator over lines, without their line endings
+    set_builtin_value("lines", Value::native([this](const vector<Value>& args) -> Value {
+
+        if (mapping->size > 0) {
+            madvise((void*)mapping->addr, mapping->size, MADV_SEQUENTIAL);
+        }
+
+        shared_ptr<Mapping> view = mapping;
+
+        return Value::object(make_shared<JSIterator>([view, offset = (size_t)0](Value& out) mutable -> bool {
+
+            if (offset >= view->size) return false;
+
+            const char* start = view->addr + offset;
+            size_t remaining = view->size - offset;
+            const char* newline = (const char*)memchr(start, '\n', remaining);
+
+            size_t length = newline ? (size_t)(newline - start) : remaining;
+            offset += newline ? length + 1 : length;
+
+            if (length > 0 && start[length - 1] == '\r') length--;
+
+            out = Value::str(string(start, length));
+            return true;
+
+        }));
+
+    }));
+
+}
+
+Value MappedBuffer::get(Atom key) const {
+
+    if (!key.empty() && key.str().find_first_not_of("0123456789") == string::npos) {
+        size_t index = stoull(key);
+        if (index >= size()) return Value::undefined();
+        return Value::number((double)(unsigned char)data()[index]);
+    }
+
+    return JSObject::get(key);
+
+}
+
+string MappedBuffer::slice(size_t start, size_t end) const {
+
+    if (end > size()) end = size();
+    if (start >= end) return "";
+
+    return string(data() + start, end - start);
+
+}
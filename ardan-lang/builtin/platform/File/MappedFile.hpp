@@ -0,0 +1,46 @@
+//
+//  MappedFile.hpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#ifndef MappedFile_hpp
+#define MappedFile_hpp
+
+#include <stdio.h>
+#include <string>
+#include <memory>
+
+#include "Interpreter/R.hpp"
+
+// Read-only view of a file mapped with mmap, returned by fs.mmap(path).
+// Pages are faulted in by the kernel as they are touched, so memory use
+// does not grow with the file. buf[i] reads a byte, slice() copies a range
+// out as a string and lines() iterates lines without copying the file.
+class MappedBuffer : public JSObject {
+
+public:
+    MappedBuffer(const string& path);
+
+    // numeric keys read a byte; everything else is a normal property
+    Value get(Atom key) const override;
+
+    const char* data() const { return mapping->addr; }
+    size_t size() const { return mapping->size; }
+
+private:
+    struct Mapping {
+        const char* addr = nullptr;
+        size_t size = 0;
+        ~Mapping();
+    };
+
+    // shared with the iterators handed out by lines(), which may outlive
+    // the buffer object itself
+    shared_ptr<Mapping> mapping;
+
+    string slice(size_t start, size_t end) const;
+};
+
+#endif /* MappedFile_hpp */
@@ -6,6 +6,7 @@
 //
 
 #include "Server.hpp"
+#include "Interpreter/ExecutionContext/JSTypedArray/JSTypedArray.h"
 
 std::shared_ptr<JSObject> Server::construct() {
     
@@ -84,7 +85,7 @@ std::shared_ptr<JSObject> Server::construct() {
                 // res.end
                 res_obj->set_builtin_value("end", Value::native([client_fd](const vector<Value>& args)->Value {
                     if (!args.empty()) {
-                        std::string body = args[0].toString();
+                        std::string body = JSTypedArray::toBytes(args[0]);
                         ::send(client_fd, body.c_str(), body.size(), 0);
                     }
                     close(client_fd);
@@ -100,6 +101,7 @@ std::shared_ptr<JSObject> Server::construct() {
                             // TODO: parse HTTP; for now, set raw body
                             auto req_obj = req.objectValue;
                             req_obj->set_builtin_value("body", Value::str(std::string(buf, n)));
+                            req_obj->set_builtin_value("rawBody", Value::object(JSTypedArray::fromBytes(std::string(buf, n))));
 
                             // Dispatch "request" event callback
                             auto it = event_callbacks.find("request");
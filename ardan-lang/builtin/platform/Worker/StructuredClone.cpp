@@ -0,0 +1,384 @@
+//
+//  StructuredClone.cpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 19/10/2026.
+//
+
+#include "StructuredClone.hpp"
+#include "Interpreter/ExecutionContext/JSArray/JSArray.h"
+#include "Interpreter/ExecutionContext/JSObject/JSObject.h"
+
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+enum class Tag : uint8_t {
+    Undefined,
+    Null,
+    False,
+    True,
+    Number,
+    String,
+    Array,
+    Object,
+    TypedArray,
+    // a typed array whose storage travels in Message::transferred
+    Transferred,
+    // a SharedArrayBuffer, and a typed array over one, by their storage in
+    // Message::shared
+    SharedBuffer,
+    SharedView,
+    // an object or array already written, by the order it was first seen
+    Reference
+};
+
+class Writer {
+
+public:
+    StructuredClone::Message message;
+
+    explicit Writer(const vector<Value>& transfer) {
+
+        for (const Value& item : transfer) {
+
+            if (item.type != ValueType::OBJECT || !item.objectValue->is_typed_array) {
+                throw runtime_error("DataCloneError: only typed arrays and Buffers can be transferred");
+            }
+
+            auto* typed = static_cast<JSTypedArray*>(item.objectValue.get());
+            if (typed->storage->shared) {
+                throw runtime_error("DataCloneError: shared memory cannot be transferred");
+            }
+            // a second view over the storage would keep using it
+            if (typed->storage.use_count() > 1) {
+                throw runtime_error("DataCloneError: a typed array with other views over its storage cannot be transferred");
+            }
+
+            transfers[typed] = message.transferred.size();
+            message.transferred.push_back(typed->storage);
+
+        }
+
+    }
+
+    // the sender's transferred views end up empty
+    void detach() {
+        for (auto& [typed, index] : transfers) {
+            typed->storage = ByteStorage::allocate(0);
+            typed->byte_offset = 0;
+            typed->length = 0;
+        }
+    }
+
+    void write(const Value& value) {
+
+        switch (value.type) {
+            case ValueType::UNDEFINED:
+                put(Tag::Undefined);
+                return;
+            case ValueType::NULLTYPE:
+                put(Tag::Null);
+                return;
+            case ValueType::BOOLEAN:
+                put(value.boolValue ? Tag::True : Tag::False);
+                return;
+            case ValueType::NUMBER:
+                put(Tag::Number);
+                putRaw(&value.numberValue, sizeof(double));
+                return;
+            case ValueType::STRING:
+                put(Tag::String);
+                putString(value.stringValue.str());
+                return;
+            case ValueType::ARRAY:
+                writeArray(value.arrayValue.get());
+                return;
+            case ValueType::OBJECT:
+                writeObject(value.objectValue.get());
+                return;
+            default:
+                throw runtime_error("DataCloneError: " + value.toString() + " could not be cloned");
+        }
+
+    }
+
+private:
+    unordered_map<const void*, size_t> seen;
+    unordered_map<JSTypedArray*, size_t> transfers;
+
+    void put(Tag tag) {
+        message.bytes.push_back((char)tag);
+    }
+
+    void putRaw(const void* data, size_t size) {
+        message.bytes.append((const char*)data, size);
+    }
+
+    void putSize(size_t size) {
+        uint64_t n = size;
+        putRaw(&n, sizeof(n));
+    }
+
+    void putString(const string& s) {
+        putSize(s.size());
+        message.bytes.append(s);
+    }
+
+    // writes a back reference and returns true for an object seen before
+    bool reference(const void* object) {
+
+        auto it = seen.find(object);
+        if (it != seen.end()) {
+            put(Tag::Reference);
+            putSize(it->second);
+            return true;
+        }
+
+        size_t index = seen.size();
+        seen[object] = index;
+        return false;
+
+    }
+
+    void writeArray(JSArray* array) {
+
+        if (reference(array)) return;
+
+        put(Tag::Array);
+        putSize(array->elements.size());
+        for (const Value& element : array->elements) write(element);
+
+    }
+
+    void writeObject(JSObject* object) {
+
+        if (reference(object)) return;
+
+        if (object->is_typed_array) {
+            writeTypedArray(static_cast<JSTypedArray*>(object));
+            return;
+        }
+
+        if (auto* buffer = dynamic_cast<JSSharedArrayBuffer*>(object)) {
+            put(Tag::SharedBuffer);
+            putSize(share(buffer->storage));
+            return;
+        }
+
+        // own public properties, as JSON.stringify sees them
+        vector<Atom> keys;
+        for (const Atom& key : object->own_keys()) {
+            const vector<string>& modifiers = object->get_modifiers(key);
+            if (find(modifiers.begin(), modifiers.end(), "private") != modifiers.end() ||
+                find(modifiers.begin(), modifiers.end(), "protected") != modifiers.end()) {
+                continue;
+            }
+            keys.push_back(key);
+        }
+
+        put(Tag::Object);
+        putSize(keys.size());
+        for (const Atom& key : keys) {
+            putString(key.str());
+            write(object->get(key));
+        }
+
+    }
+
+    // index of storage in Message::shared, adding it the first time
+    size_t share(const shared_ptr<ByteStorage>& storage) {
+
+        auto& shared = message.shared;
+        auto it = find(shared.begin(), shared.end(), storage);
+        if (it != shared.end()) return it - shared.begin();
+
+        shared.push_back(storage);
+        return shared.size() - 1;
+
+    }
+
+    void writeTypedArray(JSTypedArray* typed) {
+
+        auto it = transfers.find(typed);
+
+        if (typed->storage->shared) {
+            put(Tag::SharedView);
+            putSize(share(typed->storage));
+        } else if (it != transfers.end()) {
+            put(Tag::Transferred);
+            putSize(it->second);
+        } else {
+            put(Tag::TypedArray);
+        }
+
+        put((Tag)typed->kind);
+        put(typed->is_buffer ? Tag::True : Tag::False);
+        putSize(typed->length);
+
+        if (typed->storage->shared || it != transfers.end()) {
+            putSize(typed->byte_offset);
+        } else {
+            putRaw(typed->bytes(), typed->byteLength());
+        }
+
+    }
+
+};
+
+class Reader {
+
+public:
+    explicit Reader(StructuredClone::Message& message)
+        : message(message), p(message.bytes.data()), end(p + message.bytes.size()) {}
+
+    Value read() {
+
+        switch (take()) {
+            case Tag::Undefined:
+                return Value::undefined();
+            case Tag::Null:
+                return Value::nullVal();
+            case Tag::False:
+                return Value::boolean(false);
+            case Tag::True:
+                return Value::boolean(true);
+            case Tag::Number: {
+                double n;
+                takeRaw(&n, sizeof(n));
+                return Value::number(n);
+            }
+            case Tag::String:
+                return Value::str(takeString());
+            case Tag::Array: {
+                auto array = make_shared<JSArray>();
+                objects.push_back(Value::array(array));
+                size_t length = takeSize();
+                array->elements.reserve(length);
+                for (size_t i = 0; i < length; i++) array->elements.push_back(read());
+                return Value::array(array);
+            }
+            case Tag::Object: {
+                auto object = make_shared<JSObject>();
+                object->set_as_object_literal();
+                objects.push_back(Value::object(object));
+                size_t count = takeSize();
+                for (size_t i = 0; i < count; i++) {
+                    Atom key(takeString());
+                    object->set(key, read());
+                }
+                return Value::object(object);
+            }
+            case Tag::TypedArray:
+            case Tag::Transferred:
+            case Tag::SharedView:
+                p--;
+                return readTypedArray();
+            case Tag::SharedBuffer: {
+                auto buffer = make_shared<JSSharedArrayBuffer>(sharedStorage(takeSize()));
+                objects.push_back(Value::object(buffer));
+                return Value::object(buffer);
+            }
+            case Tag::Reference: {
+                size_t index = takeSize();
+                if (index >= objects.size()) fail();
+                return objects[index];
+            }
+        }
+
+        fail();
+        return Value::undefined();
+
+    }
+
+private:
+    StructuredClone::Message& message;
+    const char* p;
+    const char* end;
+    vector<Value> objects;
+
+    [[noreturn]] void fail() {
+        throw runtime_error("DataCloneError: malformed message");
+    }
+
+    void takeRaw(void* out, size_t size) {
+        if ((size_t)(end - p) < size) fail();
+        memcpy(out, p, size);
+        p += size;
+    }
+
+    Tag take() {
+        uint8_t tag;
+        takeRaw(&tag, 1);
+        return (Tag)tag;
+    }
+
+    size_t takeSize() {
+        uint64_t n;
+        takeRaw(&n, sizeof(n));
+        return (size_t)n;
+    }
+
+    string takeString() {
+        size_t size = takeSize();
+        if ((size_t)(end - p) < size) fail();
+        string s(p, size);
+        p += size;
+        return s;
+    }
+
+    const shared_ptr<ByteStorage>& sharedStorage(size_t index) {
+        if (index >= message.shared.size()) fail();
+        return message.shared[index];
+    }
+
+    Value readTypedArray() {
+
+        Tag tag = take();
+        bool transferred = tag == Tag::Transferred;
+        bool shared = tag == Tag::SharedView;
+        size_t index = transferred || shared ? takeSize() : 0;
+        auto kind = (TypedArrayKind)take();
+        bool is_buffer = take() == Tag::True;
+        size_t length = takeSize();
+
+        shared_ptr<JSTypedArray> typed;
+
+        if (shared) {
+            size_t byte_offset = takeSize();
+            typed = make_shared<JSTypedArray>(kind, sharedStorage(index), byte_offset, length, is_buffer);
+        } else if (transferred) {
+            size_t byte_offset = takeSize();
+            if (index >= message.transferred.size() || !message.transferred[index]) fail();
+            // the new view is the storage's only owner, so it can be transferred on
+            typed = make_shared<JSTypedArray>(kind, std::move(message.transferred[index]), byte_offset, length, is_buffer);
+        } else {
+            typed = make_shared<JSTypedArray>(kind, length, is_buffer);
+            takeRaw(typed->bytes(), typed->byteLength());
+        }
+
+        objects.push_back(Value::object(typed));
+        return Value::object(typed);
+
+    }
+
+};
+
+}
+
+StructuredClone::Message StructuredClone::serialize(const Value& value, const vector<Value>& transfer) {
+
+    Writer writer(transfer);
+    writer.write(value);
+    writer.detach();
+
+    return std::move(writer.message);
+
+}
+
+Value StructuredClone::deserialize(Message message) {
+    return Reader(message).read();
+}
@@ -0,0 +1,44 @@
+//
+//  StructuredClone.hpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 19/10/2026.
+//
+
+#ifndef StructuredClone_hpp
+#define StructuredClone_hpp
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "Interpreter/ExecutionContext/Value/Value.h"
+#include "Interpreter/ExecutionContext/JSTypedArray/JSTypedArray.h"
+
+// Copies a Value graph between threads. serialize() flattens it into bytes
+// on the sending thread and deserialize() builds a fresh graph from them on
+// the receiving one, so the two threads never share an object. Primitives,
+// arrays, plain objects and typed arrays are cloned; shared and cyclic
+// references come out shared and cyclic. Functions, classes and promises
+// cannot be cloned and throw a DataCloneError.
+//
+// Typed arrays named in the transfer list move instead of being copied: the
+// receiver gets their storage and the sender's views are left empty. A
+// SharedArrayBuffer, and any typed array over one, is never copied: both
+// sides end up looking at the same memory.
+class StructuredClone {
+
+public:
+    struct Message {
+        string bytes;
+        vector<shared_ptr<ByteStorage>> transferred;
+        vector<shared_ptr<ByteStorage>> shared;
+    };
+
+    static Message serialize(const Value& value, const vector<Value>& transfer = {});
+    static Value deserialize(Message message);
+
+};
+
+#endif /* StructuredClone_hpp */
@@ -0,0 +1,309 @@
+//
+//  Worker.cpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 19/10/2026.
+//
+
+#include "Worker.hpp"
+#include "StructuredClone.hpp"
+
+#include <thread>
+#include <mutex>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <stdexcept>
+
+#include "EventLoop/EventLoop.hpp"
+#include "engines/Peregrine/PeregrineVM.hpp"
+#include "engines/Peregrine/peregrine/PeregrineCodeGen.hpp"
+#include "Parser/Parser.hpp"
+#include "Scanner/Scanner.hpp"
+
+namespace {
+
+// What the parent and the worker thread share. handle is only touched on
+// the parent's thread and port only on the worker's; the rest is guarded
+// by mutex.
+struct WorkerChannel {
+    mutex mtx;
+    EventLoop* parentLoop = nullptr;
+    // the worker's loop, while it runs
+    EventLoop* workerLoop = nullptr;
+    // messages posted before the worker's loop existed
+    vector<StructuredClone::Message> pending;
+    // the worker accepts no more messages
+    bool closed = false;
+    thread runner;
+
+    // the Worker object, kept alive until the thread exits
+    shared_ptr<JSObject> handle;
+    // parentPort, and whether it still keeps the worker's loop running
+    shared_ptr<JSObject> port;
+    bool alive = false;
+};
+
+bool isCallable(const Value& v) {
+    return v.type == ValueType::CLOSURE ||
+        v.type == ValueType::FUNCTION ||
+        v.type == ValueType::NATIVE_FUNCTION;
+}
+
+// calls target.<name>(event), if the script set one
+bool dispatch(const shared_ptr<JSObject>& target, const string& name, const string& key, const Value& value) {
+
+    Value handler = target ? target->get(name) : Value::undefined();
+    if (!isCallable(handler)) return false;
+
+    auto event = make_shared<JSObject>();
+    event->set_as_object_literal();
+    event->set(key, value);
+
+    Value arg = Value::object(event);
+    Callback callback(handler);
+    callback(&arg, 1);
+
+    return true;
+
+}
+
+void reportError(const shared_ptr<WorkerChannel>& channel, const string& message) {
+
+    channel->parentLoop->post([channel, message](vector<Value>) -> Value {
+        if (!dispatch(channel->handle, "onerror", "message", Value::str(message))) {
+            cerr << "Uncaught error in worker: " << message << "\n";
+        }
+        return Value::undefined();
+    }, {});
+
+}
+
+// worker thread: stop keeping the loop alive for messages
+void release(const shared_ptr<WorkerChannel>& channel) {
+
+    {
+        lock_guard<mutex> lock(channel->mtx);
+        channel->closed = true;
+    }
+
+    if (channel->alive) {
+        channel->alive = false;
+        channel->workerLoop->unref();
+    }
+
+}
+
+// worker thread: hands a message to parentPort.onmessage
+void deliverToWorker(const shared_ptr<WorkerChannel>& channel, StructuredClone::Message& message) {
+    try {
+        dispatch(channel->port, "onmessage", "data", StructuredClone::deserialize(std::move(message)));
+    } catch (const std::exception& e) {
+        reportError(channel, e.what());
+    }
+}
+
+void postToWorker(const shared_ptr<WorkerChannel>& channel, StructuredClone::Message message) {
+
+    lock_guard<mutex> lock(channel->mtx);
+
+    if (channel->closed) return;
+
+    if (channel->workerLoop == nullptr) {
+        channel->pending.push_back(std::move(message));
+        return;
+    }
+
+    auto shared = make_shared<StructuredClone::Message>(std::move(message));
+    channel->workerLoop->post([channel, shared](vector<Value>) -> Value {
+        deliverToWorker(channel, *shared);
+        return Value::undefined();
+    }, {});
+
+}
+
+void postToParent(const shared_ptr<WorkerChannel>& channel, StructuredClone::Message message) {
+
+    auto shared = make_shared<StructuredClone::Message>(std::move(message));
+    channel->parentLoop->post([channel, shared](vector<Value>) -> Value {
+        dispatch(channel->handle, "onmessage", "data", StructuredClone::deserialize(std::move(*shared)));
+        return Value::undefined();
+    }, {});
+
+}
+
+vector<Value> transferList(const vector<Value>& args) {
+
+    if (args.size() < 2 || args[1].type == ValueType::UNDEFINED) return {};
+
+    if (args[1].type != ValueType::ARRAY) {
+        throw runtime_error("TypeError: postMessage expects the transfer list to be an array");
+    }
+
+    return args[1].arrayValue->elements;
+
+}
+
+string readSource(const string& path) {
+
+    ifstream file(path);
+    if (!file.is_open()) {
+        throw runtime_error("Could not open worker script: " + path);
+    }
+
+    ostringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+
+}
+
+shared_ptr<JSObject> makePort(const shared_ptr<WorkerChannel>& channel) {
+
+    auto port = make_shared<JSObject>();
+
+    port->set_builtin_value("postMessage", Value::native([channel](const vector<Value>& args) -> Value {
+        Value value = args.empty() ? Value::undefined() : args[0];
+        postToParent(channel, StructuredClone::serialize(value, transferList(args)));
+        return Value::undefined();
+    }));
+
+    port->set_builtin_value("close", Value::native([channel](const vector<Value>& args) -> Value {
+        release(channel);
+        return Value::undefined();
+    }));
+
+    return port;
+
+}
+
+void runWorker(shared_ptr<WorkerChannel> channel, string path) {
+
+    EventLoop loop;
+    EventLoop::current() = &loop;
+
+    {
+        lock_guard<mutex> lock(channel->mtx);
+        channel->workerLoop = &loop;
+        if (!channel->closed) {
+            // released by close(), terminate() or a script without onmessage
+            loop.ref();
+            channel->alive = true;
+        }
+        for (auto& message : channel->pending) {
+            auto shared = make_shared<StructuredClone::Message>(std::move(message));
+            loop.post([channel, shared](vector<Value>) -> Value {
+                deliverToWorker(channel, *shared);
+                return Value::undefined();
+            }, {});
+        }
+        channel->pending.clear();
+    }
+
+    channel->port = makePort(channel);
+
+    try {
+
+        auto text = make_shared<string>(readSource(path));
+        Scanner scanner(*text);
+        Parser parser(scanner);
+        parser.sourceFile = path;
+        if (defer_function_bodies) parser.deferFunctionBodies(text);
+        auto ast = parser.parse();
+
+        auto module_ = make_shared<TurboModule>();
+        // the parent owns stdout; a worker's bytecode would interleave with it
+        module_->disassemble = false;
+        PeregrineCodeGen codegen(module_);
+        codegen.generate(ast);
+
+        // the VM runs the worker's loop to the end as it is destroyed
+        PeregrineVM vm(module_);
+        vm.env->set_var("parentPort", Value::object(channel->port));
+
+        try {
+            vm.run(module_->chunks[module_->entryChunkIndex], {});
+        } catch (const std::exception& e) {
+            reportError(channel, e.what());
+            release(channel);
+        }
+
+        if (!isCallable(channel->port->get("onmessage"))) {
+            release(channel);
+        }
+
+    } catch (const std::exception& e) {
+        reportError(channel, e.what());
+        release(channel);
+    }
+
+    channel->port.reset();
+
+    {
+        lock_guard<mutex> lock(channel->mtx);
+        channel->workerLoop = nullptr;
+    }
+    EventLoop::current() = nullptr;
+
+    channel->parentLoop->post([channel](vector<Value>) -> Value {
+        channel->runner.join();
+        dispatch(channel->handle, "onexit", "code", Value::number(0));
+        channel->handle.reset();
+        channel->parentLoop->unref();
+        return Value::undefined();
+    }, {});
+
+}
+
+}
+
+shared_ptr<JSObject> Worker::construct() {
+
+    auto worker = make_shared<JSObject>();
+    auto channel = make_shared<WorkerChannel>();
+    weak_ptr<JSObject> self = worker;
+
+    worker->set_builtin_value("constructor", Value::native([channel, self](const vector<Value>& args) -> Value {
+
+        if (args.empty() || args[0].type != ValueType::STRING) {
+            throw runtime_error("TypeError: Worker expects the path of a script");
+        }
+
+        string path = std::filesystem::absolute(args[0].toString()).string();
+
+        channel->parentLoop = &EventLoop::getInstance();
+        channel->handle = self.lock();
+        // the parent's loop waits for the worker to exit
+        channel->parentLoop->ref();
+        channel->runner = thread(runWorker, channel, path);
+
+        return Value();
+
+    }));
+
+    worker->set_builtin_value("postMessage", Value::native([channel](const vector<Value>& args) -> Value {
+        Value value = args.empty() ? Value::undefined() : args[0];
+        postToWorker(channel, StructuredClone::serialize(value, transferList(args)));
+        return Value::undefined();
+    }));
+
+    worker->set_builtin_value("terminate", Value::native([channel](const vector<Value>& args) -> Value {
+
+        lock_guard<mutex> lock(channel->mtx);
+
+        if (channel->closed) return Value::undefined();
+        channel->closed = true;
+
+        if (channel->workerLoop != nullptr) {
+            channel->workerLoop->post([channel](vector<Value>) -> Value {
+                release(channel);
+                return Value::undefined();
+            }, {});
+        }
+
+        return Value::undefined();
+
+    }));
+
+    return worker;
+
+}
@@ -0,0 +1,45 @@
+//
+//  Worker.hpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 19/10/2026.
+//
+
+#ifndef Worker_hpp
+#define Worker_hpp
+
+#include <stdio.h>
+#include "Interpreter/ExecutionContext/JSObject/JSObject.h"
+#include "Interpreter/ExecutionContext/JSClass/JSClass.h"
+
+// Runs a script on its own thread, with its own Peregrine VM and event
+// loop. The two sides share nothing: messages are structured clones (see
+// StructuredClone), delivered on the receiver's event loop.
+//
+//    let worker = new Worker("worker.ardan");
+//    worker.onmessage = (event) => { print(event.data); worker.terminate(); };
+//    worker.postMessage({ n: 10 });
+//
+//    // worker.ardan
+//    parentPort.onmessage = (event) => {
+//        parentPort.postMessage(event.data.n * 2);
+//    };
+//
+// postMessage(value, [buffer, ...]) moves the listed typed arrays instead
+// of copying them. A worker keeps running while parentPort.onmessage is
+// set, until it calls parentPort.close() or the parent calls terminate();
+// terminate() waits for the message being handled, it cannot interrupt a
+// running script. onerror receives { message } for an error thrown in the
+// worker, and onexit runs once its thread has finished.
+class Worker : public JSClass {
+
+public:
+    Worker() {
+        is_native = true;
+    }
+
+    shared_ptr<JSObject> construct() override;
+
+};
+
+#endif /* Worker_hpp */
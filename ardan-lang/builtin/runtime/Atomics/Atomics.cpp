@@ -0,0 +1,210 @@
+//
+//  Atomics.cpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 19/10/2026.
+//
+
+#include "Atomics.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <list>
+#include <unordered_map>
+#include <cmath>
+#include <stdexcept>
+
+#include "Interpreter/ExecutionContext/JSTypedArray/JSTypedArray.h"
+
+namespace {
+
+// the element an operation works on, checked once
+struct Element {
+    JSTypedArray* array;
+    uint8_t* address;
+};
+
+Element element(const vector<Value>& args, const string& name) {
+
+    if (args.empty() || args[0].type != ValueType::OBJECT || !args[0].objectValue->is_typed_array) {
+        throw runtime_error("TypeError: Atomics." + name + " expects an integer typed array");
+    }
+
+    auto* array = static_cast<JSTypedArray*>(args[0].objectValue.get());
+    if (array->kind == TypedArrayKind::Float64) {
+        throw runtime_error("TypeError: Atomics." + name + " expects an integer typed array");
+    }
+
+    double index = args.size() > 1 ? args[1].numberValue : 0;
+    if (!(index >= 0) || index >= (double)array->length || index != std::trunc(index)) {
+        throw runtime_error("RangeError: Atomics." + name + " index " + Value::number(index).toString() + " is out of range");
+    }
+
+    return { array, array->bytes() + (size_t)index * JSTypedArray::elementSize(array->kind) };
+
+}
+
+double argument(const vector<Value>& args, size_t i) {
+    return args.size() > i ? args[i].numberValue : 0;
+}
+
+// runs op on the element as a std::atomic_ref of its own width and
+// returns what op returns
+template <typename Op>
+double atomically(const Element& at, Op op) {
+
+    if (at.array->kind == TypedArrayKind::Int32) {
+        atomic_ref<int32_t> cell(*reinterpret_cast<int32_t*>(at.address));
+        return (double)op(cell, [](double v) { return (int32_t)toUint32(v); });
+    }
+
+    atomic_ref<uint8_t> cell(*at.address);
+    return (double)op(cell, [](double v) { return (uint8_t)(toUint32(v) & 0xff); });
+
+}
+
+// Atomics.wait/notify: threads waiting on an address queue up in arrival
+// order and notify wakes them from the front. The value check and the
+// enqueue happen under the same lock notify takes, so a store followed by
+// notify cannot slip in between and be missed.
+struct Waiter {
+    condition_variable wake;
+    bool notified = false;
+};
+
+mutex& waitMutex() {
+    static auto* mtx = new mutex();
+    return *mtx;
+}
+
+unordered_map<const void*, list<Waiter*>>& waitLists() {
+    static auto* lists = new unordered_map<const void*, list<Waiter*>>();
+    return *lists;
+}
+
+Element sharedInt32(const vector<Value>& args, const string& name) {
+
+    Element at = element(args, name);
+
+    if (at.array->kind != TypedArrayKind::Int32 || !at.array->storage->shared) {
+        throw runtime_error("TypeError: Atomics." + name + " expects an Int32Array over a SharedArrayBuffer");
+    }
+
+    return at;
+
+}
+
+}
+
+Atomics::Atomics() {
+
+    set_builtin_value("load", Value::native([](const std::vector<Value>& args) -> Value {
+        return Value::number(atomically(element(args, "load"), [](auto& cell, auto) {
+            return cell.load();
+        }));
+    }));
+
+    // returns the value stored, as converted to the element type
+    set_builtin_value("store", Value::native([](const std::vector<Value>& args) -> Value {
+        double value = argument(args, 2);
+        return Value::number(atomically(element(args, "store"), [value](auto& cell, auto convert) {
+            auto v = convert(value);
+            cell.store(v);
+            return v;
+        }));
+    }));
+
+    set_builtin_value("add", Value::native([](const std::vector<Value>& args) -> Value {
+        double value = argument(args, 2);
+        return Value::number(atomically(element(args, "add"), [value](auto& cell, auto convert) {
+            return cell.fetch_add(convert(value));
+        }));
+    }));
+
+    set_builtin_value("sub", Value::native([](const std::vector<Value>& args) -> Value {
+        double value = argument(args, 2);
+        return Value::number(atomically(element(args, "sub"), [value](auto& cell, auto convert) {
+            return cell.fetch_sub(convert(value));
+        }));
+    }));
+
+    set_builtin_value("exchange", Value::native([](const std::vector<Value>& args) -> Value {
+        double value = argument(args, 2);
+        return Value::number(atomically(element(args, "exchange"), [value](auto& cell, auto convert) {
+            return cell.exchange(convert(value));
+        }));
+    }));
+
+    set_builtin_value("compareExchange", Value::native([](const std::vector<Value>& args) -> Value {
+        double expected = argument(args, 2);
+        double replacement = argument(args, 3);
+        return Value::number(atomically(element(args, "compareExchange"), [expected, replacement](auto& cell, auto convert) {
+            auto seen = convert(expected);
+            cell.compare_exchange_strong(seen, convert(replacement));
+            return seen;
+        }));
+    }));
+
+    set_builtin_value("wait", Value::native([](const std::vector<Value>& args) -> Value {
+
+        Element at = sharedInt32(args, "wait");
+        int32_t expected = (int32_t)toUint32(argument(args, 2));
+        double timeout = args.size() > 3 && args[3].type != ValueType::UNDEFINED ? args[3].numberValue : INFINITY;
+
+        atomic_ref<int32_t> cell(*reinterpret_cast<int32_t*>(at.address));
+
+        unique_lock<mutex> lock(waitMutex());
+
+        if (cell.load() != expected) return Value::str("not-equal");
+
+        Waiter waiter;
+        auto& queue = waitLists()[at.address];
+        auto position = queue.insert(queue.end(), &waiter);
+
+        if (std::isinf(timeout) && timeout > 0) {
+            waiter.wake.wait(lock, [&waiter] { return waiter.notified; });
+        } else {
+            auto span = chrono::duration<double, milli>(timeout > 0 ? timeout : 0);
+            waiter.wake.wait_for(lock, span, [&waiter] { return waiter.notified; });
+        }
+
+        if (waiter.notified) return Value::str("ok");
+
+        queue.erase(position);
+        if (queue.empty()) waitLists().erase(at.address);
+
+        return Value::str("timed-out");
+
+    }));
+
+    // wakes up to count waiters (all by default) and returns how many woke
+    set_builtin_value("notify", Value::native([](const std::vector<Value>& args) -> Value {
+
+        Element at = sharedInt32(args, "notify");
+        double count = args.size() > 2 && args[2].type != ValueType::UNDEFINED ? args[2].numberValue : INFINITY;
+
+        lock_guard<mutex> lock(waitMutex());
+
+        auto it = waitLists().find(at.address);
+        if (it == waitLists().end()) return Value::number(0);
+
+        auto& queue = it->second;
+        double woken = 0;
+
+        while (!queue.empty() && woken < count) {
+            Waiter* waiter = queue.front();
+            queue.pop_front();
+            waiter->notified = true;
+            waiter->wake.notify_one();
+            woken++;
+        }
+
+        if (queue.empty()) waitLists().erase(it);
+
+        return Value::number(woken);
+
+    }));
+
+}
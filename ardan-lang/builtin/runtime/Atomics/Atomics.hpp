@@ -0,0 +1,32 @@
+//
+//  Atomics.hpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 19/10/2026.
+//
+
+#ifndef Atomics_hpp
+#define Atomics_hpp
+
+#include <stdio.h>
+#include "Interpreter/ExecutionContext/JSObject/JSObject.h"
+
+// Atomic operations on Int32Array and Uint8Array elements, for typed arrays
+// over a SharedArrayBuffer that several Workers use at once:
+//
+//    Atomics.load(a, i)                     Atomics.store(a, i, v)
+//    Atomics.add(a, i, v)                   Atomics.sub(a, i, v)
+//    Atomics.exchange(a, i, v)              Atomics.compareExchange(a, i, expected, v)
+//
+// The read-modify-write calls return the element's previous value.
+// Atomics.wait(a, i, value[, timeoutMs]) sleeps while a[i] == value until
+// Atomics.notify(a, i[, count]) wakes it, returning "ok", "not-equal" or
+// "timed-out"; both need an Int32Array over shared memory.
+class Atomics : public JSObject {
+
+public:
+    Atomics();
+
+};
+
+#endif /* Atomics_hpp */
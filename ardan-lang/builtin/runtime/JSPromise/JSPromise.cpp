@@ -15,18 +15,27 @@ shared_ptr<JSObject> JSPromise::construct() {
     promise->set_builtin_value("constructor", Value::native([this, promise](const std::vector<Value>& args) -> Value {
 
         auto resolve = Value::native([this, promise](vector<Value> args) -> Value {
-            promise->resolve(args[0]);
+            promise->resolve(args.empty() ? Value::undefined() : args[0]);
             return Value();
         });
         
         auto reject = Value::native([this, promise](vector<Value> args) -> Value {
-            promise->reject(args[0]);
+            promise->reject(args.empty() ? Value::undefined() : args[0]);
             return Value();
         });
 
+        if (args.empty() || vm == nullptr) {
+            return Value();
+        }
+
+        // the executor runs synchronously; a throw rejects the promise
+        try {
+            vm->callFunction(args[0], { resolve, reject });
+        } catch (const std::exception& e) {
+            promise->reject(Value::str(e.what()));
+        }
+
         return Value();
-        // TODO: find a better way to hook into VM
-        // return vm->callFunction(args[0], { resolve, reject });
 
     }));
 
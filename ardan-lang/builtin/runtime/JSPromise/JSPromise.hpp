@@ -26,7 +26,17 @@ public:
             
             auto promise = make_shared<Promise>(vm);
             
-            promise->resolve(args[0]);
+            promise->resolve(args.empty() ? Value::undefined() : args[0]);
+            
+            return Value::promise(promise);
+
+        }), {});
+        
+        set_var("reject", Value::native([this, vm](const std::vector<Value>& args) -> Value {
+            
+            auto promise = make_shared<Promise>(vm);
+            
+            promise->reject(args.empty() ? Value::undefined() : args[0]);
             
             return Value::promise(promise);
 
@@ -0,0 +1,113 @@
+//
+//  TypedArray.cpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#include "TypedArray.hpp"
+#include "Statements/Statements.hpp"
+
+shared_ptr<JSObject> TypedArray::construct() {
+
+    auto array = make_shared<JSTypedArray>(kind, 0, is_buffer);
+    JSTypedArray* target = array.get();
+
+    array->set_builtin_value("constructor", Value::native([target](const std::vector<Value>& args) -> Value {
+        target->assign(args);
+        return Value();
+    }));
+
+    return array;
+
+}
+
+Value TypedArray::call(const std::vector<Value>& args) {
+
+    auto array = make_shared<JSTypedArray>(kind, 0, is_buffer);
+    array->assign(args);
+
+    return Value::object(array);
+
+}
+
+Buffer::Buffer() : TypedArray(TypedArrayKind::Uint8, true) {
+
+    set_var("from", Value::native([this](const std::vector<Value>& args) -> Value {
+        return call(args);
+    }), {});
+
+    set_var("alloc", Value::native([this](const std::vector<Value>& args) -> Value {
+
+        size_t size = args.size() > 0 ? (size_t)args[0].numberValue : 0;
+        auto buffer = make_shared<JSTypedArray>(TypedArrayKind::Uint8, size, true);
+
+        if (args.size() > 1) {
+            memset(buffer->bytes(), toUint32(args[1].numberValue) & 0xff, size);
+        }
+
+        return Value::object(buffer);
+
+    }), {});
+
+    set_var("concat", Value::native([](const std::vector<Value>& args) -> Value {
+
+        if (args.empty() || args[0].type != ValueType::ARRAY) {
+            throw runtime_error("Buffer.concat expects an array of buffers");
+        }
+
+        auto list = args[0].arrayValue;
+        size_t total = 0;
+
+        for (size_t i = 0; i < list->length(); i++) {
+            Value part = list->getIndex(i);
+            if (part.type != ValueType::OBJECT || !part.objectValue->is_typed_array) {
+                throw runtime_error("Buffer.concat expects an array of buffers");
+            }
+            total += static_cast<JSTypedArray*>(part.objectValue.get())->byteLength();
+        }
+
+        auto buffer = make_shared<JSTypedArray>(TypedArrayKind::Uint8, total, true);
+        size_t offset = 0;
+
+        for (size_t i = 0; i < list->length(); i++) {
+            auto* part = static_cast<JSTypedArray*>(list->getIndex(i).objectValue.get());
+            memcpy(buffer->bytes() + offset, part->bytes(), part->byteLength());
+            offset += part->byteLength();
+        }
+
+        return Value::object(buffer);
+
+    }), {});
+
+    set_var("isBuffer", Value::native([](const std::vector<Value>& args) -> Value {
+        bool is_buffer = !args.empty() &&
+            args[0].type == ValueType::OBJECT &&
+            args[0].objectValue->is_typed_array &&
+            static_cast<JSTypedArray*>(args[0].objectValue.get())->is_buffer;
+        return Value::boolean(is_buffer);
+    }), {});
+
+}
+
+shared_ptr<JSObject> SharedArrayBuffer::construct() {
+
+    auto buffer = make_shared<JSSharedArrayBuffer>(0);
+    JSSharedArrayBuffer* target = buffer.get();
+
+    buffer->set_builtin_value("constructor", Value::native([target](const std::vector<Value>& args) -> Value {
+
+        double size = args.size() > 0 ? args[0].numberValue : 0;
+        if (!(size >= 0) || !std::isfinite(size)) {
+            throw runtime_error("RangeError: invalid SharedArrayBuffer length");
+        }
+
+        target->storage = ByteStorage::allocate((size_t)size);
+        target->storage->shared = true;
+        return Value();
+
+    }));
+
+    return buffer;
+
+}
@@ -0,0 +1,57 @@
+//
+//  TypedArray.hpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#ifndef TypedArray_hpp
+#define TypedArray_hpp
+
+#include <stdio.h>
+#include "Interpreter/ExecutionContext/JSObject/JSObject.h"
+#include "Interpreter/ExecutionContext/JSClass/JSClass.h"
+#include "Interpreter/ExecutionContext/JSArray/JSArray.h"
+#include "Interpreter/ExecutionContext/JSTypedArray/JSTypedArray.h"
+
+// Uint8Array, Int32Array and Float64Array constructors:
+// new Int32Array(4), new Float64Array([1.5, 2]), new Uint8Array(other)
+class TypedArray : public JSClass {
+
+public:
+    TypedArray(TypedArrayKind kind, bool is_buffer = false) : kind(kind), is_buffer(is_buffer) {
+        is_native = true;
+    }
+
+    shared_ptr<JSObject> construct() override;
+    Value call(const std::vector<Value>& args) override;
+
+protected:
+    TypedArrayKind kind;
+    bool is_buffer;
+
+};
+
+// Node-style Buffer: Buffer.from(string | array | buffer), Buffer.alloc(n),
+// Buffer.concat(list), Buffer.isBuffer(v)
+class Buffer : public TypedArray {
+
+public:
+    Buffer();
+
+};
+
+// new SharedArrayBuffer(byteLength): memory a Worker can see too. View it
+// with a typed array: new Int32Array(shared[, byteOffset[, length]])
+class SharedArrayBuffer : public JSClass {
+
+public:
+    SharedArrayBuffer() {
+        is_native = true;
+    }
+
+    shared_ptr<JSObject> construct() override;
+
+};
+
+#endif /* TypedArray_hpp */
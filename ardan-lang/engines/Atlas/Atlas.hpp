@@ -0,0 +1,21 @@
+//
+//  Atlas.hpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#ifndef Atlas_hpp
+#define Atlas_hpp
+
+#include <stdio.h>
+#include <memory>
+
+#include "engines/Nova/TurboModule.hpp"
+
+// Atlas keeps its own ExecutionContext and call-frame types, so its headers
+// cannot be included next to the other engines. This is the entry point for
+// code outside engines/Atlas.
+void runAtlas(std::shared_ptr<TurboModule> module_);
+
+#endif /* Atlas_hpp */
@@ -6,6 +6,7 @@
 //
 
 #include "InterpreterTurboVMV2.hpp"
+#include "Atlas.hpp"
 
 InterpreterTurboVMV2::InterpreterTurboVMV2() {
     //env = new Env();
@@ -49,14 +50,21 @@ void InterpreterTurboVMV2::init_builtins() {
     event_loop = new EventLoop();
     
     env->set_var("Math", make_shared<Math>());
+    env->set_var("JSON", make_shared<JSON>());
     env->set_var("console", make_shared<Print>());
-    env->set_var("fs", make_shared<File>());
+    env->set_var("fs", make_shared<File>(this));
     env->set_var("Server", make_shared<Server>(event_loop));
     
     env->set_var("String", make_shared<JSString>());
     env->set_var("Number", make_shared<JSNumber>());
     env->set_var("Boolean", make_shared<JSBoolean>());
     env->set_var("Array", make_shared<Array>());
+    env->set_var("Uint8Array", make_shared<TypedArray>(TypedArrayKind::Uint8));
+    env->set_var("Int32Array", make_shared<TypedArray>(TypedArrayKind::Int32));
+    env->set_var("Float64Array", make_shared<TypedArray>(TypedArrayKind::Float64));
+    env->set_var("Buffer", make_shared<Buffer>());
+    env->set_var("SharedArrayBuffer", make_shared<SharedArrayBuffer>());
+    env->set_var("Atomics", make_shared<Atomics>());
     
     env->set_var("print", Value::function([this](vector<Value> args) mutable -> Value {
         Print::print(args);
@@ -1764,3 +1772,8 @@ void InterpreterTurboVMV2::handleRethrow() {
         //running = false;
     }
 }
+
+void runAtlas(shared_ptr<TurboModule> module_) {
+    InterpreterTurboVMV2 vm(module_);
+    vm.run(module_->chunks[module_->entryChunkIndex], {});
+}
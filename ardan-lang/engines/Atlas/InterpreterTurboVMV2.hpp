@@ -5,8 +5,8 @@
 //  Created by Chidume Nnamdi on 19/09/2025.
 //
 
-#ifndef TurboVM_hpp
-#define TurboVM_hpp
+#ifndef InterpreterTurboVMV2_hpp
+#define InterpreterTurboVMV2_hpp
 
 #pragma once
 #include <stdio.h>
@@ -114,4 +114,4 @@ private:
     
 };
 
-#endif /* TurboVM_hpp */
+#endif /* InterpreterTurboVMV2_hpp */
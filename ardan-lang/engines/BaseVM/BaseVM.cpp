@@ -6,3 +6,5 @@
 //
 
 #include "BaseVM.hpp"
+
+size_t call_stack_limit = 5000;
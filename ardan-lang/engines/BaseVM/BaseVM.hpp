@@ -22,6 +22,8 @@
 #include "Interpreter/ExecutionContext/JSArray/JSArray.h"
 #include "Interpreter/ExecutionContext/JSObject/JSObject.h"
 #include "Interpreter/ExecutionContext/JSClass/JSClass.h"
+#include "Interpreter/ExecutionContext/JSIterator/JSIterator.h"
+#include "Interpreter/ExecutionContext/JSTypedArray/JSTypedArray.h"
 #include "Interpreter/Utils/Utils.h"
 #include "builtin/platform/Print/Print.hpp"
 
@@ -30,6 +32,10 @@
 #include "builtin/platform/Server/Server.hpp"
 #include "Interpreter/Env.h"
 
+// most script frames Nova and Peregrine keep before a call throws
+// "RangeError: Maximum call stack size exceeded". set by `--stack-size=N`
+extern size_t call_stack_limit;
+
 class IVM {
 public:
     virtual ~IVM() = default;
@@ -46,10 +52,37 @@ public:
     //        vm = current_vm;
     //    }
     
+    BaseVM() : previous(current()) { current() = this; }
+    virtual ~BaseVM() { current() = previous; }
+
+    // the VM natives on this thread call back into. VMs live on the stack
+    // of the thread running them, so the newest one is the current one.
+    static BaseVM*& current() {
+        static thread_local BaseVM* vm = nullptr;
+        return vm;
+    }
+
     void init_builtins();
-    Value callFunction(const Value& callee, const vector<Value>& args) { return Value(); };
+    // overridden by VMs that can run closures handed to native code
+    // (promise reactions, array callbacks).
+    virtual Value callFunction(const Value& callee, const vector<Value>& args) { return Value(); };
     
-    // Value getProperty(const Value &objVal, const string &propName);
+    // Hooks behind Callback. A VM that returns true from beginCallback has
+    // set a frame up for the closure and runs every call in it with
+    // runCallback; otherwise each call goes through callFunction.
+    virtual bool beginCallback(const Value& closure) { return false; }
+    virtual Value runCallback(const Value& closure, const Value* argv, size_t argc) { return Value(); }
+    virtual void endCallback() {}
+
+    // Runs body over [0, count) split into ranges across worker threads.
+    // Each worker is the current VM of its thread while body runs, so a
+    // Callback opened in body calls fn there. Throws if fn may not run off
+    // this thread and pure was not declared; returns false when this VM
+    // cannot run script on other threads, and the caller runs serially.
+    virtual bool parallelFor(const Value& fn, bool pure, size_t count,
+                             const function<void(size_t begin, size_t end)>& body) { return false; }
+
+    // Value getProperty(const Value &objVal, Atom propName);
     
     void setStaticProperty(const Value &objVal, const string &propName, const Value &val) {
         if (objVal.type == ValueType::CLASS) {
@@ -66,7 +99,7 @@ public:
         }
         
         if (v.type == ValueType::ARRAY) {
-            return v.arrayValue->get("length").numberValue;
+            return (int)v.arrayValue->length();
         }
         
         return v.numberValue;
@@ -77,7 +110,7 @@ public:
     shared_ptr<Upvalue> captureUpvalue(Value* local);
     
     // Value CreateInstance(Value klass);
-    // void CreateObjectLiteralProperty(Value obj_val, string prop_name, Value object);
+    // void CreateObjectLiteralProperty(Value obj_val, Atom prop_name, Value object);
     
     void InvokeConstructor(Value obj_value, vector<Value> args);
     
@@ -99,13 +132,31 @@ public:
     //    void set_js_object_closure(Value objVal);
     void makeObjectInstance(Value klass, shared_ptr<JSObject> obj);
     
+    // the string form of v, without copying it when v already is a string
+    RopeString stringOf(const Value &v) {
+        if (v.type == ValueType::STRING) return v.stringValue;
+        return RopeString(v.toString());
+    }
+    
     Value binaryAdd(const Value &a, const Value &b) {
         if (a.type == ValueType::STRING || b.type == ValueType::STRING) {
-            return Value::str(a.toString() + b.toString());
+            return Value::rope(RopeString::concat(stringOf(a), stringOf(b)));
         }
         return Value(a.numberValue + b.numberValue);
     }
     
+    // dest = a + b, reusing dest when it already holds a number. dest may
+    // be a or b.
+    void storeAdd(Value &dest, const Value &a, const Value &b) {
+        if (a.type == ValueType::STRING || b.type == ValueType::STRING) {
+            dest = binaryAdd(a, b);
+            return;
+        }
+        double sum = a.numberValue + b.numberValue;
+        if (dest.type == ValueType::NUMBER) dest.numberValue = sum;
+        else dest = Value(sum);
+    }
+    
     bool isTruthy(const Value &v) {
         if (v.type == ValueType::NULLTYPE) return false;
         if (v.type == ValueType::UNDEFINED) return false;
@@ -196,7 +247,10 @@ public:
         auto proto = b.classValue;//->getPrototypeObject();
         auto obj = a.objectValue;
         while (obj) {
-            if (obj->getKlass().get() == proto.get()) return true;
+            // one object can stand for a whole class chain
+            for (auto klass = obj->getKlass(); klass; klass = klass->superClass) {
+                if (klass.get() == proto.get()) return true;
+            }
             obj = obj->parent_object; //prototype;
         }
         return false;
@@ -208,7 +262,11 @@ public:
         return true;
     }
     
-    void setProperty(const Value &objVal, const string &propName, const Value &val) {
+    void setProperty(const Value &objVal, Atom propName, const Value &val) {
+        if (objVal.type == ValueType::OBJECT && objVal.objectValue->is_typed_array) {
+            static_cast<JSTypedArray*>(objVal.objectValue.get())->setKey(propName, val);
+            return;
+        }
         if (objVal.type == ValueType::OBJECT) {
             objVal.objectValue->set(propName, val, "VAR", {});
             return;
@@ -230,6 +288,51 @@ public:
     
 protected:
     // DerivedVM* self() { return static_cast<DerivedVM*>(this); }
+
+private:
+    BaseVM* previous;
+};
+
+// A function that native code calls once per element, as the Array
+// builtins do. Arguments are read from the caller's buffer, and a closure
+// runs on the current VM in one frame reused for every call.
+class Callback {
+public:
+    explicit Callback(const Value& fn) : fn(fn) {
+        if (fn.type == ValueType::CLOSURE) {
+            vm = BaseVM::current();
+            if (vm == nullptr) {
+                throw runtime_error("A closure can only be called back from a VM");
+            }
+            framed = vm->beginCallback(fn);
+        } else if (fn.type != ValueType::FUNCTION && fn.type != ValueType::NATIVE_FUNCTION) {
+            throw runtime_error("TypeError: " + fn.toString() + " is not a function");
+        }
+    }
+
+    ~Callback() {
+        if (framed) vm->endCallback();
+    }
+
+    Callback(const Callback&) = delete;
+    Callback& operator=(const Callback&) = delete;
+
+    Value operator()(const Value* argv, size_t argc) {
+        if (framed) return vm->runCallback(fn, argv, argc);
+        args.assign(argv, argv + argc);
+        switch (fn.type) {
+            case ValueType::FUNCTION: return fn.functionValue(args);
+            case ValueType::NATIVE_FUNCTION: return fn.nativeFunction(args);
+            default: return vm->callFunction(fn, args);
+        }
+    }
+
+private:
+    const Value& fn;
+    BaseVM* vm = nullptr;
+    bool framed = false;
+    // reused by calls that need the arguments as a vector
+    vector<Value> args;
 };
 
 #endif /* BaseVM_hpp */
@@ -287,11 +287,11 @@ R CodeGen::visitVariable(VariableStatement* stmt) {
         if (decl.init) {
             decl.init->accept(*this); // push init value
             
-            if (auto classExpr = dynamic_cast<ClassExpression*>(decl.init.get())) {
+            if (auto classExpr = node_cast<ClassExpression>(decl.init.get())) {
                 classExpr->name = decl.id;
-            } else if (auto functionExpr = dynamic_cast<FunctionExpression*>(decl.init.get())) {
+            } else if (auto functionExpr = node_cast<FunctionExpression>(decl.init.get())) {
                 functionExpr->name = decl.id;
-            } else if (auto arrowFunctionExpr = dynamic_cast<ArrowFunction*>(decl.init.get())) {
+            } else if (auto arrowFunctionExpr = node_cast<ArrowFunction>(decl.init.get())) {
                 arrowFunctionExpr->name = decl.id;
             }
 
@@ -527,27 +527,27 @@ void CodeGen::emitAssignment(BinaryExpression* expr) {
 
     if (expr->op.type == TokenType::ASSIGN) {
         
-        if (auto classExpr = dynamic_cast<ClassExpression*>(expr->right.get())) {
-            if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+        if (auto classExpr = node_cast<ClassExpression>(expr->right.get())) {
+            if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
                 classExpr->name = idExpr->name;
-            } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+            } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
                 classExpr->name = evaluate_property(memberExpr); // e.g. obj.B
             }
-        } else if (auto functionExpr = dynamic_cast<FunctionExpression*>(expr->right.get())) {
-            if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+        } else if (auto functionExpr = node_cast<FunctionExpression>(expr->right.get())) {
+            if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
                 functionExpr->name = idExpr->name;
-            } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+            } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
                 functionExpr->name = evaluate_property(memberExpr);
             }
-        } else if (auto arrowFunctionExpr = dynamic_cast<ArrowFunction*>(expr->right.get())) {
-            if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+        } else if (auto arrowFunctionExpr = node_cast<ArrowFunction>(expr->right.get())) {
+            if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
                 arrowFunctionExpr->name = idExpr->name;
-            } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+            } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
                 arrowFunctionExpr->name = evaluate_property(memberExpr);
             }
         }
         
-        if (auto* ident = dynamic_cast<IdentifierExpression*>(left)) {
+        if (auto* ident = node_cast<IdentifierExpression>(left)) {
 
             expr->right->accept(*this);
 
@@ -556,7 +556,7 @@ void CodeGen::emitAssignment(BinaryExpression* expr) {
             store(ident->token.lexeme);
             
         }
-        else if (auto* member = dynamic_cast<MemberExpression*>(left)) {
+        else if (auto* member = node_cast<MemberExpression>(left)) {
 
             member->object->accept(*this);
 
@@ -585,32 +585,32 @@ void CodeGen::emitAssignment(BinaryExpression* expr) {
 
     // Here, we will evaluate compound assignments
 
-    if (auto classExpr = dynamic_cast<ClassExpression*>(expr->right.get())) {
-        if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+    if (auto classExpr = node_cast<ClassExpression>(expr->right.get())) {
+        if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
             classExpr->name = idExpr->name;
-        } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+        } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
             classExpr->name = evaluate_property(memberExpr); // e.g. obj.B
         }
-    } else if (auto functionExpr = dynamic_cast<FunctionExpression*>(expr->right.get())) {
-        if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+    } else if (auto functionExpr = node_cast<FunctionExpression>(expr->right.get())) {
+        if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
             functionExpr->name = idExpr->name;
-        } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+        } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
             functionExpr->name = evaluate_property(memberExpr);
         }
-    } else if (auto arrowFunctionExpr = dynamic_cast<ArrowFunction*>(expr->right.get())) {
-        if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+    } else if (auto arrowFunctionExpr = node_cast<ArrowFunction>(expr->right.get())) {
+        if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
             arrowFunctionExpr->name = idExpr->name;
-        } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+        } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
             arrowFunctionExpr->name = evaluate_property(memberExpr);
         }
 
     }
 
-    if (auto* ident = dynamic_cast<IdentifierExpression*>(left)) {
+    if (auto* ident = node_cast<IdentifierExpression>(left)) {
         // Load current value
         ident->accept(*this);
     }
-    else if (auto* member = dynamic_cast<MemberExpression*>(left)) {
+    else if (auto* member = node_cast<MemberExpression>(left)) {
         // Load current property value
         member->object->accept(*this);
         if (member->computed) {
@@ -650,11 +650,11 @@ void CodeGen::emitAssignment(BinaryExpression* expr) {
     }
 
     // Store the result back
-    if (auto* ident = dynamic_cast<IdentifierExpression*>(left)) {
+    if (auto* ident = node_cast<IdentifierExpression>(left)) {
         // define(ident->token.lexeme);
         store(ident->token.lexeme);
     }
-    else if (auto* member = dynamic_cast<MemberExpression*>(left)) {
+    else if (auto* member = node_cast<MemberExpression>(left)) {
         if (member->computed) {
             emit(OpCode::SetPropertyDynamic);
         } else {
@@ -673,7 +673,7 @@ R CodeGen::visitUnary(UnaryExpression* expr) {
     // DELETE
     if (expr->op.type == TokenType::DELETE) {
         
-        if (auto member = dynamic_cast<MemberExpression*>(expr->right.get())) {
+        if (auto member = node_cast<MemberExpression>(expr->right.get())) {
             
             (member->object->accept(*this));
             
@@ -703,7 +703,7 @@ R CodeGen::visitUnary(UnaryExpression* expr) {
     
     if (expr->op.type == TokenType::INCREMENT || expr->op.type == TokenType::DECREMENT) {
         // ++x or --x
-        if (auto ident = dynamic_cast<IdentifierExpression*>(expr->right.get())) {
+        if (auto ident = node_cast<IdentifierExpression>(expr->right.get())) {
             
             // load current value
             ident->accept(*this);
@@ -724,7 +724,7 @@ R CodeGen::visitUnary(UnaryExpression* expr) {
             
         }
 
-        if (auto member_expr = dynamic_cast<MemberExpression*>(expr->right.get())) {
+        if (auto member_expr = node_cast<MemberExpression>(expr->right.get())) {
             
             if (member_expr->computed) {
 
@@ -821,7 +821,7 @@ R CodeGen::visitCall(CallExpression* expr) {
     // emit callee, then args left-to-right, then OP_CALL argc
         
     bool isSuperCall = false;
-    if (auto ident = dynamic_cast<SuperExpression*>(expr->callee.get())) {
+    if (auto ident = node_cast<SuperExpression>(expr->callee.get())) {
         isSuperCall = true;
     }
     
@@ -855,7 +855,7 @@ R CodeGen::compileArgument(vector<unique_ptr<Expression>>& arguments,
     
     for (auto &arg : arguments) {
         
-        if (auto spreadExpr = dynamic_cast<SpreadExpression*>(arg.get())) {
+        if (auto spreadExpr = node_cast<SpreadExpression>(arg.get())) {
             byte |= (1 << bitIndex);
         }
         
@@ -903,7 +903,7 @@ R CodeGen::visitMember(MemberExpression* expr) {
 R CodeGen::visitArray(ArrayLiteralExpression* expr) {
     emit(OpCode::NewArray);
     for (auto &el : expr->elements) {
-        if (SpreadExpression* spread = dynamic_cast<SpreadExpression*>(el.get())) {
+        if (SpreadExpression* spread = node_cast<SpreadExpression>(el.get())) {
             spread->expression->accept(*this);
             emit(OpCode::ArraySpread);
         } else {
@@ -920,7 +920,7 @@ R CodeGen::visitObject(ObjectLiteralExpression* expr) {
 
     for (auto &prop : expr->props) {
         
-        if (SpreadExpression* spread = dynamic_cast<SpreadExpression*>(prop.second.get())) {
+        if (SpreadExpression* spread = node_cast<SpreadExpression>(prop.second.get())) {
             spread->expression->accept(*this); // leaves object on stack
             emit(OpCode::ObjectSpread);
         } else {
@@ -969,37 +969,37 @@ R CodeGen::visitArrowFunction(ArrowFunction* expr) {
     collectParameterInfo(expr->parameters.get(), paramNames, parameterInfos);
     
 //    if (expr->parameters) {
-//        if (SequenceExpression* seq = dynamic_cast<SequenceExpression*>(expr->parameters.get())) {
+//        if (SequenceExpression* seq = node_cast<SequenceExpression>(expr->parameters.get())) {
 //            for (auto& p : seq->expressions) {
-//                if (auto* rest = dynamic_cast<RestParameter*>(p.get())) {
+//                if (auto* rest = node_cast<RestParameter>(p.get())) {
 //                    // ...rest
-//                    //if (auto* ident = dynamic_cast<IdentifierExpression*>(rest->argument.get())) {
+//                    //if (auto* ident = node_cast<IdentifierExpression>(rest->argument.get())) {
 //                    paramNames.push_back(rest->token.lexeme);
 //                    parameterInfos
 //                        .push_back(ParameterInfo{rest->token.lexeme, false, nullptr, true});
 //                    //}
-//                } else if (auto* assign = dynamic_cast<BinaryExpression*>(p.get())) {
+//                } else if (auto* assign = node_cast<BinaryExpression>(p.get())) {
 //                    // b = 90 or c = b
-//                    if (auto* ident = dynamic_cast<IdentifierExpression*>(assign->left.get())) {
+//                    if (auto* ident = node_cast<IdentifierExpression>(assign->left.get())) {
 //                        paramNames.push_back(ident->name);
 //                        parameterInfos.push_back(ParameterInfo{ident->name, true, assign->right.get(), false});
 //                    }
-//                } else if (auto* ident = dynamic_cast<IdentifierExpression*>(p.get())) {
+//                } else if (auto* ident = node_cast<IdentifierExpression>(p.get())) {
 //                    // Simple arg
 //                    paramNames.push_back(ident->name);
 //                    parameterInfos.push_back(ParameterInfo{ident->name, false, nullptr, false});
 //                }
 //            }
-//        } else if (auto* ident = dynamic_cast<IdentifierExpression*>(expr->parameters.get())) {
+//        } else if (auto* ident = node_cast<IdentifierExpression>(expr->parameters.get())) {
 //            paramNames.push_back(ident->name);
 //            parameterInfos.push_back(ParameterInfo{ident->name, false, nullptr, false});
 //        }
-//        else if (auto* rest = dynamic_cast<RestParameter*>(expr->parameters.get())) {
+//        else if (auto* rest = node_cast<RestParameter>(expr->parameters.get())) {
 //            paramNames.push_back(rest->token.lexeme);
 //            parameterInfos.emplace_back(rest->token.lexeme, false, nullptr, true);
 //        }
-//        else if (auto* binary_expr = dynamic_cast<BinaryExpression*>(expr->parameters.get())) {
-//            if (auto* ident = dynamic_cast<IdentifierExpression*>(binary_expr->left.get())) {
+//        else if (auto* binary_expr = node_cast<BinaryExpression>(expr->parameters.get())) {
+//            if (auto* ident = node_cast<IdentifierExpression>(binary_expr->left.get())) {
 //                paramNames.push_back(ident->name);
 //                parameterInfos.emplace_back(ident->name, true, binary_expr->right.get(), false);
 //            }
@@ -1021,9 +1021,9 @@ R CodeGen::visitArrowFunction(ArrowFunction* expr) {
         
         // TODO: we need to check if return is the last statement.
         bool is_return_avaialble = false;
-        if (BlockStatement* block = dynamic_cast<BlockStatement*>(expr->stmtBody.get())) {
+        if (BlockStatement* block = node_cast<BlockStatement>(expr->stmtBody.get())) {
             for (auto& body : block->body) {
-                if (auto return_stmt = dynamic_cast<ReturnStatement*>(body.get())) {
+                if (auto return_stmt = node_cast<ReturnStatement>(body.get())) {
                     is_return_avaialble = true;
                 }
             }
@@ -1093,39 +1093,39 @@ R CodeGen::visitFunctionExpression(FunctionExpression* expr) {
         
         collectParameterInfo(param.get(), paramNames, parameterInfos);
 
-//        if (SequenceExpression* seq = dynamic_cast<SequenceExpression*>(param.get())) {
+//        if (SequenceExpression* seq = node_cast<SequenceExpression>(param.get())) {
 //            for (auto& p : seq->expressions) {
-//                if (auto* rest = dynamic_cast<RestParameter*>(p.get())) {
+//                if (auto* rest = node_cast<RestParameter>(p.get())) {
 //                    // ...rest
-//                    //if (auto* ident = dynamic_cast<IdentifierExpression*>(rest->argument.get())) {
+//                    //if (auto* ident = node_cast<IdentifierExpression>(rest->argument.get())) {
 //                    paramNames.push_back(rest->token.lexeme);
 //                    parameterInfos
 //                        .push_back(ParameterInfo{rest->token.lexeme, false, nullptr, true});
 //                    //}
-//                } else if (auto* assign = dynamic_cast<BinaryExpression*>(p.get())) {
+//                } else if (auto* assign = node_cast<BinaryExpression>(p.get())) {
 //                    // b = 90 or c = b
-//                    if (auto* ident = dynamic_cast<IdentifierExpression*>(assign->left.get())) {
+//                    if (auto* ident = node_cast<IdentifierExpression>(assign->left.get())) {
 //                        paramNames.push_back(ident->name);
 //                        parameterInfos.push_back(ParameterInfo{ident->name, true, assign->right.get(), false});
 //                    }
-//                } else if (auto* ident = dynamic_cast<IdentifierExpression*>(p.get())) {
+//                } else if (auto* ident = node_cast<IdentifierExpression>(p.get())) {
 //                    // Simple arg
 //                    paramNames.push_back(ident->name);
 //                    parameterInfos.push_back(ParameterInfo{ident->name, false, nullptr, false});
 //                }
 //            }
 //        }
-//        else if (auto* rest = dynamic_cast<RestParameter*>(param.get())) {
+//        else if (auto* rest = node_cast<RestParameter>(param.get())) {
 //            paramNames.push_back(rest->token.lexeme);
 //            parameterInfos.emplace_back(rest->token.lexeme, false, nullptr, true);
 //        }
-//        else if (auto* binary_expr = dynamic_cast<BinaryExpression*>(param.get())) {
-//            if (auto* ident = dynamic_cast<IdentifierExpression*>(binary_expr->left.get())) {
+//        else if (auto* binary_expr = node_cast<BinaryExpression>(param.get())) {
+//            if (auto* ident = node_cast<IdentifierExpression>(binary_expr->left.get())) {
 //                paramNames.push_back(ident->name);
 //                parameterInfos.emplace_back(ident->name, true, binary_expr->right.get(), false);
 //            }
 //        }
-//        else if (auto* ident = dynamic_cast<IdentifierExpression*>(param.get())) {
+//        else if (auto* ident = node_cast<IdentifierExpression>(param.get())) {
 //            paramNames.push_back(ident->name);
 //            parameterInfos.push_back(ParameterInfo{ident->name, false, nullptr, false});
 //        }
@@ -1141,9 +1141,9 @@ R CodeGen::visitFunctionExpression(FunctionExpression* expr) {
         // TODO: walk the body ast to ensure OP_RETURN is emitted at the end if not emitted
         // TODO: we need to check if return is the last statement.
         bool is_return_avaialble = false;
-        if (BlockStatement* block = dynamic_cast<BlockStatement*>(expr->body.get())) {
+        if (BlockStatement* block = node_cast<BlockStatement>(expr->body.get())) {
             for (auto& body : block->body) {
-                if (auto return_stmt = dynamic_cast<ReturnStatement*>(body.get())) {
+                if (auto return_stmt = node_cast<ReturnStatement>(body.get())) {
                     is_return_avaialble = true;
                 }
             }
@@ -1207,33 +1207,33 @@ R CodeGen::visitFunction(FunctionDeclaration* stmt) {
         
         collectParameterInfo(param.get(), paramNames, parameterInfos);
 
-//        if (SequenceExpression* seq = dynamic_cast<SequenceExpression*>(param.get())) {
+//        if (SequenceExpression* seq = node_cast<SequenceExpression>(param.get())) {
 //            for (auto& p : seq->expressions) {
-//                if (auto* rest = dynamic_cast<RestParameter*>(p.get())) {
+//                if (auto* rest = node_cast<RestParameter>(p.get())) {
 //                    paramNames.push_back(rest->token.lexeme);
 //                    parameterInfos.emplace_back(rest->token.lexeme, false, nullptr, true);
-//                } else if (auto* assign = dynamic_cast<BinaryExpression*>(p.get())) {
-//                    if (auto* ident = dynamic_cast<IdentifierExpression*>(assign->left.get())) {
+//                } else if (auto* assign = node_cast<BinaryExpression>(p.get())) {
+//                    if (auto* ident = node_cast<IdentifierExpression>(assign->left.get())) {
 //                        paramNames.push_back(ident->name);
 //                        parameterInfos.emplace_back(ident->name, true, assign->right.get(), false);
 //                    }
-//                } else if (auto* ident = dynamic_cast<IdentifierExpression*>(p.get())) {
+//                } else if (auto* ident = node_cast<IdentifierExpression>(p.get())) {
 //                    paramNames.push_back(ident->name);
 //                    parameterInfos.emplace_back(ident->name, false, nullptr, false);
 //                }
 //            }
 //        }
-//        else if (auto* rest = dynamic_cast<RestParameter*>(param.get())) {
+//        else if (auto* rest = node_cast<RestParameter>(param.get())) {
 //            paramNames.push_back(rest->token.lexeme);
 //            parameterInfos.emplace_back(rest->token.lexeme, false, nullptr, true);
 //        }
-//        else if (auto* binary_expr = dynamic_cast<BinaryExpression*>(param.get())) {
-//            if (auto* ident = dynamic_cast<IdentifierExpression*>(binary_expr->left.get())) {
+//        else if (auto* binary_expr = node_cast<BinaryExpression>(param.get())) {
+//            if (auto* ident = node_cast<IdentifierExpression>(binary_expr->left.get())) {
 //                paramNames.push_back(ident->name);
 //                parameterInfos.emplace_back(ident->name, true, binary_expr->right.get(), false);
 //            }
 //        }
-//        else if (auto* ident = dynamic_cast<IdentifierExpression*>(param.get())) {
+//        else if (auto* ident = node_cast<IdentifierExpression>(param.get())) {
 //            paramNames.push_back(ident->name);
 //            parameterInfos.emplace_back(ident->name, false, nullptr, false);
 //        }
@@ -1249,9 +1249,9 @@ R CodeGen::visitFunction(FunctionDeclaration* stmt) {
         // TODO: walk the body ast to ensure OP_RETURN is emitted at the end if not emitted
         // TODO: we need to check if return is the last statement.
         bool is_return_avaialble = false;
-        if (BlockStatement* block = dynamic_cast<BlockStatement*>(stmt->body.get())) {
+        if (BlockStatement* block = node_cast<BlockStatement>(stmt->body.get())) {
             for (auto& body : block->body) {
-                if (auto return_stmt = dynamic_cast<ReturnStatement*>(body.get())) {
+                if (auto return_stmt = node_cast<ReturnStatement>(body.get())) {
                     is_return_avaialble = true;
                 }
             }
@@ -1371,9 +1371,8 @@ R CodeGen::visitImportDeclaration(ImportDeclaration* stmt) {
     std::string source = read_file(importPath);
 
     Scanner scanner(source);
-    auto tokens = scanner.getTokens();
     
-    Parser parser(tokens);
+    Parser parser(scanner);
     parser.sourceFile = importPath;
     auto ast = parser.parse();
 
@@ -1437,7 +1436,7 @@ R CodeGen::visitSequence(SequenceExpression* expr) {
 // returns old value
 R CodeGen::visitUpdate(UpdateExpression* expr) {
     // Identifiers: x++
-    if (auto ident = dynamic_cast<IdentifierExpression*>(expr->argument.get())) {
+    if (auto ident = node_cast<IdentifierExpression>(expr->argument.get())) {
         ident->accept(*this);
         emit(OpCode::Dup); // did this, so we leave the old value on stack
 
@@ -1450,7 +1449,7 @@ R CodeGen::visitUpdate(UpdateExpression* expr) {
         return true;
     }
     // Member expressions: obj.x++, arr[i]++, obj[prop]++
-    if (auto member = dynamic_cast<MemberExpression*>(expr->argument.get())) {
+    if (auto member = node_cast<MemberExpression>(expr->argument.get())) {
         if (member->computed) {
             // Computed: arr[i]++ or obj[prop]++
             member->object->accept(*this);     // [obj]
@@ -1568,7 +1567,7 @@ R CodeGen::visitNew(NewExpression* expr) {
     
     // create new object, push, then call constructor
         
-    if (auto ident = dynamic_cast<IdentifierExpression*>(expr->callee.get())) {
+    if (auto ident = node_cast<IdentifierExpression>(expr->callee.get())) {
                 
         ident->accept(*this);
         
@@ -1605,30 +1604,30 @@ void CodeGen::compileMethod(MethodDefinition& method) {
         
         collectParameterInfo(param.get(), paramNames, parameterInfos);
         
-//        if (auto* seq = dynamic_cast<SequenceExpression*>(param.get())) {
+//        if (auto* seq = node_cast<SequenceExpression>(param.get())) {
 //            for (auto& p : seq->expressions) {
-//                if (auto* rest = dynamic_cast<RestParameter*>(p.get())) {
+//                if (auto* rest = node_cast<RestParameter>(p.get())) {
 //                    paramNames.push_back(rest->token.lexeme);
 //                    parameterInfos.push_back(ParameterInfo{rest->token.lexeme, false, nullptr, true});
-//                } else if (auto* assign = dynamic_cast<BinaryExpression*>(p.get())) {
-//                    if (auto* ident = dynamic_cast<IdentifierExpression*>(assign->left.get())) {
+//                } else if (auto* assign = node_cast<BinaryExpression>(p.get())) {
+//                    if (auto* ident = node_cast<IdentifierExpression>(assign->left.get())) {
 //                        paramNames.push_back(ident->name);
 //                        parameterInfos.push_back(ParameterInfo{ident->name, true, assign->right.get(), false});
 //                    }
-//                } else if (auto* ident = dynamic_cast<IdentifierExpression*>(p.get())) {
+//                } else if (auto* ident = node_cast<IdentifierExpression>(p.get())) {
 //                    paramNames.push_back(ident->name);
 //                    parameterInfos.push_back(ParameterInfo{ident->name, false, nullptr, false});
 //                }
 //            }
-//        } else if (auto* rest = dynamic_cast<RestParameter*>(param.get())) {
+//        } else if (auto* rest = node_cast<RestParameter>(param.get())) {
 //            paramNames.push_back(rest->token.lexeme);
 //            parameterInfos.push_back(ParameterInfo{rest->token.lexeme, false, nullptr, true});
-//        } else if (auto* assign = dynamic_cast<BinaryExpression*>(param.get())) {
-//            if (auto* ident = dynamic_cast<IdentifierExpression*>(assign->left.get())) {
+//        } else if (auto* assign = node_cast<BinaryExpression>(param.get())) {
+//            if (auto* ident = node_cast<IdentifierExpression>(assign->left.get())) {
 //                paramNames.push_back(ident->name);
 //                parameterInfos.push_back(ParameterInfo{ident->name, true, assign->right.get(), false});
 //            }
-//        } else if (auto* ident = dynamic_cast<IdentifierExpression*>(param.get())) {
+//        } else if (auto* ident = node_cast<IdentifierExpression>(param.get())) {
 //            paramNames.push_back(ident->name);
 //            parameterInfos.push_back(ParameterInfo{ident->name, false, nullptr, false});
 //        }
@@ -1646,9 +1645,9 @@ void CodeGen::compileMethod(MethodDefinition& method) {
         method.methodBody->accept(nested);
         // Ensure Return is emitted
         bool hasReturn = false;
-        if (auto* block = dynamic_cast<BlockStatement*>(method.methodBody.get())) {
+        if (auto* block = node_cast<BlockStatement>(method.methodBody.get())) {
             for (auto& stmt : block->body) {
-                if (dynamic_cast<ReturnStatement*>(stmt.get())) {
+                if (node_cast<ReturnStatement>(stmt.get())) {
                     hasReturn = true;
                     break;
                 }
@@ -1695,7 +1694,7 @@ R CodeGen::visitClass(ClassDeclaration* stmt) {
     if (stmt->superClass) {
         stmt->superClass->accept(*this); // [superclass]
         
-        auto ident = dynamic_cast<IdentifierExpression*>((stmt->superClass.get()));
+        auto ident = node_cast<IdentifierExpression>((stmt->superClass.get()));
         
         if (ident) {
             classInfo.super_class_name = ident->name;
@@ -1718,26 +1717,26 @@ R CodeGen::visitClass(ClassDeclaration* stmt) {
         
         for (const auto& mod : field->modifiers) {
             
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
             
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
             
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
             
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
             
         }
 
         // Property is always a VariableStatement
-        if (auto* varStmt = dynamic_cast<VariableStatement*>(field->property.get())) {
+        if (auto* varStmt = node_cast<VariableStatement>(field->property.get())) {
             
             string kind = varStmt->kind;
             
@@ -1847,16 +1846,16 @@ R CodeGen::visitClass(ClassDeclaration* stmt) {
         bool isProtected = false;
         
         for (const auto& mod : method->modifiers) {
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
         }
@@ -1885,19 +1884,19 @@ R CodeGen::visitClass(ClassDeclaration* stmt) {
         
         for (const auto& mod : method->modifiers) {
             
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
             
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
             
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
             
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
             
@@ -2147,13 +2146,13 @@ R CodeGen::visitForIn(ForInStatement* stmt) {
     emit(OpCode::GetPropertyDynamic);
 
     // Assign value to loop variable
-    if (auto* ident = dynamic_cast<IdentifierExpression*>(stmt->init.get())) {
+    if (auto* ident = node_cast<IdentifierExpression>(stmt->init.get())) {
         store(ident->name);
-    } else if (auto* var_stmt = dynamic_cast<VariableStatement*>(stmt->init.get())) {
+    } else if (auto* var_stmt = node_cast<VariableStatement>(stmt->init.get())) {
         store(var_stmt->declarations[0].id);
-    } else if (auto* expr_stmt = dynamic_cast<ExpressionStatement*>(stmt->init.get())) {
+    } else if (auto* expr_stmt = node_cast<ExpressionStatement>(stmt->init.get())) {
         
-        if (auto* ident = dynamic_cast<IdentifierExpression*>(expr_stmt->expression.get())) {
+        if (auto* ident = node_cast<IdentifierExpression>(expr_stmt->expression.get())) {
             store(ident->name);
         }
         
@@ -2243,13 +2242,13 @@ R CodeGen::visitForOf(ForOfStatement* stmt) {
     emitUint32((uint32_t)idx_slot);
     emit(OpCode::GetPropertyDynamic);
 
-    if (auto* ident = dynamic_cast<IdentifierExpression*>(stmt->left.get())) {
+    if (auto* ident = node_cast<IdentifierExpression>(stmt->left.get())) {
         store(ident->name);
-    } else if (auto* var_stmt = dynamic_cast<VariableStatement*>(stmt->left.get())) {
+    } else if (auto* var_stmt = node_cast<VariableStatement>(stmt->left.get())) {
         store(var_stmt->declarations[0].id);
-    } else if (auto* expr_stmt = dynamic_cast<ExpressionStatement*>(stmt->left.get())) {
+    } else if (auto* expr_stmt = node_cast<ExpressionStatement>(stmt->left.get())) {
         
-        if (auto* ident = dynamic_cast<IdentifierExpression*>(expr_stmt->expression.get())) {
+        if (auto* ident = node_cast<IdentifierExpression>(expr_stmt->expression.get())) {
             store(ident->name);
         }
         
@@ -2292,7 +2291,7 @@ R CodeGen::visitClassExpression(ClassExpression* expr) {
     if (stmt->superClass) {
         stmt->superClass->accept(*this);
         
-        auto ident = dynamic_cast<IdentifierExpression*>((stmt->superClass.get()));
+        auto ident = node_cast<IdentifierExpression>((stmt->superClass.get()));
         
         if (ident) {
             classInfo.super_class_name = ident->name;
@@ -2314,26 +2313,26 @@ R CodeGen::visitClassExpression(ClassExpression* expr) {
         
         for (const auto& mod : field->modifiers) {
             
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
             
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
             
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
             
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
             
         }
 
         // Property is always a VariableStatement
-        if (auto* varStmt = dynamic_cast<VariableStatement*>(field->property.get())) {
+        if (auto* varStmt = node_cast<VariableStatement>(field->property.get())) {
             
             string kind = varStmt->kind;
             
@@ -2447,16 +2446,16 @@ R CodeGen::visitClassExpression(ClassExpression* expr) {
         bool isProtected = false;
         
         for (const auto& mod : method->modifiers) {
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
         }
@@ -2484,19 +2483,19 @@ R CodeGen::visitClassExpression(ClassExpression* expr) {
         
         for (const auto& mod : method->modifiers) {
             
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
             
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
             
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
             
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
             
@@ -2631,33 +2630,33 @@ void CodeGen::collectParameterInfo(Expression* parameters, vector<string>& param
                           vector<ParameterInfo>& parameterInfos
 ) {
     if (parameters) {
-        if (SequenceExpression* seq = dynamic_cast<SequenceExpression*>(parameters)) {
+        if (SequenceExpression* seq = node_cast<SequenceExpression>(parameters)) {
             for (auto& p : seq->expressions) {
-                if (auto* rest = dynamic_cast<RestParameter*>(p.get())) {
-                    //if (auto* ident = dynamic_cast<IdentifierExpression*>(rest->argument.get())) {
+                if (auto* rest = node_cast<RestParameter>(p.get())) {
+                    //if (auto* ident = node_cast<IdentifierExpression>(rest->argument.get())) {
                     paramNames.push_back(rest->token.lexeme);
                     parameterInfos
                         .push_back(ParameterInfo{rest->token.lexeme, false, nullptr, true});
                     //}
-                } else if (auto* assign = dynamic_cast<BinaryExpression*>(p.get())) {
-                    if (auto* ident = dynamic_cast<IdentifierExpression*>(assign->left.get())) {
+                } else if (auto* assign = node_cast<BinaryExpression>(p.get())) {
+                    if (auto* ident = node_cast<IdentifierExpression>(assign->left.get())) {
                         paramNames.push_back(ident->name);
                         parameterInfos.push_back(ParameterInfo{ident->name, true, assign->right.get(), false});
                     }
-                } else if (auto* ident = dynamic_cast<IdentifierExpression*>(p.get())) {
+                } else if (auto* ident = node_cast<IdentifierExpression>(p.get())) {
                     paramNames.push_back(ident->name);
                     parameterInfos.push_back(ParameterInfo{ident->name, false, nullptr, false});
                 }
             }
         }
-        else if (auto* ident = dynamic_cast<IdentifierExpression*>(parameters)) {
+        else if (auto* ident = node_cast<IdentifierExpression>(parameters)) {
             paramNames.push_back(ident->name);
             parameterInfos.push_back(ParameterInfo{ident->name, false, nullptr, false});
-        } else if (auto* rest = dynamic_cast<RestParameter*>(parameters)) {
+        } else if (auto* rest = node_cast<RestParameter>(parameters)) {
             paramNames.push_back(rest->token.lexeme);
             parameterInfos.emplace_back(rest->token.lexeme, false, nullptr, true);
-        } else if (auto* binary_expr = dynamic_cast<BinaryExpression*>(parameters)) {
-            if (auto* ident = dynamic_cast<IdentifierExpression*>(binary_expr->left.get())) {
+        } else if (auto* binary_expr = node_cast<BinaryExpression>(parameters)) {
+            if (auto* ident = node_cast<IdentifierExpression>(binary_expr->left.get())) {
                 paramNames.push_back(ident->name);
                 parameterInfos.emplace_back(ident->name, true, binary_expr->right.get(), false);
             }
@@ -2726,25 +2725,25 @@ CodeGen CodeGen::compileFunction(string name, Expression* parameters) {
     vector<ParameterInfo> parameterInfos;
 
     if (parameters) {
-        if (SequenceExpression* seq = dynamic_cast<SequenceExpression*>(parameters)) {
+        if (SequenceExpression* seq = node_cast<SequenceExpression>(parameters)) {
             for (auto& p : seq->expressions) {
-                if (auto* rest = dynamic_cast<RestParameter*>(p.get())) {
-                    //if (auto* ident = dynamic_cast<IdentifierExpression*>(rest->argument.get())) {
+                if (auto* rest = node_cast<RestParameter>(p.get())) {
+                    //if (auto* ident = node_cast<IdentifierExpression>(rest->argument.get())) {
                     paramNames.push_back(rest->token.lexeme);
                     parameterInfos
                         .push_back(ParameterInfo{rest->token.lexeme, false, nullptr, true});
                     //}
-                } else if (auto* assign = dynamic_cast<BinaryExpression*>(p.get())) {
-                    if (auto* ident = dynamic_cast<IdentifierExpression*>(assign->left.get())) {
+                } else if (auto* assign = node_cast<BinaryExpression>(p.get())) {
+                    if (auto* ident = node_cast<IdentifierExpression>(assign->left.get())) {
                         paramNames.push_back(ident->name);
                         parameterInfos.push_back(ParameterInfo{ident->name, true, assign->right.get(), false});
                     }
-                } else if (auto* ident = dynamic_cast<IdentifierExpression*>(p.get())) {
+                } else if (auto* ident = node_cast<IdentifierExpression>(p.get())) {
                     paramNames.push_back(ident->name);
                     parameterInfos.push_back(ParameterInfo{ident->name, false, nullptr, false});
                 }
             }
-        } else if (auto* ident = dynamic_cast<IdentifierExpression*>(parameters)) {
+        } else if (auto* ident = node_cast<IdentifierExpression>(parameters)) {
             paramNames.push_back(ident->name);
             parameterInfos.push_back(ParameterInfo{ident->name, false, nullptr, false});
         }
@@ -3134,17 +3133,17 @@ void CodeGen::declareVariableScoping(const string& name, BindingKind kind) {
 }
 
 string CodeGen::evaluate_property(Expression* expr) {
-    if (auto member = dynamic_cast<MemberExpression*>(expr)) {
+    if (auto member = node_cast<MemberExpression>(expr)) {
         if (member->computed) {
             return evaluate_property(member->property.get());
         } else {
             return member->name.lexeme;
         }
     }
-    if (auto ident = dynamic_cast<IdentifierExpression*>(expr)) {
+    if (auto ident = node_cast<IdentifierExpression>(expr)) {
         return ident->name;
     }
-    if (auto literal = dynamic_cast<LiteralExpression*>(expr)) {
+    if (auto literal = node_cast<LiteralExpression>(expr)) {
         return literal->token.lexeme;
     }
     throw std::runtime_error("Unsupported expression type in evaluate_property");
@@ -7,8 +7,16 @@
 
 #include "Chunk.hpp"
 
+// numeric constants can name properties too: `{ 1: x }`
+static Atom nameAtom(const Value& v) {
+    if (v.type == ValueType::STRING) return Atom(v.stringValue);
+    if (v.type == ValueType::NUMBER) return Atom(v.toString());
+    return Atom();
+}
+
 int Chunk::addConstant(const Value &v) {
     constants.push_back(v);
+    atoms.push_back(nameAtom(v));
     return (int)constants.size() - 1;
 }
 
@@ -27,6 +27,9 @@ using std::string;
 struct Chunk {
     vector<uint8_t> code;
     vector<Value> constants;
+    // atoms[i] is the interned name when constants[i] is a string or number,
+    // so name operands are looked up without hashing their characters
+    vector<Atom> atoms;
 
     uint32_t maxLocals = 0;   
     uint32_t arity = 0;       
@@ -34,6 +37,8 @@ struct Chunk {
 
     int addConstant(const Value &v);
 
+    Atom atomAt(size_t index) const { return atoms[index]; }
+
     void writeByte(uint8_t b);
 
     void writeUint32(uint32_t v);
@@ -32,6 +32,7 @@ void VM::init_builtins() {
     event_loop = new EventLoop();
     
     env->set_var("Math", make_shared<Math>());
+    env->set_var("JSON", make_shared<JSON>());
     env->set_var("console", make_shared<Print>());
     env->set_var("fs", make_shared<File>());
     env->set_var("Server", make_shared<Server>(event_loop));
@@ -120,7 +121,7 @@ void VM::CreateObjectLiteralProperty(Value obj_val, string prop_name, Value obje
 
 }
 
-Value VM::getProperty(const Value &objVal, const string &propName) {
+Value VM::getProperty(const Value &objVal, Atom propName) {
     if (objVal.type == ValueType::OBJECT) {
         
         // perform privacy check
@@ -130,12 +131,12 @@ Value VM::getProperty(const Value &objVal, const string &propName) {
         // if its private, check if the js_object in closure is not nullptr
         // if closure.js_object is not nullptr
         
-        vector<string> modifiers = objVal.objectValue->get_modifiers(propName);
+        const vector<string>& modifiers = objVal.objectValue->get_modifiers(propName);
         
         bool isPrivate = false;
         bool isProtected = false;
         
-        for (auto modifier : modifiers) {
+        for (const auto& modifier : modifiers) {
             if (modifier == "private") {
                 isPrivate = true;
                 continue;
@@ -191,11 +192,11 @@ Value VM::getProperty(const Value &objVal, const string &propName) {
         // get the prop modifiers.
         // if its private, check if the js_object in closure is not nullptr
         
-        vector<string> modifiers = objVal.classValue->get_static_modifiers(propName);
+        const vector<string>& modifiers = objVal.classValue->get_static_modifiers(propName);
         bool isPrivate = false;
         bool isProtected = false;
 
-        for (auto modifier : modifiers) {
+        for (const auto& modifier : modifiers) {
             
             if (modifier == "private") {
                 isPrivate = true;
@@ -527,8 +528,7 @@ Value VM::runFrame(CallFrame &current_frame) {
                 // TODO: marked for removal
             case OpCode::LoadGlobal: {
                 uint32_t ci = readUint32();
-                Value nameVal = frame->chunk->constants[ci];
-                string name = nameVal.toString();
+                Atom name = frame->chunk->atomAt(ci);
                                 
                 try {
                     
@@ -549,8 +549,7 @@ Value VM::runFrame(CallFrame &current_frame) {
                 // TODO: marked for removal
             case OpCode::StoreGlobal: {
                 uint32_t ci = readUint32();
-                Value nameVal = frame->chunk->constants[ci];
-                string name = nameVal.toString();
+                Atom name = frame->chunk->atomAt(ci);
                 Value v = pop();
                 
                 env->set_var(name, v);
@@ -561,8 +560,7 @@ Value VM::runFrame(CallFrame &current_frame) {
                 // TODO: marked for removal
             case OpCode::CreateGlobal: {
                 uint32_t ci = readUint32();
-                Value nameVal = frame->chunk->constants[ci];
-                string name = nameVal.toString();
+                Atom name = frame->chunk->atomAt(ci);
                 Value v = pop();
                 
                 env->set_var(name, v);
@@ -583,8 +581,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::LoadGlobalVar: {
                 
                 uint32_t ci = readUint32();
-                Value nameVal = frame->chunk->constants[ci];
-                string name = nameVal.toString();
+                Atom name = frame->chunk->atomAt(ci);
                 
                 R env_value = env->get(name);
                 
@@ -608,8 +605,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::StoreGlobalVar: {
                 
                 uint32_t ci = readUint32();
-                Value nameVal = frame->chunk->constants[ci];
-                string name = nameVal.toString();
+                Atom name = frame->chunk->atomAt(ci);
                 Value v = pop();
                 
                 env->set_var(name, v);
@@ -629,8 +625,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::StoreGlobalLet: {
                 
                 uint32_t ci = readUint32();
-                Value nameVal = frame->chunk->constants[ci];
-                string name = nameVal.toString();
+                Atom name = frame->chunk->atomAt(ci);
                 Value v = pop();
                 
                 env->set_let(name, v);
@@ -669,8 +664,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateGlobalVar: {
                 
                 uint32_t ci = readUint32();
-                Value nameVal = frame->chunk->constants[ci];
-                string name = nameVal.toString();
+                Atom name = frame->chunk->atomAt(ci);
                 Value v = pop();
                 
                 env->set_var(name, v);
@@ -681,8 +675,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateGlobalLet: {
                 
                 uint32_t ci = readUint32();
-                Value nameVal = frame->chunk->constants[ci];
-                string name = nameVal.toString();
+                Atom name = frame->chunk->atomAt(ci);
                 Value v = pop();
                 
                 env->set_let(name, v);
@@ -693,8 +686,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateGlobalConst: {
                 
                 uint32_t ci = readUint32();
-                Value nameVal = frame->chunk->constants[ci];
-                string name = nameVal.toString();
+                Atom name = frame->chunk->atomAt(ci);
                 Value v = pop();
                 
                 env->set_const(name, v);
@@ -707,8 +699,7 @@ Value VM::runFrame(CallFrame &current_frame) {
                 uint32_t idx = readUint32();
                 
                 // load constant from nameIdx
-                Value property_value = frame->chunk->constants[idx];
-                string property_name = property_value.toString();
+                Atom property_name = frame->chunk->atomAt(idx);
                 
                 Value value = pop();
                 
@@ -760,9 +751,7 @@ Value VM::runFrame(CallFrame &current_frame) {
                 uint32_t idx = readUint32();
                 
                 // load constant from nameIdx
-                Value property_value = frame->chunk->constants[idx];
-                
-                string property_name = property_value.toString();
+                Atom property_name = frame->chunk->atomAt(idx);
                                 
                 Value obj = getProperty(Value::object(frame->closure->js_object), property_name);
                 
@@ -861,8 +850,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateObjectLiteralProperty: {
                 
                 uint32_t idx = readUint32();
-                Value constant = frame->chunk->constants[idx];
-                string prop_name = constant.toString();
+                Atom prop_name = frame->chunk->atomAt(idx);
                 
                 Value val = pop();
                 
@@ -912,7 +900,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateClassPrivatePropertyVar: {
 
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
 
                 Value valueToSet = pop();
                 Value klassVal = pop();
@@ -928,7 +916,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateClassPublicPropertyVar: {
                 
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
 
                 Value valueToSet = pop();
                 Value klassVal = pop();
@@ -945,7 +933,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateClassProtectedPropertyVar: {
                 
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
 
                 Value valueToSet = pop();
                 Value klassVal = pop();
@@ -963,7 +951,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateClassPrivatePropertyConst: {
                 
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
 
                 Value valueToSet = pop();
                 Value klassVal = pop();
@@ -979,7 +967,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateClassPublicPropertyConst: {
                 
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
 
                 Value valueToSet = pop();
                 Value klassVal = pop();
@@ -995,7 +983,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateClassProtectedPropertyConst: {
                 
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
 
                 Value valueToSet = pop();
                 Value klassVal = pop();
@@ -1012,7 +1000,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateClassPrivateStaticPropertyVar: {
                 
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
                 
                 Value valueToSet = pop();
                 Value objVal = pop();
@@ -1028,7 +1016,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateClassPublicStaticPropertyVar: {
                 
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
                 
                 Value valueToSet = pop();
                 Value objVal = pop();
@@ -1044,7 +1032,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateClassProtectedStaticPropertyVar: {
                 
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
                 
                 Value valueToSet = pop();
                 Value objVal = pop();
@@ -1060,7 +1048,7 @@ Value VM::runFrame(CallFrame &current_frame) {
                 // static const
             case OpCode::CreateClassPrivateStaticPropertyConst: {
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
                 
                 Value valueToSet = pop();
                 Value objVal = pop();
@@ -1075,7 +1063,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateClassPublicStaticPropertyConst: {
                 
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
                 
                 Value valueToSet = pop();
                 Value objVal = pop();
@@ -1091,7 +1079,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateClassProtectedStaticPropertyConst: {
                 
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
                 
                 Value valueToSet = pop();
                 Value objVal = pop();
@@ -1108,7 +1096,7 @@ Value VM::runFrame(CallFrame &current_frame) {
                 
             case OpCode::CreateClassProtectedStaticMethod: {
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
                 
                 Value valueToSet = pop();
                 Value objVal = pop();
@@ -1122,7 +1110,7 @@ Value VM::runFrame(CallFrame &current_frame) {
                 
             case OpCode::CreateClassPrivateStaticMethod: {
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
                 
                 Value valueToSet = pop();
                 Value objVal = pop();
@@ -1135,7 +1123,7 @@ Value VM::runFrame(CallFrame &current_frame) {
                 
             case OpCode::CreateClassPublicStaticMethod: {
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
                 
                 Value valueToSet = pop();
                 Value objVal = pop();
@@ -1149,7 +1137,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateClassProtectedMethod: {
                 
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
 
                 Value valueToSet = pop();
                 Value klassVal = pop();
@@ -1164,7 +1152,7 @@ Value VM::runFrame(CallFrame &current_frame) {
                 
             case OpCode::CreateClassPrivateMethod: {
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
 
                 Value valueToSet = pop();
                 Value klassVal = pop();
@@ -1179,7 +1167,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::CreateClassPublicMethod: {
                 
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
 
                 Value valueToSet = pop();
                 Value klassVal = pop();
@@ -1222,7 +1210,7 @@ Value VM::runFrame(CallFrame &current_frame) {
                 // this update the object the current object
                 int index = readUint32();
                 Value v = pop();
-                string prop = frame->chunk->constants[index].toString();
+                Atom prop = frame->chunk->atomAt(index);
                 setProperty(Value::object(frame->closure->js_object), prop, v);
 
                 break;
@@ -1231,7 +1219,7 @@ Value VM::runFrame(CallFrame &current_frame) {
             case OpCode::GetThisProperty: {
                 
                 int index = readUint32();
-                string prop = frame->chunk->constants[index].toString();
+                Atom prop = frame->chunk->atomAt(index);
 
                 push(getProperty(Value::object(frame->closure->js_object), prop));
                 
@@ -1305,7 +1293,7 @@ Value VM::runFrame(CallFrame &current_frame) {
                 
             case OpCode::SetStaticProperty: {
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
                 Value valueToSet = pop();
                 Value objVal = pop();
                 setStaticProperty(objVal, prop, valueToSet);
@@ -1316,7 +1304,7 @@ Value VM::runFrame(CallFrame &current_frame) {
                 
             case OpCode::SetProperty: {
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
                 Value valueToSet = pop();
                 Value objVal = pop();
                 setProperty(objVal, prop, valueToSet);
@@ -1327,7 +1315,7 @@ Value VM::runFrame(CallFrame &current_frame) {
 
             case OpCode::GetProperty: {
                 uint32_t ci = readUint32();
-                string prop = frame->chunk->constants[ci].toString();
+                Atom prop = frame->chunk->atomAt(ci);
                 Value objVal = pop();
                 Value v = getProperty(objVal, prop);
                 push(v);
@@ -1425,9 +1413,8 @@ Value VM::runFrame(CallFrame &current_frame) {
                 Value spreadArray = pop();
                 Value array = pop();
                 
-                for( auto index : spreadArray.arrayValue->get_indexed_properties()) {
-                    array.arrayValue->push({ index.second });
-                }
+                const vector<Value>& items = spreadArray.arrayValue->elements;
+                array.arrayValue->elements.insert(array.arrayValue->elements.end(), items.begin(), items.end());
                 
                 push(array);
                 
@@ -1753,7 +1740,7 @@ Value VM::runFrame(CallFrame &current_frame) {
 
                 if (inputArr && start < (int)inputArr->length()) {
                     for (int i = start; i < (int)inputArr->length(); ++i) {
-                        arr->push({ inputArr->get(to_string(i)) });
+                        arr->elements.push_back(inputArr->elements[i]);
                     }
                 }
                 push(Value::array(arr));
@@ -1966,7 +1953,7 @@ Value VM::callMethod(Value callee, vector<Value>& args, Value js_object) {
 
 }
 
-Value VM::callFunction(Value callee, const vector<Value>& args) {
+Value VM::callFunction(const Value& callee, const vector<Value>& args) {
     
     if (callee.type == ValueType::FUNCTION) {
         Value result = callee.functionValue(args);
@@ -2078,10 +2065,8 @@ vector<Value> VM::popArgs(size_t count) {
         if (isSpread) {
             const Value& spreadVal = rawArgs[i];
             if (spreadVal.type == ValueType::ARRAY) {
-                const auto& arr = spreadVal.arrayValue->get_indexed_properties();
-                for (auto& kv : arr) {
-                    finalArgs.push_back(kv.second);
-                }
+                const vector<Value>& items = spreadVal.arrayValue->elements;
+                finalArgs.insert(finalArgs.end(), items.begin(), items.end());
             } else {
                 throw runtime_error("Cannot spread non-iterable argument.");
             }
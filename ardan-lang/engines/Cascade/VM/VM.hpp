@@ -72,7 +72,7 @@ public:
     Env* env;
     EventLoop* event_loop;
 
-    Value callFunction(Value callee, const vector<Value>& args);
+    Value callFunction(const Value& callee, const vector<Value>& args) override;
 
 private:
     shared_ptr<Module> module_ = nullptr;               
@@ -104,7 +104,7 @@ private:
     uint32_t readUint32();
     uint8_t readUint8();
     void init_builtins();
-    Value getProperty(const Value &objVal, const string &propName);
+    Value getProperty(const Value &objVal, Atom propName);
     void closeUpvalues(Value* last);
     shared_ptr<Upvalue> captureUpvalue(Value* local);
     void CreateObjectLiteralProperty(Value obj_val, string prop_name, Value object);
@@ -6,6 +6,7 @@
 //
 
 #include "DeathStar.hpp"
+#include "Profiler/OpcodeStats.hpp"
 
 Value DeathStar::reg(ardan::CallFrame& f, int index) {
     return f.registers[index];
@@ -43,6 +44,10 @@ Value DeathStar::run(ardan::CallFrame& frame) {
     while (true) {
 
         Bytecode op = static_cast<Bytecode>(next(frame));
+        
+#ifdef ARDAN_OPCODE_STATS
+        OpcodeStats::deathStar().dispatch((uint8_t)op);
+#endif
 
         switch (op) {
 
@@ -6,3 +6,164 @@
 //
 
 #include "TurboBytecode.hpp"
+
+const char* turboOpCodeName(TurboOpCode op) {
+    switch (op) {
+        case TurboOpCode::Nop: return "Nop";
+        case TurboOpCode::LoadConst: return "LoadConst";
+        case TurboOpCode::LoadVar: return "LoadVar";
+        case TurboOpCode::LoadLocalVar: return "LoadLocalVar";
+        case TurboOpCode::LoadGlobalVar: return "LoadGlobalVar";
+        case TurboOpCode::StoreLocalVar: return "StoreLocalVar";
+        case TurboOpCode::StoreGlobalVar: return "StoreGlobalVar";
+        case TurboOpCode::StoreLocalLet: return "StoreLocalLet";
+        case TurboOpCode::StoreGlobalLet: return "StoreGlobalLet";
+        case TurboOpCode::CreateLocalVar: return "CreateLocalVar";
+        case TurboOpCode::CreateLocalLet: return "CreateLocalLet";
+        case TurboOpCode::CreateLocalConst: return "CreateLocalConst";
+        case TurboOpCode::CreateGlobalVar: return "CreateGlobalVar";
+        case TurboOpCode::CreateGlobalLet: return "CreateGlobalLet";
+        case TurboOpCode::CreateGlobalConst: return "CreateGlobalConst";
+        case TurboOpCode::Move: return "Move";
+        case TurboOpCode::Add: return "Add";
+        case TurboOpCode::Subtract: return "Subtract";
+        case TurboOpCode::Multiply: return "Multiply";
+        case TurboOpCode::Divide: return "Divide";
+        case TurboOpCode::Modulo: return "Modulo";
+        case TurboOpCode::Power: return "Power";
+        case TurboOpCode::Call: return "Call";
+        case TurboOpCode::PushArg: return "PushArg";
+        case TurboOpCode::Return: return "Return";
+        case TurboOpCode::Negate: return "Negate";
+        case TurboOpCode::LogicalNot: return "LogicalNot";
+        case TurboOpCode::Equal: return "Equal";
+        case TurboOpCode::NotEqual: return "NotEqual";
+        case TurboOpCode::LessThan: return "LessThan";
+        case TurboOpCode::LessThanOrEqual: return "LessThanOrEqual";
+        case TurboOpCode::GreaterThan: return "GreaterThan";
+        case TurboOpCode::GreaterThanOrEqual: return "GreaterThanOrEqual";
+        case TurboOpCode::LogicalAnd: return "LogicalAnd";
+        case TurboOpCode::LogicalOr: return "LogicalOr";
+        case TurboOpCode::NullishCoalescing: return "NullishCoalescing";
+        case TurboOpCode::StrictEqual: return "StrictEqual";
+        case TurboOpCode::StrictNotEqual: return "StrictNotEqual";
+        case TurboOpCode::Increment: return "Increment";
+        case TurboOpCode::Decrement: return "Decrement";
+        case TurboOpCode::BitAnd: return "BitAnd";
+        case TurboOpCode::BitOr: return "BitOr";
+        case TurboOpCode::BitXor: return "BitXor";
+        case TurboOpCode::ShiftLeft: return "ShiftLeft";
+        case TurboOpCode::ShiftRight: return "ShiftRight";
+        case TurboOpCode::UnsignedShiftRight: return "UnsignedShiftRight";
+        case TurboOpCode::Positive: return "Positive";
+        case TurboOpCode::Jump: return "Jump";
+        case TurboOpCode::JumpIfFalse: return "JumpIfFalse";
+        case TurboOpCode::JumpIfTrue: return "JumpIfTrue";
+        case TurboOpCode::Loop: return "Loop";
+        case TurboOpCode::CreateArrayLiteral: return "CreateArrayLiteral";
+        case TurboOpCode::CreateObjectLiteral: return "CreateObjectLiteral";
+        case TurboOpCode::CreateObjectLiteralProperty: return "CreateObjectLiteralProperty";
+        case TurboOpCode::ArrayPush: return "ArrayPush";
+        case TurboOpCode::SetProperty: return "SetProperty";
+        case TurboOpCode::GetProperty: return "GetProperty";
+        case TurboOpCode::In: return "In";
+        case TurboOpCode::Void: return "Void";
+        case TurboOpCode::ArraySpread: return "ArraySpread";
+        case TurboOpCode::ObjectSpread: return "ObjectSpread";
+        case TurboOpCode::PushSpreadArg: return "PushSpreadArg";
+        case TurboOpCode::GetPropertyDynamic: return "GetPropertyDynamic";
+        case TurboOpCode::Dup2: return "Dup2";
+        case TurboOpCode::SetPropertyDynamic: return "SetPropertyDynamic";
+        case TurboOpCode::NewClass: return "NewClass";
+        case TurboOpCode::CreateClassPrivatePropertyVar: return "CreateClassPrivatePropertyVar";
+        case TurboOpCode::CreateClassPublicPropertyVar: return "CreateClassPublicPropertyVar";
+        case TurboOpCode::CreateClassProtectedPropertyVar: return "CreateClassProtectedPropertyVar";
+        case TurboOpCode::CreateClassPrivatePropertyConst: return "CreateClassPrivatePropertyConst";
+        case TurboOpCode::CreateClassPublicPropertyConst: return "CreateClassPublicPropertyConst";
+        case TurboOpCode::CreateClassProtectedPropertyConst: return "CreateClassProtectedPropertyConst";
+        case TurboOpCode::CreateClassPrivateStaticPropertyVar: return "CreateClassPrivateStaticPropertyVar";
+        case TurboOpCode::CreateClassPublicStaticPropertyVar: return "CreateClassPublicStaticPropertyVar";
+        case TurboOpCode::CreateClassProtectedStaticPropertyVar: return "CreateClassProtectedStaticPropertyVar";
+        case TurboOpCode::CreateClassPrivateStaticPropertyConst: return "CreateClassPrivateStaticPropertyConst";
+        case TurboOpCode::CreateClassPublicStaticPropertyConst: return "CreateClassPublicStaticPropertyConst";
+        case TurboOpCode::CreateClassProtectedStaticPropertyConst: return "CreateClassProtectedStaticPropertyConst";
+        case TurboOpCode::CreateClassProtectedStaticMethod: return "CreateClassProtectedStaticMethod";
+        case TurboOpCode::CreateClassPrivateStaticMethod: return "CreateClassPrivateStaticMethod";
+        case TurboOpCode::CreateClassPublicStaticMethod: return "CreateClassPublicStaticMethod";
+        case TurboOpCode::CreateClassProtectedMethod: return "CreateClassProtectedMethod";
+        case TurboOpCode::CreateClassPrivateMethod: return "CreateClassPrivateMethod";
+        case TurboOpCode::CreateClassPublicMethod: return "CreateClassPublicMethod";
+        case TurboOpCode::Try: return "Try";
+        case TurboOpCode::EndTry: return "EndTry";
+        case TurboOpCode::EndFinally: return "EndFinally";
+        case TurboOpCode::Throw: return "Throw";
+        case TurboOpCode::LoadExceptionValue: return "LoadExceptionValue";
+        case TurboOpCode::EnumKeys: return "EnumKeys";
+        case TurboOpCode::GetObjectLength: return "GetObjectLength";
+        case TurboOpCode::GetIndexPropertyDynamic: return "GetIndexPropertyDynamic";
+        case TurboOpCode::Debug: return "Debug";
+        case TurboOpCode::LoadChunkIndex: return "LoadChunkIndex";
+        case TurboOpCode::LoadArgument: return "LoadArgument";
+        case TurboOpCode::LoadArguments: return "LoadArguments";
+        case TurboOpCode::Slice: return "Slice";
+        case TurboOpCode::LoadArgumentsLength: return "LoadArgumentsLength";
+        case TurboOpCode::CreateClosure: return "CreateClosure";
+        case TurboOpCode::SetClosureIsLocal: return "SetClosureIsLocal";
+        case TurboOpCode::SetClosureIndex: return "SetClosureIndex";
+        case TurboOpCode::CloseUpvalue: return "CloseUpvalue";
+        case TurboOpCode::LoadUpvalue: return "LoadUpvalue";
+        case TurboOpCode::StoreUpvalueVar: return "StoreUpvalueVar";
+        case TurboOpCode::StoreUpvalueLet: return "StoreUpvalueLet";
+        case TurboOpCode::StoreUpvalueConst: return "StoreUpvalueConst";
+        case TurboOpCode::CreateLocalBox: return "CreateLocalBox";
+        case TurboOpCode::StoreLocalBox: return "StoreLocalBox";
+        case TurboOpCode::LoadLocalBox: return "LoadLocalBox";
+        case TurboOpCode::CaptureLocal: return "CaptureLocal";
+        case TurboOpCode::CaptureLocalBox: return "CaptureLocalBox";
+        case TurboOpCode::CaptureUpvalue: return "CaptureUpvalue";
+        case TurboOpCode::ClearStack: return "ClearStack";
+        case TurboOpCode::ClearLocals: return "ClearLocals";
+        case TurboOpCode::LoadThisProperty: return "LoadThisProperty";
+        case TurboOpCode::StoreThisProperty: return "StoreThisProperty";
+        case TurboOpCode::SetStaticProperty: return "SetStaticProperty";
+        case TurboOpCode::CreateInstance: return "CreateInstance";
+        case TurboOpCode::InvokeConstructor: return "InvokeConstructor";
+        case TurboOpCode::GetThisProperty: return "GetThisProperty";
+        case TurboOpCode::SetThisProperty: return "SetThisProperty";
+        case TurboOpCode::GetThis: return "GetThis";
+        case TurboOpCode::GetParentObject: return "GetParentObject";
+        case TurboOpCode::SuperCall: return "SuperCall";
+        case TurboOpCode::CallMethod: return "CallMethod";
+        case TurboOpCode::GetSuperProperty: return "GetSuperProperty";
+        case TurboOpCode::TailCall: return "TailCall";
+        case TurboOpCode::TypeOf: return "TypeOf";
+        case TurboOpCode::InstanceOf: return "InstanceOf";
+        case TurboOpCode::Delete: return "Delete";
+        case TurboOpCode::CreateEnum: return "CreateEnum";
+        case TurboOpCode::SetEnumProperty: return "SetEnumProperty";
+        case TurboOpCode::CreateUIView: return "CreateUIView";
+        case TurboOpCode::AddChildSubView: return "AddChildSubView";
+        case TurboOpCode::SetUIViewArgument: return "SetUIViewArgument";
+        case TurboOpCode::CallUIViewModifier: return "CallUIViewModifier";
+        case TurboOpCode::PushLexicalEnv: return "PushLexicalEnv";
+        case TurboOpCode::PopLexicalEnv: return "PopLexicalEnv";
+        case TurboOpCode::SetExecutionContext: return "SetExecutionContext";
+        case TurboOpCode::CopyIterationBinding: return "CopyIterationBinding";
+        case TurboOpCode::Await: return "Await";
+        case TurboOpCode::CreatePromise: return "CreatePromise";
+        case TurboOpCode::GetIterator: return "GetIterator";
+        case TurboOpCode::IteratorNext: return "IteratorNext";
+        case TurboOpCode::GetIndex: return "GetIndex";
+        case TurboOpCode::SetIndex: return "SetIndex";
+        case TurboOpCode::StringConcat: return "StringConcat";
+        case TurboOpCode::LessThanJumpIfFalse: return "LessThanJumpIfFalse";
+        case TurboOpCode::LessThanOrEqualJumpIfFalse: return "LessThanOrEqualJumpIfFalse";
+        case TurboOpCode::GreaterThanJumpIfFalse: return "GreaterThanJumpIfFalse";
+        case TurboOpCode::GreaterThanOrEqualJumpIfFalse: return "GreaterThanOrEqualJumpIfFalse";
+        case TurboOpCode::AddConst: return "AddConst";
+        case TurboOpCode::LoadLocalGetProperty: return "LoadLocalGetProperty";
+        case TurboOpCode::IncrementLocal: return "IncrementLocal";
+        case TurboOpCode::Halt: return "Halt";
+    }
+    return "Unknown";
+}
@@ -145,6 +145,15 @@ enum class TurboOpCode : uint8_t {
     StoreUpvalueVar,
     StoreUpvalueLet,
     StoreUpvalueConst,
+    
+    // captured locals that are assigned after capture live in a box
+    CreateLocalBox,
+    StoreLocalBox,
+    LoadLocalBox,
+    // fill the record of the closure just created, one capture each
+    CaptureLocal,
+    CaptureLocalBox,
+    CaptureUpvalue,
 
     ClearStack,
     ClearLocals,
@@ -160,6 +169,9 @@ enum class TurboOpCode : uint8_t {
     GetThis,
     GetParentObject,
     SuperCall,
+    CallMethod,
+    GetSuperProperty,
+    TailCall,
     
     TypeOf,
     InstanceOf,
@@ -183,8 +195,42 @@ enum class TurboOpCode : uint8_t {
     CreatePromise,
     // end for PeregrineVM
 
+    // for...of: GetIterator, iterReg, srcReg
+    //           IteratorNext, valueReg, iterReg, hasValueReg
+    GetIterator,
+    IteratorNext,
+
+    // obj[key], unboxed for typed arrays with a numeric key
+    // GetIndex, lhsReg, objReg, keyReg
+    // SetIndex, objReg, keyReg, valueReg
+    GetIndex,
+    SetIndex,
+
+    // StringConcat, destReg, count, followed by (count + 2) / 3 Nop
+    // instructions whose a, b, c are the part registers, in order
+    StringConcat,
+
+    // superinstructions, written by fuseSuperinstructions() over the first
+    // instruction of a hot sequence. The rest of the sequence stays in place
+    // and holds the remaining operands; the VM executes the whole sequence in
+    // one dispatch and steps over it.
+    //
+    // LessThanJumpIfFalse, -, lhsReg, rhsReg; JumpIfFalse -, offset
+    LessThanJumpIfFalse,
+    LessThanOrEqualJumpIfFalse,
+    GreaterThanJumpIfFalse,
+    GreaterThanOrEqualJumpIfFalse,
+    // AddConst, -, constIdx; Add dest, lhsReg, -
+    AddConst,
+    // LoadLocalGetProperty, -, localIdx; GetProperty dest, -, nameIdx
+    LoadLocalGetProperty,
+    // IncrementLocal, -, localIdx; LoadConst -, constIdx; Add dest; StoreLocal*
+    IncrementLocal,
+
     Halt
     
 };
 
+const char* turboOpCodeName(TurboOpCode op);
+
 #endif /* TurboBytecode_hpp */
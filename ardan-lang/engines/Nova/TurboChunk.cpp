@@ -6,10 +6,58 @@
 //
 
 #include "TurboChunk.hpp"
+#include <algorithm>
+
+// numeric constants can name properties too: `{ 1: x }`
+static Atom nameAtom(const Value& v) {
+    if (v.type == ValueType::STRING) return Atom(v.stringValue);
+    if (v.type == ValueType::NUMBER) return Atom(v.toString());
+    return Atom();
+}
 
 int TurboChunk::addConstant(const Value &v) {
     constants.push_back(v);
+    atoms.push_back(nameAtom(v));
     return (int)constants.size() - 1;
 }
 
 size_t TurboChunk::size() const { return code.size(); }
+
+void TurboChunk::markLine(uint32_t line) {
+    
+    if (line == 0) return;
+    if (!lines.empty() && lines.back().line == line) return;
+    
+    uint32_t ip = (uint32_t)code.size();
+    
+    // nothing was emitted for the previous line; reuse its entry
+    if (!lines.empty() && lines.back().ip == ip) {
+        lines.back().line = line;
+        return;
+    }
+    
+    lines.push_back({ ip, line });
+    
+}
+
+uint32_t TurboChunk::lineAt(size_t ip) const {
+    
+    auto it = upper_bound(lines.begin(), lines.end(), ip, [](size_t ip, const LineEntry& entry) {
+        return ip < entry.ip;
+    });
+    
+    if (it == lines.begin()) return 0;
+    
+    return prev(it)->line;
+    
+}
+
+const HandlerEntry* TurboChunk::handlerAt(size_t ip) const {
+    
+    for (const HandlerEntry& entry : handlers) {
+        if (ip >= entry.start && ip < entry.end) return &entry;
+    }
+    
+    return nullptr;
+    
+}
@@ -32,9 +32,33 @@ struct Instruction {
     : op(op), a(a), b(b), c(c) {}
 };
 
+// code from ip up to the next entry's ip was compiled from line
+struct LineEntry {
+    uint32_t ip;
+    uint32_t line;
+};
+
+// a try statement's handler, looked up only when something is thrown.
+// code in [start, end) that throws lands at catchIP, or at finallyIP when
+// there is no catch.
+struct HandlerEntry {
+    uint32_t start;
+    uint32_t end;
+    int catchIP;        // -1 if none
+    int finallyIP;      // -1 if none
+    uint8_t regCatch;   // register the thrown value is written to
+};
+
 struct TurboChunk {
     vector<Instruction> code;
     vector<Value> constants;
+    // atoms[i] is the interned name when constants[i] is a string or number,
+    // so name operands are looked up without hashing their characters
+    vector<Atom> atoms;
+    vector<LineEntry> lines;
+    // in the order their try statements finished compiling, so the first
+    // entry covering an ip is the innermost
+    vector<HandlerEntry> handlers;
     
     uint32_t maxLocals = 0;   
     uint32_t arity = 0;       
@@ -42,6 +66,8 @@ struct TurboChunk {
     
     int addConstant(const Value &v);
     
+    Atom atomAt(size_t index) const { return atoms[index]; }
+    
     void writeByte(uint8_t b);
     
     void writeUint32(uint32_t v);
@@ -50,6 +76,15 @@ struct TurboChunk {
     
     size_t size() const;
     
+    // records that code emitted from now on belongs to line
+    void markLine(uint32_t line);
+    
+    // source line of the instruction at ip, 0 if unknown
+    uint32_t lineAt(size_t ip) const;
+    
+    // innermost handler whose range holds ip, nullptr if none
+    const HandlerEntry* handlerAt(size_t ip) const;
+    
 };
 
 #endif /* TurboChunk_hpp */
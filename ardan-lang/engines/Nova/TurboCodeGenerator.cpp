@@ -15,6 +15,7 @@ size_t TurboCodeGen::generate(const vector<unique_ptr<Statement>> &program) {
     nextLocalSlot = 0;
     
     for (const auto &s : program) {
+        cur->markLine(s->line);
         s->accept(*this);
     }
     
@@ -34,6 +35,7 @@ R TurboCodeGen::visitExpression(ExpressionStatement* stmt) {
 R TurboCodeGen::visitBlock(BlockStatement* stmt) {
     beginScope();
     for (auto& s : stmt->body) {
+        cur->markLine(s->line);
         s->accept(*this);
         // registerAllocator->reset();
     }
@@ -70,7 +72,7 @@ R TurboCodeGen::create(string decl, uint32_t reg_slot, BindingKind kind) {
                 break;
         }
 
-        emit(op, idx, reg_slot);
+        emitLocal(op, idx, reg_slot, idx);
 
     } else {
         
@@ -126,16 +128,21 @@ R TurboCodeGen::store(string decl, uint32_t reg_slot) {
         
         uint32_t idx = getLocal(decl);
         
-        Local local = locals[idx];
+        Local& local = locals[idx];
         
         if (locals[idx].kind == BindingKind::Const) {
             throw std::runtime_error("Cannot assign value to constant variable.");
         }
         
+        if ((int)loopStack.size() > local.loopDepth) local.storedInLoop = true;
+        
+        // closures made so far hold a copy this store would leave stale
+        if (local.isCaptured) boxLocal(idx);
+        
         if (local.kind == BindingKind::Var) {
-            emit(TurboOpCode::StoreLocalVar, idx, reg_slot);
+            emitLocal(TurboOpCode::StoreLocalVar, idx, reg_slot, idx);
         } else if (local.kind == BindingKind::Let) {
-            emit(TurboOpCode::StoreLocalLet, idx, reg_slot);
+            emitLocal(TurboOpCode::StoreLocalLet, idx, reg_slot, idx);
         }
         
     } else {
@@ -145,7 +152,8 @@ R TurboCodeGen::store(string decl, uint32_t reg_slot) {
             throw runtime_error("Cannot assign value to a const field.");
         }
         
-        if (classProperty.level == 1) {
+        // superclass fields (level 2) live on the same object
+        if (classProperty.level == 1 || classProperty.level == 2) {
             
             // Rewrite: legs = one;  ⇒  this.legs = one;
             // Rewrite: legs;  ⇒  this.legs;
@@ -158,21 +166,9 @@ R TurboCodeGen::store(string decl, uint32_t reg_slot) {
             
             return true;
             
-        } else if (classProperty.level == 2) {
-            
-            int nameIdx = emitConstant(Value::str(decl));
-            
-            int parent_obj_reg = allocRegister();
-            emit(TurboOpCode::GetParentObject, parent_obj_reg);
-            // SetProperty: objReg, nameIdx, valueReg
-            emit(TurboOpCode::SetProperty, parent_obj_reg, nameIdx, reg_slot);
-            freeRegister(parent_obj_reg);
-            
-            return true;
-
         }
         
-        int upvalue = resolveUpvalue(decl);
+        int upvalue = resolveUpvalue(decl, true);
         if (upvalue != -1) {
             
             UpvalueMeta upvalueMeta = upvalues[upvalue];
@@ -190,17 +186,21 @@ R TurboCodeGen::store(string decl, uint32_t reg_slot) {
             return true;
         }
         
-        // top-level/global
+        // top-level/global, declared on the outermost generator. A deferred
+        // function's stand-in top level knows none, and stores them as vars.
         int nameIdx = emitConstant(Value::str(decl));
-        Global global = globals[lookupGlobal(decl)];
+        TurboCodeGen* top = this;
+        while (top->enclosing) top = top->enclosing;
+        int globalIndex = top->lookupGlobal(decl);
+        BindingKind kind = globalIndex == -1 ? BindingKind::Var : top->globals[globalIndex].kind;
         
-        if (global.kind == BindingKind::Const) {
+        if (kind == BindingKind::Const) {
             throw runtime_error("Cannot assign value to a const expression");
         }
         
-        if (global.kind == BindingKind::Var) {
+        if (kind == BindingKind::Var) {
             emit(TurboOpCode::StoreGlobalVar, (uint32_t)nameIdx, reg_slot);
-        } else if (global.kind == BindingKind::Let) {
+        } else if (kind == BindingKind::Let) {
             emit(TurboOpCode::StoreGlobalLet, (uint32_t)nameIdx, reg_slot);
         }
         
@@ -216,12 +216,13 @@ R TurboCodeGen::load(string decl, uint32_t reg_slot) {
     // decide local or global
     if (hasLocal(decl)) {
         uint32_t idx = getLocal(decl);
-        emit(TurboOpCode::LoadLocalVar, reg_slot, idx);
+        emitLocal(TurboOpCode::LoadLocalVar, reg_slot, idx, idx);
     } else {
         
         // search if decl is in class fields
         TurboCodeGen::PropertyLookup result = lookupClassProperty(decl);
-        if (result.level == 1) {
+        // level 2 exists in parent class, whose members are found through this too
+        if (result.level == 1 || result.level == 2) {
             
             // Rewrite: legs = one;  ⇒  this.legs = one;
             // Rewrite: legs;  ⇒  this.legs;
@@ -232,16 +233,6 @@ R TurboCodeGen::load(string decl, uint32_t reg_slot) {
             // int nameIdx = emitConstant(Value::str(decl));
             // emitUint32(nameIdx);
             return true;
-        } else if (result.level == 2) {
-            // exists in parent class
-            
-            int nameIdx = emitConstant(Value::str(decl));
-
-            int parent_obj_reg = allocRegister();
-            emit(TurboOpCode::GetParentObject, parent_obj_reg);
-            emit(TurboOpCode::GetProperty, reg_slot, parent_obj_reg, nameIdx);
-            freeRegister(parent_obj_reg);
-            return true;
         }
         
         int upvalue = resolveUpvalue(decl);
@@ -277,11 +268,11 @@ R TurboCodeGen::visitVariable(VariableStatement* stmt) {
             emit(TurboOpCode::Move, slot, initReg); // move data inside initReg into register slot.
             freeRegister(initReg);
             
-            if (auto classExpr = dynamic_cast<ClassExpression*>(decl.init.get())) {
+            if (auto classExpr = node_cast<ClassExpression>(decl.init.get())) {
                 classExpr->name = decl.id;
-            } else if (auto functionExpr = dynamic_cast<FunctionExpression*>(decl.init.get())) {
+            } else if (auto functionExpr = node_cast<FunctionExpression>(decl.init.get())) {
                 functionExpr->name = decl.id;
-            } else if (auto arrowFunctionExpr = dynamic_cast<ArrowFunction*>(decl.init.get())) {
+            } else if (auto arrowFunctionExpr = node_cast<ArrowFunction>(decl.init.get())) {
                 arrowFunctionExpr->name = decl.id;
             }
 
@@ -422,9 +413,11 @@ R TurboCodeGen::visitReturn(ReturnStatement* stmt) {
     
     uint32_t value = allocRegister();
     
-    if (stmt->argument)
+    if (stmt->argument) {
+        tailCall = tryDepth == 0 && node_cast<CallExpression>(stmt->argument.get()) != nullptr;
         value = get<int>(stmt->argument->accept(*this));
-    else
+        tailCall = false;
+    } else
         emit(TurboOpCode::LoadConst, value, emitConstant(Value::undefined()));
     
     emit(TurboOpCode::Return, value);
@@ -520,22 +513,22 @@ void TurboCodeGen::emitAssignment(BinaryExpression* expr) {
 
         // int rhsReg = allocRegister();
         
-        if (auto classExpr = dynamic_cast<ClassExpression*>(expr->right.get())) {
-            if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+        if (auto classExpr = node_cast<ClassExpression>(expr->right.get())) {
+            if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
                 classExpr->name = idExpr->name;
-            } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+            } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
                 classExpr->name = evaluate_property(memberExpr);
             }
-        } else if (auto functionExpr = dynamic_cast<FunctionExpression*>(expr->right.get())) {
-            if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+        } else if (auto functionExpr = node_cast<FunctionExpression>(expr->right.get())) {
+            if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
                 functionExpr->name = idExpr->name;
-            } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+            } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
                 functionExpr->name = evaluate_property(memberExpr);
             }
-        } else if (auto arrowFunctionExpr = dynamic_cast<ArrowFunction*>(expr->right.get())) {
-            if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+        } else if (auto arrowFunctionExpr = node_cast<ArrowFunction>(expr->right.get())) {
+            if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
                 arrowFunctionExpr->name = idExpr->name;
-            } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+            } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
                 arrowFunctionExpr->name = evaluate_property(memberExpr);
             }
         }
@@ -543,13 +536,13 @@ void TurboCodeGen::emitAssignment(BinaryExpression* expr) {
         
         int resultReg = get<int>(expr->right->accept(*this));
         
-        if (auto* ident = dynamic_cast<IdentifierExpression*>(left)) {
+        if (auto* ident = node_cast<IdentifierExpression>(left)) {
             // int destReg = lookupLocalSlot(ident->name);
             // Move/copy result into local/global slot
             // emit(TurboOpCode::Move, destReg, resultReg);
             store(ident->name, resultReg);
         }
-        else if (auto* member = dynamic_cast<MemberExpression*>(left)) {
+        else if (auto* member = node_cast<MemberExpression>(left)) {
 
             int objReg = get<int>(member->object->accept(*this));
             
@@ -557,8 +550,8 @@ void TurboCodeGen::emitAssignment(BinaryExpression* expr) {
                 
                 int propReg = get<int>(member->property->accept(*this)); // Property key to reg
                 
-                // SetPropertyDynamic: objReg, propReg, valueReg
-                emit(TurboOpCode::SetPropertyDynamic, objReg, propReg, resultReg);
+                // SetIndex: objReg, propReg, valueReg
+                emit(TurboOpCode::SetIndex, objReg, propReg, resultReg);
                 freeRegister(propReg); // propReg
                 
             } else {
@@ -586,39 +579,39 @@ void TurboCodeGen::emitAssignment(BinaryExpression* expr) {
     int propReg = -1;
     int nameIdx = -1;
     
-    if (auto classExpr = dynamic_cast<ClassExpression*>(expr->right.get())) {
-        if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+    if (auto classExpr = node_cast<ClassExpression>(expr->right.get())) {
+        if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
             classExpr->name = idExpr->name;
-        } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+        } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
             classExpr->name = evaluate_property(memberExpr); // e.g. obj.B
         }
-    } else if (auto functionExpr = dynamic_cast<FunctionExpression*>(expr->right.get())) {
-        if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+    } else if (auto functionExpr = node_cast<FunctionExpression>(expr->right.get())) {
+        if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
             functionExpr->name = idExpr->name;
-        } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+        } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
             functionExpr->name = evaluate_property(memberExpr);
         }
-    } else if (auto arrowFunctionExpr = dynamic_cast<ArrowFunction*>(expr->right.get())) {
-        if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+    } else if (auto arrowFunctionExpr = node_cast<ArrowFunction>(expr->right.get())) {
+        if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
             arrowFunctionExpr->name = idExpr->name;
-        } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+        } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
             arrowFunctionExpr->name = evaluate_property(memberExpr);
         }
 
     }
 
     
-    if (auto* ident = dynamic_cast<IdentifierExpression*>(left)) {
+    if (auto* ident = node_cast<IdentifierExpression>(left)) {
         load(ident->name, lhsReg);
     }
-    else if (auto* member = dynamic_cast<MemberExpression*>(left)) {
+    else if (auto* member = node_cast<MemberExpression>(left)) {
         
          objReg = get<int>(member->object->accept(*this));
         
          if (member->computed) {
              propReg = get<int>(member->property->accept(*this));
              // Get property value into lhsReg
-             emit(TurboOpCode::GetPropertyDynamic, lhsReg, objReg, propReg);
+             emit(TurboOpCode::GetIndex, lhsReg, objReg, propReg);
          } else {
              nameIdx = emitConstant(Value::str(member->name.lexeme));
              emit(TurboOpCode::GetProperty, lhsReg, objReg, nameIdx);
@@ -652,13 +645,13 @@ void TurboCodeGen::emitAssignment(BinaryExpression* expr) {
         default: throw std::runtime_error("Unknown compound assignment operator in emitAssignment");
     }
     
-    if (auto* ident = dynamic_cast<IdentifierExpression*>(left)) {
+    if (auto* ident = node_cast<IdentifierExpression>(left)) {
         // emit(TurboOpCode::Move, lhsReg, opResultReg);
         store(ident->name, opResultReg);
     }
-    else if (auto* member = dynamic_cast<MemberExpression*>(left)) {
+    else if (auto* member = node_cast<MemberExpression>(left)) {
          if (member->computed) {
-             emit(TurboOpCode::SetPropertyDynamic, objReg, propReg, opResultReg);
+             emit(TurboOpCode::SetIndex, objReg, propReg, opResultReg);
              freeRegister(propReg); // propReg
          } else {
              emit(TurboOpCode::SetProperty, objReg, nameIdx, opResultReg);
@@ -697,7 +690,21 @@ R TurboCodeGen::visitIdentifier(IdentifierExpression* expr) {
 
 R TurboCodeGen::visitCall(CallExpression* expr) {
 
-    int funcReg = get<int>(expr->callee->accept(*this));
+    bool superCall = node_cast<SuperExpression>(expr->callee.get()) != nullptr;
+    auto member = node_cast<MemberExpression>(expr->callee.get());
+    // only this call is in tail position, not the ones in its arguments
+    bool tail = tailCall;
+    tailCall = false;
+
+    // obj.method(...) passes obj along as `this`
+    int funcReg = 0;
+    int receiverReg = -1;
+    if (member) {
+        receiverReg = get<int>(member->object->accept(*this));
+        funcReg = getMember(member, receiverReg);
+    } else if (!superCall) {
+        funcReg = get<int>(expr->callee->accept(*this));
+    }
 
     vector<int> argRegs;
     argRegs.reserve(expr->arguments.size());
@@ -711,7 +718,7 @@ R TurboCodeGen::visitCall(CallExpression* expr) {
 
     for (int argReg : argRegs) {
         
-        if (auto spreadExpr = dynamic_cast<SpreadExpression*>((expr->arguments[index]).get())) {
+        if (auto spreadExpr = node_cast<SpreadExpression>((expr->arguments[index]).get())) {
             emit(TurboOpCode::PushSpreadArg, argReg);
         } else {
             emit(TurboOpCode::PushArg, argReg);
@@ -721,10 +728,12 @@ R TurboCodeGen::visitCall(CallExpression* expr) {
         
     }
 
-    if (auto super_expr = dynamic_cast<SuperExpression*>(expr->callee.get())) {
-        emit(TurboOpCode::SuperCall, resultReg, funcReg, static_cast<int>(argRegs.size()));
+    if (superCall) {
+        emit(TurboOpCode::SuperCall, resultReg, 0, static_cast<int>(argRegs.size()));
+    } else if (member) {
+        emit(TurboOpCode::CallMethod, resultReg, funcReg, receiverReg);
     } else {
-        emit(TurboOpCode::Call, resultReg, funcReg, static_cast<int>(argRegs.size()));
+        emit(tail ? TurboOpCode::TailCall : TurboOpCode::Call, resultReg, funcReg, static_cast<int>(argRegs.size()));
     }
 
     for (int argReg : argRegs) {
@@ -740,13 +749,23 @@ R TurboCodeGen::visitMember(MemberExpression* expr) {
     
     int objectReg = get<int>(expr->object->accept(*this));
 
+    return getMember(expr, objectReg);
+    
+}
+
+// loads expr.property off the object already in objectReg
+int TurboCodeGen::getMember(MemberExpression* expr, int objectReg) {
+
     int targetReg = allocRegister();
 
-    if (expr->computed) {
+    if (!expr->computed && node_cast<SuperExpression>(expr->object.get())) {
+        // super.name: from the superclass of the method's class
+        emit(TurboOpCode::GetSuperProperty, targetReg, emitConstant(Value::str(expr->name.lexeme)));
+    } else if (expr->computed) {
         // obj[prop]
         int propertyReg = get<int>(expr->property->accept(*this));
 
-        emit(TurboOpCode::GetPropertyDynamic, targetReg, objectReg, propertyReg);
+        emit(TurboOpCode::GetIndex, targetReg, objectReg, propertyReg);
         
         freeRegister(propertyReg);
         
@@ -767,7 +786,7 @@ R TurboCodeGen::visitNew(NewExpression* expr) {
         throw runtime_error("Arguments to constructor must not exceed 255.");
     }
     
-    if (auto ident = dynamic_cast<IdentifierExpression*>(expr->callee.get())) {
+    if (auto ident = node_cast<IdentifierExpression>(expr->callee.get())) {
                 
         int reg = get<int>(ident->accept(*this));
         
@@ -810,7 +829,7 @@ R TurboCodeGen::visitArray(ArrayLiteralExpression* expr) {
 
     for (auto& el : expr->elements) {
 
-        if (SpreadExpression* spread = dynamic_cast<SpreadExpression*>(el.get())) {
+        if (SpreadExpression* spread = node_cast<SpreadExpression>(el.get())) {
 
             int val = get<int>(spread->expression->accept(*this));
             emit(TurboOpCode::ArraySpread, arr, val);
@@ -835,24 +854,24 @@ R TurboCodeGen::visitObject(ObjectLiteralExpression* expr) {
     
     for (auto& prop : expr->props) {
 
-        if (auto classExpr = dynamic_cast<ClassExpression*>(prop.second.get())) {
+        if (auto classExpr = node_cast<ClassExpression>(prop.second.get())) {
             classExpr->name = prop.first.lexeme;
-        } else if (auto functionExpr = dynamic_cast<FunctionExpression*>(prop.second.get())) {
+        } else if (auto functionExpr = node_cast<FunctionExpression>(prop.second.get())) {
             functionExpr->name = prop.first.lexeme;
-        } else if (auto arrowFunctionExpr = dynamic_cast<ArrowFunction*>(prop.second.get())) {
+        } else if (auto arrowFunctionExpr = node_cast<ArrowFunction>(prop.second.get())) {
             arrowFunctionExpr->name = prop.first.lexeme;
         }
 
         int val = -1;
         
-        if (SpreadExpression* spread = dynamic_cast<SpreadExpression*>(prop.second.get())) {
+        if (SpreadExpression* spread = node_cast<SpreadExpression>(prop.second.get())) {
             
-            int val = get<int>(spread->expression->accept(*this));
+            val = get<int>(spread->expression->accept(*this));
             emit(TurboOpCode::ObjectSpread, obj, val);
             
         } else {
             
-            int val = get<int>(prop.second->accept(*this));
+            val = get<int>(prop.second->accept(*this));
             emit(TurboOpCode::CreateObjectLiteralProperty, obj, emitConstant(prop.first.lexeme), val);
         }
         
@@ -896,7 +915,7 @@ R TurboCodeGen::visitUnary(UnaryExpression* expr) {
         
         int reg = allocRegister();
         
-        if (auto member = dynamic_cast<MemberExpression*>(expr->right.get())) {
+        if (auto member = node_cast<MemberExpression>(expr->right.get())) {
             
             int objReg = get<int>(member->object->accept(*this));
             
@@ -933,7 +952,7 @@ R TurboCodeGen::visitUnary(UnaryExpression* expr) {
     if (expr->op.type == TokenType::INCREMENT || expr->op.type == TokenType::DECREMENT) {
 
         // ++x or --x
-        if (auto ident = dynamic_cast<IdentifierExpression*>(expr->right.get())) {
+        if (auto ident = node_cast<IdentifierExpression>(expr->right.get())) {
             
             int lhsReg = allocRegister();
             load(ident->name, lhsReg);
@@ -957,7 +976,7 @@ R TurboCodeGen::visitUnary(UnaryExpression* expr) {
             
         }
 
-        if (auto member_expr = dynamic_cast<MemberExpression*>(expr->right.get())) {
+        if (auto member_expr = node_cast<MemberExpression>(expr->right.get())) {
             
             int lhsReg = get<int>(member_expr->accept(*this));
             int rhsReg = allocRegister();
@@ -978,8 +997,8 @@ R TurboCodeGen::visitUnary(UnaryExpression* expr) {
                 
                 int propReg = get<int>(member_expr->property->accept(*this)); // Property key to reg
                 
-                // SetPropertyDynamic: objReg, propReg, valueReg
-                emit(TurboOpCode::SetPropertyDynamic, objReg, propReg, opResultReg);
+                // SetIndex: objReg, propReg, valueReg
+                emit(TurboOpCode::SetIndex, objReg, propReg, opResultReg);
                 freeRegister(propReg); // propReg
                 
             } else {
@@ -1026,7 +1045,7 @@ R TurboCodeGen::visitUpdate(UpdateExpression* expr) {
     
     int returnReg = -1;
     
-    if (auto ident = dynamic_cast<IdentifierExpression*>(expr->argument.get())) {
+    if (auto ident = node_cast<IdentifierExpression>(expr->argument.get())) {
         
         int rhsReg = allocRegister();
         emit(TurboOpCode::LoadConst, rhsReg, emitConstant(Value(1)));
@@ -1047,7 +1066,7 @@ R TurboCodeGen::visitUpdate(UpdateExpression* expr) {
         returnReg = lhsReg; //opResultReg;
         
     }
-    else if (auto member = dynamic_cast<MemberExpression*>(expr->argument.get())) {
+    else if (auto member = node_cast<MemberExpression>(expr->argument.get())) {
         
         // int oldValueReg = get<int>(visitMember(member));
         
@@ -1071,7 +1090,7 @@ R TurboCodeGen::visitUpdate(UpdateExpression* expr) {
             
             int propReg = get<int>(member->property->accept(*this)); // Property key to reg
             
-            emit(TurboOpCode::SetPropertyDynamic, objReg, propReg, opResultReg);
+            emit(TurboOpCode::SetIndex, objReg, propReg, opResultReg);
             freeRegister(propReg); // propReg
             
         } else {
@@ -1105,35 +1124,35 @@ R TurboCodeGen::visitArrowFunction(ArrowFunction* expr) {
         
         collectParameterInfo(expr->parameters.get(), paramNames, parameterInfos);
         
-//        if (SequenceExpression* seq = dynamic_cast<SequenceExpression*>(expr->parameters.get())) {
+//        if (SequenceExpression* seq = node_cast<SequenceExpression>(expr->parameters.get())) {
 //            for (auto& p : seq->expressions) {
-//                if (auto* rest = dynamic_cast<RestParameter*>(p.get())) {
+//                if (auto* rest = node_cast<RestParameter>(p.get())) {
 //                    // ...rest
-//                    //if (auto* ident = dynamic_cast<IdentifierExpression*>(rest->argument.get())) {
+//                    //if (auto* ident = node_cast<IdentifierExpression>(rest->argument.get())) {
 //                    paramNames.push_back(rest->token.lexeme);
 //                    parameterInfos
 //                        .push_back(ParameterInfo{rest->token.lexeme, false, nullptr, true});
 //                    //}
-//                } else if (auto* assign = dynamic_cast<BinaryExpression*>(p.get())) {
+//                } else if (auto* assign = node_cast<BinaryExpression>(p.get())) {
 //                    // b = 90 or c = b
-//                    if (auto* ident = dynamic_cast<IdentifierExpression*>(assign->left.get())) {
+//                    if (auto* ident = node_cast<IdentifierExpression>(assign->left.get())) {
 //                        paramNames.push_back(ident->name);
 //                        parameterInfos.push_back(ParameterInfo{ident->name, true, assign->right.get(), false});
 //                    }
-//                } else if (auto* ident = dynamic_cast<IdentifierExpression*>(p.get())) {
+//                } else if (auto* ident = node_cast<IdentifierExpression>(p.get())) {
 //                    // Simple arg
 //                    paramNames.push_back(ident->name);
 //                    parameterInfos.push_back(ParameterInfo{ident->name, false, nullptr, false});
 //                }
 //            }
-//        } else if (auto* ident = dynamic_cast<IdentifierExpression*>(expr->parameters.get())) {
+//        } else if (auto* ident = node_cast<IdentifierExpression>(expr->parameters.get())) {
 //            paramNames.push_back(ident->name);
 //            parameterInfos.push_back(ParameterInfo{ident->name, false, nullptr, false});
-//        } else if (auto* rest = dynamic_cast<RestParameter*>(expr->parameters.get())) {
+//        } else if (auto* rest = node_cast<RestParameter>(expr->parameters.get())) {
 //            paramNames.push_back(rest->token.lexeme);
 //            parameterInfos.emplace_back(rest->token.lexeme, false, nullptr, true);
-//        } else if (auto* binary_expr = dynamic_cast<BinaryExpression*>(expr->parameters.get())) {
-//            if (auto* ident = dynamic_cast<IdentifierExpression*>(binary_expr->left.get())) {
+//        } else if (auto* binary_expr = node_cast<BinaryExpression>(expr->parameters.get())) {
+//            if (auto* ident = node_cast<IdentifierExpression>(binary_expr->left.get())) {
 //                paramNames.push_back(ident->name);
 //                parameterInfos.emplace_back(ident->name, true, binary_expr->right.get(), false);
 //            }
@@ -1298,18 +1317,18 @@ R TurboCodeGen::visitArrowFunction(ArrowFunction* expr) {
     }
 
     if (expr->exprBody) {
-        expr->exprBody->accept(nested);
-        nested.emit(TurboOpCode::Return);
-        // we must return the value of the expr
+        // the value of the expression is the result
+        int result = get<int>(expr->exprBody->accept(nested));
+        nested.emit(TurboOpCode::Return, result);
     } else if (expr->stmtBody) {
         
         expr->stmtBody->accept(nested);
         
         // TODO: we need to check if return is the last statement.
         bool is_return_avaialble = false;
-        if (BlockStatement* block = dynamic_cast<BlockStatement*>(expr->stmtBody.get())) {
+        if (BlockStatement* block = node_cast<BlockStatement>(expr->stmtBody.get())) {
             for (auto& body : block->body) {
-                if (auto return_stmt = dynamic_cast<ReturnStatement*>(body.get())) {
+                if (auto return_stmt = node_cast<ReturnStatement>(body.get())) {
                     is_return_avaialble = true;
                 }
             }
@@ -1347,26 +1366,7 @@ R TurboCodeGen::visitArrowFunction(ArrowFunction* expr) {
     // closure_info.ci = ci;
     // closure_info.upvalues = nested.upvalues;
 
-    for (auto& uv : nested.upvalues) {
-        
-        // emitUint8(uv.isLocal ? 1 : 0);
-        // emitUint8(uv.index);
-        
-        int isLocalReg = allocRegister();
-        int indexReg = allocRegister();
-        emit(TurboOpCode::LoadConst, indexReg, emitConstant(Value(uv.index)));
-        emit(TurboOpCode::LoadConst, isLocalReg, emitConstant(Value(uv.isLocal ? 1 : 0)));
-
-        if (uv.isLocal) {
-            emit(TurboOpCode::SetClosureIsLocal, isLocalReg, indexReg, closureChunkIndexReg);
-        } else {
-            emit(TurboOpCode::SetClosureIndex, indexReg, closureChunkIndexReg);
-        }
-        
-        freeRegister(isLocalReg);
-        freeRegister(indexReg);
-
-    }
+    emitCaptures(nested, closureChunkIndexReg);
 
     // gather createclosure info for dissaemble
     // closure_infos[to_string(ci)] = closure_info;
@@ -1407,39 +1407,39 @@ R TurboCodeGen::visitFunctionExpression(FunctionExpression* expr) {
         
         collectParameterInfo(param.get(), paramNames, parameterInfos);
         
-//        if (SequenceExpression* seq = dynamic_cast<SequenceExpression*>(param.get())) {
+//        if (SequenceExpression* seq = node_cast<SequenceExpression>(param.get())) {
 //            for (auto& p : seq->expressions) {
-//                if (auto* rest = dynamic_cast<RestParameter*>(p.get())) {
+//                if (auto* rest = node_cast<RestParameter>(p.get())) {
 //                    // ...rest
-//                    //if (auto* ident = dynamic_cast<IdentifierExpression*>(rest->argument.get())) {
+//                    //if (auto* ident = node_cast<IdentifierExpression>(rest->argument.get())) {
 //                    paramNames.push_back(rest->token.lexeme);
 //                    parameterInfos
 //                        .push_back(ParameterInfo{rest->token.lexeme, false, nullptr, true});
 //                    //}
-//                } else if (auto* assign = dynamic_cast<BinaryExpression*>(p.get())) {
+//                } else if (auto* assign = node_cast<BinaryExpression>(p.get())) {
 //                    // b = 90 or c = b
-//                    if (auto* ident = dynamic_cast<IdentifierExpression*>(assign->left.get())) {
+//                    if (auto* ident = node_cast<IdentifierExpression>(assign->left.get())) {
 //                        paramNames.push_back(ident->name);
 //                        parameterInfos.push_back(ParameterInfo{ident->name, true, assign->right.get(), false});
 //                    }
-//                } else if (auto* ident = dynamic_cast<IdentifierExpression*>(p.get())) {
+//                } else if (auto* ident = node_cast<IdentifierExpression>(p.get())) {
 //                    // Simple arg
 //                    paramNames.push_back(ident->name);
 //                    parameterInfos.push_back(ParameterInfo{ident->name, false, nullptr, false});
 //                }
 //            }
 //        }
-//        else if (auto* rest = dynamic_cast<RestParameter*>(param.get())) {
+//        else if (auto* rest = node_cast<RestParameter>(param.get())) {
 //            paramNames.push_back(rest->token.lexeme);
 //            parameterInfos.emplace_back(rest->token.lexeme, false, nullptr, true);
 //        }
-//        else if (auto* binary_expr = dynamic_cast<BinaryExpression*>(param.get())) {
-//            if (auto* ident = dynamic_cast<IdentifierExpression*>(binary_expr->left.get())) {
+//        else if (auto* binary_expr = node_cast<BinaryExpression>(param.get())) {
+//            if (auto* ident = node_cast<IdentifierExpression>(binary_expr->left.get())) {
 //                paramNames.push_back(ident->name);
 //                parameterInfos.emplace_back(ident->name, true, binary_expr->right.get(), false);
 //            }
 //        }
-//        else if (auto* ident = dynamic_cast<IdentifierExpression*>(param.get())) {
+//        else if (auto* ident = node_cast<IdentifierExpression>(param.get())) {
 //            paramNames.push_back(ident->name);
 //            parameterInfos.push_back(ParameterInfo{ident->name, false, nullptr, false});
 //        }
@@ -1606,9 +1606,9 @@ R TurboCodeGen::visitFunctionExpression(FunctionExpression* expr) {
         // TODO: walk the body ast to ensure OP_RETURN is emitted at the end if not emitted
         // TODO: we need to check if return is the last statement.
         bool is_return_avaialble = false;
-        if (BlockStatement* block = dynamic_cast<BlockStatement*>(expr->body.get())) {
+        if (BlockStatement* block = node_cast<BlockStatement>(expr->body.get())) {
             for (auto& body : block->body) {
-                if (auto return_stmt = dynamic_cast<ReturnStatement*>(body.get())) {
+                if (auto return_stmt = node_cast<ReturnStatement>(body.get())) {
                     is_return_avaialble = true;
                 }
             }
@@ -1657,26 +1657,7 @@ R TurboCodeGen::visitFunctionExpression(FunctionExpression* expr) {
     // closure_info.ci = ci;
     // closure_info.upvalues = nested.upvalues;
 
-    // Emit upvalue descriptors
-    for (auto& uv : nested.upvalues) {
-        // emitUint8(uv.isLocal ? 1 : 0);
-        // emitUint8(uv.index);
-
-        int isLocalReg = allocRegister();
-        int indexReg = allocRegister();
-        emit(TurboOpCode::LoadConst, indexReg, emitConstant(Value(uv.index)));
-        emit(TurboOpCode::LoadConst, isLocalReg, emitConstant(Value(uv.isLocal ? 1 : 0)));
-
-        if (uv.isLocal) {
-            emit(TurboOpCode::SetClosureIsLocal, isLocalReg, indexReg, closureChunkIndexReg);
-        } else {
-            emit(TurboOpCode::SetClosureIndex, indexReg, closureChunkIndexReg);
-        }
-        
-        freeRegister(isLocalReg);
-        freeRegister(indexReg);
-
-    }
+    emitCaptures(nested, closureChunkIndexReg);
     
     // Bind function to its name in the global environment
     if (scopeDepth == 0) {
@@ -1697,9 +1678,9 @@ R TurboCodeGen::visitFunctionExpression(FunctionExpression* expr) {
     return closureChunkIndexReg;
 }
 
-R TurboCodeGen::visitFunction(FunctionDeclaration* stmt) {
-    // Create a nested code generator for the function body
-    TurboCodeGen nested(module_);
+// Compiles the parameters and body of stmt into nested.cur
+shared_ptr<TurboChunk> TurboCodeGen::compileFunction(FunctionDeclaration* stmt, TurboCodeGen& nested) {
+    
     nested.enclosing = this;
     nested.cur = make_shared<TurboChunk>();
     nested.cur->name = stmt->id;
@@ -1712,33 +1693,33 @@ R TurboCodeGen::visitFunction(FunctionDeclaration* stmt) {
         
         collectParameterInfo(param.get(), paramNames, parameterInfos);
         
-//        if (SequenceExpression* seq = dynamic_cast<SequenceExpression*>(param.get())) {
+//        if (SequenceExpression* seq = node_cast<SequenceExpression>(param.get())) {
 //            for (auto& p : seq->expressions) {
-//                if (auto* rest = dynamic_cast<RestParameter*>(p.get())) {
+//                if (auto* rest = node_cast<RestParameter>(p.get())) {
 //                    paramNames.push_back(rest->token.lexeme);
 //                    parameterInfos.emplace_back(rest->token.lexeme, false, nullptr, true);
-//                } else if (auto* assign = dynamic_cast<BinaryExpression*>(p.get())) {
-//                    if (auto* ident = dynamic_cast<IdentifierExpression*>(assign->left.get())) {
+//                } else if (auto* assign = node_cast<BinaryExpression>(p.get())) {
+//                    if (auto* ident = node_cast<IdentifierExpression>(assign->left.get())) {
 //                        paramNames.push_back(ident->name);
 //                        parameterInfos.emplace_back(ident->name, true, assign->right.get(), false);
 //                    }
-//                } else if (auto* ident = dynamic_cast<IdentifierExpression*>(p.get())) {
+//                } else if (auto* ident = node_cast<IdentifierExpression>(p.get())) {
 //                    paramNames.push_back(ident->name);
 //                    parameterInfos.emplace_back(ident->name, false, nullptr, false);
 //                }
 //            }
 //        }
-//        else if (auto* rest = dynamic_cast<RestParameter*>(param.get())) {
+//        else if (auto* rest = node_cast<RestParameter>(param.get())) {
 //            paramNames.push_back(rest->token.lexeme);
 //            parameterInfos.emplace_back(rest->token.lexeme, false, nullptr, true);
 //        }
-//        else if (auto* binary_expr = dynamic_cast<BinaryExpression*>(param.get())) {
-//            if (auto* ident = dynamic_cast<IdentifierExpression*>(binary_expr->left.get())) {
+//        else if (auto* binary_expr = node_cast<BinaryExpression>(param.get())) {
+//            if (auto* ident = node_cast<IdentifierExpression>(binary_expr->left.get())) {
 //                paramNames.push_back(ident->name);
 //                parameterInfos.emplace_back(ident->name, true, binary_expr->right.get(), false);
 //            }
 //        }
-//        else if (auto* ident = dynamic_cast<IdentifierExpression*>(param.get())) {
+//        else if (auto* ident = node_cast<IdentifierExpression>(param.get())) {
 //            paramNames.push_back(ident->name);
 //            parameterInfos.emplace_back(ident->name, false, nullptr, false);
 //        }
@@ -1826,9 +1807,9 @@ R TurboCodeGen::visitFunction(FunctionDeclaration* stmt) {
         // TODO: walk the body ast to ensure OP_RETURN is emitted at the end if not emitted
         // TODO: we need to check if return is the last statement.
         bool is_return_avaialble = false;
-        if (BlockStatement* block = dynamic_cast<BlockStatement*>(stmt->body.get())) {
+        if (BlockStatement* block = node_cast<BlockStatement>(stmt->body.get())) {
             for (auto& body : block->body) {
-                if (auto return_stmt = dynamic_cast<ReturnStatement*>(body.get())) {
+                if (auto return_stmt = node_cast<ReturnStatement>(body.get())) {
                     is_return_avaialble = true;
                 }
             }
@@ -1851,12 +1832,66 @@ R TurboCodeGen::visitFunction(FunctionDeclaration* stmt) {
 
     auto fnChunk = nested.cur;
     fnChunk->arity = (uint32_t)paramNames.size();
+    
+    return fnChunk;
+    
+}
 
-    uint32_t chunkIndex = module_->addChunk(fnChunk);
+// A top-level function whose body the parser skipped. It can reach nothing
+// but globals, so it has no upvalues, and a fresh generator standing in for
+// the top level compiles it on its first call.
+uint32_t TurboCodeGen::deferFunction(FunctionDeclaration* stmt, uint32_t& arity) {
+    
+    vector<string> paramNames;
+    vector<ParameterInfo> parameterInfos;
+    for (auto& param : stmt->params) {
+        collectParameterInfo(param.get(), paramNames, parameterInfos);
+    }
+    arity = (uint32_t)paramNames.size();
+    
+    weak_ptr<TurboModule> module = module_;
+    string id = stmt->id;
+    shared_ptr<DeferredFunction> deferred = stmt->deferred;
+    
+    return module_->deferChunk([module, id, deferred]() {
+        
+        auto function = Parser::parseDeferred(id, *deferred);
+        
+        TurboCodeGen top(module.lock());
+        TurboCodeGen nested(module.lock());
+        auto fnChunk = top.compileFunction(function.get(), nested);
+        
+        top.disassembleChunk(fnChunk.get(), id);
+        
+        return fnChunk;
+        
+    });
+    
+}
+
+R TurboCodeGen::visitFunction(FunctionDeclaration* stmt) {
+    
+    if (!stmt->body && stmt->deferred && (enclosing != nullptr || scopeDepth > 0)) {
+        // it may capture locals here, so it is compiled along with them
+        stmt->body = std::move(Parser::parseDeferred(stmt->id, *stmt->deferred)->body);
+    }
+    
+    // Create a nested code generator for the function body
+    TurboCodeGen nested(module_);
+    uint32_t chunkIndex;
+    uint32_t arity;
+    
+    if (stmt->body) {
+        auto fnChunk = compileFunction(stmt, nested);
+        chunkIndex = module_->addChunk(fnChunk);
+        arity = fnChunk->arity;
+    } else {
+        chunkIndex = deferFunction(stmt, arity);
+    }
 
     auto fnObj = make_shared<FunctionObject>();
     fnObj->chunkIndex = chunkIndex;
-    fnObj->arity = fnChunk->arity;
+    fnObj->arity = arity;
     fnObj->name = stmt->id;
     fnObj->upvalues_size = (uint32_t)nested.upvalues.size();
 
@@ -1874,26 +1909,7 @@ R TurboCodeGen::visitFunction(FunctionDeclaration* stmt) {
     
     emit(TurboOpCode::CreateClosure, closureChunkIndexReg);
 
-    // Emit upvalue descriptors
-    for (auto& uv : nested.upvalues) {
-//        emitUint8(uv.isLocal ? 1 : 0);
-//        emitUint8(uv.index);
-        
-        int isLocalReg = allocRegister();
-        int indexReg = allocRegister();
-        emit(TurboOpCode::LoadConst, indexReg, emitConstant(Value(uv.index)));
-        emit(TurboOpCode::LoadConst, isLocalReg, emitConstant(Value(uv.isLocal ? 1 : 0)));
-
-        if (uv.isLocal) {
-            emit(TurboOpCode::SetClosureIsLocal, isLocalReg, indexReg, closureChunkIndexReg);
-        } else {
-            emit(TurboOpCode::SetClosureIndex, indexReg, closureChunkIndexReg);
-        }
-        
-        freeRegister(isLocalReg);
-        freeRegister(indexReg);
-
-    }
+    emitCaptures(nested, closureChunkIndexReg);
     
     // Bind function to its name in the global environment
 //    if (scopeDepth == 0) {
@@ -1917,7 +1933,7 @@ R TurboCodeGen::visitFunction(FunctionDeclaration* stmt) {
     create(stmt->id, closureChunkIndexReg, functionBinding);
 
     // disassemble the chunk for debugging
-    disassembleChunk(nested.cur.get(), stmt->id/*nested.cur->name*/);
+    if (stmt->body) disassembleChunk(nested.cur.get(), stmt->id/*nested.cur->name*/);
     
     freeRegister(closureChunkIndexReg);
 
@@ -1926,24 +1942,42 @@ R TurboCodeGen::visitFunction(FunctionDeclaration* stmt) {
 
 R TurboCodeGen::visitTemplateLiteral(TemplateLiteral* expr) {
 
+    // the pieces are evaluated into registers and joined by StringConcat,
+    // at most MAX_CONCAT_PARTS at a time. the result register is the first
+    // part of each later StringConcat.
     int reg = allocRegister();
-    
-    emit(TurboOpCode::LoadConst, reg, emitConstant(Value::str("")));
-    
+    vector<int> parts;
+
+    auto flush = [&]() {
+        emit(TurboOpCode::StringConcat, reg, (int)parts.size());
+        for (size_t i = 0; i < parts.size(); i += 3) {
+            emit(TurboOpCode::Nop,
+                 parts[i],
+                 i + 1 < parts.size() ? parts[i + 1] : 0,
+                 i + 2 < parts.size() ? parts[i + 2] : 0);
+        }
+        for (int part : parts) {
+            if (part != reg) freeRegister(part);
+        }
+        parts = { reg };
+    };
+
     for (size_t i = 0; i < expr->quasis.size(); ++i) {
-        int strReg = allocRegister();
-        emit(TurboOpCode::LoadConst, strReg, emitConstant(expr->quasis[i]->text));
-        emit(TurboOpCode::Add, reg, reg, strReg);
-        freeRegister(strReg);
+        if (!expr->quasis[i]->text.empty()) {
+            int strReg = allocRegister();
+            emit(TurboOpCode::LoadConst, strReg, emitConstant(expr->quasis[i]->text));
+            parts.push_back(strReg);
+        }
         
         if (i < expr->expressions.size()) {
-            int exprReg = get<int>(expr->expressions[i]->accept(*this));
-            emit(TurboOpCode::Add, reg, reg, exprReg);
-            freeRegister(exprReg);
+            parts.push_back(get<int>(expr->expressions[i]->accept(*this)));
         }
         
+        if (parts.size() >= MAX_CONCAT_PARTS) flush();
     }
     
+    flush();
+    
     return reg;
 }
 
@@ -1972,13 +2006,14 @@ R TurboCodeGen::visitImportDeclaration(ImportDeclaration* stmt) {
         return true;
     }
 
-    std::string source = read_file(importPath);
+    // kept alive by the functions whose bodies are deferred
+    auto source = make_shared<string>(read_file(importPath));
 
-    Scanner scanner(source);
-    auto tokens = scanner.getTokens();
+    Scanner scanner(*source);
     
-    Parser parser(tokens);
+    Parser parser(scanner);
     parser.sourceFile = importPath;
+    if (defer_function_bodies && enclosing == nullptr) parser.deferFunctionBodies(source);
     auto ast = parser.parse();
 
     registerModule(importPath);
@@ -2009,10 +2044,12 @@ R TurboCodeGen::visitThis(ThisExpression* expr) {
     return this_reg;
 }
 
+// super is `this` looked at from the superclass: super.name reads through
+// GetSuperProperty, and super(...) compiles to SuperCall
 R TurboCodeGen::visitSuper(SuperExpression* expr) {
-    int parent_reg = allocRegister();
-    emit(TurboOpCode::GetParentObject, parent_reg);
-    return parent_reg;
+    int this_reg = allocRegister();
+    emit(TurboOpCode::GetThis, this_reg);
+    return this_reg;
 }
 
 R TurboCodeGen::visitProperty(PropertyExpression* expr) {
@@ -2128,30 +2165,30 @@ int TurboCodeGen::compileMethod(MethodDefinition& method) {
         
         collectParameterInfo(param.get(), paramNames, parameterInfos);
         
-//        if (auto* seq = dynamic_cast<SequenceExpression*>(param.get())) {
+//        if (auto* seq = node_cast<SequenceExpression>(param.get())) {
 //            for (auto& p : seq->expressions) {
-//                if (auto* rest = dynamic_cast<RestParameter*>(p.get())) {
+//                if (auto* rest = node_cast<RestParameter>(p.get())) {
 //                    paramNames.push_back(rest->token.lexeme);
 //                    parameterInfos.push_back(ParameterInfo{rest->token.lexeme, false, nullptr, true});
-//                } else if (auto* assign = dynamic_cast<BinaryExpression*>(p.get())) {
-//                    if (auto* ident = dynamic_cast<IdentifierExpression*>(assign->left.get())) {
+//                } else if (auto* assign = node_cast<BinaryExpression>(p.get())) {
+//                    if (auto* ident = node_cast<IdentifierExpression>(assign->left.get())) {
 //                        paramNames.push_back(ident->name);
 //                        parameterInfos.push_back(ParameterInfo{ident->name, true, assign->right.get(), false});
 //                    }
-//                } else if (auto* ident = dynamic_cast<IdentifierExpression*>(p.get())) {
+//                } else if (auto* ident = node_cast<IdentifierExpression>(p.get())) {
 //                    paramNames.push_back(ident->name);
 //                    parameterInfos.push_back(ParameterInfo{ident->name, false, nullptr, false});
 //                }
 //            }
-//        } else if (auto* rest = dynamic_cast<RestParameter*>(param.get())) {
+//        } else if (auto* rest = node_cast<RestParameter>(param.get())) {
 //            paramNames.push_back(rest->token.lexeme);
 //            parameterInfos.push_back(ParameterInfo{rest->token.lexeme, false, nullptr, true});
-//        } else if (auto* assign = dynamic_cast<BinaryExpression*>(param.get())) {
-//            if (auto* ident = dynamic_cast<IdentifierExpression*>(assign->left.get())) {
+//        } else if (auto* assign = node_cast<BinaryExpression>(param.get())) {
+//            if (auto* ident = node_cast<IdentifierExpression>(assign->left.get())) {
 //                paramNames.push_back(ident->name);
 //                parameterInfos.push_back(ParameterInfo{ident->name, true, assign->right.get(), false});
 //            }
-//        } else if (auto* ident = dynamic_cast<IdentifierExpression*>(param.get())) {
+//        } else if (auto* ident = node_cast<IdentifierExpression>(param.get())) {
 //            paramNames.push_back(ident->name);
 //            parameterInfos.push_back(ParameterInfo{ident->name, false, nullptr, false});
 //        }
@@ -2317,18 +2354,18 @@ int TurboCodeGen::compileMethod(MethodDefinition& method) {
         method.methodBody->accept(nested);
         // Ensure OP_RETURN is emitted
         bool hasReturn = false;
-        if (auto* block = dynamic_cast<BlockStatement*>(method.methodBody.get())) {
+        if (auto* block = node_cast<BlockStatement>(method.methodBody.get())) {
             for (auto& stmt : block->body) {
-                if (dynamic_cast<ReturnStatement*>(stmt.get())) {
+                if (node_cast<ReturnStatement>(stmt.get())) {
                     hasReturn = true;
                     break;
                 }
                 
                 // TODO: This needs refactor, we should not special case "body" method like this
                 // for view builders 
-                if (auto exprStmt = dynamic_cast<ExpressionStatement*>(stmt.get())) {
+                if (auto exprStmt = node_cast<ExpressionStatement>(stmt.get())) {
                     
-                    if (auto ui = dynamic_cast<UIViewExpression*>(exprStmt->expression.get()) && method.name == "body") {
+                    if (auto ui = node_cast<UIViewExpression>(exprStmt->expression.get()) && method.name == "body") {
                         hasReturn = true;
                         
                         nested
@@ -2372,25 +2409,7 @@ int TurboCodeGen::compileMethod(MethodDefinition& method) {
     
     emit(TurboOpCode::CreateClosure, closureChunkIndexReg);
 
-    for (auto& uv : nested.upvalues) {
-        // emitUint8(uv.isLocal ? 1 : 0);
-        // emitUint8(uv.index);
-        
-        int isLocalReg = allocRegister();
-        int indexReg = allocRegister();
-        emit(TurboOpCode::LoadConst, indexReg, emitConstant(Value(uv.index)));
-        emit(TurboOpCode::LoadConst, isLocalReg, emitConstant(Value(uv.isLocal ? 1 : 0)));
-
-        if (uv.isLocal) {
-            emit(TurboOpCode::SetClosureIsLocal, isLocalReg, indexReg, closureChunkIndexReg);
-        } else {
-            emit(TurboOpCode::SetClosureIndex, indexReg, closureChunkIndexReg);
-        }
-        
-        freeRegister(isLocalReg);
-        freeRegister(indexReg);
-
-    }
+    emitCaptures(nested, closureChunkIndexReg);
     
     disassembleChunk(nested.cur.get(), method.name);
     
@@ -2407,7 +2426,7 @@ R TurboCodeGen::visitClass(ClassDeclaration* stmt) {
         
         super_class_reg = get<int>(stmt->superClass->accept(*this)); // [superclass]
         
-        auto ident = dynamic_cast<IdentifierExpression*>((stmt->superClass.get()));
+        auto ident = node_cast<IdentifierExpression>((stmt->superClass.get()));
         
         if (ident) {
             classInfo.super_class_name = ident->name;
@@ -2433,22 +2452,22 @@ R TurboCodeGen::visitClass(ClassDeclaration* stmt) {
         bool isProtected = false;
         
         for (const auto& mod : field->modifiers) {
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
         }
 
         // Property is always a VariableStatement
-        if (auto* varStmt = dynamic_cast<VariableStatement*>(field->property.get())) {
+        if (auto* varStmt = node_cast<VariableStatement>(field->property.get())) {
             
             string kind = varStmt->kind;
             
@@ -2565,16 +2584,16 @@ R TurboCodeGen::visitClass(ClassDeclaration* stmt) {
         bool isProtected = false;
         
         for (const auto& mod : method->modifiers) {
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
         }
@@ -2597,16 +2616,16 @@ R TurboCodeGen::visitClass(ClassDeclaration* stmt) {
         bool isProtected = false;
         
         for (const auto& mod : method->modifiers) {
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
         }
@@ -2682,7 +2701,7 @@ R TurboCodeGen::visitClassExpression(ClassExpression* stmt) {
         
         super_class_reg = get<int>(stmt->superClass->accept(*this)); // [superclass]
         
-        auto ident = dynamic_cast<IdentifierExpression*>((stmt->superClass.get()));
+        auto ident = node_cast<IdentifierExpression>((stmt->superClass.get()));
         
         if (ident) {
             classInfo.super_class_name = ident->name;
@@ -2706,22 +2725,22 @@ R TurboCodeGen::visitClassExpression(ClassExpression* stmt) {
         bool isProtected = false;
         
         for (const auto& mod : field->modifiers) {
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
         }
         
         // Property is always a VariableStatement
-        if (auto* varStmt = dynamic_cast<VariableStatement*>(field->property.get())) {
+        if (auto* varStmt = node_cast<VariableStatement>(field->property.get())) {
             
             string kind = varStmt->kind;
             
@@ -2838,16 +2857,16 @@ R TurboCodeGen::visitClassExpression(ClassExpression* stmt) {
         bool isProtected = false;
         
         for (const auto& mod : method->modifiers) {
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
         }
@@ -2870,16 +2889,16 @@ R TurboCodeGen::visitClassExpression(ClassExpression* stmt) {
         bool isProtected = false;
         
         for (const auto& mod : method->modifiers) {
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
         }
@@ -3045,25 +3064,28 @@ R TurboCodeGen::visitCatch(CatchClause* stmt) {
 R TurboCodeGen::visitTry(TryStatement* stmt) {
     
     int ex_val_reg = allocRegister();
-    int tryPos = emitTryPlaceholder();
-    patchTry(tryPos, ex_val_reg);
     
+    // nothing is emitted on entry or exit; the VM finds the handler in
+    // cur->handlers only when something throws
+    HandlerEntry entry { (uint32_t)cur->code.size(), 0, -1, -1, (uint8_t)ex_val_reg };
+    
+    tryDepth++;
     stmt->block->accept(*this);
 
-    emit(TurboOpCode::EndTry);
+    entry.end = (uint32_t)cur->code.size();
 
     int endJump = -1;
 
     if (stmt->handler) {
         endJump = emitJump(TurboOpCode::Jump);
 
-        patchTryCatch(tryPos, (int)cur->code.size() - 1);
+        entry.catchIP = (int)cur->code.size();
 
         beginScope();
         
         declareLocal(stmt->handler->param, BindingKind::Let);
         uint32_t idx = getLocal(stmt->handler->param);
-        emit(TurboOpCode::LoadExceptionValue, ex_val_reg, idx);
+        emitLocal(TurboOpCode::LoadExceptionValue, ex_val_reg, idx, idx);
         
         stmt->handler->body->accept(*this);
         
@@ -3071,17 +3093,28 @@ R TurboCodeGen::visitTry(TryStatement* stmt) {
 
     }
 
+    uint32_t catchEnd = (uint32_t)cur->code.size();
+
     if (endJump != -1) {
         patchSingleJump(endJump);
     }
 
     if (stmt->finalizer) {
-        patchTryFinally(tryPos, (int)cur->code.size() - 1);
+        int finallyStart = (int)cur->code.size();
+        entry.finallyIP = finallyStart;
 
         stmt->finalizer->accept(*this);
-        emit(TurboOpCode::EndFinally);
+        emit(TurboOpCode::EndFinally, (int)cur->code.size() - finallyStart);
     }
     
+    cur->handlers.push_back(entry);
+    
+    // a throw from the catch block still runs the finally
+    if (stmt->handler && stmt->finalizer) {
+        cur->handlers.push_back({ (uint32_t)entry.catchIP, catchEnd, -1, entry.finallyIP, 0 });
+    }
+    
+    tryDepth--;
     return true;
     
 }
@@ -3117,13 +3150,13 @@ R TurboCodeGen::visitForIn(ForInStatement* stmt) {
 
     // Assign keyReg to loop variable (var/let/const)
     // Assign value to loop variable
-    if (auto* ident = dynamic_cast<IdentifierExpression*>(stmt->init.get())) {
+    if (auto* ident = node_cast<IdentifierExpression>(stmt->init.get())) {
         store(ident->name, keyReg);
-    } else if (auto* var_stmt = dynamic_cast<VariableStatement*>(stmt->init.get())) {
+    } else if (auto* var_stmt = node_cast<VariableStatement>(stmt->init.get())) {
         store(var_stmt->declarations[0].id, keyReg);
-    } else if (auto* expr_stmt = dynamic_cast<ExpressionStatement*>(stmt->init.get())) {
+    } else if (auto* expr_stmt = node_cast<ExpressionStatement>(stmt->init.get())) {
         
-        if (auto* ident = dynamic_cast<IdentifierExpression*>(expr_stmt->expression.get())) {
+        if (auto* ident = node_cast<IdentifierExpression>(expr_stmt->expression.get())) {
             store(ident->name, keyReg);
         }
         
@@ -3176,31 +3209,26 @@ R TurboCodeGen::visitForOf(ForOfStatement* stmt) {
     
     int arrReg = get<int>(stmt->right->accept(*this));
 
-    int lenReg = allocRegister();
-    emit(TurboOpCode::GetObjectLength, lenReg, arrReg);
-
-    int idxReg = allocRegister();
-    emit(TurboOpCode::LoadConst, idxReg, emitConstant(Value(0)));
+    // arrays are walked by index, native iterators (streams) pulled lazily
+    int iterReg = allocRegister();
+    emit(TurboOpCode::GetIterator, iterReg, arrReg);
 
     int loopStart = (int)cur->code.size();
 
-    // if (idx >= len) break;
+    // elem = next(); if (!hasValue) break;
+    int elemReg = allocRegister();
     int condReg = allocRegister();
-    emit(TurboOpCode::LessThan, condReg, idxReg, lenReg);
+    emit(TurboOpCode::IteratorNext, elemReg, iterReg, condReg);
     int breakJump = emitJump(TurboOpCode::JumpIfFalse, condReg);
 
-    // Get current element: arr[idx]
-    int elemReg = allocRegister();
-    emit(TurboOpCode::GetPropertyDynamic, elemReg, arrReg, idxReg);
-
     // Assign element to loop variable
-    if (auto* ident = dynamic_cast<IdentifierExpression*>(stmt->left.get())) {
+    if (auto* ident = node_cast<IdentifierExpression>(stmt->left.get())) {
         store(ident->name, elemReg);
-    } else if (auto* var_stmt = dynamic_cast<VariableStatement*>(stmt->left.get())) {
+    } else if (auto* var_stmt = node_cast<VariableStatement>(stmt->left.get())) {
         store(var_stmt->declarations[0].id, elemReg);
-    } else if (auto* expr_stmt = dynamic_cast<ExpressionStatement*>(stmt->left.get())) {
+    } else if (auto* expr_stmt = node_cast<ExpressionStatement>(stmt->left.get())) {
         
-        if (auto* ident = dynamic_cast<IdentifierExpression*>(expr_stmt->expression.get())) {
+        if (auto* ident = node_cast<IdentifierExpression>(expr_stmt->expression.get())) {
             store(ident->name, elemReg);
         }
         
@@ -3222,21 +3250,14 @@ R TurboCodeGen::visitForOf(ForOfStatement* stmt) {
 
     freeRegister(elemReg);
 
-    // idx++
-    int incr_const_reg = allocRegister();
-    emit(TurboOpCode::LoadConst, incr_const_reg, emitConstant(Value(1)));
-    emit(TurboOpCode::Add, idxReg, idxReg, incr_const_reg);
-
     emitLoop(loopStart);
 
     patchJump(breakJump, (int)cur->code.size());
 
     // Free registers
     freeRegister(arrReg);
-    freeRegister(lenReg);
-    freeRegister(idxReg);
+    freeRegister(iterReg);
     freeRegister(condReg);
-    freeRegister(incr_const_reg);
     
     endScope();
     endLoop();
@@ -3325,8 +3346,8 @@ R TurboCodeGen::visitUIExpression(UIViewExpression* expr) {
     }
     
     for (auto& modifier : expr->modifiers) {
-        if (auto call = dynamic_cast<CallExpression*>(modifier.get())) {
-            auto ident = dynamic_cast<IdentifierExpression*>(call->callee.get());
+        if (auto call = node_cast<CallExpression>(modifier.get())) {
+            auto ident = node_cast<IdentifierExpression>(call->callee.get());
             
             vector<int> modifier_args;
             for (auto& arg : call->arguments) {
@@ -3357,33 +3378,33 @@ void TurboCodeGen::collectParameterInfo(Expression* parameters, vector<string>&
 ) {
     if (parameters) {
 
-                if (SequenceExpression* seq = dynamic_cast<SequenceExpression*>(parameters)) {
+                if (SequenceExpression* seq = node_cast<SequenceExpression>(parameters)) {
                     for (auto& p : seq->expressions) {
-                        if (auto* rest = dynamic_cast<RestParameter*>(p.get())) {
+                        if (auto* rest = node_cast<RestParameter>(p.get())) {
                             paramNames.push_back(rest->token.lexeme);
                             parameterInfos.emplace_back(rest->token.lexeme, false, nullptr, true);
-                        } else if (auto* assign = dynamic_cast<BinaryExpression*>(p.get())) {
-                            if (auto* ident = dynamic_cast<IdentifierExpression*>(assign->left.get())) {
+                        } else if (auto* assign = node_cast<BinaryExpression>(p.get())) {
+                            if (auto* ident = node_cast<IdentifierExpression>(assign->left.get())) {
                                 paramNames.push_back(ident->name);
                                 parameterInfos.emplace_back(ident->name, true, assign->right.get(), false);
                             }
-                        } else if (auto* ident = dynamic_cast<IdentifierExpression*>(p.get())) {
+                        } else if (auto* ident = node_cast<IdentifierExpression>(p.get())) {
                             paramNames.push_back(ident->name);
                             parameterInfos.emplace_back(ident->name, false, nullptr, false);
                         }
                     }
                 }
-                else if (auto* rest = dynamic_cast<RestParameter*>(parameters)) {
+                else if (auto* rest = node_cast<RestParameter>(parameters)) {
                     paramNames.push_back(rest->token.lexeme);
                     parameterInfos.emplace_back(rest->token.lexeme, false, nullptr, true);
                 }
-                else if (auto* binary_expr = dynamic_cast<BinaryExpression*>(parameters)) {
-                    if (auto* ident = dynamic_cast<IdentifierExpression*>(binary_expr->left.get())) {
+                else if (auto* binary_expr = node_cast<BinaryExpression>(parameters)) {
+                    if (auto* ident = node_cast<IdentifierExpression>(binary_expr->left.get())) {
                         paramNames.push_back(ident->name);
                         parameterInfos.emplace_back(ident->name, true, binary_expr->right.get(), false);
                     }
                 }
-                else if (auto* ident = dynamic_cast<IdentifierExpression*>(parameters)) {
+                else if (auto* ident = node_cast<IdentifierExpression>(parameters)) {
                     paramNames.push_back(ident->name);
                     parameterInfos.emplace_back(ident->name, false, nullptr, false);
                 }
@@ -3445,46 +3466,22 @@ int TurboCodeGen::recordInstanceField(const string& classId, const string& field
 }
 
 string TurboCodeGen::evaluate_property(Expression* expr) {
-    if (auto member = dynamic_cast<MemberExpression*>(expr)) {
+    if (auto member = node_cast<MemberExpression>(expr)) {
         if (member->computed) {
             return evaluate_property(member->property.get());
         } else {
             return member->name.lexeme;
         }
     }
-    if (auto ident = dynamic_cast<IdentifierExpression*>(expr)) {
+    if (auto ident = node_cast<IdentifierExpression>(expr)) {
         return ident->name;
     }
-    if (auto literal = dynamic_cast<LiteralExpression*>(expr)) {
+    if (auto literal = node_cast<LiteralExpression>(expr)) {
         return literal->token.lexeme;
     }
     throw std::runtime_error("Unsupported expression type in evaluate_property");
 }
 
-int TurboCodeGen::emitTryPlaceholder() {
-    emit(TurboOpCode::Try);
-
-    int pos = (int)cur->size() - 1;
-
-    return pos; 
-}
-
-void TurboCodeGen::patchTryCatch(int tryPos, int target) {
-    
-    cur->code[tryPos].a = target;
-        
-}
-
-void TurboCodeGen::patchTryFinally(int tryPos, int target) {
-    
-    cur->code[tryPos].b = target;
-    
-}
-
-void TurboCodeGen::patchTry(int tryPos, int reg) {
-    cur->code[tryPos].c = reg;
-}
-
 void TurboCodeGen::emit(TurboOpCode op, int a, int b = 0, int c = 0) {
     if (!cur) throw std::runtime_error("No active chunk for code generation.");
     cur->code.push_back({op, (uint8_t)a, (uint8_t)b, (uint8_t)c});
@@ -3556,16 +3553,9 @@ void TurboCodeGen::beginScope() {
 }
 
 void TurboCodeGen::endScope() {
-    // Pop locals declared in this scope
+    // Pop locals declared in this scope. Closures hold copies or boxes of
+    // the ones they captured, so nothing has to be closed.
     while (!locals.empty() && locals.back().depth == scopeDepth) {
-        if (locals.back().isCaptured) {
-            // Local captured by closure → close it
-            emit(TurboOpCode::CloseUpvalue);
-        } else {
-            // Normal local → just pop
-            // emit(TurboOpCode::OP_POP);
-            
-        }
         locals.pop_back();
     }
     scopeDepth--;
@@ -3585,8 +3575,7 @@ int TurboCodeGen::paramSlot(const string& name) {
 }
 
 int TurboCodeGen::emitConstant(const Value& v) {
-    cur->constants.push_back(v);
-    return (int)cur->constants.size() - 1;
+    return cur->addConstant(v);
 }
 
 bool TurboCodeGen::hasLocal(const std::string& name) {
@@ -3606,19 +3595,22 @@ int TurboCodeGen::addUpvalue(bool isLocal, int index, string name, BindingKind k
     return (int)upvalues.size() - 1;
 }
 
-// resolve variable
-int TurboCodeGen::resolveUpvalue(const string& name) {
+// resolve variable; assign is set when the access is a store
+int TurboCodeGen::resolveUpvalue(const string& name, bool assign) {
     if (enclosing) {
         int localIndex = enclosing->resolveLocal(name);
         if (localIndex != -1) {
-            enclosing->locals[localIndex].isCaptured = true;
+            Local& local = enclosing->locals[localIndex];
+            local.isCaptured = true;
+            // a copy taken when the closure is made could go stale
+            if (assign || local.storedInLoop) enclosing->boxLocal(localIndex);
             return addUpvalue(true,
                               localIndex,
                               name,
-                              enclosing->locals[localIndex].kind);
+                              local.kind);
         }
         
-        int upIndex = enclosing->resolveUpvalue(name);
+        int upIndex = enclosing->resolveUpvalue(name, assign);
         if (upIndex != -1) {
             
             return addUpvalue(false,
@@ -3630,6 +3622,58 @@ int TurboCodeGen::resolveUpvalue(const string& name) {
     return -1;
 }
 
+// the box form of an instruction on a local's slot
+static Instruction boxed(const Instruction& instr) {
+    switch (instr.op) {
+        case TurboOpCode::CreateLocalVar:
+        case TurboOpCode::CreateLocalLet:
+        case TurboOpCode::CreateLocalConst:
+            return { TurboOpCode::CreateLocalBox, instr.a, instr.b };
+        case TurboOpCode::StoreLocalVar:
+        case TurboOpCode::StoreLocalLet:
+            return { TurboOpCode::StoreLocalBox, instr.a, instr.b };
+        case TurboOpCode::LoadLocalVar:
+            return { TurboOpCode::LoadLocalBox, instr.a, instr.b };
+        case TurboOpCode::LoadExceptionValue:
+            return { TurboOpCode::CreateLocalBox, instr.b, instr.a };
+        case TurboOpCode::CaptureLocal:
+            return { TurboOpCode::CaptureLocalBox, instr.a, instr.b };
+        default:
+            return instr;
+    }
+}
+
+// emits an instruction on the slot of a local, remembering where it went
+void TurboCodeGen::emitLocal(TurboOpCode op, int a, int b, uint32_t slot) {
+    locals[slot].sites.push_back((int)cur->code.size());
+    emit(op, a, b, 0);
+    if (locals[slot].boxed) cur->code.back() = boxed(cur->code.back());
+}
+
+// Moves a local into a box once a closure shares it and it is assigned
+// after the capture. The function has not run yet, so the accesses already
+// emitted are simply rewritten.
+void TurboCodeGen::boxLocal(uint32_t slot) {
+    Local& local = locals[slot];
+    if (local.boxed) return;
+    local.boxed = true;
+    for (int site : local.sites) {
+        cur->code[site] = boxed(cur->code[site]);
+    }
+}
+
+// fills in the record of the closure just created in closureReg: one
+// capture per upvalue of nested, from a local here or from our own record
+void TurboCodeGen::emitCaptures(const TurboCodeGen& nested, int closureReg) {
+    for (auto& uv : nested.upvalues) {
+        if (uv.isLocal) {
+            emitLocal(TurboOpCode::CaptureLocal, closureReg, uv.index, uv.index);
+        } else {
+            emit(TurboOpCode::CaptureUpvalue, closureReg, uv.index, 0);
+        }
+    }
+}
+
 uint32_t TurboCodeGen::getLocal(const std::string& name) {
     for (int i = (int)locals.size() - 1; i >= 0; --i) {
         if (locals[i].name == name) return locals[i].slot_index;
@@ -3669,6 +3713,7 @@ void TurboCodeGen::declareLocal(const string& name, BindingKind kind) {
     uint32_t idx = (uint32_t)locals.size();
 
     Local local { name, scopeDepth, false, (uint32_t)locals.size(), kind };
+    local.loopDepth = (int)loopStack.size();
     locals.push_back(local);
     
     if (idx + 1 > cur->maxLocals) cur->maxLocals = idx + 1;
@@ -3827,6 +3872,9 @@ size_t TurboCodeGen::disassembleInstruction(const TurboChunk* chunk, size_t offs
         case TurboOpCode::Jump: opName = "Jump"; break;
         case TurboOpCode::Return: opName = "Return"; break;
         case TurboOpCode::Call: opName = "Call"; break;
+        case TurboOpCode::CallMethod: opName = "CallMethod"; break;
+        case TurboOpCode::GetSuperProperty: opName = "GetSuperProperty"; break;
+        case TurboOpCode::TailCall: opName = "TailCall"; break;
         case TurboOpCode::PushArg: opName = "PushArg"; break;
         case TurboOpCode::CreateClosure: opName = "CreateClosure"; break;
         case TurboOpCode::CreateArrayLiteral: opName = "CreateArrayLiteral"; break;
@@ -3835,6 +3883,9 @@ size_t TurboCodeGen::disassembleInstruction(const TurboChunk* chunk, size_t offs
         case TurboOpCode::ArrayPush: opName = "ArrayPush"; break;
         case TurboOpCode::GetProperty: opName = "GetProperty"; break;
         case TurboOpCode::GetPropertyDynamic: opName = "GetPropertyDynamic"; break;
+        case TurboOpCode::GetIndex: opName = "GetIndex"; break;
+        case TurboOpCode::SetIndex: opName = "SetIndex"; break;
+        case TurboOpCode::StringConcat: opName = "StringConcat"; break;
         case TurboOpCode::GetThis: opName = "GetThis"; break;
         case TurboOpCode::SetThisProperty: opName = "SetThisProperty"; break;
         case TurboOpCode::Halt: opName = "Halt"; break;
@@ -3850,6 +3901,12 @@ size_t TurboCodeGen::disassembleInstruction(const TurboChunk* chunk, size_t offs
         case TurboOpCode::StoreUpvalueVar: opName = "StoreUpvalueVar"; break;
         case TurboOpCode::StoreUpvalueLet: opName = "StoreUpvalueLet"; break;
         case TurboOpCode::StoreUpvalueConst: opName = "StoreUpvalueConst"; break;
+        case TurboOpCode::CreateLocalBox: opName = "CreateLocalBox"; break;
+        case TurboOpCode::StoreLocalBox: opName = "StoreLocalBox"; break;
+        case TurboOpCode::LoadLocalBox: opName = "LoadLocalBox"; break;
+        case TurboOpCode::CaptureLocal: opName = "CaptureLocal"; break;
+        case TurboOpCode::CaptureLocalBox: opName = "CaptureLocalBox"; break;
+        case TurboOpCode::CaptureUpvalue: opName = "CaptureUpvalue"; break;
         case TurboOpCode::LoadUpvalue: opName = "LoadUpvalue"; break;
         case TurboOpCode::SetClosureIsLocal: opName = "SetClosureIsLocal"; break;
         case TurboOpCode::SetClosureIndex: opName = "SetClosureIndex"; break;
@@ -3913,6 +3970,7 @@ size_t TurboCodeGen::disassembleInstruction(const TurboChunk* chunk, size_t offs
 }
 
 void TurboCodeGen::disassembleChunk(const TurboChunk* chunk, const std::string& name) {
+    if (!module_->disassemble) return;
     std::cout << "== " << name << " ==\n";
     for (size_t offset = 0; offset < chunk->code.size();) {
         offset = disassembleInstruction(chunk, offset);
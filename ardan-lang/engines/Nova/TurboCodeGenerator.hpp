@@ -112,6 +112,15 @@ class TurboCodeGen : public ExpressionVisitor, public StatementVisitor {
         bool isCaptured;  // true if used by an inner function
         uint32_t slot_index;
         BindingKind kind;
+        // captured and assigned after the capture: the local lives in a box
+        // its closures share instead of being copied into them
+        bool boxed = false;
+        // assigned inside a loop it was declared outside of, so any store
+        // can come after a capture made in the same loop
+        bool storedInLoop = false;
+        int loopDepth = 0;
+        // instructions that read or write the slot, rewritten by boxLocal
+        vector<int> sites;
     };
 
     struct Global {
@@ -122,7 +131,7 @@ class TurboCodeGen : public ExpressionVisitor, public StatementVisitor {
 private:
     shared_ptr<TurboChunk> cur;
     int scopeDepth = 0;
-    TurboCodeGen* enclosing;
+    TurboCodeGen* enclosing = nullptr;
     R create(string decl, uint32_t reg_slot, BindingKind kind);
     R store(string decl, uint32_t reg_slot);
     R load(string decl, uint32_t reg_slot);
@@ -144,8 +153,14 @@ private:
     string evaluate_property(Expression* expr);
     
     int compileMethod(MethodDefinition& method);
+    int getMember(MemberExpression* expr, int objectReg);
+    shared_ptr<TurboChunk> compileFunction(FunctionDeclaration* stmt, TurboCodeGen& nested);
+    uint32_t deferFunction(FunctionDeclaration* stmt, uint32_t& arity);
     int recordInstanceField(const string& classId, const string& fieldId, Expression* initExpr, const PropertyMeta& propMeta);
     
+    // template literal pieces joined by one StringConcat
+    static const size_t MAX_CONCAT_PARTS = 16;
+    
     void emit(TurboOpCode op);
     int emitConstant(const Value &v);
     void emitLoop(uint32_t loopStart);
@@ -153,13 +168,7 @@ private:
     bool hasLocal(const string &name);
     uint32_t getLocal(const string &name);
     void resetLocalsForFunction(uint32_t paramCount, const vector<string>& paramNames);
-    
-    int emitTryPlaceholder();
-    void patchTry(int tryPos, int reg);
-    void patchTryFinally(int tryPos, int target);
-    void patchTryCatch(int tryPos, int target);
-    
-    void declareVariableScoping(const std::string& name, BindingKind kind);
+        void declareVariableScoping(const std::string& name, BindingKind kind);
     void declareLocal(const string& name, BindingKind kind);
     void emitSetLocal(int slot);
     int paramSlot(const string& name);
@@ -184,10 +193,19 @@ private:
     
     vector<ExceptionHandler> handlerStack;
     
+    // try blocks around the code being compiled; a return inside one is
+    // not a tail call, since its catch or finally still has to run
+    int tryDepth = 0;
+    // set while compiling the call a return statement returns
+    bool tailCall = false;
+    
     void beginScope();
     void endScope();
     int addUpvalue(bool isLocal, int index, string name, BindingKind kind);
-    int resolveUpvalue(const string& name);
+    int resolveUpvalue(const string& name, bool assign = false);
+    void emitLocal(TurboOpCode op, int a, int b, uint32_t slot);
+    void boxLocal(uint32_t slot);
+    void emitCaptures(const TurboCodeGen& nested, int closureReg);
         
     inline uint32_t readUint32(const TurboChunk* chunk, size_t offset);
     
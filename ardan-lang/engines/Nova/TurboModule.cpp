@@ -6,3 +6,20 @@
 //
 
 #include "TurboModule.hpp"
+#include "TurboPeephole.hpp"
+
+void TurboModule::compileDeferred(uint32_t index) {
+    
+    // copied: compiling can defer or add chunks of its own. On a parse
+    // error the entry stays, and the next call reports it again.
+    auto compile = deferred.at(index);
+    
+    shared_ptr<TurboChunk> compiled = compile();
+    
+    // the VMs fuse every chunk they start with; this one joins later
+    fuseSuperinstructions(*compiled);
+    
+    chunks[index] = compiled;
+    deferred.erase(index);
+    
+}
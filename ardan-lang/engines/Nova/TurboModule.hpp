@@ -9,6 +9,8 @@
 #define TurboModule_hpp
 
 #include <stdio.h>
+#include <functional>
+#include <unordered_map>
 #include "TurboChunk.hpp"
 
 struct TurboModule {
@@ -16,17 +18,38 @@ struct TurboModule {
     vector<Value> constants;               
     uint32_t entryChunkIndex;
     uint32_t version;
+    // the code generators print each chunk as they finish it
+    bool disassemble = true;
+    
+    // compilers of the chunks whose slots are still empty, run by chunk()
+    unordered_map<uint32_t, function<shared_ptr<TurboChunk>()>> deferred;
     
     uint32_t addChunk(shared_ptr<TurboChunk> c) {
         chunks.push_back(c);
         return (uint32_t)chunks.size() - 1;
     }
     
+    // reserves a chunk index for a function compiled on its first call
+    uint32_t deferChunk(function<shared_ptr<TurboChunk>()> compile) {
+        uint32_t index = addChunk(nullptr);
+        deferred[index] = std::move(compile);
+        return index;
+    }
+    
+    // chunks[index], compiled and kept in the module if it was deferred
+    shared_ptr<TurboChunk> chunk(uint32_t index) {
+        if (!chunks[index]) compileDeferred(index);
+        return chunks[index];
+    }
+    
     uint32_t addConstant(const Value &v) {
         constants.push_back(v);
         return (uint32_t)constants.size() - 1;
     }
     
+private:
+    void compileDeferred(uint32_t index);
+    
 };
 
 #endif /* TurboModule_hpp */
@@ -0,0 +1,167 @@
+//
+//  TurboPeephole.cpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#include "TurboPeephole.hpp"
+
+bool superinstructions_enabled = true;
+
+static void markTarget(vector<bool>& targets, long ip) {
+    if (ip >= 0 && ip < (long)targets.size()) targets[ip] = true;
+}
+
+// every ip a jump, loop or try handler can land on
+static vector<bool> jumpTargets(const TurboChunk& chunk) {
+
+    vector<bool> targets(chunk.code.size() + 1, false);
+
+    for (size_t ip = 0; ip < chunk.code.size(); ip++) {
+
+        const Instruction& instr = chunk.code[ip];
+        long next = (long)ip + 1;
+
+        switch (instr.op) {
+            case TurboOpCode::Jump:
+                markTarget(targets, next + instr.a);
+                break;
+            case TurboOpCode::JumpIfFalse:
+            case TurboOpCode::JumpIfTrue:
+                markTarget(targets, next + instr.b);
+                break;
+            case TurboOpCode::Loop:
+                markTarget(targets, next - instr.a);
+                break;
+            default:
+                break;
+        }
+
+    }
+
+    // no fused sequence may straddle the edge of a try range
+    for (const HandlerEntry& entry : chunk.handlers) {
+        markTarget(targets, entry.start);
+        markTarget(targets, entry.end);
+        markTarget(targets, entry.catchIP);
+        markTarget(targets, entry.finallyIP);
+    }
+
+    return targets;
+
+}
+
+static bool isNumberConst(const TurboChunk& chunk, const Instruction& instr) {
+    return instr.op == TurboOpCode::LoadConst &&
+        instr.b < chunk.constants.size() &&
+        chunk.constants[instr.b].type == ValueType::NUMBER;
+}
+
+static bool isStoreLocal(TurboOpCode op) {
+    return op == TurboOpCode::StoreLocalLet || op == TurboOpCode::StoreLocalVar;
+}
+
+static TurboOpCode compareJump(TurboOpCode op) {
+    switch (op) {
+        case TurboOpCode::LessThan: return TurboOpCode::LessThanJumpIfFalse;
+        case TurboOpCode::LessThanOrEqual: return TurboOpCode::LessThanOrEqualJumpIfFalse;
+        case TurboOpCode::GreaterThan: return TurboOpCode::GreaterThanJumpIfFalse;
+        case TurboOpCode::GreaterThanOrEqual: return TurboOpCode::GreaterThanOrEqualJumpIfFalse;
+        default: return TurboOpCode::Nop;
+    }
+}
+
+// Temporaries that only feed the next instruction of a sequence (the loaded
+// local, the loaded constant, the comparison result) are not written by the
+// fused instruction. The code generators free those registers right after
+// their one use, so nothing reads them later.
+static size_t fuse(TurboChunk& chunk, const vector<bool>& targets) {
+
+    auto& code = chunk.code;
+    size_t fused = 0;
+
+    // true when no jump lands inside [ip + 1, ip + length)
+    auto straight = [&](size_t ip, size_t length) {
+        if (ip + length > code.size()) return false;
+        for (size_t i = ip + 1; i < ip + length; i++) {
+            if (targets[i]) return false;
+        }
+        return true;
+    };
+
+    size_t ip = 0;
+
+    while (ip < code.size()) {
+
+        Instruction& first = code[ip];
+
+        // i = i + k, i++, i += k on a local
+        if (first.op == TurboOpCode::LoadLocalVar && straight(ip, 4)) {
+            const Instruction& load = code[ip + 1];
+            const Instruction& add = code[ip + 2];
+            const Instruction& store = code[ip + 3];
+
+            if (isNumberConst(chunk, load) && load.a != first.a &&
+                add.op == TurboOpCode::Add && add.b == first.a && add.c == load.a &&
+                isStoreLocal(store.op) && store.a == first.b && store.b == add.a) {
+                first.op = TurboOpCode::IncrementLocal;
+                fused++;
+                ip += 4;
+                continue;
+            }
+        }
+
+        // local.name
+        if (first.op == TurboOpCode::LoadLocalVar && straight(ip, 2)) {
+            const Instruction& get = code[ip + 1];
+
+            if (get.op == TurboOpCode::GetProperty && get.b == first.a) {
+                first.op = TurboOpCode::LoadLocalGetProperty;
+                fused++;
+                ip += 2;
+                continue;
+            }
+        }
+
+        // loop and if conditions
+        TurboOpCode fusedCompare = compareJump(first.op);
+        if (fusedCompare != TurboOpCode::Nop && straight(ip, 2)) {
+            const Instruction& jump = code[ip + 1];
+
+            if (jump.op == TurboOpCode::JumpIfFalse && jump.a == first.a &&
+                first.a != first.b && first.a != first.c) {
+                first.op = fusedCompare;
+                fused++;
+                ip += 2;
+                continue;
+            }
+        }
+
+        // x + k
+        if (isNumberConst(chunk, first) && straight(ip, 2)) {
+            const Instruction& add = code[ip + 1];
+
+            if (add.op == TurboOpCode::Add && add.c == first.a && add.b != first.a) {
+                first.op = TurboOpCode::AddConst;
+                fused++;
+                ip += 2;
+                continue;
+            }
+        }
+
+        ip++;
+
+    }
+
+    return fused;
+
+}
+
+size_t fuseSuperinstructions(TurboChunk& chunk) {
+
+    if (!superinstructions_enabled) return 0;
+
+    return fuse(chunk, jumpTargets(chunk));
+
+}
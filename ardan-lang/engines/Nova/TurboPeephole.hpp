@@ -0,0 +1,31 @@
+//
+//  TurboPeephole.hpp
+//  ardan-lang
+//
+//  Created by Chidume Nnamdi on 18/10/2026.
+//
+
+#ifndef TurboPeephole_hpp
+#define TurboPeephole_hpp
+
+#include <stdio.h>
+#include "TurboChunk.hpp"
+
+// Rewrites hot instruction sequences in chunk into superinstructions.
+//
+// The sequences were picked from the opcode-pair counts of an
+// ARDAN_OPCODE_STATS build over bench/workloads: LessThan -> JumpIfFalse,
+// LoadConst -> Add, LoadLocalVar -> GetProperty and the
+// LoadLocalVar, LoadConst, Add, StoreLocalLet of `i++` were the most frequent
+// pairs left after loads.
+//
+// Only the first instruction of a sequence is rewritten, so code size, jump
+// offsets, try offsets and the line table do not change, and a sequence is
+// never fused across a jump target. Running the pass twice is harmless.
+// Returns the number of sequences fused.
+size_t fuseSuperinstructions(TurboChunk& chunk);
+
+// cleared by `--no-fuse`, to measure the unfused bytecode
+extern bool superinstructions_enabled;
+
+#endif /* TurboPeephole_hpp */
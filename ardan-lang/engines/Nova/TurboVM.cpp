@@ -6,6 +6,8 @@
 //
 
 #include "TurboVM.hpp"
+#include "Profiler/OpcodeStats.hpp"
+#include "EventLoop/WorkStealingPool.hpp"
 
 TurboVM::TurboVM() {
     env = new Env();
@@ -21,10 +23,20 @@ TurboVM::TurboVM(shared_ptr<TurboModule> module_) : module_(module_) {
     init_host_builtins();
     init_language_builtins();
     
+    // deferred function bodies are fused when the module compiles them
+    for (auto& chunk : module_->chunks) {
+        if (chunk) fuseSuperinstructions(*chunk);
+    }
+    
+}
+
+TurboVM::TurboVM(shared_ptr<TurboModule> module_, Env* globals, const vector<bool>* pureChunks)
+    : env(globals), event_loop(nullptr), module_(module_), ownsEnv(false), pureChunks(pureChunks) {
+    frame = nullptr;
 }
 
 TurboVM::~TurboVM() {
-    if (env != nullptr) {
+    if (env != nullptr && ownsEnv) {
         delete env;
     }
 }
@@ -41,6 +53,13 @@ void TurboVM::init_language_builtins() {
     env->set_var("Number", make_shared<JSNumber>());
     env->set_var("Boolean", make_shared<JSBoolean>());
     env->set_var("Array", make_shared<Array>());
+    env->set_var("Uint8Array", make_shared<TypedArray>(TypedArrayKind::Uint8));
+    env->set_var("Int32Array", make_shared<TypedArray>(TypedArrayKind::Int32));
+    env->set_var("Float64Array", make_shared<TypedArray>(TypedArrayKind::Float64));
+    env->set_var("Buffer", make_shared<Buffer>());
+    env->set_var("SharedArrayBuffer", make_shared<SharedArrayBuffer>());
+    env->set_var("Atomics", make_shared<Atomics>());
+    env->set_var("JSON", make_shared<JSON>());
 
 }
 
@@ -58,32 +77,9 @@ void TurboVM::init_host_builtins() {
 
 }
 
-shared_ptr<Upvalue> TurboVM::captureUpvalue(Value* local) {
-    Upvalue* prev = nullptr;
-    Upvalue* up = openUpvalues;
-    while (up && up->location > local) {
-        prev = up;
-        up = up->next;
-    }
-    if (up && up->location == local) {
-        // Return shared_ptr wrapping the existing raw pointer - dangerous if we don't manage lifetime properly
-        // But for now, assume we keep lifetime with shared_ptr elsewhere
-        // We'll create a shared_ptr aliasing same pointer
-        return std::shared_ptr<Upvalue>(up, [](Upvalue*){}); // no-op deleter
-    }
-    auto created = std::make_shared<Upvalue>();
-    created->location = local;
-    created->next = up;
-    if (prev) prev->next = created.get(); else openUpvalues = created.get();
-    return created;
-}
-
-void TurboVM::closeUpvalues(Value* last) {
-    while (openUpvalues && openUpvalues->location >= last) {
-        openUpvalues->closed = *openUpvalues->location;
-        openUpvalues->location = &openUpvalues->closed;
-        openUpvalues = openUpvalues->next;
-    }
+shared_ptr<Value>& TurboVM::localBox(uint32_t idx) {
+    if (frame->boxes.size() <= idx) frame->boxes.resize(frame->locals.size());
+    return frame->boxes[idx];
 }
 
 Instruction TurboVM::readInstruction() {
@@ -126,7 +122,7 @@ Value TurboVM::CreateInstance(Value klass) {
 
 }
 
-Value TurboVM::getProperty(const Value &objVal, const string &propName) {
+Value TurboVM::getProperty(const Value &objVal, Atom propName) {
     
     if (objVal.type == ValueType::OBJECT) {
         // perform privacy check
@@ -136,12 +132,12 @@ Value TurboVM::getProperty(const Value &objVal, const string &propName) {
         // if its private, check if the js_object in closure is not nullptr
         // if closure.js_object is not nullptr
         
-        vector<string> modifiers = objVal.objectValue->get_modifiers(propName);
+        const vector<string>& modifiers = objVal.objectValue->get_modifiers(propName);
         
         bool isPrivate = false;
         bool isProtected = false;
         
-        for (auto modifier : modifiers) {
+        for (const auto& modifier : modifiers) {
             if (modifier == "private") {
                 isPrivate = true;
                 continue;
@@ -155,16 +151,16 @@ Value TurboVM::getProperty(const Value &objVal, const string &propName) {
         
         if (isPrivate) {
             // Disallow if we are not inside a closure of the owning object
-            if (frame->closure->js_object == nullptr || frame->closure->js_object.get() != objVal.objectValue.get()) {
+            if (frame->thisObject == nullptr || frame->thisObject.get() != objVal.objectValue.get()) {
                 throw runtime_error("Can't access '" + propName + "' a private property outside its class.");
             }
         }
         
         if (isProtected) {
-            if (frame->closure->js_object == nullptr) {
+            if (frame->thisObject == nullptr) {
                 throw runtime_error("Can't access '" + propName + "' a protected property outside its class or subclass.");
             }
-            auto accessor = frame->closure->js_object;
+            auto accessor = frame->thisObject;
             auto owner = objVal.objectValue;
             // Traverse up the class hierarchy of accessor to see if it matches owner's class
             auto accessorClass = accessor->getKlass();
@@ -197,11 +193,11 @@ Value TurboVM::getProperty(const Value &objVal, const string &propName) {
         // get the prop modifiers.
         // if its private, check if the js_object in closure is not nullptr
         
-        vector<string> modifiers = objVal.classValue->get_static_modifiers(propName);
+        const vector<string>& modifiers = objVal.classValue->get_static_modifiers(propName);
         bool isPrivate = false;
         bool isProtected = false;
 
-        for (auto modifier : modifiers) {
+        for (const auto& modifier : modifiers) {
             
             if (modifier == "private") {
                 isPrivate = true;
@@ -216,17 +212,17 @@ Value TurboVM::getProperty(const Value &objVal, const string &propName) {
         }
 
         if (isPrivate) {
-            if (!frame->closure->js_object ||
-                frame->closure->js_object->getKlass().get() != objVal.classValue.get()) {
+            if (!frame->thisObject ||
+                frame->thisObject->getKlass().get() != objVal.classValue.get()) {
                 throw runtime_error("Can't access a private static property outside its class.");
             }
         }
         
         if (isProtected) {
-            if (!frame->closure->js_object) {
+            if (!frame->thisObject) {
                 throw runtime_error("Can't access a protected static property outside its class or subclass.");
             }
-            auto accessorClass = frame->closure->js_object->getKlass();
+            auto accessorClass = frame->thisObject->getKlass();
             auto targetClass = objVal.classValue;
             bool allowed = false;
             while (accessorClass) {
@@ -291,26 +287,20 @@ shared_ptr<JSObject> TurboVM::createJSObject(shared_ptr<JSClass> klass) {
     object->turboVM = this;
     object->setClass(klass);
 
+    // a single object for the whole class chain: it holds only fields, and
+    // methods are looked up on the classes
     makeObjectInstance(Value::klass(klass), object);
-    
-    // create a jsobject from superclass and assign to parent_object
-    if (klass->superClass != nullptr) {
-        
-        object->parent_object = klass->superClass->is_native ? klass->superClass->construct() : createJSObject(klass->superClass);
-        object->parent_class = klass->superClass;
-        
-    }
 
     return object;
 
 }
 
-void TurboVM::CreateObjectLiteralProperty(Value obj_val, string prop_name, Value object) {
+void TurboVM::CreateObjectLiteralProperty(Value obj_val, Atom prop_name, Value object) {
     if (obj_val.type == ValueType::CLOSURE) {
         
         shared_ptr<Closure> new_closure = make_shared<Closure>();
         new_closure->fn = obj_val.closureValue->fn;
-        new_closure->upvalues = obj_val.closureValue->upvalues;
+        new_closure->captures = obj_val.closureValue->captures;
         new_closure->js_object = object.objectValue;
 
         object.objectValue->set(prop_name, Value::closure(new_closure), "VAR", { "public" });
@@ -325,54 +315,60 @@ void TurboVM::CreateObjectLiteralProperty(Value obj_val, string prop_name, Value
 
 void TurboVM::makeObjectInstance(Value klass, shared_ptr<JSObject> obj) {
     
+    // superclass fields first
+    shared_ptr<JSClass> superClass = klass.classValue->superClass;
+    if (superClass != nullptr) {
+        
+        if (superClass->is_native) {
+            // a native superclass keeps its own object
+            obj->parent_object = superClass->construct();
+            obj->parent_class = superClass;
+        } else {
+            makeObjectInstance(Value::klass(superClass), obj);
+        }
+        
+    }
+    
     for (auto& protoProp : klass.classValue->var_proto_props) {
                 
-        if (protoProp.second.value.type == ValueType::CLOSURE) {
-            
-            shared_ptr<Closure> new_closure = make_shared<Closure>();
-            new_closure->fn = protoProp.second.value.closureValue->fn;
-            new_closure->upvalues = protoProp.second.value.closureValue->upvalues;
-            new_closure->js_object = obj;
-
-            obj->set(protoProp.first, Value::closure(new_closure), "VAR", protoProp.second.modifiers);
-
-        } else {
+        // methods stay on the class
+        if (protoProp.second.value.type == ValueType::CLOSURE) continue;
             
-            // evaluate fields
-            int field_reg = protoProp.second.value.numberValue;
-            Value fnValue = module_->constants[field_reg];
-            Value val = callFunction(fnValue, {});
-                        
-            obj->set(protoProp.first, val, "VAR", protoProp.second.modifiers);
-
-        }
+        // evaluate fields
+        int field_reg = protoProp.second.value.numberValue;
+        Value fnValue = module_->constants[field_reg];
+        Value val = callFunction(fnValue, {});
+                    
+        obj->set(protoProp.first, val, "VAR", protoProp.second.modifiers);
 
     }
 
     for (auto& constProtoProp : klass.classValue->const_proto_props) {
                 
-        if (constProtoProp.second.value.type == ValueType::CLOSURE) {
+        if (constProtoProp.second.value.type == ValueType::CLOSURE) continue;
             
-            shared_ptr<Closure> new_closure = make_shared<Closure>();
-            new_closure->fn = constProtoProp.second.value.closureValue->fn;
-            new_closure->upvalues = constProtoProp.second.value.closureValue->upvalues;
-            new_closure->js_object = obj;
+        // evaluate fields
+        int field_reg = constProtoProp.second.value.numberValue;
+        Value fnValue = module_->constants[field_reg];
+        Value val = callFunction(fnValue, {});
 
-            obj->set(constProtoProp.first, Value::closure(new_closure), "CONST", {});
+        obj->set(constProtoProp.first, val, "CONST", constProtoProp.second.modifiers);
 
-        } else {
-            
-            // evaluate fields
-            int field_reg = constProtoProp.second.value.numberValue;
-            Value fnValue = module_->constants[field_reg];
-            Value val = callFunction(fnValue, {});
-
-            obj->set(constProtoProp.first, constProtoProp.second.value, "CONST", constProtoProp.second.modifiers);
+    }
 
-        }
+}
 
+// class methods are shared by all instances and take `this` from the
+// call; closures bound to an object literal or native object keep theirs
+static shared_ptr<JSObject> methodReceiver(const Value& callee, const Value& js_object) {
+    
+    shared_ptr<JSObject> thisObject = callee.closureValue->js_object;
+    if (!thisObject && js_object.type == ValueType::OBJECT) {
+        thisObject = js_object.objectValue;
     }
-
+    
+    return thisObject;
+    
 }
 
 void TurboVM::invokeMethod(Value obj_value, string name, vector<Value> args) {
@@ -387,15 +383,19 @@ void TurboVM::invokeMethod(Value obj_value, string name, vector<Value> args) {
     
 }
 
-void TurboVM::InvokeConstructor(Value obj_value, vector<Value> args) {
+// Runs the constructor of klass on obj_value. Every class gets one, and the
+// default one passes its arguments on to the superclass constructor.
+void TurboVM::InvokeConstructor(shared_ptr<JSClass> klass, Value obj_value, vector<Value> args) {
     
-    invokeMethod(obj_value, "constructor", args);
+    if (klass->is_native) {
+        if (obj_value.objectValue->parent_object != nullptr) {
+            invokeMethod(Value::object(obj_value.objectValue->parent_object), "constructor", args);
+        }
+        return;
+    }
     
-    // call super class constructor
+    callMethod(klass->get_constructor(), args, obj_value);
     
-    if (obj_value.objectValue->parent_object != nullptr) {
-        InvokeConstructor(Value::object(obj_value.objectValue->parent_object), args);
-    }
 }
 
 Value TurboVM::addCtor() {
@@ -407,7 +407,8 @@ Value TurboVM::addCtor() {
     fnChunk->code.push_back({TurboOpCode::Nop, 0,0,0});
     // fnChunk->writeByte(static_cast<uint8_t>((OpCode::SuperCall)));
     // fnChunk->writeUint8((uint8_t)0);
-    fnChunk->code.push_back({TurboOpCode::SuperCall, 0,0,0});
+    // super(...arguments)
+    fnChunk->code.push_back({TurboOpCode::SuperCall, 0,1,0});
 
     int constant_index = fnChunk->addConstant(Value::undefined());
     
@@ -430,7 +431,6 @@ Value TurboVM::addCtor() {
 
     shared_ptr<Closure> new_closure = make_shared<Closure>();
     new_closure->fn = fnObj;
-    new_closure->upvalues = {};
     
     return Value::closure(new_closure);
 
@@ -447,6 +447,7 @@ Value TurboVM::run(shared_ptr<TurboChunk> chunk_, const vector<Value>& args) {
     new_frame.locals.resize(chunk_->maxLocals, Value::undefined());
     new_frame.args = args;
     new_frame.closure = closure;
+    new_frame.tryBase = tryStack.size();
     
     uint32_t ncopy = std::min((uint32_t)args.size(), chunk_->maxLocals);
     for (uint32_t i = 0; i < ncopy; ++i) new_frame.locals[i] = args[i];
@@ -465,8 +466,14 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
     frame = &current_frame;
 
     while (true) {
+        if (Profiler::sample_pending) sampleStack();
+        
         Instruction instruction = readInstruction();
         TurboOpCode op = instruction.op;
+        
+#ifdef ARDAN_OPCODE_STATS
+        OpcodeStats::nova().dispatch((uint8_t)op);
+#endif
 
         switch (op) {
             case TurboOpCode::Nop:
@@ -514,8 +521,7 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 uint8_t constant_index = instruction.a;
                 uint8_t data_reg = instruction.b;
                 
-                Value name_val = frame->chunk->constants[constant_index];
-                string name = name_val.stringValue;
+                Atom name = frame->chunk->atomAt(constant_index);
                 
                 env->set_var(name, frame->registers[data_reg]);
                 
@@ -526,8 +532,7 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 uint8_t constant_index = instruction.a;
                 uint8_t data_reg = instruction.b;
                 
-                Value name_val = frame->chunk->constants[constant_index];
-                string name = name_val.stringValue;
+                Atom name = frame->chunk->atomAt(constant_index);
                 
                 env->set_let(name, frame->registers[data_reg]);
                 
@@ -538,8 +543,7 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 uint8_t constant_index = instruction.a;
                 uint8_t data_reg = instruction.b;
                 
-                Value name_val = frame->chunk->constants[constant_index];
-                string name = name_val.stringValue;
+                Atom name = frame->chunk->atomAt(constant_index);
                 
                 env->set_const(name, frame->registers[data_reg]);
                 
@@ -842,6 +846,73 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 break;
             }
 
+                // StringConcat, destReg, count; the part registers follow
+                // in Nop instructions, three per instruction
+            case TurboOpCode::StringConcat: {
+                size_t count = instruction.b;
+                vector<RopeString> parts;
+                parts.reserve(count);
+                
+                for (size_t i = 0; i < count; i++) {
+                    const Instruction& holder = frame->chunk->code[frame->ip + i / 3];
+                    uint8_t reg = i % 3 == 0 ? holder.a : (i % 3 == 1 ? holder.b : holder.c);
+                    parts.push_back(stringOf(frame->registers[reg]));
+                }
+                
+                frame->ip += (count + 2) / 3;
+                frame->registers[instruction.a] = Value::rope(RopeString::concat(parts));
+                break;
+            }
+                
+                // superinstructions, see TurboPeephole.hpp. ip already points
+                // at the second instruction of the sequence.
+            case TurboOpCode::LessThanJumpIfFalse:
+            case TurboOpCode::LessThanOrEqualJumpIfFalse:
+            case TurboOpCode::GreaterThanJumpIfFalse:
+            case TurboOpCode::GreaterThanOrEqualJumpIfFalse: {
+                double lhs = frame->registers[instruction.b].numberValue;
+                double rhs = frame->registers[instruction.c].numberValue;
+                bool result;
+                switch (op) {
+                    case TurboOpCode::LessThanJumpIfFalse: result = lhs < rhs; break;
+                    case TurboOpCode::LessThanOrEqualJumpIfFalse: result = lhs <= rhs; break;
+                    case TurboOpCode::GreaterThanJumpIfFalse: result = lhs > rhs; break;
+                    default: result = lhs >= rhs; break;
+                }
+                const Instruction& jump = frame->chunk->code[frame->ip++];
+                if (!result) frame->ip += jump.b;
+                break;
+            }
+                
+            case TurboOpCode::AddConst: {
+                const Instruction& add = frame->chunk->code[frame->ip++];
+                storeAdd(frame->registers[add.a],
+                         frame->registers[add.b],
+                         frame->chunk->constants[instruction.b]);
+                break;
+            }
+                
+            case TurboOpCode::LoadLocalGetProperty: {
+                const Instruction& get = frame->chunk->code[frame->ip++];
+                Atom prop = frame->chunk->atomAt(get.c);
+                // kept for when it is the receiver of a method call
+                frame->registers[instruction.a] = frame->locals[instruction.b];
+                frame->registers[get.a] = getProperty(frame->locals[instruction.b], prop);
+                break;
+            }
+                
+            case TurboOpCode::IncrementLocal: {
+                const Instruction& load = frame->chunk->code[frame->ip];
+                const Instruction& add = frame->chunk->code[frame->ip + 1];
+                frame->ip += 3;
+                Value& local = frame->locals[instruction.b];
+                storeAdd(local, local, frame->chunk->constants[load.b]);
+                Value& dest = frame->registers[add.a];
+                if (local.type == ValueType::NUMBER && dest.type == ValueType::NUMBER) dest.numberValue = local.numberValue;
+                else dest = local;
+                break;
+            }
+
             case TurboOpCode::LoadLocalVar: {
                 // LoadLocalVar, reg_slot, idx
                 int reg = instruction.a;
@@ -855,7 +926,7 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 
                 int reg = instruction.a;
                 int idx = instruction.b;
-                string name = frame->chunk->constants[idx].stringValue;
+                Atom name = frame->chunk->atomAt(idx);
                 
                 frame->registers[reg] = toValue(env->get(name));
 
@@ -888,8 +959,7 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 
                 uint8_t idx = instruction.a;
                 uint8_t reg_slot = instruction.b;
-                Value val = frame->chunk->constants[idx];
-                string name = val.stringValue;
+                Atom name = frame->chunk->atomAt(idx);
                 
                 env->set_var(name, frame->registers[reg_slot]);
 
@@ -900,8 +970,7 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 
                 uint8_t idx = instruction.a;
                 uint8_t reg_slot = instruction.b;
-                Value val = frame->chunk->constants[idx];
-                string name = val.stringValue;
+                Atom name = frame->chunk->atomAt(idx);
 
                 env->set_let(name, frame->registers[reg_slot]);
 
@@ -928,9 +997,8 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 Value spreadArray = frame->registers[instruction.b];
                 Value array = frame->registers[instruction.a];
                 
-                for( auto index : spreadArray.arrayValue->get_indexed_properties()) {
-                    array.arrayValue->push({ index.second });
-                }
+                const vector<Value>& items = spreadArray.arrayValue->elements;
+                array.arrayValue->elements.insert(array.arrayValue->elements.end(), items.begin(), items.end());
                 
                 frame->registers[instruction.a] = array;
 
@@ -968,7 +1036,9 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 klass.classValue->name = name;
                 
                 // add constructor
-                klass.classValue->set_proto_vm_var("constructor", addCtor(), { "public" } );
+                Value ctor = addCtor();
+                ctor.closureValue->home_class = js_class;
+                klass.classValue->set_proto_vm_var("constructor", ctor, { "public" } );
                                 
                 frame->registers[instruction.a] = (klass);
                 break;
@@ -1140,6 +1210,11 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 Value init = frame->registers[instruction.b];
                 Value fieldNameValue = frame->registers[instruction.c];
                 
+                if (init.type == ValueType::CLOSURE) {
+                    // shared by every instance; `this` comes from the call
+                    init.closureValue->js_object = nullptr;
+                    init.closureValue->home_class = klass.classValue;
+                }
                 klass.classValue->set_proto_vm_var(fieldNameValue.stringValue, init, { "protected" });
                 break;
             }
@@ -1149,6 +1224,10 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 Value init = frame->registers[instruction.b];
                 Value fieldNameValue = frame->registers[instruction.c];
                 
+                if (init.type == ValueType::CLOSURE) {
+                    init.closureValue->js_object = nullptr;
+                    init.closureValue->home_class = klass.classValue;
+                }
                 klass.classValue->set_proto_vm_var(fieldNameValue.stringValue, init, { "private" });
                 break;
             }
@@ -1159,6 +1238,10 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 Value init = frame->registers[instruction.b];
                 Value fieldNameValue = frame->registers[instruction.c];
                 
+                if (init.type == ValueType::CLOSURE) {
+                    init.closureValue->js_object = nullptr;
+                    init.closureValue->home_class = klass.classValue;
+                }
                 klass.classValue->set_proto_vm_var(fieldNameValue.stringValue, init, { "public" });
                 break;
             }
@@ -1178,13 +1261,25 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 // TurboOpCode::InvokeConstructor, reg, argRegs[0], (int)argRegs.size());
             case TurboOpCode::InvokeConstructor: {
                 
-                const vector<Value> const_args = { argStack.begin(), argStack.end() };
+                vector<Value> args = { argStack.begin(), argStack.end() };
                 argStack.clear();
 
                 Value obj_value = frame->registers[instruction.a];
 
                 // call the constructor
-                InvokeConstructor(obj_value, const_args);
+                shared_ptr<JSClass> klass = obj_value.type == ValueType::OBJECT ? obj_value.objectValue->getKlass() : nullptr;
+                Value ctor = klass != nullptr && !klass->is_native ? klass->get_constructor() : Value::undefined();
+                
+                if (ctor.type == ValueType::CLOSURE) {
+                    enterFrame(ctor.closureValue, std::move(args), methodReceiver(ctor, obj_value), instruction.a, true);
+                    break;
+                }
+                
+                if (klass != nullptr && !klass->is_native) {
+                    InvokeConstructor(klass, obj_value, args);
+                } else {
+                    invokeMethod(obj_value, "constructor", args);
+                }
                 
                 frame->registers[instruction.a] = obj_value;
 
@@ -1206,8 +1301,7 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
             case TurboOpCode::CreateObjectLiteralProperty: {
                 
                 auto object = frame->registers[instruction.a];
-                Value val = frame->chunk->constants[instruction.b];
-                string prop_name = val.toString();
+                Atom prop_name = frame->chunk->atomAt(instruction.b);
                 Value obj_val = frame->registers[instruction.c];
 
                 CreateObjectLiteralProperty(obj_val, prop_name, object);
@@ -1218,7 +1312,7 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
             }
                 
             case TurboOpCode::GetThis: {
-                frame->registers[instruction.a] = Value::object(frame->closure->js_object);
+                frame->registers[instruction.a] = frame->thisObject ? Value::object(frame->thisObject) : Value::undefined();
                 break;
             }
                 
@@ -1226,10 +1320,13 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
             case TurboOpCode::LoadThisProperty: {
                 
                 // load constant from nameIdx
-                Value property_value = frame->chunk->constants[instruction.b];
-                string property_name = property_value.toString();
+                Atom property_name = frame->chunk->atomAt(instruction.b);
+                
+                if (!frame->thisObject) {
+                    throw runtime_error("Cannot read '" + property_name + "' of undefined 'this'.");
+                }
                                 
-                Value obj = getProperty(Value::object(frame->closure->js_object), property_name);
+                Value obj = getProperty(Value::object(frame->thisObject), property_name);
                 
                 frame->registers[instruction.a] = obj;
 
@@ -1240,12 +1337,15 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
             case TurboOpCode::StoreThisProperty: {
                 
                 // load constant from nameIdx
-                Value property_value = frame->chunk->constants[instruction.a];
-                string property_name = property_value.toString();
+                Atom property_name = frame->chunk->atomAt(instruction.a);
                 
                 Value value = frame->registers[instruction.b];
                 
-                setProperty(Value::object(frame->closure->js_object), property_name, value);
+                if (!frame->thisObject) {
+                    throw runtime_error("Cannot set '" + property_name + "' of undefined 'this'.");
+                }
+                
+                setProperty(Value::object(frame->thisObject), property_name, value);
                 
                 // this update the object the current object
                 
@@ -1275,7 +1375,8 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
             }
                 
             case TurboOpCode::GetParentObject: {
-                frame->registers[instruction.a] = Value::object(frame->closure->js_object->parent_object);
+                // only objects with a native superclass have one
+                frame->registers[instruction.a] = frame->thisObject && frame->thisObject->parent_object ? Value::object(frame->thisObject->parent_object) : Value::undefined();
                 break;
             }
 
@@ -1283,8 +1384,7 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 // SetProperty: objReg, nameIdx, valueReg
             case TurboOpCode::SetProperty: {
                 auto object = frame->registers[instruction.a];
-                Value val = frame->chunk->constants[instruction.b];
-                string prop_name = val.toString();//stringValue;
+                Atom prop_name = frame->chunk->atomAt(instruction.b);
                 Value obj_val = frame->registers[instruction.c];
                 
                 setProperty(object, prop_name, obj_val);
@@ -1317,7 +1417,7 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 // TurboOpCode::GetProperty, lhsReg, objReg, nameIdx
             case TurboOpCode::GetProperty: {
                 Value object = frame->registers[instruction.b];
-                string prop = frame->chunk->constants[instruction.c].stringValue;
+                Atom prop = frame->chunk->atomAt(instruction.c);
                 Value val = getProperty(object, prop);
                 frame->registers[instruction.a] = val;
                 break;
@@ -1330,6 +1430,79 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 break;
             }
                 
+                // GetIndex, lhsReg, objReg, keyReg
+            case TurboOpCode::GetIndex: {
+                const Value& object = frame->registers[instruction.b];
+                const Value& key = frame->registers[instruction.c];
+                
+                if (key.type == ValueType::NUMBER &&
+                    object.type == ValueType::OBJECT &&
+                    object.objectValue->is_typed_array) {
+                    auto* typed = static_cast<JSTypedArray*>(object.objectValue.get());
+                    double index = key.numberValue;
+                    size_t i = (size_t)index;
+                    frame->registers[instruction.a] = (index >= 0 && i < typed->length && (double)i == index)
+                        ? Value::number(typed->load(i))
+                        : Value::undefined();
+                    break;
+                }
+                
+                if (key.type == ValueType::NUMBER && object.type == ValueType::ARRAY) {
+                    double index = key.numberValue;
+                    size_t i = (size_t)index;
+                    if (index >= 0 && (double)i == index) {
+                        frame->registers[instruction.a] = object.arrayValue->getIndex(i);
+                        break;
+                    }
+                }
+                
+                frame->registers[instruction.a] = getProperty(object, key.toString());
+                break;
+            }
+                
+                // SetIndex, objReg, keyReg, valueReg
+            case TurboOpCode::SetIndex: {
+                Value object = frame->registers[instruction.a];
+                const Value& key = frame->registers[instruction.b];
+                
+                if (key.type == ValueType::NUMBER &&
+                    object.type == ValueType::OBJECT &&
+                    object.objectValue->is_typed_array) {
+                    auto* typed = static_cast<JSTypedArray*>(object.objectValue.get());
+                    double index = key.numberValue;
+                    size_t i = (size_t)index;
+                    if (index >= 0 && i < typed->length && (double)i == index) {
+                        typed->store(i, frame->registers[instruction.c].numberValue);
+                    }
+                } else if (key.type == ValueType::NUMBER &&
+                           object.type == ValueType::ARRAY &&
+                           key.numberValue >= 0 &&
+                           (double)(size_t)key.numberValue == key.numberValue) {
+                    object.arrayValue->setIndex((size_t)key.numberValue, frame->registers[instruction.c]);
+                } else {
+                    setProperty(object, key.toString(), frame->registers[instruction.c]);
+                }
+                
+                frame->registers[instruction.c] = object;
+                break;
+            }
+                
+                // GetIterator, iterReg, srcReg
+            case TurboOpCode::GetIterator: {
+                frame->registers[instruction.a] = getIterator(frame->registers[instruction.b]);
+                break;
+            }
+                
+                // IteratorNext, valueReg, iterReg, hasValueReg
+            case TurboOpCode::IteratorNext: {
+                auto iterator = static_pointer_cast<JSIterator>(frame->registers[instruction.b].objectValue);
+                Value value = Value::undefined();
+                bool has_value = iterator->next(value);
+                frame->registers[instruction.a] = value;
+                frame->registers[instruction.c] = Value::boolean(has_value);
+                break;
+            }
+                
                 // keysReg, objReg
             case TurboOpCode::EnumKeys: {
                 // object is in stack.
@@ -1373,83 +1546,11 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 break;
             }
                 
-            case TurboOpCode::Try: {
-                uint32_t catchOffset = instruction.a;
-                uint32_t finallyOffset = instruction.b;
-                // compute absolute IPs
-                int base = (int)frame->ip; // ip now points after the offsets
-                TryFrame f;
-                f.catchIP = (catchOffset == 0) ? -1 : (base + (int)catchOffset);
-                f.finallyIP = (finallyOffset == 0) ? -1 : (base + (int)finallyOffset);
-                // f.stackDepth = (int)stack.size();
-                // ipAfterTry can be filled later by codegen if you want; keep -1 if unused
-                f.ipAfterTry = -1;
-                f.regCatch = instruction.c;
-                tryStack.push_back(f);
-                break;
-            }
-
-            case TurboOpCode::EndTry: {
-                if (tryStack.empty()) {
-                    // runtime error: unmatched END_TRY
-                    // running = false;
-                    break;
-                }
-                tryStack.pop_back();
-                break;
-            }
-                
             case TurboOpCode::Throw: {
                 // exception value on top of stack
                 Value exc = frame->registers[instruction.a].toString();
-                // unwind frames until we find a handler (catch or finally)
-                bool handled = false;
-                // Store a 'pending exception' to know we are unwinding due to throw
-                Value pending = exc;
                 
-                while (!tryStack.empty()) {
-                    TryFrame f = tryStack.back();
-                    tryStack.pop_back();
-                    
-                    // first, unwind the value stack to the depth at try entry
-                    // while ((int)stack.size() > f.stackDepth) stack.pop_back();
-                    
-                    // If there is a finally, run it first.
-                    if (f.catchIP != -1) {
-                        // push pending exception so finalizer can see it if needed
-                        // stack.push_back(pending);
-                        
-                        // Record a special marker frame to indicate we are resuming a throw after finally
-                        // We'll push a synthetic TryFrame with catchIP = original catchIP, finallyIP = -1
-                        TryFrame resume;
-                        resume.catchIP = -1;
-                        resume.finallyIP = f.finallyIP;
-                        // resume.stackDepth = f.stackDepth; // after finally resumes, stack depth should be this
-                        resume.ipAfterTry = -1;
-                        
-                        frame->registers[f.regCatch] = exc;
-                        
-                        tryStack.push_back(resume);
-                        
-                        // jump into finalizer
-                        frame->ip = f.catchIP;
-                        
-                        handled = true; // we will handle after finalizer/resume
-                        break;
-                    }
-                    
-                    // If no finally, but there is a catch, jump to catch and push exception
-                    if (f.finallyIP != -1) {
-                        // stack.push_back(pending);
-                        frame->ip = f.finallyIP;
-                        handled = true;
-                        break;
-                    }
-                    
-                    // else continue unwinding to outer try frame
-                }
-                
-                if (!handled) {
+                if (!throwToHandler(exc)) {
                     // uncaught
                     // Here: runtime uncaught exception -> abort or print error
                     // For demo, we stop the VM
@@ -1459,38 +1560,18 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 break;
             }
                 
+                // TurboOpCode::EndFinally, distance back to the start of the finally block
             case TurboOpCode::EndFinally: {
-                // When a finally finishes, we must check whether we have a resume frame that carries a pending throw
-                // Approach: if there is a TryFrame on tryStack whose catchIP != -1 and which we pushed as resume frame,
-                // then either jump into catch or rethrow.
-                if (!tryStack.empty()) {
-                    TryFrame resume = tryStack.back();
-                    // If resume.finallyIP == -1, we treat this as the resume frame we pushed earlier
-                    if (resume.finallyIP == -1) {
-                        tryStack.pop_back();
-                        if (resume.finallyIP != -1) {
-                            // pending exception should be on stack top
-                            // jump into catch with exception on stack
-                            frame->ip = resume.finallyIP;
-                            break;
-                        } else {
-                            // no catch for the pending exception, continue unwinding:
-                            // emulate throwing again: pop pending exception and re-run OP_THROW logic
-                            // Value pending = pop();
-                            // continue throw loop by re-inserting pending on stack and handling next frame
-                            // simplest approach: directly re-run THROW handling by pushing pending and continuing
-                            // For clarity, we will set a special behaviour: re-insert pending and emulate OP_THROW
-                            // stack.push_back(pending);
-                            // simulate OP_THROW logic by jumping back one step: decrement ip so we re-execute OP_THROW
-                            // But cleaner: call a helper to handle rethrow. For brevity we perform a manual loop here.
-                            // (In production you would share the throw-handling code.)
-                            // For now: we'll call a helper:
-                            handleRethrow();
-                            break;
-                        }
+                int finallyIP = (int)frame->ip - 1 - instruction.a;
+                
+                // a throw that ran this finally goes on to the next handler
+                if (tryStack.size() > frame->tryBase && tryStack.back().finallyIP == finallyIP) {
+                    TryFrame f = tryStack.back();
+                    tryStack.pop_back();
+                    if (!throwToHandler(f.exception)) {
+                        printf("Uncaught exception after finally, halting VM\n");
                     }
                 }
-                // Normal end finally with no pending throw resume -> continue execution
                 break;
             }
                 
@@ -1518,8 +1599,8 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 int argReg = instruction.a;
                 Value array = frame->registers[argReg];
                 
-                for (auto index : array.arrayValue->get_indexed_properties()) {
-                    argStack.push_back(index.second);
+                for (const Value& item : array.arrayValue->elements) {
+                    argStack.push_back(item);
                 }
                 
                 break;
@@ -1561,7 +1642,7 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
 
                 if (inputArr && start < (int)inputArr->length()) {
                     for (int i = start; i < (int)inputArr->length(); ++i) {
-                        arr->push({ inputArr->get(to_string(i)) });
+                        arr->elements.push_back(inputArr->elements[i]);
                     }
                 }
                 
@@ -1598,73 +1679,70 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 auto fnRef = fnVal.fnRef; // FunctionObject*
                 auto closure = make_shared<Closure>();
                 closure->fn = fnRef;
+                closure->captures.reserve(fnRef->upvalues_size);
+                // functions created inside a method see its `this` and `super`
+                closure->js_object = frame->thisObject;
+                if (frame->closure) closure->home_class = frame->closure->home_class;
 
                 frame->registers[instruction.a] = Value::closure(closure);
 
                 break;
             }
                 
-                // --- Upvalue access ---
-                //case TurboOpCode::GetUpvalue: {
-//                    uint32_t idx = readUint32();
-//                    push(*frame->closure->upvalues[idx]->location);
-                //    break;
-                //}
-                //case TurboOpCode::SetUpvalue: {
-//                    uint32_t idx = readUint32();
-//                    *frame->closure->upvalues[idx]->location = pop();
-                //    break;
-                //}
-                    
-            case TurboOpCode::CloseUpvalue: {
-                //                    closeUpvalues(stack.empty() ? nullptr : &stack.back());
-                //                    pop();
-                // TODO: check this works
-                closeUpvalues(nullptr);
-                break;
-            }
-                
                 // LoadUpvalue, reg_slot, upvalue
             case TurboOpCode::LoadUpvalue: {
-                uint32_t idx = instruction.b;
-                frame->registers[instruction.a] = *frame->closure->upvalues[idx]->location;
-
+                const Capture& capture = frame->closure->captures[instruction.b];
+                frame->registers[instruction.a] = capture.box ? *capture.box : capture.value;
                 break;
             }
                 
-                // StoreUpvalueVar, upvalue, reg_slot
-            case TurboOpCode::StoreUpvalueVar: {
-                *frame->closure->upvalues[instruction.a]->location = frame->registers[instruction.b];
+                // StoreUpvalueVar, upvalue, reg_slot; assigned captures are always boxed
+            case TurboOpCode::StoreUpvalueVar:
+            case TurboOpCode::StoreUpvalueLet:
+            case TurboOpCode::StoreUpvalueConst: {
+                *frame->closure->captures[instruction.a].box = frame->registers[instruction.b];
                 break;
             }
-            case TurboOpCode::StoreUpvalueLet: {
-                *frame->closure->upvalues[instruction.a]->location = frame->registers[instruction.b];
+                
+                // CreateLocalBox, idx, reg_slot: a fresh box, so closures made
+                // in earlier loop iterations keep their own
+            case TurboOpCode::CreateLocalBox: {
+                localBox(instruction.a) = make_shared<Value>(frame->registers[instruction.b]);
                 break;
             }
-            case TurboOpCode::StoreUpvalueConst: {
-                *frame->closure->upvalues[instruction.a]->location = frame->registers[instruction.b];
+                
+                // StoreLocalBox, idx, reg_slot
+            case TurboOpCode::StoreLocalBox: {
+                shared_ptr<Value>& box = localBox(instruction.a);
+                if (box) *box = frame->registers[instruction.b];
+                else box = make_shared<Value>(frame->registers[instruction.b]);
                 break;
             }
                 
-                // SetClosureIsLocal, isLocalReg, indexReg, closureChunkIndexReg
-            case TurboOpCode::SetClosureIsLocal: {
-                int idx = frame->registers[instruction.b].numberValue;
-                frame->registers[instruction.c].closureValue->upvalues.push_back(captureUpvalue(&frame->locals[idx]));
+                // LoadLocalBox, reg_slot, idx
+            case TurboOpCode::LoadLocalBox: {
+                shared_ptr<Value>& box = localBox(instruction.b);
+                frame->registers[instruction.a] = box ? *box : frame->locals[instruction.b];
                 break;
             }
-
-                // TurboOpCode::SetClosureIndex, indexReg, closureChunkIndexReg
-            case TurboOpCode::SetClosureIndex: {
                 
-                int indexReg = instruction.a;
-                int closureChunkIndexReg = instruction.b;
-                
-                int idx = frame->registers[indexReg].numberValue;
+                // CaptureLocal, closureReg, idx: the closure keeps a copy
+            case TurboOpCode::CaptureLocal: {
+                frame->registers[instruction.a].closureValue->captures.push_back({ frame->locals[instruction.b], nullptr });
+                break;
+            }
                 
-                auto up = frame->closure->upvalues[idx];
+                // CaptureLocalBox, closureReg, idx: the closure shares the box
+            case TurboOpCode::CaptureLocalBox: {
+                shared_ptr<Value>& box = localBox(instruction.b);
+                if (!box) box = make_shared<Value>(frame->locals[instruction.b]);
+                frame->registers[instruction.a].closureValue->captures.push_back({ Value(), box });
+                break;
+            }
                 
-                frame->registers[closureChunkIndexReg].closureValue->upvalues.push_back(up);
-
+                // CaptureUpvalue, closureReg, upvalue: passed on from this closure
+            case TurboOpCode::CaptureUpvalue: {
+                frame->registers[instruction.a].closureValue->captures.push_back(frame->closure->captures[instruction.b]);
                 break;
             }
                 
@@ -1684,37 +1762,146 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
                 
                 Value func = frame->registers[funcReg];
                 
-                const vector<Value> const_args = { argStack.begin(), argStack.end() };
+                vector<Value> args = { argStack.begin(), argStack.end() };
                 argStack.clear();
 
-                Value result = callFunction(func, const_args);
+                if (func.type == ValueType::CLOSURE) {
+                    enterFrame(func.closureValue, std::move(args), func.closureValue->js_object, resultReg);
+                    break;
+                }
+                
+                Value result = callFunction(func, args);
                 frame->registers[resultReg] = result;
 
                 break;
             }
                 
-                // TurboOpCode::SuperCall, resultReg, funcReg, static_cast<int>(argRegs.size())
-            case TurboOpCode::SuperCall: {
+                // TurboOpCode::TailCall, resultReg, funcReg, argc; always followed by Return resultReg
+            case TurboOpCode::TailCall: {
                 
-                const vector<Value> const_args = { argStack.begin(), argStack.end() };
+                Value func = frame->registers[instruction.b];
+                
+                vector<Value> args = { argStack.begin(), argStack.end() };
                 argStack.clear();
 
-                Value obj_value = frame->registers[instruction.b];
+                // anything but a closure is called as usual and the Return
+                // after this instruction hands on its result
+                if (func.type != ValueType::CLOSURE) {
+                    frame->registers[instruction.a] = callFunction(func, args);
+                    break;
+                }
+                
+                // the callee takes over this frame: whoever called it gets
+                // the callee's result, and the stack does not grow
+                shared_ptr<TurboChunk> calleeChunk = chunkFor(func.closureValue->fn->chunkIndex);
+                
+                tryStack.resize(frame->tryBase);
+                frame->chunk = calleeChunk;
+                frame->ip = 0;
+                frame->locals.assign(calleeChunk->maxLocals, Value::undefined());
+                frame->boxes.clear();
+                frame->args = std::move(args);
+                frame->closure = func.closureValue;
+                frame->thisObject = func.closureValue->js_object;
+                
+                break;
+            }
+                
+                // TurboOpCode::SuperCall, resultReg, forwardArgs, argc
+                // runs the superclass constructor on `this`; the default
+                // constructor sets forwardArgs to pass on its own arguments
+            case TurboOpCode::SuperCall: {
+                
+                vector<Value> args = instruction.b ? frame->args : vector<Value>(argStack.begin(), argStack.end());
+                argStack.clear();
 
-                // call the constructor
-                invokeMethod(obj_value, "constructor", const_args);
+                shared_ptr<JSClass> home = frame->closure ? frame->closure->home_class : nullptr;
+                Value obj_value = frame->thisObject ? Value::object(frame->thisObject) : Value::undefined();
 
                 frame->registers[instruction.a] = obj_value;
 
+                if (home == nullptr || home->superClass == nullptr || obj_value.type != ValueType::OBJECT) {
+                    break;
+                }
+                
+                Value ctor = home->superClass->is_native ? Value::undefined() : home->superClass->get_constructor();
+                
+                if (ctor.type == ValueType::CLOSURE) {
+                    enterFrame(ctor.closureValue, std::move(args), methodReceiver(ctor, obj_value), instruction.a, true);
+                } else {
+                    InvokeConstructor(home->superClass, obj_value, args);
+                }
+
                 break;
             }
+                
+                // TurboOpCode::CallMethod, resultReg, funcReg, receiverReg
+            case TurboOpCode::CallMethod: {
+                
+                Value func = frame->registers[instruction.b];
+                Value receiver = frame->registers[instruction.c];
+                
+                vector<Value> args = { argStack.begin(), argStack.end() };
+                argStack.clear();
 
-            case TurboOpCode::Return: {
-                closeUpvalues(nullptr);
+                if (func.type == ValueType::CLOSURE) {
+                    enterFrame(func.closureValue, std::move(args), methodReceiver(func, receiver), instruction.a);
+                    break;
+                }
+                
+                Value result = callMethod(func, args, receiver);
+                frame->registers[instruction.a] = result;
 
+                break;
+            }
+                
+                // TurboOpCode::GetSuperProperty, reg, nameIdx
+            case TurboOpCode::GetSuperProperty: {
+                
+                Atom name = frame->chunk->atomAt(instruction.b);
+                shared_ptr<JSClass> home = frame->closure ? frame->closure->home_class : nullptr;
+                Value value = Value::undefined();
+                
+                if (home != nullptr && home->superClass != nullptr) {
+                    if (!home->superClass->is_native) {
+                        if (const ValueField* method = home->superClass->find_proto_method(name)) {
+                            value = method->value;
+                        }
+                    } else if (frame->thisObject && frame->thisObject->parent_object) {
+                        value = frame->thisObject->parent_object->get(name);
+                    }
+                }
+                
+                // superclass fields live on `this`
+                if (value.isUndefined() && frame->thisObject) {
+                    value = getProperty(Value::object(frame->thisObject), name);
+                }
+                
+                frame->registers[instruction.a] = value;
+                
+                break;
+            }
+
+            case TurboOpCode::Return: {
                 Value v = frame->registers[instruction.a];
-                                
-                return v;
+                
+                if (!frame->inlineCall) {
+                    return v;
+                }
+                
+                // back to the caller in this same loop
+                bool construct = frame->construct;
+                uint8_t returnReg = frame->returnReg;
+                tryStack.resize(frame->tryBase);
+                callStack.pop_back();
+                frame = &callStack.back();
+                
+                // a constructor's result is the `this` the caller already holds
+                if (!construct) {
+                    frame->registers[returnReg] = v;
+                }
+                
+                break;
             }
 
             case TurboOpCode::Halt:
@@ -1752,11 +1939,280 @@ Value TurboVM::runFrame(CallFrame &current_frame) {
 
 Value TurboVM::callMethod(Value callee, vector<Value>& args, Value js_object) {
 
-    return callFunction(callee, args);
+    if (callee.type != ValueType::CLOSURE) {
+        return callFunction(callee, args);
+    }
+    
+    return callClosure(callee.closureValue, args, methodReceiver(callee, js_object));
+    
+}
+
+// an empty frame on top of callStack. past call_stack_limit frames this
+// throws instead; enterFrame turns that into a catchable RangeError.
+TurboVM::CallFrame& TurboVM::pushFrame() {
+    
+    if (callStack.size() >= call_stack_limit) {
+        throw runtime_error("RangeError: Maximum call stack size exceeded");
+    }
+    
+    callStack.emplace_back();
+    CallFrame& callee = callStack.back();
+    callee.tryBase = tryStack.size();
+    
+    return callee;
+    
+}
+
+// Starts a script call from inside runFrame: the callee becomes the current
+// frame and the loop carries on with its first instruction. Its Return
+// comes back to the caller, so script calls never nest runFrame.
+void TurboVM::enterFrame(shared_ptr<Closure> closure, vector<Value> args, shared_ptr<JSObject> thisObject, uint8_t returnReg, bool construct) {
+    
+    if (callStack.size() >= call_stack_limit) {
+        Value error = Value::str("RangeError: Maximum call stack size exceeded");
+        if (!throwToHandler(error)) {
+            throw runtime_error(error.toString());
+        }
+        return;
+    }
+    
+    shared_ptr<TurboChunk> calleeChunk = chunkFor(closure->fn->chunkIndex);
+    
+    CallFrame& callee = pushFrame();
+    callee.chunk = calleeChunk;
+    callee.locals.resize(calleeChunk->maxLocals, Value::undefined());
+    callee.args = std::move(args);
+    callee.closure = std::move(closure);
+    callee.thisObject = std::move(thisObject);
+    callee.inlineCall = true;
+    callee.construct = construct;
+    callee.returnReg = returnReg;
+    
+    frame = &callee;
+    
+}
+
+// runs a closure to completion for native code (builtin callbacks,
+// promise reactions) with its own runFrame loop
+Value TurboVM::callClosure(shared_ptr<Closure> closure, const vector<Value>& args, shared_ptr<JSObject> thisObject) {
+    
+    shared_ptr<TurboChunk> calleeChunk = chunkFor(closure->fn->chunkIndex);
+    
+    CallFrame& new_frame = pushFrame();
+    new_frame.chunk = calleeChunk;
+    // allocate locals sized to the chunk's max locals (some chunks use maxLocals)
+    new_frame.locals.resize(calleeChunk->maxLocals, Value::undefined());
+    new_frame.args = args;
+    new_frame.closure = closure;
+    new_frame.thisObject = std::move(thisObject);
+
+    size_t depth = callStack.size();
+    size_t tryBase = new_frame.tryBase;
+    Value result;
+    
+    try {
+        result = runFrame(new_frame);
+    } catch (...) {
+        // drop the frames the error unwound through, inline ones included
+        callStack.resize(depth - 1);
+        tryStack.resize(tryBase);
+        frame = callStack.empty() ? nullptr : &callStack.back();
+        throw;
+    }
+    
+    tryStack.resize(tryBase);
+    callStack.pop_back();
+    frame = &callStack.back();
+    
+    return result;
+    
+}
+
+// Callback frames. The callee's frame is pushed once and rewound for each
+// call, so a builtin running a closure per element sets up one frame.
+bool TurboVM::beginCallback(const Value& closure) {
+    
+    CallFrame* caller = frame;
+    CallFrame& callback = pushFrame();
+    callback.chunk = chunkFor(closure.closureValue->fn->chunkIndex);
+    callback.closure = closure.closureValue;
+    
+    callbackFrames.push_back({ callStack.size(), caller });
+    frame = caller;
+    
+    return true;
+    
+}
+
+Value TurboVM::runCallback(const Value& closure, const Value* argv, size_t argc) {
+    
+    const CallbackFrame& entry = callbackFrames.back();
+    CallFrame& callback = callStack[entry.depth - 1];
+    
+    // a tail call in the last run may have left another function here
+    if (callback.closure != closure.closureValue) {
+        callback.chunk = chunkFor(closure.closureValue->fn->chunkIndex);
+        callback.closure = closure.closureValue;
+    }
+    callback.thisObject = closure.closureValue->js_object;
+    callback.ip = 0;
+    callback.locals.assign(callback.chunk->maxLocals, Value::undefined());
+    callback.boxes.clear();
+    callback.args.assign(argv, argv + argc);
+    
+    CallFrame* caller = entry.caller;
+    size_t depth = entry.depth;
+    size_t tryBase = callback.tryBase;
+    Value result;
+    
+    try {
+        result = runFrame(callback);
+    } catch (...) {
+        // the frame goes with the error; endCallback finds it gone
+        callStack.resize(depth - 1);
+        tryStack.resize(tryBase);
+        frame = caller;
+        throw;
+    }
+    
+    tryStack.resize(tryBase);
+    frame = caller;
+    
+    return result;
+    
+}
+
+void TurboVM::endCallback() {
+    
+    CallbackFrame entry = callbackFrames.back();
+    callbackFrames.pop_back();
+    
+    if (callStack.size() == entry.depth) {
+        callStack.pop_back();
+    }
+    frame = entry.caller;
+    
+}
+
+// the chunk a call enters. a parallelFor worker refuses the functions that
+// failed the purity check, since it shares their state with other threads.
+shared_ptr<TurboChunk> TurboVM::chunkFor(uint32_t index) {
+    
+    if (pureChunks && (index >= pureChunks->size() || !(*pureChunks)[index])) {
+        throw runtime_error("TypeError: " + module_->chunks[index]->name + " is not pure and cannot run in parallel");
+    }
+    
+    return module_->chunk(index);
+    
+}
+
+// ops that write state outside the running frame (globals, captured
+// variables, objects and arrays the function did not create) or that need
+// the VM's own thread (promises, classes, the event loop)
+static bool writesOutsideFrame(TurboOpCode op) {
+    switch (op) {
+        case TurboOpCode::StoreGlobalVar:
+        case TurboOpCode::StoreGlobalLet:
+        case TurboOpCode::CreateGlobalVar:
+        case TurboOpCode::CreateGlobalLet:
+        case TurboOpCode::CreateGlobalConst:
+        case TurboOpCode::StoreUpvalueVar:
+        case TurboOpCode::StoreUpvalueLet:
+        case TurboOpCode::StoreUpvalueConst:
+        case TurboOpCode::SetProperty:
+        case TurboOpCode::SetPropertyDynamic:
+        case TurboOpCode::SetIndex:
+        case TurboOpCode::SetStaticProperty:
+        case TurboOpCode::StoreThisProperty:
+        case TurboOpCode::SetThisProperty:
+        case TurboOpCode::Delete:
+        case TurboOpCode::CreateEnum:
+        case TurboOpCode::SetEnumProperty:
+        case TurboOpCode::NewClass:
+        case TurboOpCode::CreateInstance:
+        case TurboOpCode::InvokeConstructor:
+        case TurboOpCode::SuperCall:
+        case TurboOpCode::PushLexicalEnv:
+        case TurboOpCode::PopLexicalEnv:
+        case TurboOpCode::SetExecutionContext:
+        case TurboOpCode::Await:
+        case TurboOpCode::CreatePromise:
+        case TurboOpCode::CreateUIView:
+        case TurboOpCode::AddChildSubView:
+        case TurboOpCode::SetUIViewArgument:
+        case TurboOpCode::CallUIViewModifier:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static const size_t min_parallel_count = 1024;
+
+// Array callbacks on worker threads. Every chunk is compiled first, since
+// compiling writes to the module, and checked once for ops that write
+// outside their frame. The callback must pass unless it was declared pure;
+// the functions it calls are checked as the workers enter them.
+bool TurboVM::parallelFor(const Value& fn, bool pure, size_t count,
+                          const function<void(size_t begin, size_t end)>& body) {
+    
+    if (fn.type != ValueType::CLOSURE) return false;
+    
+    while (!module_->deferred.empty()) {
+        module_->chunk(module_->deferred.begin()->first);
+    }
+    
+    vector<bool> pureChunks(module_->chunks.size(), true);
+    for (size_t i = 0; i < module_->chunks.size(); i++) {
+        for (const Instruction& instruction : module_->chunks[i]->code) {
+            if (writesOutsideFrame(instruction.op)) {
+                pureChunks[i] = false;
+                break;
+            }
+        }
+    }
+    
+    uint32_t index = fn.closureValue->fn->chunkIndex;
+    if (!pure && !pureChunks[index]) {
+        shared_ptr<TurboChunk> chunk = module_->chunks[index];
+        for (size_t ip = 0; ip < chunk->code.size(); ip++) {
+            if (!writesOutsideFrame(chunk->code[ip].op)) continue;
+            throw runtime_error("TypeError: parallel callback " + chunk->name + " writes outside its frame (" +
+                                turboOpCodeName(chunk->code[ip].op) + " at line " + to_string(chunk->lineAt(ip)) +
+                                "); pass { pure: true } to run it anyway");
+        }
+    }
+    
+    // strings are flattened on first read, which is a write; read the ones
+    // the workers share now
+    for (const Capture& capture : fn.closureValue->captures) {
+        if (capture.value.type == ValueType::STRING) capture.value.stringValue.str();
+    }
+    
+    // too little work to be worth waking the pool for
+    if (count < min_parallel_count) {
+        body(0, count);
+        return true;
+    }
+    
+    WorkStealingPool& pool = WorkStealingPool::getInstance();
+    const vector<bool>* allowed = pure ? nullptr : &pureChunks;
+    
+    pool.run(count, pool.size() * 4, [&](const WorkStealingPool::Next& next) {
+        WorkStealingPool::Range range;
+        if (!next(range)) return;
+        // constructed on this thread, so it is the thread's current VM
+        TurboVM worker(module_, env, allowed);
+        do {
+            body(range.begin, range.end);
+        } while (next(range));
+    });
+    
+    return true;
     
 }
 
-Value TurboVM::callFunction(Value callee, const vector<Value>& args) {
+Value TurboVM::callFunction(const Value& callee, const vector<Value>& args) {
     
     if (callee.type == ValueType::FUNCTION) {
         Value result = callee.functionValue(args);
@@ -1764,27 +2220,7 @@ Value TurboVM::callFunction(Value callee, const vector<Value>& args) {
     }
     
     if (callee.type == ValueType::CLOSURE) {
-
-        shared_ptr<TurboChunk> calleeChunk = module_->chunks[callee.closureValue->fn->chunkIndex];
-        
-        // Build new frame
-        CallFrame new_frame;
-        new_frame.chunk = calleeChunk;
-        new_frame.ip = 0;
-        // allocate locals sized to the chunk's max locals (some chunks use maxLocals)
-        new_frame.locals.resize(calleeChunk->maxLocals, Value::undefined());
-        new_frame.args = args;
-        new_frame.closure = callee.closureValue;
-
-        callStack.push_back(std::move(new_frame));
-
-        Value result = runFrame(callStack.back());
-        
-        callStack.pop_back();
-        frame = &callStack.back();
-        
-        return result;
-        
+        return callClosure(callee.closureValue, args, callee.closureValue->js_object);
     }
 
     if (callee.type == ValueType::NATIVE_FUNCTION) {
@@ -1815,74 +2251,127 @@ Value TurboVM::callFunction(Value callee, const vector<Value>& args) {
         return Value::undefined();
     }
     
-    shared_ptr<TurboChunk> calleeChunk = module_->chunks[fn->chunkIndex];
+    shared_ptr<TurboChunk> calleeChunk = chunkFor(fn->chunkIndex);
 
     // Build new frame
-    CallFrame new_frame;
+    CallFrame& new_frame = pushFrame();
     new_frame.chunk = calleeChunk;
-    new_frame.ip = 0;
     // allocate locals sized to the chunk's max locals (some chunks use maxLocals)
     new_frame.locals.resize(calleeChunk->maxLocals, Value::undefined());
     new_frame.args = args;
     
     new_frame.closure = callee.closureValue; // may be nullptr if callee is plain functionRef
 
-    // save current frame
-    CallFrame prev_frame = callStack.back();
-        
     // copy args into frame.locals[0..]
     uint32_t ncopy = std::min<uint32_t>((uint32_t)args.size(), calleeChunk->maxLocals);
     for (uint32_t i = 0; i < ncopy; ++i) new_frame.locals[i] = args[i];
 
-    // push frame and execute it
-    callStack.push_back(std::move(new_frame));
-
-    Value result = runFrame(callStack.back());
+    // execute it
+    Value result = runFrame(new_frame);
     
+    tryStack.resize(new_frame.tryBase);
     callStack.pop_back();
-    frame = &prev_frame;
+    frame = &callStack.back();
 
     return result;
     
 }
 
-void TurboVM::handleRethrow() {
-    // simplified: pop pending exception and re-run OP_THROW-like unwinding
-//    if (stack.empty()) { /*running = false;*/ return; }
-//    Value pending = pop();
-    // Re-run throw loop: same as OP_THROW handling but without recursion here.
-    bool handled = false;
-    while (!tryStack.empty()) {
-        TryFrame f = tryStack.back();
-        tryStack.pop_back();
-        //while ((int)stack.size() > f.stackDepth) stack.pop_back();
-        
-        if (f.catchIP != -1) {
-            
-            //stack.push_back(pending);
-            
-            TryFrame resume;
-            resume.catchIP = -1;
-            resume.finallyIP = f.finallyIP;
-            // resume.stackDepth = f.stackDepth;
-            tryStack.push_back(resume);
-            
-            frame->ip = f.catchIP;
-            
-            handled = true;
+// Jumps to the innermost catch/finally for exc, looking each frame's ip up
+// in its chunk's handler table and popping the inline frames that have
+// none. Returns false, leaving every frame as it was, when no handler is
+// reachable before a frame that native code entered.
+bool TurboVM::throwToHandler(const Value& exc) {
+    
+    // ip has already stepped past the throwing instruction or the call
+    bool reachable = false;
+    
+    for (auto it = callStack.rbegin(); it != callStack.rend(); ++it) {
+        if (it->chunk->handlerAt(it->ip - 1)) {
+            reachable = true;
             break;
         }
+        if (!it->inlineCall) break;
+    }
+    
+    if (!reachable) return false;
+    
+    while (true) {
+        
+        const HandlerEntry* handler = frame->chunk->handlerAt(frame->ip - 1);
+        
+        if (!handler) {
+            tryStack.resize(frame->tryBase);
+            callStack.pop_back();
+            frame = &callStack.back();
+            continue;
+        }
         
-        if (f.finallyIP != -1) {
-            //stack.push_back(pending);
-            frame->ip = f.finallyIP;
-            handled = true;
-            break;
+        // throws waiting on finally blocks that the handler sits outside of
+        // are dropped
+        while (tryStack.size() > frame->tryBase && tryStack.back().finallyIP > (int)handler->start) {
+            tryStack.pop_back();
+        }
+        
+        if (handler->catchIP != -1) {
+            frame->registers[handler->regCatch] = exc;
+            frame->ip = handler->catchIP;
+            return true;
         }
         
+        // EndFinally throws exc again once the finally has run
+        TryFrame pending;
+        pending.finallyIP = handler->finallyIP;
+        pending.exception = exc;
+        tryStack.push_back(pending);
+        
+        frame->ip = handler->finallyIP;
+        return true;
+        
     }
-    if (!handled) {
-        printf("Uncaught exception after finally, halting VM\n");
-        //running = false;
+    
+}
+
+// native iterators (streams, line readers) are used as they are; arrays and
+// other array-likes are walked by index, reading length once up front.
+void TurboVM::sampleStack() {
+    
+    vector<Profiler::Frame> stack;
+    stack.reserve(callStack.size());
+    
+    for (size_t i = 0; i < callStack.size(); i++) {
+        const CallFrame& f = callStack[i];
+        // callers have already stepped past their Call instruction
+        size_t ip = (i + 1 < callStack.size() && f.ip > 0) ? f.ip - 1 : f.ip;
+        stack.push_back({ f.chunk->name, f.chunk->lineAt(ip) });
     }
+    
+    Profiler::getInstance().record(stack);
+    
+}
+
+Value TurboVM::getIterator(const Value& source) {
+    
+    if (source.type == ValueType::OBJECT && dynamic_pointer_cast<JSIterator>(source.objectValue)) {
+        return source;
+    }
+    
+    Value sized = source;
+    size_t length = getValueLength(sized);
+    
+    if (source.type == ValueType::OBJECT) {
+        Value own_length = source.objectValue->get("length");
+        if (own_length.type == ValueType::NUMBER) {
+            length = (size_t)own_length.numberValue;
+        }
+    }
+    
+    auto iterator = make_shared<JSIterator>([this, source, length, index = (size_t)0](Value& out) mutable -> bool {
+        if (index >= length) return false;
+        out = getProperty(source, to_string(index++));
+        return true;
+    });
+    
+    return Value::object(iterator);
+    
 }
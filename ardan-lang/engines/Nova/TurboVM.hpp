@@ -27,6 +27,7 @@
 #include "Interpreter/Utils/Utils.h"
 #include "builtin/platform/Print/Print.hpp"
 #include "TurboModule.hpp"
+#include "TurboPeephole.hpp"
 
 #include "builtin/builtin-includes.h"
 #include "Interpreter/Promise/Promise.hpp"
@@ -34,6 +35,7 @@
 #include "Interpreter/Env.h"
 
 #include "engines/BaseVM/BaseVM.hpp"
+#include "Profiler/Profiler.hpp"
 
 using namespace std;
 
@@ -47,20 +49,33 @@ class TurboVM : public BaseVM /* <TurboVM, TurboModule, TurboChunk> */ {
     struct CallFrame {
         shared_ptr<TurboChunk> chunk;
         size_t ip = 0;                    
-        deque<Value> locals;        
+        vector<Value> locals;
+        // boxes of the locals that closures capture and then assign; a null
+        // box means the value still sits in locals
+        vector<shared_ptr<Value>> boxes;
         size_t slotsStart = 0;            
         
         vector<Value> args;
         shared_ptr<Closure> closure;
+        // `this`: the receiver of a method call, else the closure's bound object
+        shared_ptr<JSObject> thisObject;
         Value registers[256];
+        
+        // frames pushed by Call and friends run in the caller's runFrame
+        // loop; Return pops them and writes the result to returnReg
+        bool inlineCall = false;
+        // a constructor call, which evaluates to `this`
+        bool construct = false;
+        uint8_t returnReg = 0;
+        // depth of tryStack when the frame was entered
+        size_t tryBase = 0;
     };
     
+    // a throw that landed in a finally block with no catch; EndFinally
+    // throws it again once the block has run
     struct TryFrame {
-        int catchIP;      // -1 if none
-        int finallyIP;    // -1 if none
-        int stackDepth;   // stack size at entry
-        int ipAfterTry;   // where the linear try block ends (for normal flow)
-        uint8_t regCatch;   // register index to store the thrown value
+        int finallyIP;
+        Value exception;
     };
     
 public:
@@ -73,12 +88,27 @@ public:
     
     TurboVM(shared_ptr<TurboModule> module_ = nullptr);
     ~TurboVM();
-    Value callFunction(Value callee, const vector<Value>& args);
+    Value callFunction(const Value& callee, const vector<Value>& args) override;
+    
+    bool beginCallback(const Value& closure) override;
+    Value runCallback(const Value& closure, const Value* argv, size_t argc) override;
+    void endCallback() override;
+    
+    bool parallelFor(const Value& fn, bool pure, size_t count,
+                     const function<void(size_t begin, size_t end)>& body) override;
     
 private:
     shared_ptr<TurboModule> module_ = nullptr; 
     
-    vector<CallFrame> callStack; 
+    // a parallelFor worker: it reads the globals of the VM that started it
+    // and may only enter the chunks marked in pureChunks, if that is set
+    TurboVM(shared_ptr<TurboModule> module_, Env* globals, const vector<bool>* pureChunks);
+    bool ownsEnv = true;
+    const vector<bool>* pureChunks = nullptr;
+    shared_ptr<TurboChunk> chunkFor(uint32_t index);
+    
+    // a deque, so pushing a frame never moves the ones below it
+    deque<CallFrame> callStack; 
     
     vector<Value> popArgs(size_t count);
     shared_ptr<JSObject> createJSObject(shared_ptr<JSClass> klass);
@@ -88,30 +118,40 @@ private:
     void invokeConstructor(Value obj_value, vector<Value> args);
     void invokeMethod(Value obj_value, string name, vector<Value> args);
     Value callMethod(Value callee, vector<Value>& args, Value js_object);
-    
-    Upvalue* openUpvalues = nullptr;
+    Value callClosure(shared_ptr<Closure> closure, const vector<Value>& args, shared_ptr<JSObject> thisObject);
+    void enterFrame(shared_ptr<Closure> closure, vector<Value> args, shared_ptr<JSObject> thisObject, uint8_t returnReg, bool construct = false);
+    CallFrame& pushFrame();
     
     Value runFrame(CallFrame &current_frame);
-    void handleRethrow();
+    bool throwToHandler(const Value& exc);
     bool running = true;
     vector<TryFrame> tryStack;
     deque<Value> argStack;
     
     CallFrame* frame;
     
+    // one per open Callback: the frame it reuses, at this depth of
+    // callStack, and the frame that was running when it was opened
+    struct CallbackFrame {
+        size_t depth;
+        CallFrame* caller;
+    };
+    vector<CallbackFrame> callbackFrames;
+    
     Instruction readInstruction();
     
     void init_builtins();
     void init_host_builtins();
     void init_language_builtins();
     
-    Value getProperty(const Value &objVal, const string &propName);
-    void closeUpvalues(Value* last);
-    shared_ptr<Upvalue> captureUpvalue(Value* local);
+    Value getProperty(const Value &objVal, Atom propName);
+    Value getIterator(const Value& source);
+    void sampleStack();
+    shared_ptr<Value>& localBox(uint32_t idx);
     
     Value CreateInstance(Value klass);
-    void CreateObjectLiteralProperty(Value obj_val, string prop_name, Value object);
-    void InvokeConstructor(Value obj_value, vector<Value> args);
+    void CreateObjectLiteralProperty(Value obj_val, Atom prop_name, Value object);
+    void InvokeConstructor(shared_ptr<JSClass> klass, Value obj_value, vector<Value> args);
     
     // UI
     // void runCreateUIView(Instruction i);
@@ -7,6 +7,7 @@
 
 #include <thread>
 #include "PeregrineVM.hpp"
+#include "Profiler/OpcodeStats.hpp"
 
 //PeregrineVM::PeregrineVM() {
 //    init_builtins();
@@ -16,19 +17,24 @@ PeregrineVM::PeregrineVM(shared_ptr<TurboModule> module_) : module_(module_) {
 
     init_builtins();
     
+    // deferred function bodies are fused when the module compiles them
+    for (auto& chunk : module_->chunks) {
+        if (chunk) fuseSuperinstructions(*chunk);
+    }
+    
 }
 
 PeregrineVM::~PeregrineVM() {
     
-    thread stopper([this]() {
-        sleep(0);
+    // run the event loop until it has no more work. stop() is posted so it
+    // runs inside the loop and cannot be overridden by run() starting.
+    event_loop->post([this](vector<Value> args) -> Value {
         event_loop->stop();
-    });
+        return Value::undefined();
+    }, {});
     
     event_loop->run();
     
-    stopper.join();
-    
     if (env != nullptr) {
         delete env;
     }
@@ -51,7 +57,7 @@ void PeregrineVM::init_builtins() {
 
     env->set_var("Math", make_shared<Math>());
     env->set_var("console", make_shared<Print>());
-    env->set_var("fs", make_shared<File>());
+    env->set_var("fs", make_shared<File>(this));
     env->set_var("Server", make_shared<Server>(event_loop));
     env->set_var("Promise", make_shared<JSPromise>(this));
 
@@ -59,6 +65,14 @@ void PeregrineVM::init_builtins() {
     env->set_var("Number", make_shared<JSNumber>());
     env->set_var("Boolean", make_shared<JSBoolean>());
     env->set_var("Array", make_shared<Array>());
+    env->set_var("Uint8Array", make_shared<TypedArray>(TypedArrayKind::Uint8));
+    env->set_var("Int32Array", make_shared<TypedArray>(TypedArrayKind::Int32));
+    env->set_var("Float64Array", make_shared<TypedArray>(TypedArrayKind::Float64));
+    env->set_var("Buffer", make_shared<Buffer>());
+    env->set_var("SharedArrayBuffer", make_shared<SharedArrayBuffer>());
+    env->set_var("Atomics", make_shared<Atomics>());
+    env->set_var("JSON", make_shared<JSON>());
+    env->set_var("Worker", make_shared<Worker>());
 
     env->set_var("print", Value::function([this](vector<Value> args) mutable -> Value {
         Print::print(args);
@@ -74,7 +88,7 @@ void PeregrineVM::init_builtins() {
 
 }
 
-Value PeregrineVM::getVariable(const string& key) const {
+Value PeregrineVM::getVariable(Atom key) const {
     R value = (executionCtx->lexicalEnv->getValueWithoutThrow(key));
     
     if (std::holds_alternative<std::nullptr_t>(value)) {
@@ -89,7 +103,7 @@ Value PeregrineVM::getVariable(const string& key) const {
     
 }
 
-void PeregrineVM::putVariable(const string& key, const Value& v) const {
+void PeregrineVM::putVariable(Atom key, const Value& v) const {
     
     Env* target = executionCtx->lexicalEnv->resolveBinding(key, executionCtx->lexicalEnv.get());
     if (target) {
@@ -146,7 +160,7 @@ Value PeregrineVM::CreateInstance(Value klass) {
 
 }
 
-Value PeregrineVM::getProperty(const Value &objVal, const string &propName) {
+Value PeregrineVM::getProperty(const Value &objVal, Atom propName) {
     
     if (objVal.type == ValueType::OBJECT) {
         // perform privacy check
@@ -156,12 +170,12 @@ Value PeregrineVM::getProperty(const Value &objVal, const string &propName) {
         // if its private, check if the js_object in closure is not nullptr
         // if closure.js_object is not nullptr
         
-        vector<string> modifiers = objVal.objectValue->get_modifiers(propName);
+        const vector<string>& modifiers = objVal.objectValue->get_modifiers(propName);
         
         bool isPrivate = false;
         bool isProtected = false;
         
-        for (auto modifier : modifiers) {
+        for (const auto& modifier : modifiers) {
             if (modifier == "private") {
                 isPrivate = true;
                 continue;
@@ -217,11 +231,11 @@ Value PeregrineVM::getProperty(const Value &objVal, const string &propName) {
         // get the prop modifiers.
         // if its private, check if the js_object in closure is not nullptr
         
-        vector<string> modifiers = objVal.classValue->get_static_modifiers(propName);
+        const vector<string>& modifiers = objVal.classValue->get_static_modifiers(propName);
         bool isPrivate = false;
         bool isProtected = false;
 
-        for (auto modifier : modifiers) {
+        for (const auto& modifier : modifiers) {
             
             if (modifier == "private") {
                 isPrivate = true;
@@ -329,7 +343,7 @@ shared_ptr<JSObject> PeregrineVM::createJSObject(shared_ptr<JSClass> klass) {
 
 }
 
-void PeregrineVM::CreateObjectLiteralProperty(const Value& obj_val, const string& prop_name, const Value& object) {
+void PeregrineVM::CreateObjectLiteralProperty(const Value& obj_val, Atom prop_name, const Value& object) {
     if (obj_val.type == ValueType::CLOSURE) {
         
         shared_ptr<Closure> new_closure = make_shared<Closure>();
@@ -469,11 +483,13 @@ Value PeregrineVM::run(shared_ptr<TurboChunk> chunk_, const vector<Value>& args)
     new_frame.ip = 0;
     new_frame.args = args;
     new_frame.closure = closure;
+    // top-level await suspends the script body like an async function
+    new_frame.async = true;
+    new_frame.tryBase = tryStack.size();
+    new_frame.contextBase = contextStack.size();
         
     callStack.push_back(std::move(new_frame));
-    Value result = runFrame(callStack.back());
-    callStack.pop_back();
-    return result;
+    return runAsyncFrame();
     
 }
 
@@ -484,8 +500,14 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
     frame = &current_frame;
 
     while (true) {
+        if (Profiler::sample_pending) sampleStack();
+        
         Instruction instruction = readInstruction();
         TurboOpCode op = instruction.op;
+        
+#ifdef ARDAN_OPCODE_STATS
+        OpcodeStats::peregrine().dispatch((uint8_t)op);
+#endif
 
         switch (op) {
             case TurboOpCode::Nop:
@@ -510,8 +532,7 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
                 uint8_t constant_index = instruction.a;
                 uint8_t data_reg = instruction.b;
                 
-                Value name_val = frame->chunk->constants[constant_index];
-                string name = name_val.stringValue;
+                Atom name = frame->chunk->atomAt(constant_index);
                 
                 executionCtx->variableEnv->set_var(name,
                                                          frame->registers[data_reg]);
@@ -523,8 +544,7 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
                 uint8_t constant_index = instruction.a;
                 uint8_t data_reg = instruction.b;
                 
-                Value name_val = frame->chunk->constants[constant_index];
-                string name = name_val.stringValue;
+                Atom name = frame->chunk->atomAt(constant_index);
                 
                 executionCtx
                     ->lexicalEnv->set_let(name, frame->registers[data_reg]);
@@ -536,8 +556,7 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
                 uint8_t constant_index = instruction.a;
                 uint8_t data_reg = instruction.b;
                 
-                Value name_val = frame->chunk->constants[constant_index];
-                string name = name_val.stringValue;
+                Atom name = frame->chunk->atomAt(constant_index);
                 
                 executionCtx->lexicalEnv->set_const(name,
                                                frame->registers[data_reg]);
@@ -836,12 +855,58 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
 
                 break;
             }
+
+                // StringConcat, destReg, count; the part registers follow
+                // in Nop instructions, three per instruction
+            case TurboOpCode::StringConcat: {
+                size_t count = instruction.b;
+                vector<RopeString> parts;
+                parts.reserve(count);
+                
+                for (size_t i = 0; i < count; i++) {
+                    const Instruction& holder = frame->chunk->code[frame->ip + i / 3];
+                    uint8_t reg = i % 3 == 0 ? holder.a : (i % 3 == 1 ? holder.b : holder.c);
+                    parts.push_back(stringOf(frame->registers[reg]));
+                }
+                
+                frame->ip += (count + 2) / 3;
+                frame->registers[instruction.a] = Value::rope(RopeString::concat(parts));
+                break;
+            }
+                
+                // superinstructions, see TurboPeephole.hpp. ip already points
+                // at the second instruction of the sequence.
+            case TurboOpCode::LessThanJumpIfFalse:
+            case TurboOpCode::LessThanOrEqualJumpIfFalse:
+            case TurboOpCode::GreaterThanJumpIfFalse:
+            case TurboOpCode::GreaterThanOrEqualJumpIfFalse: {
+                double lhs = frame->registers[instruction.b].numberValue;
+                double rhs = frame->registers[instruction.c].numberValue;
+                bool result;
+                switch (op) {
+                    case TurboOpCode::LessThanJumpIfFalse: result = lhs < rhs; break;
+                    case TurboOpCode::LessThanOrEqualJumpIfFalse: result = lhs <= rhs; break;
+                    case TurboOpCode::GreaterThanJumpIfFalse: result = lhs > rhs; break;
+                    default: result = lhs >= rhs; break;
+                }
+                const Instruction& jump = frame->chunk->code[frame->ip++];
+                if (!result) frame->ip += jump.b;
+                break;
+            }
+                
+            case TurboOpCode::AddConst: {
+                const Instruction& add = frame->chunk->code[frame->ip++];
+                storeAdd(frame->registers[add.a],
+                         frame->registers[add.b],
+                         frame->chunk->constants[instruction.b]);
+                break;
+            }
                 
             case TurboOpCode::LoadGlobalVar: {
                 
                 int reg = instruction.a;
                 int idx = instruction.b;
-                string name = frame->chunk->constants[idx].stringValue;
+                Atom name = frame->chunk->atomAt(idx);
                 
                 frame->registers[reg] = getVariable(name); //toValue(executionCtx->variableEnv->get(name)/*env->get(name)*/);
 
@@ -852,8 +917,7 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
                 
                 uint8_t idx = instruction.a;
                 uint8_t reg_slot = instruction.b;
-                Value val = frame->chunk->constants[idx];
-                string name = val.stringValue;
+                Atom name = frame->chunk->atomAt(idx);
                 
                 // env->set_var(name, frame->registers[reg_slot]);
                 putVariable(name, frame->registers[reg_slot]);
@@ -865,8 +929,7 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
                 
                 uint8_t idx = instruction.a;
                 uint8_t reg_slot = instruction.b;
-                Value val = frame->chunk->constants[idx];
-                string name = val.stringValue;
+                Atom name = frame->chunk->atomAt(idx);
 
                 // env->set_let(name, frame->registers[reg_slot]);
                 putVariable(name, frame->registers[reg_slot]);
@@ -894,9 +957,8 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
                 Value spreadArray = frame->registers[instruction.b];
                 Value array = frame->registers[instruction.a];
                 
-                for( auto index : spreadArray.arrayValue->get_indexed_properties()) {
-                    array.arrayValue->push({ index.second });
-                }
+                const vector<Value>& items = spreadArray.arrayValue->elements;
+                array.arrayValue->elements.insert(array.arrayValue->elements.end(), items.begin(), items.end());
                 
                 frame->registers[instruction.a] = array;
 
@@ -1172,8 +1234,7 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
             case TurboOpCode::CreateObjectLiteralProperty: {
                 
                 auto object = frame->registers[instruction.a];
-                Value val = frame->chunk->constants[instruction.b];
-                string prop_name = val.toString();
+                Atom prop_name = frame->chunk->atomAt(instruction.b);
                 Value obj_val = frame->registers[instruction.c];
 
                 CreateObjectLiteralProperty(obj_val, prop_name, object);
@@ -1192,8 +1253,7 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
             case TurboOpCode::LoadThisProperty: {
                 
                 // load constant from nameIdx
-                Value property_value = frame->chunk->constants[instruction.b];
-                string property_name = property_value.toString();
+                Atom property_name = frame->chunk->atomAt(instruction.b);
                                 
                 Value obj = getProperty(Value::object(frame->closure->js_object), property_name);
                 
@@ -1206,8 +1266,7 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
             case TurboOpCode::StoreThisProperty: {
                 
                 // load constant from nameIdx
-                Value property_value = frame->chunk->constants[instruction.a];
-                string property_name = property_value.toString();
+                Atom property_name = frame->chunk->atomAt(instruction.a);
                 
                 Value value = frame->registers[instruction.b];
                 
@@ -1249,8 +1308,7 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
                 // SetProperty: objReg, nameIdx, valueReg
             case TurboOpCode::SetProperty: {
                 auto object = frame->registers[instruction.a];
-                Value val = frame->chunk->constants[instruction.b];
-                string prop_name = val.toString();//stringValue;
+                Atom prop_name = frame->chunk->atomAt(instruction.b);
                 Value obj_val = frame->registers[instruction.c];
                 
                 setProperty(object, prop_name, obj_val);
@@ -1283,7 +1341,7 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
                 // TurboOpCode::GetProperty, lhsReg, objReg, nameIdx
             case TurboOpCode::GetProperty: {
                 Value object = frame->registers[instruction.b];
-                string prop = frame->chunk->constants[instruction.c].stringValue;
+                Atom prop = frame->chunk->atomAt(instruction.c);
                 Value val = getProperty(object, prop);
                 frame->registers[instruction.a] = val;
                 break;
@@ -1296,6 +1354,79 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
                 break;
             }
                 
+                // GetIndex, lhsReg, objReg, keyReg
+            case TurboOpCode::GetIndex: {
+                const Value& object = frame->registers[instruction.b];
+                const Value& key = frame->registers[instruction.c];
+                
+                if (key.type == ValueType::NUMBER &&
+                    object.type == ValueType::OBJECT &&
+                    object.objectValue->is_typed_array) {
+                    auto* typed = static_cast<JSTypedArray*>(object.objectValue.get());
+                    double index = key.numberValue;
+                    size_t i = (size_t)index;
+                    frame->registers[instruction.a] = (index >= 0 && i < typed->length && (double)i == index)
+                        ? Value::number(typed->load(i))
+                        : Value::undefined();
+                    break;
+                }
+                
+                if (key.type == ValueType::NUMBER && object.type == ValueType::ARRAY) {
+                    double index = key.numberValue;
+                    size_t i = (size_t)index;
+                    if (index >= 0 && (double)i == index) {
+                        frame->registers[instruction.a] = object.arrayValue->getIndex(i);
+                        break;
+                    }
+                }
+                
+                frame->registers[instruction.a] = getProperty(object, key.toString());
+                break;
+            }
+                
+                // SetIndex, objReg, keyReg, valueReg
+            case TurboOpCode::SetIndex: {
+                Value object = frame->registers[instruction.a];
+                const Value& key = frame->registers[instruction.b];
+                
+                if (key.type == ValueType::NUMBER &&
+                    object.type == ValueType::OBJECT &&
+                    object.objectValue->is_typed_array) {
+                    auto* typed = static_cast<JSTypedArray*>(object.objectValue.get());
+                    double index = key.numberValue;
+                    size_t i = (size_t)index;
+                    if (index >= 0 && i < typed->length && (double)i == index) {
+                        typed->store(i, frame->registers[instruction.c].numberValue);
+                    }
+                } else if (key.type == ValueType::NUMBER &&
+                           object.type == ValueType::ARRAY &&
+                           key.numberValue >= 0 &&
+                           (double)(size_t)key.numberValue == key.numberValue) {
+                    object.arrayValue->setIndex((size_t)key.numberValue, frame->registers[instruction.c]);
+                } else {
+                    setProperty(object, key.toString(), frame->registers[instruction.c]);
+                }
+                
+                frame->registers[instruction.c] = object;
+                break;
+            }
+                
+                // GetIterator, iterReg, srcReg
+            case TurboOpCode::GetIterator: {
+                frame->registers[instruction.a] = getIterator(frame->registers[instruction.b]);
+                break;
+            }
+                
+                // IteratorNext, valueReg, iterReg, hasValueReg
+            case TurboOpCode::IteratorNext: {
+                auto iterator = static_pointer_cast<JSIterator>(frame->registers[instruction.b].objectValue);
+                Value value = Value::undefined();
+                bool has_value = iterator->next(value);
+                frame->registers[instruction.a] = value;
+                frame->registers[instruction.c] = Value::boolean(has_value);
+                break;
+            }
+                
                 // keysReg, objReg
             case TurboOpCode::EnumKeys: {
                 // object is in stack.
@@ -1339,75 +1470,15 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
                 break;
             }
                 
-            case TurboOpCode::Try: {
-                uint32_t catchOffset = instruction.a;
-                uint32_t finallyOffset = instruction.b;
-                // compute absolute IPs
-                int base = (int)frame->ip; // ip now points after the offsets
-                TryFrame f;
-                f.catchIP = (catchOffset == 0) ? -1 : (base + (int)catchOffset);
-                f.finallyIP = (finallyOffset == 0) ? -1 : (base + (int)finallyOffset);
-                // ipAfterTry can be filled later by codegen if you want; keep -1 if unused
-                f.ipAfterTry = -1;
-                f.regCatch = instruction.c;
-                tryStack.push_back(f);
-                break;
-            }
-
-            case TurboOpCode::EndTry: {
-                if (tryStack.empty()) {
-                    // runtime error: unmatched EndTry
-                    break;
-                }
-                tryStack.pop_back();
-                break;
-            }
-                
             case TurboOpCode::Throw: {
                 // exception value on top of stack
                 Value exc = frame->registers[instruction.a].toString();
-                // unwind frames until we find a handler (catch or finally)
-                bool handled = false;
-                // Store a 'pending exception' to know we are unwinding due to throw
-                Value pending = exc;
                 
-                while (!tryStack.empty()) {
-                    TryFrame f = tryStack.back();
-                    tryStack.pop_back();
-                                        
-                    // If there is a finally, run it first.
-                    if (f.catchIP != -1) {
-                        
-                        // Record a special marker frame to indicate we are resuming a throw after finally
-                        // We'll push a synthetic TryFrame with catchIP = original catchIP, finallyIP = -1
-                        TryFrame resume;
-                        resume.catchIP = -1;
-                        resume.finallyIP = f.finallyIP;
-                        resume.ipAfterTry = -1;
-                        
-                        frame->registers[f.regCatch] = exc;
-                        
-                        tryStack.push_back(resume);
-                        
-                        // jump into finalizer
-                        frame->ip = f.catchIP;
-                        
-                        handled = true; // we will handle after finalizer/resume
-                        break;
-                    }
-                    
-                    // If no finally, but there is a catch, jump to catch and push exception
-                    if (f.finallyIP != -1) {
-                        // stack.push_back(pending);
-                        frame->ip = f.finallyIP;
-                        handled = true;
-                        break;
+                if (!throwToHandler(exc)) {
+                    // an async function rejects its promise instead
+                    if (frame->promise) {
+                        throw runtime_error(exc.toString());
                     }
-                    
-                    // else continue unwinding to outer try frame
-                }
-                
-                if (!handled) {
                     // uncaught
                     // Here: runtime uncaught exception -> abort or print error
                     printf("Uncaught exception, halting VM\n");
@@ -1415,38 +1486,21 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
                 break;
             }
                 
+                // TurboOpCode::EndFinally, distance back to the start of the finally block
             case TurboOpCode::EndFinally: {
-                // When a finally finishes, we must check whether we have a resume frame that carries a pending throw
-                // Approach: if there is a TryFrame on tryStack whose catchIP != -1 and which we pushed as resume frame,
-                // then either jump into catch or rethrow.
-                if (!tryStack.empty()) {
-                    TryFrame resume = tryStack.back();
-                    // If resume.finallyIP == -1, we treat this as the resume frame we pushed earlier
-                    if (resume.finallyIP == -1) {
-                        tryStack.pop_back();
-                        if (resume.finallyIP != -1) {
-                            // pending exception should be on stack top
-                            // jump into catch with exception on stack
-                            frame->ip = resume.finallyIP;
-                            break;
-                        } else {
-                            // no catch for the pending exception, continue unwinding:
-                            // emulate throwing again: pop pending exception and re-run Throw logic
-                            // Value pending = pop();
-                            // continue throw loop by re-inserting pending on stack and handling next frame
-                            // simplest approach: directly re-run THROW handling by pushing pending and continuing
-                            // For clarity, we will set a special behaviour: re-insert pending and emulate OP_THROW
-                            // stack.push_back(pending);
-                            // simulate Throw logic by jumping back one step: decrement ip so we re-execute OP_THROW
-                            // But cleaner: call a helper to handle rethrow. For brevity we perform a manual loop here.
-                            // (In production you would share the throw-handling code.)
-                            // For now: we'll call a helper:
-                            handleRethrow();
-                            break;
+                int finallyIP = (int)frame->ip - 1 - instruction.a;
+                
+                // a throw that ran this finally goes on to the next handler
+                if (tryStack.size() > frame->tryBase && tryStack.back().finallyIP == finallyIP) {
+                    TryFrame f = tryStack.back();
+                    tryStack.pop_back();
+                    if (!throwToHandler(f.exception)) {
+                        if (frame->promise) {
+                            throw runtime_error(f.exception.toString());
                         }
+                        printf("Uncaught exception after finally, halting VM\n");
                     }
                 }
-                // Normal end finally with no pending throw resume -> continue execution
                 break;
             }
                 
@@ -1474,8 +1528,8 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
                 int argReg = instruction.a;
                 Value array = frame->registers[argReg];
                 
-                for (auto index : array.arrayValue->get_indexed_properties()) {
-                    argStack.push_back(index.second);
+                for (const Value& item : array.arrayValue->elements) {
+                    argStack.push_back(item);
                 }
                 
                 break;
@@ -1517,7 +1571,7 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
 
                 if (inputArr && start < (int)inputArr->length()) {
                     for (int i = start; i < (int)inputArr->length(); ++i) {
-                        arr->push({ inputArr->get(to_string(i)) });
+                        arr->elements.push_back(inputArr->elements[i]);
                     }
                 }
                 
@@ -1568,12 +1622,49 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
                 
                 Value func = frame->registers[funcReg];
                 
-                const vector<Value> const_args = { argStack.begin(), argStack.end() };
+                vector<Value> args = { argStack.begin(), argStack.end() };
                 argStack.clear();
 
-                Value result = callFunction(func, const_args);
+                // async closures keep their own runFrame so Await can park them
+                if (func.type == ValueType::CLOSURE && !func.closureValue->fn->isAsync) {
+                    enterFrame(func, std::move(args), resultReg);
+                    break;
+                }
+                
+                Value result = callFunction(func, args);
                 frame->registers[resultReg] = result;
 
+                break;
+            }
+                
+                // TurboOpCode::TailCall, resultReg, funcReg, argc; always followed by Return resultReg
+            case TurboOpCode::TailCall: {
+                
+                Value func = frame->registers[instruction.b];
+                
+                vector<Value> args = { argStack.begin(), argStack.end() };
+                argStack.clear();
+
+                // async callers and callees keep their promises: those, and
+                // anything but a closure, are called as usual and the Return
+                // after this instruction hands on the result
+                if (func.type != ValueType::CLOSURE || func.closureValue->fn->isAsync || frame->async) {
+                    frame->registers[instruction.a] = callFunction(func, args);
+                    break;
+                }
+                
+                // the callee takes over this frame, with a context of its own
+                tryStack.resize(frame->tryBase);
+                dropContexts(frame->contextBase);
+                
+                frame->chunk = module_->chunk(func.closureValue->fn->chunkIndex);
+                frame->ip = 0;
+                frame->args = std::move(args);
+                frame->closure = func.closureValue;
+                
+                contextStack.push_back(createNewExecutionContext(func));
+                executionCtx = contextStack.back();
+                
                 break;
             }
                 
@@ -1596,8 +1687,17 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
             case TurboOpCode::Return: {
 
                 Value v = frame->registers[instruction.a];
-                                
-                return v;
+                
+                if (!frame->inlineCall) {
+                    return v;
+                }
+                
+                // back to the caller in this same loop
+                uint8_t returnReg = frame->returnReg;
+                leaveFrame();
+                frame->registers[returnReg] = v;
+                
+                break;
             }
 
             case TurboOpCode::Halt:
@@ -1605,9 +1705,9 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
                 break;
                 
             case TurboOpCode::CopyIterationBinding: {
-                Value name_value = frame->chunk->constants[instruction.a];
-                R prev = executionCtx->lexicalEnv->getParentValue(name_value.toString());
-                executionCtx->lexicalEnv->set_let(name_value.toString(), toValue(prev));
+                Atom name = frame->chunk->atomAt(instruction.a);
+                R prev = executionCtx->lexicalEnv->getParentValue(name);
+                executionCtx->lexicalEnv->set_let(name, toValue(prev));
                 break;
             }
                 
@@ -1627,7 +1727,7 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
                 
             case TurboOpCode::PopLexicalEnv: {
                 
-                contextStack.pop_back();
+                dropContexts(contextStack.size() - 1);
                 executionCtx = contextStack.back();
                 break;
             }
@@ -1648,48 +1748,26 @@ Value PeregrineVM::runFrame(CallFrame &current_frame) {
                 
             }
                 
+                // Await, promise_reg, result_reg
             case TurboOpCode::Await: {
-                //                auto& promise = registers[instr.a];
-                //                auto* currentTask = this->currentCoroutine();
-                //
-                //                // Suspend coroutine
-                //                currentTask->suspend();
-                //
-                //                // Register resume callback when promise resolves
-                //                promise->then(
-                //                    [currentTask](Value result) {
-                //                        currentTask->resumeWith(result);
-                //                    },
-                //                    [currentTask](Value error) {
-                //                        currentTask->resumeWithException(error);
-                //                    });
-                
-                Value result = frame->registers[instruction.a];
-                auto index = frame->closure->fn->chunkIndex;
-                auto this_frame = frame;
-                auto i = instruction;
-                auto executionContext = executionCtx;
-                
-                if (result.type != ValueType::PROMISE) {
-                    auto promise = make_shared<Promise>(this);
-                    promise->resolve(result);
-                    result = Value::promise(promise);
+                
+                if (!frame->async) {
+                    throw runtime_error("await is only valid in async functions and the top level");
                 }
                 
-                auto value = result.promiseValue->then([this, this_frame, index, i, executionContext](vector<Value> args)->Value {
-                    
-                    shared_ptr<TurboChunk> calleeChunk = module_->chunks[index];
-                    
-                    callStack.push_back(*this_frame);
-                    callStack.back().registers[i.b] = args[0];
-                    Value result = runFrameContext(callStack.back(), executionContext);
-                    
-                    return result;
-                    
-                });
+                Value awaited = frame->registers[instruction.a];
+                shared_ptr<Promise> promise = Promise::from(awaited);
                 
+                if (!promise) {
+                    promise = make_shared<Promise>(this);
+                    promise->resolve(awaited);
+                }
+                
+                // hand control back to runAsyncFrame, which parks the frame
+                frame->awaiting = promise;
+                frame->resumeReg = instruction.b;
                 
-                return Value();
+                return Value::undefined();
                 
             }
                 
@@ -1739,38 +1817,40 @@ Value PeregrineVM::callFunction(const Value& callee, const vector<Value>& args)
     
     if (callee.type == ValueType::CLOSURE) {
 
-        shared_ptr<TurboChunk> calleeChunk = module_->chunks[callee.closureValue->fn->chunkIndex];
+        shared_ptr<TurboChunk> calleeChunk = module_->chunk(callee.closureValue->fn->chunkIndex);
         
-        CallFrame new_frame;
+        CallFrame& new_frame = pushFrame();
         new_frame.chunk = calleeChunk;
-        new_frame.ip = 0;
         new_frame.args = args;
         new_frame.closure = callee.closureValue;
 
-        callStack.push_back(std::move(new_frame));
+        if (callee.closureValue->fn->isAsync) {
+            new_frame.async = true;
+            new_frame.promise = make_shared<Promise>(this);
+        }
 
         ExecutionContext* funcCtx = createNewExecutionContext(callee);
         
         contextStack.push_back(funcCtx);
         executionCtx = contextStack.back();
 
-        Value result = runFrame(callStack.back());
-        
-        callStack.pop_back();
-        if (callStack.size() > 0) {
-            frame = &callStack.back();
+        if (callee.closureValue->fn->isAsync) {
+            return runAsyncFrame();
         }
-        
-        contextStack.pop_back();
-        executionCtx = contextStack.back();
-        
-        if (callee.closureValue->fn->isAsync && result.type != ValueType::PROMISE) {
-            auto promise = make_shared<Promise>(this);
-            promise->resolve(result);
-            return Value::promise(promise);
 
+        size_t depth = callStack.size();
+        Value result;
+        
+        try {
+            result = runFrame(new_frame);
+        } catch (...) {
+            // drop the frames the error unwound through, inline ones included
+            while (callStack.size() >= depth) leaveFrame();
+            throw;
         }
         
+        leaveFrame();
+        
         return result;
         
     }
@@ -1803,59 +1883,293 @@ Value PeregrineVM::callFunction(const Value& callee, const vector<Value>& args)
         return Value::undefined();
     }
     
-    shared_ptr<TurboChunk> calleeChunk = module_->chunks[fn->chunkIndex];
+    shared_ptr<TurboChunk> calleeChunk = module_->chunk(fn->chunkIndex);
 
-    CallFrame new_frame;
+    CallFrame& new_frame = pushFrame();
     new_frame.chunk = calleeChunk;
-    new_frame.ip = 0;
     new_frame.args = args;
     
     new_frame.closure = callee.closureValue;
 
-    // save current frame
-    CallFrame prev_frame = callStack.back();
-        
-    // push frame and execute it
-    callStack.push_back(std::move(new_frame));
-
-    Value result = runFrame(callStack.back());
+    Value result = runFrame(new_frame);
     
-    callStack.pop_back();
-    frame = &prev_frame;
+    leaveFrame();
 
     return result;
     
 }
 
-void PeregrineVM::handleRethrow() {
-    // simplified: pop pending exception and re-run OP_THROW-like unwinding
-    // Re-run throw loop: same as OP_THROW handling but without recursion here.
-    bool handled = false;
-    while (!tryStack.empty()) {
-        TryFrame f = tryStack.back();
-        tryStack.pop_back();
-        
-        if (f.catchIP != -1) {
-                        
-            TryFrame resume;
-            resume.catchIP = -1;
-            resume.finallyIP = f.finallyIP;
-            tryStack.push_back(resume);
-            
-            frame->ip = f.catchIP;
-            
-            handled = true;
+// jumps to the innermost catch/finally for exc, looking each frame's ip up
+// in its chunk's handler table and popping the inline frames that have
+// none. returns false, leaving every frame as it was, when no handler is
+// reachable before a frame that native code entered.
+bool PeregrineVM::throwToHandler(const Value& exc) {
+    
+    // ip has already stepped past the throwing instruction or the call
+    bool reachable = false;
+    
+    for (auto it = callStack.rbegin(); it != callStack.rend(); ++it) {
+        if (it->chunk->handlerAt(it->ip - 1)) {
+            reachable = true;
             break;
         }
+        if (!it->inlineCall) break;
+    }
+    
+    if (!reachable) return false;
+    
+    while (true) {
         
-        if (f.finallyIP != -1) {
-            frame->ip = f.finallyIP;
-            handled = true;
-            break;
+        const HandlerEntry* handler = frame->chunk->handlerAt(frame->ip - 1);
+        
+        if (!handler) {
+            leaveFrame();
+            continue;
+        }
+        
+        // throws waiting on finally blocks that the handler sits outside of
+        // are dropped
+        while (tryStack.size() > frame->tryBase && tryStack.back().finallyIP > (int)handler->start) {
+            tryStack.pop_back();
+        }
+        
+        if (handler->catchIP != -1) {
+            frame->registers[handler->regCatch] = exc;
+            frame->ip = handler->catchIP;
+            return true;
+        }
+        
+        // EndFinally throws exc again once the finally has run
+        TryFrame pending;
+        pending.finallyIP = handler->finallyIP;
+        pending.exception = exc;
+        tryStack.push_back(pending);
+        
+        frame->ip = handler->finallyIP;
+        return true;
+        
+    }
+    
+}
+
+// an empty frame on top of callStack. past call_stack_limit frames this
+// throws instead; enterFrame turns that into a catchable RangeError.
+PeregrineVM::CallFrame& PeregrineVM::pushFrame() {
+    
+    if (callStack.size() >= call_stack_limit) {
+        throw runtime_error("RangeError: Maximum call stack size exceeded");
+    }
+    
+    callStack.emplace_back();
+    CallFrame& callee = callStack.back();
+    callee.tryBase = tryStack.size();
+    callee.contextBase = contextStack.size();
+    
+    return callee;
+    
+}
+
+// starts a synchronous closure from inside runFrame: it becomes the current
+// frame, with its own execution context, and the loop carries on with its
+// first instruction until its Return comes back to the caller.
+void PeregrineVM::enterFrame(const Value& callee, vector<Value> args, uint8_t returnReg) {
+    
+    if (callStack.size() >= call_stack_limit) {
+        Value error = Value::str("RangeError: Maximum call stack size exceeded");
+        if (!throwToHandler(error)) {
+            throw runtime_error(error.toString());
+        }
+        return;
+    }
+    
+    shared_ptr<TurboChunk> calleeChunk = module_->chunk(callee.closureValue->fn->chunkIndex);
+    
+    CallFrame& next = pushFrame();
+    next.chunk = calleeChunk;
+    next.args = std::move(args);
+    next.closure = callee.closureValue;
+    next.inlineCall = true;
+    next.returnReg = returnReg;
+    
+    contextStack.push_back(createNewExecutionContext(callee));
+    executionCtx = contextStack.back();
+    
+    frame = &next;
+    
+}
+
+// frees the contexts a synchronous frame pushed above base. closures keep
+// copies of the ones they capture, so nothing else points at them.
+void PeregrineVM::dropContexts(size_t base) {
+    
+    for (size_t i = base; i < contextStack.size(); i++) {
+        delete contextStack[i];
+    }
+    contextStack.resize(base);
+    
+}
+
+// pops the top frame along with the try frames and contexts it pushed
+void PeregrineVM::leaveFrame() {
+    
+    CallFrame& top = callStack.back();
+    tryStack.resize(top.tryBase);
+    dropContexts(top.contextBase);
+    callStack.pop_back();
+    
+    frame = callStack.empty() ? nullptr : &callStack.back();
+    executionCtx = contextStack.empty() ? nullptr : contextStack.back();
+    
+}
+
+// runs the async frame on top of callStack until it returns or suspends on
+// Await. either way the frame, its contexts and its try frames are popped
+// before returning, so the caller continues as if the call had completed.
+Value PeregrineVM::runAsyncFrame() {
+    
+    shared_ptr<Promise> promise = callStack.back().promise;
+    size_t tryBase = callStack.back().tryBase;
+    size_t contextBase = callStack.back().contextBase;
+    size_t depth = callStack.size();
+    Value result = Value::undefined();
+    
+    try {
+        result = runFrame(callStack.back());
+        
+        CallFrame& current = callStack.back();
+        
+        if (current.awaiting) {
+            suspend(current);
+        } else if (promise) {
+            promise->resolve(result);
         }
+    } catch (const std::exception& e) {
+        // inline frames the error unwound through
+        callStack.resize(depth);
+        if (!promise) {
+            callStack.pop_back();
+            tryStack.resize(tryBase);
+            contextStack.resize(contextBase);
+            frame = callStack.empty() ? nullptr : &callStack.back();
+            executionCtx = contextStack.back();
+            throw;
+        }
+        promise->reject(Value::str(e.what()));
+    }
+    
+    callStack.pop_back();
+    tryStack.resize(tryBase);
+    contextStack.resize(contextBase);
+    
+    frame = callStack.empty() ? nullptr : &callStack.back();
+    executionCtx = contextStack.back();
+    
+    return promise ? Value::promise(promise) : result;
+    
+}
+
+// moves a frame that hit Await off the VM stacks into a coroutine and
+// resumes it from a microtask once the awaited promise settles.
+void PeregrineVM::suspend(CallFrame& suspended) {
+    
+    auto co = make_shared<Coroutine>();
+    
+    co->contexts.assign(contextStack.begin() + suspended.contextBase, contextStack.end());
+    co->tryFrames.assign(tryStack.begin() + suspended.tryBase, tryStack.end());
+    
+    shared_ptr<Promise> awaiting = suspended.awaiting;
+    suspended.awaiting = nullptr;
+    co->frame = std::move(suspended);
+    
+    awaiting->then([this, co](vector<Value> args) -> Value {
+        resumeCoroutine(co, args.empty() ? Value::undefined() : args[0], false);
+        return Value::undefined();
+    }, [this, co](vector<Value> args) -> Value {
+        resumeCoroutine(co, args.empty() ? Value::undefined() : args[0], true);
+        return Value::undefined();
+    });
+    
+}
+
+void PeregrineVM::resumeCoroutine(shared_ptr<Coroutine> co, const Value& result, bool rejected) {
+    
+    CallFrame resumed = std::move(co->frame);
+    resumed.tryBase = tryStack.size();
+    resumed.contextBase = contextStack.size();
+    
+    contextStack.insert(contextStack.end(), co->contexts.begin(), co->contexts.end());
+    tryStack.insert(tryStack.end(), co->tryFrames.begin(), co->tryFrames.end());
+    executionCtx = contextStack.back();
+    
+    callStack.push_back(std::move(resumed));
+    frame = &callStack.back();
+    
+    if (!rejected) {
+        frame->registers[frame->resumeReg] = result;
+    } else if (!throwToHandler(result)) {
+        // no try/catch around the await: the async function rejects
+        shared_ptr<Promise> promise = frame->promise;
+        size_t tryBase = frame->tryBase;
+        size_t contextBase = frame->contextBase;
         
+        callStack.pop_back();
+        tryStack.resize(tryBase);
+        contextStack.resize(contextBase);
+        frame = callStack.empty() ? nullptr : &callStack.back();
+        executionCtx = contextStack.back();
+        
+        if (promise) {
+            promise->reject(result);
+        } else {
+            printf("Uncaught (in promise) %s\n", result.toString().c_str());
+        }
+        return;
+    }
+    
+    runAsyncFrame();
+    
+}
+
+// native iterators (streams, line readers) are used as they are; arrays and
+// other array-likes are walked by index, reading length once up front.
+void PeregrineVM::sampleStack() {
+    
+    vector<Profiler::Frame> stack;
+    stack.reserve(callStack.size());
+    
+    for (size_t i = 0; i < callStack.size(); i++) {
+        const CallFrame& f = callStack[i];
+        // callers have already stepped past their Call instruction
+        size_t ip = (i + 1 < callStack.size() && f.ip > 0) ? f.ip - 1 : f.ip;
+        stack.push_back({ f.chunk->name, f.chunk->lineAt(ip) });
+    }
+    
+    Profiler::getInstance().record(stack);
+    
+}
+
+Value PeregrineVM::getIterator(const Value& source) {
+    
+    if (source.type == ValueType::OBJECT && dynamic_pointer_cast<JSIterator>(source.objectValue)) {
+        return source;
     }
-    if (!handled) {
-        printf("Uncaught exception after finally, halting VM\n");
+    
+    Value sized = source;
+    size_t length = getValueLength(sized);
+    
+    if (source.type == ValueType::OBJECT) {
+        Value own_length = source.objectValue->get("length");
+        if (own_length.type == ValueType::NUMBER) {
+            length = (size_t)own_length.numberValue;
+        }
     }
+    
+    auto iterator = make_shared<JSIterator>([this, source, length, index = (size_t)0](Value& out) mutable -> bool {
+        if (index >= length) return false;
+        out = getProperty(source, to_string(index++));
+        return true;
+    });
+    
+    return Value::object(iterator);
+    
 }
@@ -5,8 +5,8 @@
 //  Created by Chidume Nnamdi on 19/09/2025.
 //
 
-#ifndef TurboVM_hpp
-#define TurboVM_hpp
+#ifndef PeregrineVM_hpp
+#define PeregrineVM_hpp
 
 #pragma once
 #include <stdio.h>
@@ -21,6 +21,7 @@
 #include "engines/Nova/TurboBytecode.hpp"
 #include "engines/Nova/TurboChunk.hpp"
 #include "engines/Nova/TurboModule.hpp"
+#include "engines/Nova/TurboPeephole.hpp"
 
 #include "Interpreter/ExecutionContext/Value/Value.h"
 #include "Interpreter/ExecutionContext/JSArray/JSArray.h"
@@ -36,6 +37,7 @@
 #include "builtin/platform/Server/Server.hpp"
 
 #include "engines/BaseVM/BaseVM.hpp"
+#include "Profiler/Profiler.hpp"
 
 using namespace std;
 
@@ -44,38 +46,6 @@ using std::unordered_map;
 using std::shared_ptr;
 using std::string;
 
-//struct Coroutine {
-//    PeregrineVM* vm;
-//    shared_ptr<TurboChunk> chunk;
-//    vector<Value> args;
-//    std::shared_ptr<Promise> promise;
-//    int ip = 0;
-//    // Add any state you need (registers, etc.)
-//
-//    Coroutine(PeregrineVM* vm_, shared_ptr<TurboChunk> chunk_, vector<Value> args_)
-//        : vm(vm_), chunk(chunk_), args(args_), promise(std::make_shared<Promise>()) {}
-//
-//    void resume(Value resumeValue = Value::undefined()) {
-//        // Run until next await or return
-//        try {
-//            Value result = vm->runFrame(*this /*or via a special coroutine frame*/);
-//            promise->resolve(result);
-//        } catch (const std::exception& e) {
-//            promise->reject(Value::str(e.what()));
-//        }
-//    }
-//    // More: suspend(), handling of yields, etc.
-//};
-
-//struct Coroutine {
-//    // ...
-//    void resume(Value resumeValue = Value::undefined()) {
-//        // Set up VM state (registers, etc.)
-//        // Loop: interpret bytecode until return/await
-//        // On await, yield control, and resume later
-//    }
-//};
-
 struct ExecutionContext {
     shared_ptr<Env> lexicalEnv;
     shared_ptr<Env> variableEnv;
@@ -90,14 +60,37 @@ class PeregrineVM : public BaseVM/* <PeregrineVM, TurboModule, TurboChunk> */ {
         vector<Value> args;
         shared_ptr<Closure> closure;
         Value registers[256];
+
+        // async frames (async closures and the top-level script) can
+        // suspend on Await. promise is null for the top-level frame.
+        bool async = false;
+        shared_ptr<Promise> promise;
+        shared_ptr<Promise> awaiting;
+        uint8_t resumeReg = 0;
+
+        // depth of tryStack/contextStack when the frame was entered
+        size_t tryBase = 0;
+        size_t contextBase = 0;
+        
+        // synchronous closures called by Call run in the caller's runFrame
+        // loop; Return pops them and writes the result to returnReg
+        bool inlineCall = false;
+        uint8_t returnReg = 0;
     };
 
+    // a throw that landed in a finally block with no catch; EndFinally
+    // throws it again once the block has run
     struct TryFrame {
-        int catchIP;      // -1 if none
-        int finallyIP;    // -1 if none
-        int stackDepth;   // stack size at entry
-        int ipAfterTry;   // where the linear try block ends (for normal flow)
-        uint8_t regCatch;   // register index to store the thrown value
+        int finallyIP;
+        Value exception;
+    };
+
+    // a suspended async frame. it owns its registers, ip, lexical
+    // contexts and try frames until the awaited promise settles.
+    struct Coroutine {
+        CallFrame frame;
+        vector<ExecutionContext*> contexts;
+        vector<TryFrame> tryFrames;
     };
 
 public:
@@ -111,12 +104,13 @@ public:
 
     PeregrineVM(shared_ptr<TurboModule> module_ = nullptr);
     ~PeregrineVM();
-    Value callFunction(const Value& callee, const vector<Value>& args);
+    Value callFunction(const Value& callee, const vector<Value>& args) override;
     
 private:
     shared_ptr<TurboModule> module_ = nullptr; 
     
-    vector<CallFrame> callStack; 
+    // a deque, so pushing a frame never moves the ones below it
+    deque<CallFrame> callStack; 
     
     shared_ptr<JSObject> createJSObject(shared_ptr<JSClass> klass);
     Value addCtor();
@@ -126,7 +120,15 @@ private:
     Value callMethod(const Value& callee, const vector<Value>& args, const Value& js_object);
 
     Value runFrame(CallFrame &current_frame);
-    void handleRethrow();
+    bool throwToHandler(const Value& exc);
+    CallFrame& pushFrame();
+    void enterFrame(const Value& callee, vector<Value> args, uint8_t returnReg);
+    void leaveFrame();
+    void dropContexts(size_t base);
+
+    Value runAsyncFrame();
+    void suspend(CallFrame& suspended);
+    void resumeCoroutine(shared_ptr<Coroutine> co, const Value& result, bool rejected);
 
     vector<TryFrame> tryStack;
     deque<Value> argStack;
@@ -137,16 +139,18 @@ private:
     Instruction readInstruction();
     void init_gui();
     void init_builtins();
-    Value getProperty(const Value &objVal, const string &propName);
+    Value getProperty(const Value &objVal, Atom propName);
+    Value getIterator(const Value& source);
+    void sampleStack();
     
     Value CreateInstance(Value klass);
-    void CreateObjectLiteralProperty(const Value& obj_val, const string& prop_name, const Value& object);
+    void CreateObjectLiteralProperty(const Value& obj_val, Atom prop_name, const Value& object);
     void InvokeConstructor(const Value& obj_value, const vector<Value>& args);
-    Value getVariable(const string& key) const;
-    void putVariable(const string& key, const Value& v) const;
+    Value getVariable(Atom key) const;
+    void putVariable(Atom key, const Value& v) const;
     ExecutionContext* createNewExecutionContext(const Value& callee) const;
     Value runFrameContext(CallFrame& frame, ExecutionContext* ctx);
     
 };
 
-#endif /* TurboVM_hpp */
+#endif /* PeregrineVM_hpp */
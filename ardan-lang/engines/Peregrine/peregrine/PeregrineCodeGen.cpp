@@ -26,6 +26,7 @@ size_t PeregrineCodeGen::generate(const vector<unique_ptr<Statement>> &program)
     emit(TurboOpCode::PushLexicalEnv);
     
     for (const auto &s : program) {
+        cur->markLine(s->line);
         s->accept(*this);
     }
     
@@ -34,6 +35,9 @@ size_t PeregrineCodeGen::generate(const vector<unique_ptr<Statement>> &program)
     emit(TurboOpCode::Halt);
     disassembleChunk(cur.get(), cur->name);
     
+    // the top level is done; deferred functions compile against it
+    if (deferredScope) *deferredScope = variables;
+    
     uint32_t idx = module_->addChunk(cur);
     module_->entryChunkIndex = idx;
     
@@ -48,6 +52,7 @@ R PeregrineCodeGen::visitBlock(BlockStatement* stmt) {
     
     if(stmt->standalone) beginScope();
     for (auto& s : stmt->body) {
+        cur->markLine(s->line);
         s->accept(*this);
         // registerAllocator->reset();
     }
@@ -225,11 +230,11 @@ R PeregrineCodeGen::visitVariable(VariableStatement* stmt) {
             emit(TurboOpCode::Move, slot, initReg); // move data inside initReg into register slot.
             freeRegister(initReg);
             
-            if (auto classExpr = dynamic_cast<ClassExpression*>(decl.init.get())) {
+            if (auto classExpr = node_cast<ClassExpression>(decl.init.get())) {
                 classExpr->name = decl.id;
-            } else if (auto functionExpr = dynamic_cast<FunctionExpression*>(decl.init.get())) {
+            } else if (auto functionExpr = node_cast<FunctionExpression>(decl.init.get())) {
                 functionExpr->name = decl.id;
-            } else if (auto arrowFunctionExpr = dynamic_cast<ArrowFunction*>(decl.init.get())) {
+            } else if (auto arrowFunctionExpr = node_cast<ArrowFunction>(decl.init.get())) {
                 arrowFunctionExpr->name = decl.id;
             }
 
@@ -319,7 +324,7 @@ R PeregrineCodeGen::visitWhile(WhileStatement* stmt) {
 R PeregrineCodeGen::visitFor(ForStatement* stmt) {
     
     bool isLexical = false;
-    if (auto it_stmt = dynamic_cast<VariableStatement*>(stmt->init.get())) {
+    if (auto it_stmt = node_cast<VariableStatement>(stmt->init.get())) {
         isLexical = get_kind(it_stmt->kind) != BindingKind::Var;
     }
     
@@ -342,7 +347,7 @@ R PeregrineCodeGen::visitFor(ForStatement* stmt) {
         if (isLexical) {
             emit(TurboOpCode::PushLexicalEnv);
             // copy iteration binding
-            if (auto it_stmt = dynamic_cast<VariableStatement*>(stmt->init.get())) {
+            if (auto it_stmt = node_cast<VariableStatement>(stmt->init.get())) {
                 int idx = emitConstant(Value::str(it_stmt->declarations[0].id));
                 emit(TurboOpCode::CopyIterationBinding, idx);
             }
@@ -388,9 +393,11 @@ R PeregrineCodeGen::visitReturn(ReturnStatement* stmt) {
     
     uint32_t value = allocRegister();
     
-    if (stmt->argument)
+    if (stmt->argument) {
+        tailCall = tryDepth == 0 && node_cast<CallExpression>(stmt->argument.get()) != nullptr;
         value = get<int>(stmt->argument->accept(*this));
-    else
+        tailCall = false;
+    } else
         emit(TurboOpCode::LoadConst, value, emitConstant(Value::undefined()));
     
     emit(TurboOpCode::Return, value);
@@ -486,23 +493,23 @@ void PeregrineCodeGen::emitAssignment(BinaryExpression* expr) {
         // Evaluate RHS into a fresh register
         // int rhsReg = allocRegister();
         
-        if (auto classExpr = dynamic_cast<ClassExpression*>(expr->right.get())) {
+        if (auto classExpr = node_cast<ClassExpression>(expr->right.get())) {
             // Try to infer name from left
-            if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+            if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
                 classExpr->name = idExpr->name;
-            } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+            } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
                 classExpr->name = evaluate_property(memberExpr); // e.g. obj.B
             }
-        } else if (auto functionExpr = dynamic_cast<FunctionExpression*>(expr->right.get())) {
-            if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+        } else if (auto functionExpr = node_cast<FunctionExpression>(expr->right.get())) {
+            if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
                 functionExpr->name = idExpr->name;
-            } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+            } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
                 functionExpr->name = evaluate_property(memberExpr);
             }
-        } else if (auto arrowFunctionExpr = dynamic_cast<ArrowFunction*>(expr->right.get())) {
-            if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+        } else if (auto arrowFunctionExpr = node_cast<ArrowFunction>(expr->right.get())) {
+            if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
                 arrowFunctionExpr->name = idExpr->name;
-            } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+            } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
                 arrowFunctionExpr->name = evaluate_property(memberExpr);
             }
         }
@@ -511,14 +518,14 @@ void PeregrineCodeGen::emitAssignment(BinaryExpression* expr) {
         int resultReg = get<int>(expr->right->accept(*this));
         
         // Assignment to a variable (identifier)
-        if (auto* ident = dynamic_cast<IdentifierExpression*>(left)) {
+        if (auto* ident = node_cast<IdentifierExpression>(left)) {
             // int destReg = lookupLocalSlot(ident->name);
             // Move/copy result into local/global slot
             // emit(TurboOpCode::Move, destReg, resultReg);
             store(ident->name, resultReg);
         }
         // Assignment to an object property
-        else if (auto* member = dynamic_cast<MemberExpression*>(left)) {
+        else if (auto* member = node_cast<MemberExpression>(left)) {
             // Evaluate object to reg
             int objReg = get<int>(member->object->accept(*this));
             
@@ -526,8 +533,8 @@ void PeregrineCodeGen::emitAssignment(BinaryExpression* expr) {
                 
                 int propReg = get<int>(member->property->accept(*this)); // Property key to reg
                 
-                // SetPropertyDynamic: objReg, propReg, valueReg
-                emit(TurboOpCode::SetPropertyDynamic, objReg, propReg, resultReg);
+                // SetIndex: objReg, propReg, valueReg
+                emit(TurboOpCode::SetIndex, objReg, propReg, resultReg);
                 freeRegister(propReg); // propReg
                 
             } else {
@@ -558,40 +565,40 @@ void PeregrineCodeGen::emitAssignment(BinaryExpression* expr) {
     int propReg = -1;
     int nameIdx = -1;
     
-    if (auto classExpr = dynamic_cast<ClassExpression*>(expr->right.get())) {
+    if (auto classExpr = node_cast<ClassExpression>(expr->right.get())) {
         // Try to infer name from left
-        if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+        if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
             classExpr->name = idExpr->name;
-        } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+        } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
             classExpr->name = evaluate_property(memberExpr); // e.g. obj.B
         }
-    } else if (auto functionExpr = dynamic_cast<FunctionExpression*>(expr->right.get())) {
-        if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+    } else if (auto functionExpr = node_cast<FunctionExpression>(expr->right.get())) {
+        if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
             functionExpr->name = idExpr->name;
-        } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+        } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
             functionExpr->name = evaluate_property(memberExpr);
         }
-    } else if (auto arrowFunctionExpr = dynamic_cast<ArrowFunction*>(expr->right.get())) {
-        if (auto idExpr = dynamic_cast<IdentifierExpression*>(expr->left.get())) {
+    } else if (auto arrowFunctionExpr = node_cast<ArrowFunction>(expr->right.get())) {
+        if (auto idExpr = node_cast<IdentifierExpression>(expr->left.get())) {
             arrowFunctionExpr->name = idExpr->name;
-        } else if (auto memberExpr = dynamic_cast<MemberExpression*>(expr->left.get())) {
+        } else if (auto memberExpr = node_cast<MemberExpression>(expr->left.get())) {
             arrowFunctionExpr->name = evaluate_property(memberExpr);
         }
 
     }
 
     
-    if (auto* ident = dynamic_cast<IdentifierExpression*>(left)) {
+    if (auto* ident = node_cast<IdentifierExpression>(left)) {
         load(ident->name, lhsReg);
     }
-    else if (auto* member = dynamic_cast<MemberExpression*>(left)) {
+    else if (auto* member = node_cast<MemberExpression>(left)) {
         
          objReg = get<int>(member->object->accept(*this));
         
          if (member->computed) {
              propReg = get<int>(member->property->accept(*this));
              // Get property value into lhsReg
-             emit(TurboOpCode::GetPropertyDynamic, lhsReg, objReg, propReg);
+             emit(TurboOpCode::GetIndex, lhsReg, objReg, propReg);
          } else {
              nameIdx = emitConstant(Value::str(member->name.lexeme));
              emit(TurboOpCode::GetProperty, lhsReg, objReg, nameIdx);
@@ -628,13 +635,13 @@ void PeregrineCodeGen::emitAssignment(BinaryExpression* expr) {
     }
     
     // Store back to LHS
-    if (auto* ident = dynamic_cast<IdentifierExpression*>(left)) {
+    if (auto* ident = node_cast<IdentifierExpression>(left)) {
         // emit(TurboOpCode::Move, lhsReg, opResultReg);
         store(ident->name, opResultReg);
     }
-    else if (auto* member = dynamic_cast<MemberExpression*>(left)) {
+    else if (auto* member = node_cast<MemberExpression>(left)) {
          if (member->computed) {
-             emit(TurboOpCode::SetPropertyDynamic, objReg, propReg, opResultReg);
+             emit(TurboOpCode::SetIndex, objReg, propReg, opResultReg);
              freeRegister(propReg); // propReg
          } else {
              emit(TurboOpCode::SetProperty, objReg, nameIdx, opResultReg);
@@ -673,6 +680,10 @@ R PeregrineCodeGen::visitIdentifier(IdentifierExpression* expr) {
 
 R PeregrineCodeGen::visitCall(CallExpression* expr) {
 
+    // only this call is in tail position, not the ones in its arguments
+    bool tail = tailCall && !node_cast<MemberExpression>(expr->callee.get());
+    tailCall = false;
+    
     int funcReg = get<int>(expr->callee->accept(*this));
     // auto funcGuard = makeRegGuard(funcReg, *this);
 
@@ -689,7 +700,7 @@ R PeregrineCodeGen::visitCall(CallExpression* expr) {
 
     for (int argReg : argRegs) {
         
-        if (auto spreadExpr = dynamic_cast<SpreadExpression*>((expr->arguments[index]).get())) {
+        if (auto spreadExpr = node_cast<SpreadExpression>((expr->arguments[index]).get())) {
             emit(TurboOpCode::PushSpreadArg, argReg);
         } else {
             emit(TurboOpCode::PushArg, argReg);
@@ -699,10 +710,10 @@ R PeregrineCodeGen::visitCall(CallExpression* expr) {
         
     }
 
-    if (auto super_expr = dynamic_cast<SuperExpression*>(expr->callee.get())) {
+    if (auto super_expr = node_cast<SuperExpression>(expr->callee.get())) {
         emit(TurboOpCode::SuperCall, resultReg, funcReg, static_cast<int>(argRegs.size()));
     } else {
-        emit(TurboOpCode::Call, resultReg, funcReg, static_cast<int>(argRegs.size()));
+        emit(tail ? TurboOpCode::TailCall : TurboOpCode::Call, resultReg, funcReg, static_cast<int>(argRegs.size()));
     }
 
     for (int argReg : argRegs) {
@@ -730,7 +741,7 @@ R PeregrineCodeGen::visitMember(MemberExpression* expr) {
         int propertyReg = get<int>(expr->property->accept(*this));
         // auto propertyGuard = makeRegGuard(propertyReg, *this);
 
-        emit(TurboOpCode::GetPropertyDynamic, targetReg, objectReg, propertyReg);
+        emit(TurboOpCode::GetIndex, targetReg, objectReg, propertyReg);
         
         freeRegister(propertyReg);
         
@@ -754,7 +765,7 @@ R PeregrineCodeGen::visitNew(NewExpression* expr) {
         throw runtime_error("Arguments to constructor must not exceed 255.");
     }
     
-    if (auto ident = dynamic_cast<IdentifierExpression*>(expr->callee.get())) {
+    if (auto ident = node_cast<IdentifierExpression>(expr->callee.get())) {
                 
         int reg = get<int>(ident->accept(*this));
         
@@ -794,7 +805,7 @@ R PeregrineCodeGen::visitArray(ArrayLiteralExpression* expr) {
     int arr = allocRegister();
     emit(TurboOpCode::CreateArrayLiteral, arr);
     for (auto& el : expr->elements) {
-        if (SpreadExpression* spread = dynamic_cast<SpreadExpression*>(el.get())) {
+        if (SpreadExpression* spread = node_cast<SpreadExpression>(el.get())) {
             int val = get<int>(spread->expression->accept(*this));
             emit(TurboOpCode::ArraySpread, arr, val);
         } else {
@@ -813,24 +824,24 @@ R PeregrineCodeGen::visitObject(ObjectLiteralExpression* expr) {
     
     for (auto& prop : expr->props) {
 
-        if (auto classExpr = dynamic_cast<ClassExpression*>(prop.second.get())) {
+        if (auto classExpr = node_cast<ClassExpression>(prop.second.get())) {
             classExpr->name = prop.first.lexeme;
-        } else if (auto functionExpr = dynamic_cast<FunctionExpression*>(prop.second.get())) {
+        } else if (auto functionExpr = node_cast<FunctionExpression>(prop.second.get())) {
             functionExpr->name = prop.first.lexeme;
-        } else if (auto arrowFunctionExpr = dynamic_cast<ArrowFunction*>(prop.second.get())) {
+        } else if (auto arrowFunctionExpr = node_cast<ArrowFunction>(prop.second.get())) {
             arrowFunctionExpr->name = prop.first.lexeme;
         }
 
         int val = -1;
         
-        if (SpreadExpression* spread = dynamic_cast<SpreadExpression*>(prop.second.get())) {
+        if (SpreadExpression* spread = node_cast<SpreadExpression>(prop.second.get())) {
             
-            int val = get<int>(spread->expression->accept(*this));
+            val = get<int>(spread->expression->accept(*this));
             emit(TurboOpCode::ObjectSpread, obj, val);
             
         } else {
             
-            int val = get<int>(prop.second->accept(*this));
+            val = get<int>(prop.second->accept(*this));
             emit(TurboOpCode::CreateObjectLiteralProperty, obj, emitConstant(prop.first.lexeme), val);
         }
         
@@ -874,7 +885,7 @@ R PeregrineCodeGen::visitUnary(UnaryExpression* expr) {
         
         int reg = allocRegister();
         
-        if (auto member = dynamic_cast<MemberExpression*>(expr->right.get())) {
+        if (auto member = node_cast<MemberExpression>(expr->right.get())) {
             
             int objReg = get<int>(member->object->accept(*this));
             
@@ -911,7 +922,7 @@ R PeregrineCodeGen::visitUnary(UnaryExpression* expr) {
     // For prefix unary ops that target identifiers or members, we need special handling.
     if (expr->op.type == TokenType::INCREMENT || expr->op.type == TokenType::DECREMENT) {
         // ++x or --x
-        if (auto ident = dynamic_cast<IdentifierExpression*>(expr->right.get())) {
+        if (auto ident = node_cast<IdentifierExpression>(expr->right.get())) {
             
             // load ident
             int lhsReg = allocRegister();
@@ -936,7 +947,7 @@ R PeregrineCodeGen::visitUnary(UnaryExpression* expr) {
             
         }
 
-        if (auto member_expr = dynamic_cast<MemberExpression*>(expr->right.get())) {
+        if (auto member_expr = node_cast<MemberExpression>(expr->right.get())) {
             
             int lhsReg = get<int>(member_expr->accept(*this));
             int rhsReg = allocRegister();
@@ -958,8 +969,8 @@ R PeregrineCodeGen::visitUnary(UnaryExpression* expr) {
                 
                 int propReg = get<int>(member_expr->property->accept(*this)); // Property key to reg
                 
-                // SetPropertyDynamic: objReg, propReg, valueReg
-                emit(TurboOpCode::SetPropertyDynamic, objReg, propReg, opResultReg);
+                // SetIndex: objReg, propReg, valueReg
+                emit(TurboOpCode::SetIndex, objReg, propReg, opResultReg);
                 freeRegister(propReg); // propReg
                 
             } else {
@@ -1003,7 +1014,7 @@ R PeregrineCodeGen::visitUpdate(UpdateExpression* expr) {
     
     int returnReg = -1;
     
-    if (auto ident = dynamic_cast<IdentifierExpression*>(expr->argument.get())) {
+    if (auto ident = node_cast<IdentifierExpression>(expr->argument.get())) {
         
         int rhsReg = allocRegister();
         emit(TurboOpCode::LoadConst, rhsReg, emitConstant(Value(1)));
@@ -1023,7 +1034,7 @@ R PeregrineCodeGen::visitUpdate(UpdateExpression* expr) {
         returnReg = lhsReg; //opResultReg;
         
     }
-    else if (auto member = dynamic_cast<MemberExpression*>(expr->argument.get())) {
+    else if (auto member = node_cast<MemberExpression>(expr->argument.get())) {
                 
         int rhsReg = allocRegister();
         emit(TurboOpCode::LoadConst, rhsReg, emitConstant(Value(1)));
@@ -1044,7 +1055,7 @@ R PeregrineCodeGen::visitUpdate(UpdateExpression* expr) {
             
             int propReg = get<int>(member->property->accept(*this)); // Property key to reg
             
-            emit(TurboOpCode::SetPropertyDynamic, objReg, propReg, opResultReg);
+            emit(TurboOpCode::SetIndex, objReg, propReg, opResultReg);
             freeRegister(propReg); // propReg
             
         } else {
@@ -1167,18 +1178,18 @@ R PeregrineCodeGen::visitArrowFunction(ArrowFunction* expr) {
 
     // Compile function body
     if (expr->exprBody) {
-        expr->exprBody->accept(nested);
-        nested.emit(TurboOpCode::Return);
-        // we must return the value of the expr
+        // the value of the expression is the result
+        int result = get<int>(expr->exprBody->accept(nested));
+        nested.emit(TurboOpCode::Return, result);
     } else if (expr->stmtBody) {
         
         expr->stmtBody->accept(nested);
         
         // TODO: we need to check if return is the last statement.
         bool is_return_avaialble = false;
-        if (BlockStatement* block = dynamic_cast<BlockStatement*>(expr->stmtBody.get())) {
+        if (BlockStatement* block = node_cast<BlockStatement>(expr->stmtBody.get())) {
             for (auto& body : block->body) {
-                if (auto return_stmt = dynamic_cast<ReturnStatement*>(body.get())) {
+                if (auto return_stmt = node_cast<ReturnStatement>(body.get())) {
                     is_return_avaialble = true;
                 }
             }
@@ -1204,6 +1215,7 @@ R PeregrineCodeGen::visitArrowFunction(ArrowFunction* expr) {
     fnObj->arity = fnChunk->arity;
     fnObj->name =  expr->name;
     fnObj->upvalues_size = (uint32_t)nested.upvalues.size();
+    fnObj->isAsync = expr->is_async;
 
     Value fnValue = Value::functionRef(fnObj);
     int ci = module_->addConstant(fnValue);
@@ -1333,9 +1345,9 @@ R PeregrineCodeGen::visitFunctionExpression(FunctionExpression* expr) {
         // TODO: walk the body ast to ensure OP_RETURN is emitted at the end if not emitted
         // TODO: we need to check if return is the last statement.
         bool is_return_avaialble = false;
-        if (BlockStatement* block = dynamic_cast<BlockStatement*>(expr->body.get())) {
+        if (BlockStatement* block = node_cast<BlockStatement>(expr->body.get())) {
             for (auto& body : block->body) {
-                if (auto return_stmt = dynamic_cast<ReturnStatement*>(body.get())) {
+                if (auto return_stmt = node_cast<ReturnStatement>(body.get())) {
                     is_return_avaialble = true;
                 }
             }
@@ -1364,6 +1376,7 @@ R PeregrineCodeGen::visitFunctionExpression(FunctionExpression* expr) {
     fnObj->arity = fnChunk->arity;
     fnObj->name = expr->name; //"<anon>";
     fnObj->upvalues_size = (uint32_t)nested.upvalues.size();
+    fnObj->isAsync = expr->is_async;
 
     Value fnValue = Value::functionRef(fnObj);
     int ci = module_->addConstant(fnValue);
@@ -1379,9 +1392,9 @@ R PeregrineCodeGen::visitFunctionExpression(FunctionExpression* expr) {
     return closureChunkIndexReg;
 }
 
-R PeregrineCodeGen::visitFunction(FunctionDeclaration* stmt) {
-    // Create a nested code generator for the function body
-    PeregrineCodeGen nested(module_);
+// Compiles the parameters and body of stmt into nested.cur
+shared_ptr<TurboChunk> PeregrineCodeGen::compileFunction(FunctionDeclaration* stmt, PeregrineCodeGen& nested) {
+    
     nested.enclosing = this;
     nested.cur = make_shared<TurboChunk>();
     nested.cur->name = stmt->id;
@@ -1484,25 +1497,13 @@ R PeregrineCodeGen::visitFunction(FunctionDeclaration* stmt) {
     // Compile function body
     if (stmt->body) {
         
-        if (stmt->is_async) {
-            
-            if (BlockStatement* block = dynamic_cast<BlockStatement*>(stmt->body.get())) {
-                for (auto& body : block->body) {
-                    if (auto return_stmt = dynamic_cast<ReturnStatement*>(body.get())) {
-                        // wrap the return value in Promise
-                    }
-                }
-            }
-
-        }
-        
         stmt->body->accept(nested);
         // TODO: walk the body ast to ensure OP_RETURN is emitted at the end if not emitted
         // TODO: we need to check if return is the last statement.
         bool is_return_avaialble = false;
-        if (BlockStatement* block = dynamic_cast<BlockStatement*>(stmt->body.get())) {
+        if (BlockStatement* block = node_cast<BlockStatement>(stmt->body.get())) {
             for (auto& body : block->body) {
-                if (auto return_stmt = dynamic_cast<ReturnStatement*>(body.get())) {
+                if (auto return_stmt = node_cast<ReturnStatement>(body.get())) {
                     is_return_avaialble = true;
                 }
             }
@@ -1519,15 +1520,76 @@ R PeregrineCodeGen::visitFunction(FunctionDeclaration* stmt) {
 
     }
 
-    // Register chunk & emit as constant
     auto fnChunk = nested.cur;
     fnChunk->arity = (uint32_t)paramNames.size();
+    
+    return fnChunk;
+    
+}
 
-    uint32_t chunkIndex = module_->addChunk(fnChunk);
+// A top-level function whose body the parser skipped, compiled on its first
+// call. Names resolve through the execution context at run time; what
+// compiling needs from the top level is which variables (and which consts)
+// were declared before the function, so the generator standing in for the
+// top level gets those.
+uint32_t PeregrineCodeGen::deferFunction(FunctionDeclaration* stmt, uint32_t& arity) {
+    
+    vector<string> paramNames;
+    vector<ParameterInfo> parameterInfos;
+    for (auto& param : stmt->params) {
+        collectParameterInfo(param.get(), paramNames, parameterInfos);
+    }
+    arity = (uint32_t)paramNames.size();
+    
+    if (!deferredScope) deferredScope = make_shared<vector<Variable>>();
+    
+    weak_ptr<TurboModule> module = module_;
+    string id = stmt->id;
+    shared_ptr<DeferredFunction> deferred = stmt->deferred;
+    shared_ptr<vector<Variable>> scope = deferredScope;
+    size_t visible = variables.size();
+    
+    return module_->deferChunk([module, id, deferred, scope, visible]() {
+        
+        auto function = Parser::parseDeferred(id, *deferred);
+        
+        PeregrineCodeGen top(module.lock());
+        top.variables.assign(scope->begin(), scope->begin() + visible);
+        
+        PeregrineCodeGen nested(module.lock());
+        auto fnChunk = top.compileFunction(function.get(), nested);
+        
+        top.disassembleChunk(fnChunk.get(), id);
+        
+        return fnChunk;
+        
+    });
+    
+}
+
+R PeregrineCodeGen::visitFunction(FunctionDeclaration* stmt) {
+    
+    if (!stmt->body && stmt->deferred && enclosing != nullptr) {
+        stmt->body = std::move(Parser::parseDeferred(stmt->id, *stmt->deferred)->body);
+    }
+    
+    // Create a nested code generator for the function body
+    PeregrineCodeGen nested(module_);
+    uint32_t chunkIndex;
+    uint32_t arity;
+    
+    // Register chunk & emit as constant
+    if (stmt->body) {
+        auto fnChunk = compileFunction(stmt, nested);
+        chunkIndex = module_->addChunk(fnChunk);
+        arity = fnChunk->arity;
+    } else {
+        chunkIndex = deferFunction(stmt, arity);
+    }
 
     auto fnObj = make_shared<FunctionObject>();
     fnObj->chunkIndex = chunkIndex;
-    fnObj->arity = fnChunk->arity;
+    fnObj->arity = arity;
     fnObj->name = stmt->id;
     fnObj->upvalues_size = (uint32_t)nested.upvalues.size();
     fnObj->isAsync = stmt->is_async;
@@ -1547,7 +1609,7 @@ R PeregrineCodeGen::visitFunction(FunctionDeclaration* stmt) {
     create(stmt->id, closureChunkIndexReg, functionBinding);
 
     // disassemble the chunk for debugging
-    disassembleChunk(nested.cur.get(), stmt->id/*nested.cur->name*/);
+    if (stmt->body) disassembleChunk(nested.cur.get(), stmt->id/*nested.cur->name*/);
     
     freeRegister(closureChunkIndexReg);
 
@@ -1555,25 +1617,43 @@ R PeregrineCodeGen::visitFunction(FunctionDeclaration* stmt) {
 }
 
 R PeregrineCodeGen::visitTemplateLiteral(TemplateLiteral* expr) {
-    // Concatenate all pieces
+
+    // the pieces are evaluated into registers and joined by StringConcat,
+    // at most MAX_CONCAT_PARTS at a time. the result register is the first
+    // part of each later StringConcat.
     int reg = allocRegister();
-    
-    emit(TurboOpCode::LoadConst, reg, emitConstant(Value::str("")));
-    
+    vector<int> parts;
+
+    auto flush = [&]() {
+        emit(TurboOpCode::StringConcat, reg, (int)parts.size());
+        for (size_t i = 0; i < parts.size(); i += 3) {
+            emit(TurboOpCode::Nop,
+                 parts[i],
+                 i + 1 < parts.size() ? parts[i + 1] : 0,
+                 i + 2 < parts.size() ? parts[i + 2] : 0);
+        }
+        for (int part : parts) {
+            if (part != reg) freeRegister(part);
+        }
+        parts = { reg };
+    };
+
     for (size_t i = 0; i < expr->quasis.size(); ++i) {
-        int strReg = allocRegister();
-        emit(TurboOpCode::LoadConst, strReg, emitConstant(expr->quasis[i]->text));
-        emit(TurboOpCode::Add, reg, reg, strReg);
-        freeRegister(strReg);
+        if (!expr->quasis[i]->text.empty()) {
+            int strReg = allocRegister();
+            emit(TurboOpCode::LoadConst, strReg, emitConstant(expr->quasis[i]->text));
+            parts.push_back(strReg);
+        }
         
         if (i < expr->expressions.size()) {
-            int exprReg = get<int>(expr->expressions[i]->accept(*this));
-            emit(TurboOpCode::Add, reg, reg, exprReg);
-            freeRegister(exprReg);
+            parts.push_back(get<int>(expr->expressions[i]->accept(*this)));
         }
         
+        if (parts.size() >= MAX_CONCAT_PARTS) flush();
     }
     
+    flush();
+    
     return reg;
 }
 
@@ -1606,15 +1686,16 @@ R PeregrineCodeGen::visitImportDeclaration(ImportDeclaration* stmt) {
         return true;
     }
 
-    std::string source = read_file(importPath);
+    // kept alive by the functions whose bodies are deferred
+    auto source = make_shared<string>(read_file(importPath));
 
     // Parse the imported source to AST
-    Scanner scanner(source);
-    auto tokens = scanner.getTokens();
+    Scanner scanner(*source);
     
     // pass the resolved file path into the parser
-    Parser parser(tokens);
+    Parser parser(scanner);
     parser.sourceFile = importPath;
+    if (defer_function_bodies && enclosing == nullptr) parser.deferFunctionBodies(source);
     auto ast = parser.parse();
 
     // Register the imported module BEFORE compiling to handle cycles
@@ -1858,18 +1939,18 @@ int PeregrineCodeGen::compileMethod(MethodDefinition& method) {
         method.methodBody->accept(nested);
         // Ensure OP_RETURN is emitted
         bool hasReturn = false;
-        if (auto* block = dynamic_cast<BlockStatement*>(method.methodBody.get())) {
+        if (auto* block = node_cast<BlockStatement>(method.methodBody.get())) {
             for (auto& stmt : block->body) {
-                if (dynamic_cast<ReturnStatement*>(stmt.get())) {
+                if (node_cast<ReturnStatement>(stmt.get())) {
                     hasReturn = true;
                     break;
                 }
                 
                 // TODO: This needs refactor, we should not special case "body" method like this
                 // for view builders
-                if (auto exprStmt = dynamic_cast<ExpressionStatement*>(stmt.get())) {
+                if (auto exprStmt = node_cast<ExpressionStatement>(stmt.get())) {
                     
-                    if (auto ui = dynamic_cast<UIViewExpression*>(exprStmt->expression.get()) && method.name == "body") {
+                    if (auto ui = node_cast<UIViewExpression>(exprStmt->expression.get()) && method.name == "body") {
                         hasReturn = true;
                         
                         nested
@@ -1927,7 +2008,7 @@ R PeregrineCodeGen::visitClass(ClassDeclaration* stmt) {
         
         super_class_reg = get<int>(stmt->superClass->accept(*this)); // [superclass]
         
-        auto ident = dynamic_cast<IdentifierExpression*>((stmt->superClass.get()));
+        auto ident = node_cast<IdentifierExpression>((stmt->superClass.get()));
         
         if (ident) {
             classInfo.super_class_name = ident->name;
@@ -1953,22 +2034,22 @@ R PeregrineCodeGen::visitClass(ClassDeclaration* stmt) {
         bool isProtected = false;
         
         for (const auto& mod : field->modifiers) {
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
         }
 
         // Property is always a VariableStatement
-        if (auto* varStmt = dynamic_cast<VariableStatement*>(field->property.get())) {
+        if (auto* varStmt = node_cast<VariableStatement>(field->property.get())) {
             
             string kind = varStmt->kind;
             
@@ -2085,16 +2166,16 @@ R PeregrineCodeGen::visitClass(ClassDeclaration* stmt) {
         bool isProtected = false;
         
         for (const auto& mod : method->modifiers) {
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
         }
@@ -2117,16 +2198,16 @@ R PeregrineCodeGen::visitClass(ClassDeclaration* stmt) {
         bool isProtected = false;
         
         for (const auto& mod : method->modifiers) {
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
         }
@@ -2203,7 +2284,7 @@ R PeregrineCodeGen::visitClassExpression(ClassExpression* stmt) {
         
         super_class_reg = get<int>(stmt->superClass->accept(*this)); // [superclass]
         
-        auto ident = dynamic_cast<IdentifierExpression*>((stmt->superClass.get()));
+        auto ident = node_cast<IdentifierExpression>((stmt->superClass.get()));
         
         if (ident) {
             classInfo.super_class_name = ident->name;
@@ -2227,22 +2308,22 @@ R PeregrineCodeGen::visitClassExpression(ClassExpression* stmt) {
         bool isProtected = false;
         
         for (const auto& mod : field->modifiers) {
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
         }
         
         // Property is always a VariableStatement
-        if (auto* varStmt = dynamic_cast<VariableStatement*>(field->property.get())) {
+        if (auto* varStmt = node_cast<VariableStatement>(field->property.get())) {
             
             string kind = varStmt->kind;
             
@@ -2359,16 +2440,16 @@ R PeregrineCodeGen::visitClassExpression(ClassExpression* stmt) {
         bool isProtected = false;
         
         for (const auto& mod : method->modifiers) {
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
         }
@@ -2391,16 +2472,16 @@ R PeregrineCodeGen::visitClassExpression(ClassExpression* stmt) {
         bool isProtected = false;
         
         for (const auto& mod : method->modifiers) {
-            if (auto* staticKW = dynamic_cast<StaticKeyword*>(mod.get())) {
+            if (auto* staticKW = node_cast<StaticKeyword>(mod.get())) {
                 isStatic = true;
             }
-            if (auto* privateKW = dynamic_cast<PrivateKeyword*>(mod.get())) {
+            if (auto* privateKW = node_cast<PrivateKeyword>(mod.get())) {
                 isPrivate = true;
             }
-            if (auto* publicKW = dynamic_cast<PublicKeyword*>(mod.get())) {
+            if (auto* publicKW = node_cast<PublicKeyword>(mod.get())) {
                 isPublic = true;
             }
-            if (auto* protectedKW = dynamic_cast<ProtectedKeyword*>(mod.get())) {
+            if (auto* protectedKW = node_cast<ProtectedKeyword>(mod.get())) {
                 isProtected = true;
             }
         }
@@ -2567,12 +2648,15 @@ R PeregrineCodeGen::visitTry(TryStatement* stmt) {
     beginScope();
     
     int ex_val_reg = allocRegister();
-    int tryPos = emitTryPlaceholder();
-    patchTry(tryPos, ex_val_reg);
     
+    // nothing is emitted on entry or exit; the VM finds the handler in
+    // cur->handlers only when something throws
+    HandlerEntry entry { (uint32_t)cur->code.size(), 0, -1, -1, (uint8_t)ex_val_reg };
+    
+    tryDepth++;
     stmt->block->accept(*this);
 
-    emit(TurboOpCode::EndTry);
+    entry.end = (uint32_t)cur->code.size();
 
     endScope();
     
@@ -2581,7 +2665,7 @@ R PeregrineCodeGen::visitTry(TryStatement* stmt) {
     if (stmt->handler) {
         endJump = emitJump(TurboOpCode::Jump);
 
-        patchTryCatch(tryPos, (int)cur->code.size() - 1);
+        entry.catchIP = (int)cur->code.size();
 
         beginScope();
         
@@ -2596,19 +2680,30 @@ R PeregrineCodeGen::visitTry(TryStatement* stmt) {
 
     }
 
+    uint32_t catchEnd = (uint32_t)cur->code.size();
+
     if (endJump != -1) {
         patchSingleJump(endJump);
     }
 
     if (stmt->finalizer) {
-        patchTryFinally(tryPos, (int)cur->code.size() - 1);
+        int finallyStart = (int)cur->code.size();
+        entry.finallyIP = finallyStart;
         beginScope();
 
         stmt->finalizer->accept(*this);
-        emit(TurboOpCode::EndFinally);
+        emit(TurboOpCode::EndFinally, (int)cur->code.size() - finallyStart);
         endScope();
     }
     
+    cur->handlers.push_back(entry);
+    
+    // a throw from the catch block still runs the finally
+    if (stmt->handler && stmt->finalizer) {
+        cur->handlers.push_back({ (uint32_t)entry.catchIP, catchEnd, -1, entry.finallyIP, 0 });
+    }
+    
+    tryDepth--;
     return true;
     
 }
@@ -2646,17 +2741,17 @@ R PeregrineCodeGen::visitForIn(ForInStatement* stmt) {
 
     // Assign keyReg to loop variable (var/let/const)
     // Assign value to loop variable
-    if (auto* ident = dynamic_cast<IdentifierExpression*>(stmt->init.get())) {
+    if (auto* ident = node_cast<IdentifierExpression>(stmt->init.get())) {
         store(ident->name, keyReg);
-    } else if (auto* var_stmt = dynamic_cast<VariableStatement*>(stmt->init.get())) {
+    } else if (auto* var_stmt = node_cast<VariableStatement>(stmt->init.get())) {
         store(var_stmt->declarations[0].id, keyReg);
         if (get_kind(var_stmt->kind) != BindingKind::Var) {
             isLexical = true;
             name = var_stmt->declarations[0].id;
         }
-    } else if (auto* expr_stmt = dynamic_cast<ExpressionStatement*>(stmt->init.get())) {
+    } else if (auto* expr_stmt = node_cast<ExpressionStatement>(stmt->init.get())) {
         
-        if (auto* ident = dynamic_cast<IdentifierExpression*>(expr_stmt->expression.get())) {
+        if (auto* ident = node_cast<IdentifierExpression>(expr_stmt->expression.get())) {
             store(ident->name, keyReg);
         }
         
@@ -2721,37 +2816,32 @@ R PeregrineCodeGen::visitForOf(ForOfStatement* stmt) {
     
     int arrReg = get<int>(stmt->right->accept(*this));
 
-    int lenReg = allocRegister();
-    emit(TurboOpCode::GetObjectLength, lenReg, arrReg);
-
-    int idxReg = allocRegister();
-    emit(TurboOpCode::LoadConst, idxReg, emitConstant(Value(0)));
+    // arrays are walked by index, native iterators (streams) pulled lazily
+    int iterReg = allocRegister();
+    emit(TurboOpCode::GetIterator, iterReg, arrReg);
 
     int loopStart = (int)cur->code.size();
 
-    // if (idx >= len) break;
+    // elem = next(); if (!hasValue) break;
+    int elemReg = allocRegister();
     int condReg = allocRegister();
-    emit(TurboOpCode::LessThan, condReg, idxReg, lenReg);
+    emit(TurboOpCode::IteratorNext, elemReg, iterReg, condReg);
     int breakJump = emitJump(TurboOpCode::JumpIfFalse, condReg);
 
-    // Get current element: arr[idx]
-    int elemReg = allocRegister();
-    emit(TurboOpCode::GetPropertyDynamic, elemReg, arrReg, idxReg);
-
     bool isLexical = false;
     string name;
     
-    if (auto* ident = dynamic_cast<IdentifierExpression*>(stmt->left.get())) {
+    if (auto* ident = node_cast<IdentifierExpression>(stmt->left.get())) {
         store(ident->name, elemReg);
-    } else if (auto* var_stmt = dynamic_cast<VariableStatement*>(stmt->left.get())) {
+    } else if (auto* var_stmt = node_cast<VariableStatement>(stmt->left.get())) {
         store(var_stmt->declarations[0].id, elemReg);
         if (get_kind(var_stmt->kind) != BindingKind::Var) {
             isLexical = true;
             name = var_stmt->declarations[0].id;
         }
-    } else if (auto* expr_stmt = dynamic_cast<ExpressionStatement*>(stmt->left.get())) {
+    } else if (auto* expr_stmt = node_cast<ExpressionStatement>(stmt->left.get())) {
         
-        if (auto* ident = dynamic_cast<IdentifierExpression*>(expr_stmt->expression.get())) {
+        if (auto* ident = node_cast<IdentifierExpression>(expr_stmt->expression.get())) {
             store(ident->name, elemReg);
         }
         
@@ -2785,21 +2875,14 @@ R PeregrineCodeGen::visitForOf(ForOfStatement* stmt) {
 
     freeRegister(elemReg);
 
-    // idx++
-    int incr_const_reg = allocRegister();
-    emit(TurboOpCode::LoadConst, incr_const_reg, emitConstant(Value(1)));
-    emit(TurboOpCode::Add, idxReg, idxReg, incr_const_reg);
-
     emitLoop(loopStart);
 
     patchJump(breakJump, (int)cur->code.size());
 
     // Free registers
     freeRegister(arrReg);
-    freeRegister(lenReg);
-    freeRegister(idxReg);
+    freeRegister(iterReg);
     freeRegister(condReg);
-    freeRegister(incr_const_reg);
     
     endScope();
     endLoop();
@@ -2888,8 +2971,8 @@ R PeregrineCodeGen::visitUIExpression(UIViewExpression* expr) {
     }
     
     for (auto& modifier : expr->modifiers) {
-        if (auto call = dynamic_cast<CallExpression*>(modifier.get())) {
-            auto ident = dynamic_cast<IdentifierExpression*>(call->callee.get());
+        if (auto call = node_cast<CallExpression>(modifier.get())) {
+            auto ident = node_cast<IdentifierExpression>(call->callee.get());
             
             vector<int> modifier_args;
             for (auto& arg : call->arguments) {
@@ -2920,33 +3003,33 @@ void PeregrineCodeGen::collectParameterInfo(Expression* parameters, vector<strin
                                             ) {
     if (parameters) {
         
-        if (SequenceExpression* seq = dynamic_cast<SequenceExpression*>(parameters)) {
+        if (SequenceExpression* seq = node_cast<SequenceExpression>(parameters)) {
             for (auto& p : seq->expressions) {
-                if (auto* rest = dynamic_cast<RestParameter*>(p.get())) {
+                if (auto* rest = node_cast<RestParameter>(p.get())) {
                     paramNames.push_back(rest->token.lexeme);
                     parameterInfos.emplace_back(rest->token.lexeme, false, nullptr, true);
-                } else if (auto* assign = dynamic_cast<BinaryExpression*>(p.get())) {
-                    if (auto* ident = dynamic_cast<IdentifierExpression*>(assign->left.get())) {
+                } else if (auto* assign = node_cast<BinaryExpression>(p.get())) {
+                    if (auto* ident = node_cast<IdentifierExpression>(assign->left.get())) {
                         paramNames.push_back(ident->name);
                         parameterInfos.emplace_back(ident->name, true, assign->right.get(), false);
                     }
-                } else if (auto* ident = dynamic_cast<IdentifierExpression*>(p.get())) {
+                } else if (auto* ident = node_cast<IdentifierExpression>(p.get())) {
                     paramNames.push_back(ident->name);
                     parameterInfos.emplace_back(ident->name, false, nullptr, false);
                 }
             }
         }
-        else if (auto* rest = dynamic_cast<RestParameter*>(parameters)) {
+        else if (auto* rest = node_cast<RestParameter>(parameters)) {
             paramNames.push_back(rest->token.lexeme);
             parameterInfos.emplace_back(rest->token.lexeme, false, nullptr, true);
         }
-        else if (auto* binary_expr = dynamic_cast<BinaryExpression*>(parameters)) {
-            if (auto* ident = dynamic_cast<IdentifierExpression*>(binary_expr->left.get())) {
+        else if (auto* binary_expr = node_cast<BinaryExpression>(parameters)) {
+            if (auto* ident = node_cast<IdentifierExpression>(binary_expr->left.get())) {
                 paramNames.push_back(ident->name);
                 parameterInfos.emplace_back(ident->name, true, binary_expr->right.get(), false);
             }
         }
-        else if (auto* ident = dynamic_cast<IdentifierExpression*>(parameters)) {
+        else if (auto* ident = node_cast<IdentifierExpression>(parameters)) {
             paramNames.push_back(ident->name);
             parameterInfos.emplace_back(ident->name, false, nullptr, false);
         }
@@ -3007,47 +3090,22 @@ int PeregrineCodeGen::recordInstanceField(const string& classId, const string& f
 }
 
 string PeregrineCodeGen::evaluate_property(Expression* expr) {
-    if (auto member = dynamic_cast<MemberExpression*>(expr)) {
+    if (auto member = node_cast<MemberExpression>(expr)) {
         if (member->computed) {
             return evaluate_property(member->property.get());
         } else {
             return member->name.lexeme;
         }
     }
-    if (auto ident = dynamic_cast<IdentifierExpression*>(expr)) {
+    if (auto ident = node_cast<IdentifierExpression>(expr)) {
         return ident->name;
     }
-    if (auto literal = dynamic_cast<LiteralExpression*>(expr)) {
+    if (auto literal = node_cast<LiteralExpression>(expr)) {
         return literal->token.lexeme; 
     }
     throw std::runtime_error("Unsupported expression type in evaluate_property");
 }
 
-int PeregrineCodeGen::emitTryPlaceholder() {
-    emit(TurboOpCode::Try);
-
-    int pos = (int)cur->size() - 1;
-
-    return pos; 
-    
-}
-
-void PeregrineCodeGen::patchTryCatch(int tryPos, int target) {
-    
-    cur->code[tryPos].a = target;
-        
-}
-
-void PeregrineCodeGen::patchTryFinally(int tryPos, int target) {
-    
-    cur->code[tryPos].b = target;
-    
-}
-
-void PeregrineCodeGen::patchTry(int tryPos, int reg) {
-    cur->code[tryPos].c = reg;
-}
-
 void PeregrineCodeGen::emit(TurboOpCode op, int a, int b = 0, int c = 0) {
     if (!cur) throw std::runtime_error("No active chunk for code generation.");
     cur->code.push_back({op, (uint8_t)a, (uint8_t)b, (uint8_t)c});
@@ -3122,8 +3180,7 @@ void PeregrineCodeGen::endScope() {
 }
 
 int PeregrineCodeGen::emitConstant(const Value& v) {
-    cur->constants.push_back(v);
-    return (int)cur->constants.size() - 1;
+    return cur->addConstant(v);
 }
 
 int PeregrineCodeGen::addUpvalue(bool isLocal, int index, string name, BindingKind kind) {
@@ -3276,6 +3333,7 @@ size_t PeregrineCodeGen::disassembleInstruction(const TurboChunk* chunk, size_t
         case TurboOpCode::Jump: opName = "Jump"; break;
         case TurboOpCode::Return: opName = "Return"; break;
         case TurboOpCode::Call: opName = "Call"; break;
+        case TurboOpCode::TailCall: opName = "TailCall"; break;
         case TurboOpCode::PushArg: opName = "PushArg"; break;
         case TurboOpCode::CreateClosure: opName = "CreateClosure"; break;
         case TurboOpCode::CreateArrayLiteral: opName = "CreateArrayLiteral"; break;
@@ -3284,6 +3342,9 @@ size_t PeregrineCodeGen::disassembleInstruction(const TurboChunk* chunk, size_t
         case TurboOpCode::ArrayPush: opName = "ArrayPush"; break;
         case TurboOpCode::GetProperty: opName = "GetProperty"; break;
         case TurboOpCode::GetPropertyDynamic: opName = "GetPropertyDynamic"; break;
+        case TurboOpCode::GetIndex: opName = "GetIndex"; break;
+        case TurboOpCode::SetIndex: opName = "SetIndex"; break;
+        case TurboOpCode::StringConcat: opName = "StringConcat"; break;
         case TurboOpCode::GetThis: opName = "GetThis"; break;
         case TurboOpCode::SetThisProperty: opName = "SetThisProperty"; break;
         case TurboOpCode::Halt: opName = "Halt"; break;
@@ -3299,6 +3360,12 @@ size_t PeregrineCodeGen::disassembleInstruction(const TurboChunk* chunk, size_t
         case TurboOpCode::StoreUpvalueVar: opName = "StoreUpvalueVar"; break;
         case TurboOpCode::StoreUpvalueLet: opName = "StoreUpvalueLet"; break;
         case TurboOpCode::StoreUpvalueConst: opName = "StoreUpvalueConst"; break;
+        case TurboOpCode::CreateLocalBox: opName = "CreateLocalBox"; break;
+        case TurboOpCode::StoreLocalBox: opName = "StoreLocalBox"; break;
+        case TurboOpCode::LoadLocalBox: opName = "LoadLocalBox"; break;
+        case TurboOpCode::CaptureLocal: opName = "CaptureLocal"; break;
+        case TurboOpCode::CaptureLocalBox: opName = "CaptureLocalBox"; break;
+        case TurboOpCode::CaptureUpvalue: opName = "CaptureUpvalue"; break;
         case TurboOpCode::LoadUpvalue: opName = "LoadUpvalue"; break;
         case TurboOpCode::SetClosureIsLocal: opName = "SetClosureIsLocal"; break;
         case TurboOpCode::SetClosureIndex: opName = "SetClosureIndex"; break;
@@ -3368,6 +3435,7 @@ size_t PeregrineCodeGen::disassembleInstruction(const TurboChunk* chunk, size_t
 }
 
 void PeregrineCodeGen::disassembleChunk(const TurboChunk* chunk, const std::string& name) {
+    if (!module_->disassemble) return;
     std::cout << "== " << name << " ==\n";
     for (size_t offset = 0; offset < chunk->code.size();) {
         offset = disassembleInstruction(chunk, offset);
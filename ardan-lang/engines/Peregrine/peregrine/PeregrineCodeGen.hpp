@@ -109,7 +109,9 @@ class PeregrineCodeGen : public ExpressionVisitor, public StatementVisitor {
 
 private:
     shared_ptr<TurboChunk> cur; 
-    PeregrineCodeGen* enclosing;
+    PeregrineCodeGen* enclosing = nullptr;
+    // variables of the top level once it is generated, for deferred functions
+    shared_ptr<vector<Variable>> deferredScope;
     R create(string decl, uint32_t reg_slot, BindingKind kind);
     R store(string decl, uint32_t reg_slot);
     R load(string decl, uint32_t reg_slot);
@@ -131,18 +133,17 @@ private:
     string evaluate_property(Expression* expr);
     
     int compileMethod(MethodDefinition& method);
+    shared_ptr<TurboChunk> compileFunction(FunctionDeclaration* stmt, PeregrineCodeGen& nested);
+    uint32_t deferFunction(FunctionDeclaration* stmt, uint32_t& arity);
     int recordInstanceField(const string& classId, const string& fieldId, Expression* initExpr, const PropertyMeta& propMeta);
     
+    // template literal pieces joined by one StringConcat
+    static const size_t MAX_CONCAT_PARTS = 16;
+    
     void emit(TurboOpCode op);
     int emitConstant(const Value &v);
     void emitLoop(uint32_t loopStart);
-    
-    int emitTryPlaceholder();
-    void patchTry(int tryPos, int reg);
-    void patchTryFinally(int tryPos, int target);
-    void patchTryCatch(int tryPos, int target);
-    
-    void declareVariableScoping(const std::string& name, BindingKind kind);
+        void declareVariableScoping(const std::string& name, BindingKind kind);
     void emitSetLocal(int slot);
     
     void declareGlobal(const string& name, BindingKind kind);
@@ -164,6 +165,12 @@ private:
     
     vector<ExceptionHandler> handlerStack;
     
+    // try blocks around the code being compiled; a return inside one is
+    // not a tail call, since its catch or finally still has to run
+    int tryDepth = 0;
+    // set while compiling the call a return statement returns
+    bool tailCall = false;
+    
     void beginScope();
     void endScope();
     int addUpvalue(bool isLocal, int index, string name, BindingKind kind);
@@ -11,6 +11,8 @@
 #include <sstream>
 
 #include <filesystem>
+#include <chrono>
+#include <sys/resource.h>
 
 #include "Scanner/Scanner.hpp"
 #include "overloads/operators.h"
@@ -24,6 +26,13 @@
 
 #include "engines/Cascade/CodeGenerator.hpp"
 #include "Compiler/Compiler.hpp"
+#include "engines/Peregrine/PeregrineVM.hpp"
+#include "engines/Peregrine/peregrine/PeregrineCodeGen.hpp"
+#include "engines/Atlas/Atlas.hpp"
+#include "engines/DeathStar/DeathStar.hpp"
+#include "IR/ir/IRBuilderVisitor/IRBuilderVisitor.hpp"
+#include "Profiler/Profiler.hpp"
+#include "Profiler/AllocStats.hpp"
 
 string read_file(const string& filename);
 
@@ -535,14 +544,18 @@ string get_entry_file() {
     
 }
 
-vector<unique_ptr<Statement>> get_ast(string source, string filename) {
+// deferFunctions: pre-parse top-level function bodies, for engines that
+// compile them on first call (nova and peregrine)
+vector<unique_ptr<Statement>> get_ast(string source, string filename, bool deferFunctions = false) {
     
-    Scanner scanner(source);
+    // deferred bodies are parsed from this later
+    auto text = make_shared<string>(std::move(source));
     
-    auto tokens = scanner.getTokens();
+    Scanner scanner(*text);
 
-    Parser parser(tokens);
+    Parser parser(scanner);
     parser.sourceFile = filename;
+    if (deferFunctions && defer_function_bodies) parser.deferFunctionBodies(text);
     
     auto ast = parser.parse();
     
@@ -569,6 +582,146 @@ void run_compiler(string& filename, string& source) {
     
 }
 
+// --prof[=nova|peregrine]: runs the script on a register VM under the
+// sampling profiler and writes <output>.folded and <output>.pb
+void run_profiler(string& filename, string& source, const string& engine, const string& output) {
+    
+    auto ast = get_ast(source, filename, true);
+    auto module_ = make_shared<TurboModule>();
+    
+    Profiler& profiler = Profiler::getInstance();
+    profiler.script = filename;
+    
+    if (engine == "nova") {
+        
+        TurboCodeGen codegen(module_);
+        codegen.generate(ast);
+        
+        TurboVM vm(module_);
+        profiler.start();
+        vm.run(module_->chunks[module_->entryChunkIndex], {});
+        profiler.stop();
+        
+    } else {
+        
+        PeregrineCodeGen codegen(module_);
+        codegen.generate(ast);
+        
+        PeregrineVM vm(module_);
+        profiler.start();
+        vm.run(module_->chunks[module_->entryChunkIndex], {});
+        profiler.stop();
+        
+    }
+    
+    profiler.writeCollapsed(output + ".folded");
+    profiler.writePprof(output + ".pb");
+    
+    cerr << "profile: " << profiler.sampleCount() << " samples written to "
+         << output << ".folded and " << output << ".pb\n";
+    
+}
+
+// --engine=<name>: runs the script on one execution engine
+void run_engine(string& filename, string& source, const string& engine) {
+    
+    auto ast = get_ast(source, filename, engine == "nova" || engine == "peregrine");
+    auto module_ = make_shared<TurboModule>();
+    
+    if (engine == "interpreter") {
+        
+        Interpreter interpreter;
+        interpreter.execute(std::move(ast));
+        
+    } else if (engine == "cascade") {
+        
+        Compiler compiler;
+        compiler.run(compiler.compile(ast));
+        
+    } else if (engine == "nova") {
+        
+        TurboCodeGen codegen(module_);
+        codegen.generate(ast);
+        
+        TurboVM vm(module_);
+        vm.run(module_->chunks[module_->entryChunkIndex], {});
+        
+    } else if (engine == "peregrine") {
+        
+        PeregrineCodeGen codegen(module_);
+        codegen.generate(ast);
+        
+        PeregrineVM vm(module_);
+        vm.run(module_->chunks[module_->entryChunkIndex], {});
+        
+    } else if (engine == "atlas") {
+        
+        PeregrineCodeGen codegen(module_);
+        codegen.generate(ast);
+        
+        runAtlas(module_);
+        
+    } else if (engine == "deathstar") {
+        
+        IRBuilderVisitor builder;
+        builder.build(ast);
+        
+        AssemblyLine assembly;
+        Compiled compiled = assembly.start(builder.irModule);
+        
+        DeathStar vm(compiled);
+        vm.runProgram();
+        
+    } else {
+        throw runtime_error("Unknown engine: " + engine);
+    }
+    
+}
+
+// --stats: one JSON line on stderr for the bench runner
+void print_run_stats(const string& engine, const string& filename, double wall_ms) {
+    
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    
+#ifdef __APPLE__
+    long peak_rss_kb = usage.ru_maxrss / 1024;
+#else
+    long peak_rss_kb = usage.ru_maxrss;
+#endif
+    
+    cerr << "ardan-stats {\"engine\": \"" << engine
+         << "\", \"script\": \"" << filename
+         << "\", \"wall_ms\": " << wall_ms
+         << ", \"peak_rss_kb\": " << peak_rss_kb
+         << ", \"allocations\": " << AllocStats::count()
+         << ", \"allocated_bytes\": " << AllocStats::bytes() << "}\n";
+    
+}
+
+// --scan-only / --parse-only: times the front end alone for
+// bench/parse_throughput.sh
+void run_front_end(string& filename, string& source, bool parse, bool stats) {
+    
+    auto start = chrono::steady_clock::now();
+    
+    if (parse) {
+        
+        auto ast = get_ast(source, filename);
+        chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+        if (stats) print_run_stats("parse", filename, elapsed.count());
+        
+    } else {
+        
+        Scanner scanner(source);
+        while (scanner.nextToken().type != TokenType::END_OF_FILE) {}
+        chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+        if (stats) print_run_stats("scan", filename, elapsed.count());
+        
+    }
+    
+}
+
 void test() {
     
     string entryFileName = "/Users/chidumennamdi/Documents/MacBookPro2020/developerse/xcode-prjs/ardan-lang/ardan-lang/tests/arm64.ardan";
@@ -601,6 +754,13 @@ int main(int argc, const char * argv[]) {
     bool compile_run = false;
     bool repl_it = false;
     bool new_project = false;
+    bool profile = false;
+    bool stats = false;
+    bool scan_only = false;
+    bool parse_only = false;
+    string engine;
+    string prof_engine = "peregrine";
+    string prof_output = "ardan.prof";
     string e;
     
     string filename;
@@ -623,13 +783,57 @@ int main(int argc, const char * argv[]) {
             e = param.substr(4); // after "--e="
         } else if (param == "--e" && (i+1 < argc)) {
             e = argv[++i];
+        } else if (param == "--prof") {
+            profile = true;
+        } else if (param.find("--prof=") == 0) {
+            profile = true;
+            prof_engine = param.substr(7);
+        } else if (param.find("--prof-out=") == 0) {
+            prof_output = param.substr(11);
+        } else if (param.find("--engine=") == 0) {
+            engine = param.substr(9);
+        } else if (param == "--stats") {
+            stats = true;
+        } else if (param == "--scan-only") {
+            scan_only = true;
+        } else if (param == "--parse-only") {
+            parse_only = true;
+        } else if (param == "--no-fuse") {
+            superinstructions_enabled = false;
+        } else if (param == "--eager") {
+            defer_function_bodies = false;
+        } else if (param.find("--stack-size=") == 0) {
+            call_stack_limit = stoul(param.substr(13));
         } else {
             filename = param;
         }
         
     }
             
-    if (interpret) {
+    if (scan_only || parse_only) {
+        
+        if (!e.empty()) filename = e;
+        string source = read_file(filename);
+        run_front_end(filename, source, parse_only, stats);
+        
+    } else if (!engine.empty() && !profile) {
+        
+        if (!e.empty()) filename = e;
+        string source = read_file(filename);
+        
+        auto start = chrono::steady_clock::now();
+        run_engine(filename, source, engine);
+        chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+        
+        if (stats) print_run_stats(engine, filename, elapsed.count());
+        
+    } else if (profile) {
+        
+        if (!e.empty()) filename = e;
+        string source = read_file(filename);
+        run_profiler(filename, source, prof_engine, prof_output);
+        
+    } else if (interpret) {
         
         string source = read_file(filename);
         run_interpreter(filename, source);
@@ -0,0 +1,47 @@
+#!/bin/bash
+#
+# Counts instructions dispatched per workload with and without
+# superinstruction fusion. Needs a binary built with -DARDAN_OPCODE_STATS=ON.
+#
+#   bench/dispatch_counts.sh path/to/ardan [--engines=nova,peregrine]
+
+ARDAN=./ardan
+ENGINES=nova,peregrine
+BENCH_DIR=$(cd "$(dirname "$0")" && pwd)
+
+for arg in "$@"; do
+    case $arg in
+        --engines=*) ENGINES=${arg#*=} ;;
+        *) ARDAN=$arg ;;
+    esac
+done
+
+ARDAN=$(cd "$(dirname "$ARDAN")" && pwd)/$(basename "$ARDAN")
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+cd "$WORK_DIR"
+
+dispatches() {
+    # dispatches <engine> <workload> [flags] -> instruction count, or "-"
+    rm -f "$1.opstats.json"
+    ( "$ARDAN" --engine="$1" $3 "$2" > /dev/null 2>&1; exit $? ) 2> /dev/null
+    sed -n 's/.*"instructions": \([0-9]*\).*/\1/p' "$1.opstats.json" 2> /dev/null | grep . || echo -
+}
+
+printf "%-16s %-10s %12s %12s %8s\n" workload engine unfused fused saved
+
+for workload in "$BENCH_DIR"/workloads/*.ardan; do
+    name=$(basename "$workload" .ardan)
+
+    for engine in ${ENGINES//,/ }; do
+        unfused=$(dispatches "$engine" "$workload" --no-fuse)
+        fused=$(dispatches "$engine" "$workload")
+
+        saved=-
+        if [ "$unfused" != - ] && [ "$fused" != - ]; then
+            saved=$(awk "BEGIN { printf \"%.1f%%\", 100 * ($unfused - $fused) / $unfused }")
+        fi
+
+        printf "%-16s %-10s %12s %12s %8s\n" "$name" "$engine" "$unfused" "$fused" "$saved"
+    done
+done
@@ -0,0 +1,81 @@
+#!/bin/bash
+#
+# Measures front-end throughput in MB/s on a large generated source: the
+# scanner alone (--scan-only) and scanning plus parsing (--parse-only).
+#
+#   bench/parse_throughput.sh [path/to/ardan] [--lines=N] [--runs=N]
+#
+# The source repeats a block of declarations, loops, classes, object and
+# template literals with fresh names until it has about --lines lines.
+
+ARDAN=./ardan
+LINES=50000
+RUNS=5
+
+for arg in "$@"; do
+    case $arg in
+        --lines=*) LINES=${arg#*=} ;;
+        --runs=*) RUNS=${arg#*=} ;;
+        *) ARDAN=$arg ;;
+    esac
+done
+
+if [ ! -x "$ARDAN" ]; then
+    echo "ardan binary not found: $ARDAN" >&2
+    exit 1
+fi
+
+SOURCE=$(mktemp --suffix=.ardan 2> /dev/null || mktemp)
+trap 'rm -f "$SOURCE"' EXIT
+
+block() {
+    # block <n> -> 23 lines of code whose names end in n
+    cat << EOF
+// block $1: helpers and a small class
+function scale_$1(values, factor) {
+    let out = [];
+    for (let i = 0; i < values.length; i++) {
+        out.push(values[i] * factor + $1);
+    }
+    return out;
+}
+
+const config_$1 = { name: "block-$1", size: $1, ratio: 0.75, tags: ["a", "b"] };
+
+class Shape_$1 {
+    constructor(width, height) {
+        this.width = width;
+        this.height = height;
+    }
+    area() {
+        return this.width * this.height;
+    }
+}
+
+let label_$1 = \`shape \${config_$1.name} has area \${new Shape_$1(2, 3).area()}\`;
+let total_$1 = config_$1.size > 10 ? scale_$1([1, 2, 3], 2).length : 0;
+EOF
+}
+
+for ((n = 0; n * 23 < LINES; n++)); do
+    block $n
+done > "$SOURCE"
+
+BYTES=$(wc -c < "$SOURCE")
+echo "source: $(wc -l < "$SOURCE") lines, $BYTES bytes"
+
+for mode in scan parse; do
+    best=""
+    for ((run = 0; run < RUNS; run++)); do
+        stats=$("$ARDAN" --$mode-only --stats "$SOURCE" 2>&1 > /dev/null | grep '^ardan-stats ' | tail -1)
+        wall=$(echo "$stats" | sed -n 's/.*"wall_ms": \([0-9.e+-]*\).*/\1/p')
+        if [ -z "$wall" ]; then
+            echo "$mode: failed" >&2
+            exit 1
+        fi
+        if [ -z "$best" ] || awk "BEGIN { exit !($wall < $best) }"; then
+            best=$wall
+        fi
+    done
+    awk "BEGIN { printf \"%-6s %10.2f ms %10.1f MB/s\n\", \"$mode\", $best, $BYTES / 1048576 / ($best / 1000) }"
+done
@@ -0,0 +1,118 @@
+#!/bin/bash
+#
+# Runs every workload in bench/workloads under each engine and reports wall
+# time, ops/sec, peak RSS and allocation counts.
+#
+#   bench/run_bench.sh [path/to/ardan] [--engines=a,b,..] [--runs=N]
+#                      [--timeout=SECONDS] [--out=results.jsonl]
+#
+# Each workload declares its operation count in a "// ops: N" header and the
+# value of its final "result" line in a "// expect: X" header, so a fast but
+# wrong engine shows up as "mismatch". One JSON object per workload/engine
+# pair is written to the --out file.
+
+ARDAN=./ardan
+ENGINES=interpreter,cascade,nova,peregrine,atlas,deathstar
+RUNS=3
+TIMEOUT=60
+OUT=bench_results.jsonl
+BENCH_DIR=$(cd "$(dirname "$0")" && pwd)
+
+for arg in "$@"; do
+    case $arg in
+        --engines=*) ENGINES=${arg#*=} ;;
+        --runs=*) RUNS=${arg#*=} ;;
+        --timeout=*) TIMEOUT=${arg#*=} ;;
+        --out=*) OUT=${arg#*=} ;;
+        *) ARDAN=$arg ;;
+    esac
+done
+
+if [ ! -x "$ARDAN" ]; then
+    echo "ardan binary not found: $ARDAN" >&2
+    exit 1
+fi
+
+json_field() {
+    # json_field <line> <key> -> value of a number field in an ardan-stats line
+    echo "$1" | sed -n "s/.*\"$2\": \([0-9.e+-]*\).*/\1/p"
+}
+
+: > "$OUT"
+FAILED=0
+TMP_OUT=$(mktemp)
+TMP_ERR=$(mktemp)
+trap 'rm -f "$TMP_OUT" "$TMP_ERR"' EXIT
+
+printf "%-16s %-12s %-9s %10s %12s %10s %12s\n" \
+    workload engine status wall_ms ops/sec rss_kb allocs
+
+for workload in "$BENCH_DIR"/workloads/*.ardan; do
+    name=$(basename "$workload" .ardan)
+    ops=$(sed -n 's|^// ops: *\([0-9]*\).*|\1|p' "$workload" | head -1)
+    expected=$(sed -n 's|^// expect: *||p' "$workload" | head -1)
+
+    for engine in ${ENGINES//,/ }; do
+        status=ok
+        best_ms=""
+        rss=0
+        allocs=0
+        bytes=0
+        result=""
+
+        for ((run = 0; run < RUNS; run++)); do
+            # the subshell keeps bash's "Segmentation fault" notices out of the table
+            ( timeout "$TIMEOUT" "$ARDAN" --engine="$engine" --stats "$workload" \
+                > "$TMP_OUT" 2> "$TMP_ERR"; exit $? ) 2> /dev/null
+            code=$?
+
+            if [ $code -eq 124 ]; then
+                status=timeout
+                break
+            fi
+
+            stats=$(grep '^ardan-stats ' "$TMP_ERR" | tail -1)
+            if [ $code -ne 0 ] || [ -z "$stats" ]; then
+                status=crash
+                break
+            fi
+
+            result=$(sed -n 's/^result, *//p' "$TMP_OUT" | tail -1)
+            wall=$(json_field "$stats" wall_ms)
+
+            if [ -z "$best_ms" ] || awk "BEGIN { exit !($wall < $best_ms) }"; then
+                best_ms=$wall
+                rss=$(json_field "$stats" peak_rss_kb)
+                allocs=$(json_field "$stats" allocations)
+                bytes=$(json_field "$stats" allocated_bytes)
+            fi
+        done
+
+        if [ $status = ok ] && [ "$result" != "$expected" ]; then
+            status=mismatch
+        fi
+
+        if [ $status = ok ] || [ $status = mismatch ]; then
+            ops_per_sec=$(awk "BEGIN { printf \"%.0f\", $ops / ($best_ms / 1000) }")
+        else
+            best_ms=null
+            ops_per_sec=null
+            rss=null
+            allocs=null
+            bytes=null
+        fi
+
+        [ $status = ok ] || let FAILED++
+
+        printf "%-16s %-12s %-9s %10s %12s %10s %12s\n" \
+            "$name" "$engine" "$status" "$best_ms" "$ops_per_sec" "$rss" "$allocs"
+
+        echo "{\"workload\": \"$name\", \"engine\": \"$engine\", \"status\": \"$status\"," \
+             "\"ops\": ${ops:-0}, \"runs\": $RUNS, \"wall_ms\": $best_ms," \
+             "\"ops_per_sec\": $ops_per_sec, \"peak_rss_kb\": $rss," \
+             "\"allocations\": $allocs, \"allocated_bytes\": $bytes}" >> "$OUT"
+    done
+done
+
+echo
+echo "results written to $OUT ($FAILED non-ok runs)"